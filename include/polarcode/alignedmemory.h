@@ -0,0 +1,44 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PC_ALIGNEDMEMORY_H
+#define PC_ALIGNEDMEMORY_H
+
+#include <polarcode/isadispatch.h>
+
+#include <cstddef>
+
+namespace PolarCode {
+
+/*!
+ * \brief Allocate aligned memory for decoder buffers.
+ *
+ * DataPools, PathArenas and the node memory of tree decoders allocate
+ * through this function and count their allocations, so that tests can
+ * check that decoding a frame does not allocate.
+ *
+ * \param bytes Size of the memory, at least one byte is allocated.
+ * \param alignment Alignment of the memory, a power of two.
+ * \throw std::bad_alloc if no memory is left.
+ */
+POLARCODE_SHARED void* alignedAlloc(size_t bytes, size_t alignment);
+
+/*!
+ * \brief Free memory obtained from alignedAlloc(). Null pointers are ignored.
+ */
+POLARCODE_SHARED void alignedFree(void* ptr);
+
+/*!
+ * \brief Get the number of alignedAlloc() calls of this process, kernel modules
+ *        included.
+ */
+POLARCODE_SHARED size_t alignedAllocationCount();
+
+} // namespace PolarCode
+
+#endif // PC_ALIGNEDMEMORY_H
@@ -17,7 +17,66 @@ union HybridFloat {
     int i;
 };
 
-#ifndef __AVX2__
+#ifdef POLARCODE_AVX512
+#if !defined(__AVX512BW__) || !defined(__AVX512VL__)
+#error "POLARCODE_AVX512 requires a target with AVX-512BW and AVX-512VL"
+#endif
+#define BITSPERVECTOR 512
+#define BYTESPERVECTOR 64
+typedef __m512i fipv; // fixed point vector type
+
+#define fi_load _mm512_load_si512
+#define fi_store _mm512_store_si512
+
+#define fi_setzero _mm512_setzero_si512
+#define fi_set1_epi8 _mm512_set1_epi8
+
+#define fi_and _mm512_and_si512
+#define fi_or _mm512_or_si512
+#define fi_xor _mm512_xor_si512
+
+#define fi_add_epi64 _mm512_add_epi64
+
+#define fi_adds_epi8 _mm512_adds_epi8
+#define fi_subs_epi8 _mm512_subs_epi8
+
+#define fi_min_epi8 _mm512_min_epi8
+#define fi_min_epu8 _mm512_min_epu8
+#define fi_max_epi8 _mm512_max_epi8
+#define fi_max_epu8 _mm512_max_epu8
+
+#define fi_abs_epi8 _mm512_abs_epi8
+
+// Sign bits into a 64-bit mask register
+#define fi_movemask_epi8 _mm512_movepi8_mask
+
+/*
+ * AVX-512 compares into mask registers and lacks byte-wise sign and variable
+ * blend instructions, the vector forms below are built from masks.
+ */
+static inline __m512i fi_blendv_epi8(__m512i a, __m512i b, __m512i mask)
+{
+    return _mm512_mask_blend_epi8(_mm512_movepi8_mask(mask), a, b);
+}
+
+static inline __m512i fi_sign_epi8(__m512i a, __m512i b)
+{
+    const __m512i negated =
+        _mm512_mask_sub_epi8(a, _mm512_movepi8_mask(b), _mm512_setzero_si512(), a);
+    return _mm512_maskz_mov_epi8(_mm512_test_epi8_mask(b, b), negated);
+}
+
+static inline __m512i fi_cmpeq_epi8(__m512i a, __m512i b)
+{
+    return _mm512_movm_epi8(_mm512_cmpeq_epi8_mask(a, b));
+}
+
+static inline __m512i fi_cmpgt_epi8(__m512i a, __m512i b)
+{
+    return _mm512_movm_epi8(_mm512_cmpgt_epi8_mask(a, b));
+}
+
+#elif !defined(__AVX2__)
 #define BITSPERVECTOR 128
 #define BYTESPERVECTOR 16
 typedef __m128i fipv; // fixed point vector type
@@ -47,6 +106,10 @@ typedef __m128i fipv; // fixed point vector type
 #define fi_abs_epi8 _mm_abs_epi8
 #define fi_sign_epi8 _mm_sign_epi8
 
+#define fi_cmpeq_epi8 _mm_cmpeq_epi8
+#define fi_cmpgt_epi8 _mm_cmpgt_epi8
+#define fi_movemask_epi8 _mm_movemask_epi8
+
 
 #else
 #define BITSPERVECTOR 256
@@ -78,6 +141,10 @@ typedef __m256i fipv; // fixed point vector type
 #define fi_abs_epi8 _mm256_abs_epi8
 #define fi_sign_epi8 _mm256_sign_epi8
 
+#define fi_cmpeq_epi8 _mm256_cmpeq_epi8
+#define fi_cmpgt_epi8 _mm256_cmpgt_epi8
+#define fi_movemask_epi8 _mm256_movemask_epi8
+
 #endif
 
 
@@ -253,6 +320,41 @@ static inline unsigned char reduce_xor(__m256i x)
 
 #endif
 
+#ifdef POLARCODE_AVX512
+/*
+ * The 512-bit reductions fold the upper onto the lower half and continue with
+ * the 256-bit versions.
+ */
+static inline char reduce_adds_epi8(__m512i x)
+{
+    return reduce_adds_epi8(
+        _mm256_adds_epi8(_mm512_castsi512_si256(x), _mm512_extracti64x4_epi64(x, 1)));
+}
+
+static inline __m512i half_reduce_adds_epi8(__m512i x)
+{
+    const __m512i halves = _mm512_shuffle_i64x2(x, x, 0b01001110);
+    const __m512i x32 = _mm512_adds_epi8(x, halves);
+    const __m512i lanes = _mm512_shuffle_i64x2(x32, x32, 0b10110001);
+    const __m512i x16 = _mm512_adds_epi8(x32, lanes);
+    const __m512i x8 = _mm512_adds_epi8(
+        x16, _mm512_shuffle_epi8(x16, _mm512_broadcast_i64x4(SHUFFLE_MASK_X8)));
+    const __m512i x4 = _mm512_adds_epi8(
+        x8, _mm512_shuffle_epi8(x8, _mm512_broadcast_i64x4(SHUFFLE_MASK_X4)));
+    const __m512i x2 = _mm512_adds_epi8(
+        x4, _mm512_shuffle_epi8(x4, _mm512_broadcast_i64x4(SHUFFLE_MASK_X2)));
+    return x2;
+}
+
+static inline long long reduce_add_epi64(__m512i x) { return _mm512_reduce_add_epi64(x); }
+
+static inline unsigned char reduce_xor(__m512i x)
+{
+    return reduce_xor(
+        _mm256_xor_si256(_mm512_castsi512_si256(x), _mm512_extracti64x4_epi64(x, 1)));
+}
+#endif
+
 static inline float reduce_add_ps(__m256 x)
 {
     /*	// ( x3+x7, x2+x6, x1+x5, x0+x4 )
@@ -281,6 +383,14 @@ static inline char reduce_adds_epi8(__m128i x)
     return ((char*)&x8)[0];
 }
 
+static inline __m128i half_reduce_adds_epi8(__m128i x)
+{
+    const __m128i x8 = _mm_adds_epi8(x, _mm_shuffle_epi32(x, 0b01001110));
+    const __m128i x4 = _mm_adds_epi8(x8, _mm_shuffle_epi32(x8, 0b10110001));
+    const __m128i x2 = _mm_shufflelo_epi16(x4, 0b10110001);
+    return _mm_adds_epi8(x4, _mm_shufflehi_epi16(x2, 0b10110001));
+}
+
 static inline int reduce_or_epi32(__m128i x)
 {
     const __m128i x64 = _mm_or_si128(x, _mm_srli_si128(x, 8));
@@ -421,6 +531,21 @@ __m256i subVectorBackShift_epu8(__m256i x, int shift);
 __m256i subVectorShiftBytes_epu8(__m256i x, int shift);
 __m256i subVectorBackShiftBytes_epu8(__m256i x, int shift);
 
+#ifdef POLARCODE_AVX512
+/*!
+ * \brief Returns the index of the first smallest unsigned byte of x.
+ *
+ * The minimum is found by folding the vector in halves, its position by
+ * comparing x against it into a mask register.
+ */
+unsigned minpos_epu8(__m512i x, char* val = nullptr);
+
+__m512i subVectorShift_epu8(__m512i x, int shift);
+__m512i subVectorBackShift_epu8(__m512i x, int shift);
+__m512i subVectorShiftBytes_epu8(__m512i x, int shift);
+__m512i subVectorBackShiftBytes_epu8(__m512i x, int shift);
+#endif
+
 #else
 
 /** \brief Returns the index of the smallest element of x.
@@ -472,6 +597,17 @@ __m128i subVectorBackShiftBytes_epu8(__m128i x, int shift);
 
 #endif
 
+/*!
+ * \brief Parity of the sign bits of all bytes, i.e. of the hard decisions.
+ */
+static inline bool sign_parity_epi8(fipv x)
+{
+#ifdef POLARCODE_AVX512
+    return __builtin_parityll(fi_movemask_epi8(x));
+#else
+    return __builtin_parity(static_cast<unsigned>(fi_movemask_epi8(x)));
+#endif
+}
 
 __m256 _mm256_subVectorShift_ps(__m256 x, int shift);
 __m256 _mm256_subVectorBackShift_ps(__m256 x, int shift);
@@ -0,0 +1,98 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PC_CON_CONSTRUCTIONCACHE_H
+#define PC_CON_CONSTRUCTIONCACHE_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace PolarCode {
+namespace Construction {
+
+/*!
+ * \brief Thread-safe store of constructed frozen bit sets.
+ *
+ * Entries are keyed by block length, information length, design-SNR and the
+ * canonical construction method (see constructorName()). Parameter sweeps and
+ * repeated jobs therefore construct each code only once per process.
+ *
+ * If a file is attached, its entries are loaded and every new construction is
+ * appended to it, so later processes start with a warm cache. The file holds
+ * one line per code: method, N, K, design-SNR and the frozen bit indices.
+ * Lines are appended and read under flock(), so several processes may share
+ * the file. File access happens without holding the cache lock.
+ */
+class ConstructionCache
+{
+public:
+    typedef std::shared_ptr<const std::vector<unsigned>> frozen_t;
+
+private:
+    typedef std::tuple<std::string, size_t, size_t, float> key_t;
+
+    std::mutex mMutex;
+    std::map<key_t, frozen_t> mEntries;
+    std::string mFileName;
+
+    static void append(const std::string& fileName,
+                       const key_t& key,
+                       const std::vector<unsigned>& frozenBits);
+
+public:
+    ConstructionCache();
+    ~ConstructionCache();
+
+    ConstructionCache(const ConstructionCache&) = delete;
+    ConstructionCache& operator=(const ConstructionCache&) = delete;
+
+    /*!
+     * \brief The process-wide cache, used by frozen_bits().
+     */
+    static ConstructionCache& global();
+
+    /*!
+     * \brief Get the frozen bits of a code, constructing it on first use.
+     * \param N Code length.
+     * \param K Information length.
+     * \param designSnr Design-SNR in dB.
+     * \param type Construction method, as for create().
+     * \return The sorted set of frozen bits, shared with other callers.
+     */
+    frozen_t frozenBits(size_t N, size_t K, float designSnr, const std::string& type);
+
+    /*!
+     * \brief Load entries from _fileName_ and append new ones to it.
+     *
+     * A missing file is created with the first new entry. Malformed lines,
+     * and lines whose frozen bits are not N-K unique indices below N, are
+     * skipped.
+     *
+     * \return The number of entries loaded.
+     */
+    size_t attachFile(const std::string& fileName);
+
+    /*!
+     * \brief Drop all entries. An attached file is left untouched.
+     */
+    void clear();
+
+    /*!
+     * \brief Get the number of cached codes.
+     */
+    size_t size();
+};
+
+} // namespace Construction
+} // namespace PolarCode
+
+#endif // PC_CON_CONSTRUCTIONCACHE_H
@@ -10,6 +10,7 @@
 #define PC_CON_CONSTRUCTOR_H
 
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -55,6 +56,28 @@ public:
     void setDesignSnr(float designSnr);
 };
 
+/*!
+ * \brief Get the canonical name of a construction method.
+ * \param constructor_type Case-insensitive type, "BE", "5G", "GA" or "BB" (default).
+ * \return One of "BE", "5G", "GA" or "BB".
+ */
+std::string constructorName(const std::string& constructor_type);
+
+/*!
+ * \brief Create a constructor for the given code parameters.
+ * \sa constructorName()
+ */
+std::unique_ptr<Constructor>
+create(const size_t blockLength,
+       const size_t infoLength,
+       const float designSNR,
+       const std::string& constructor_type = std::string("BB"));
+
+/*!
+ * \brief Get the frozen bits of a code, reusing earlier constructions.
+ *
+ * Results are kept in ConstructionCache::global().
+ */
 std::vector<unsigned>
 frozen_bits(const int blockLength,
             const int infoLength,
@@ -0,0 +1,80 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PC_CON_GAUSSIANAPPROXIMATION_H
+#define PC_CON_GAUSSIANAPPROXIMATION_H
+
+#include <polarcode/construction/constructor.h>
+#include <memory>
+#include <vector>
+
+namespace PolarCode {
+namespace Construction {
+
+/*!
+ * \brief Code Construction via Gaussian Approximation
+ *
+ * The mean LLR of every bit channel is tracked through the polarization
+ * stages under the assumption of Gaussian distributed LLRs, using the
+ * piecewise approximation of the phi-function by Dai et al. The channels
+ * with the lowest mean LLR are frozen.
+ *
+ * The reliability order only depends on the block length and the design-SNR,
+ * so it is computed once per pair and shared by all instances in the process.
+ *
+ * See "Does Gaussian Approximation Work Well for the Long-Length Polar Code
+ * Construction?" by Jincheng Dai, Kai Niu, Zhongwei Si, Chao Dong, Jiaru Lin
+ * Published in: IEEE Access, Vol. 5, 2017
+ */
+class GaussianApproximation : public Constructor
+{
+public:
+    GaussianApproximation();
+
+    /*!
+     * \brief Create the constructor and initialize the length parameters.
+     * \param N Code length.
+     * \param K Information length.
+     */
+    GaussianApproximation(size_t N, size_t K);
+
+    /*!
+     * \brief Create the constructor and initialize all parameters.
+     * \param N Code length.
+     * \param K Information length.
+     * \param designSnr Signal-to-noise ratio of an AWGN channel for code optimization.
+     */
+    GaussianApproximation(size_t N, size_t K, float designSnr);
+    ~GaussianApproximation();
+
+    /*!
+     * \brief Executes the construction algorithm.
+     * \return The set of frozen bits.
+     */
+    std::vector<unsigned> construct();
+
+    /*!
+     * \brief Get the mean LLR of all bit channels.
+     * \param N Code length.
+     * \param designSnr The design-SNR in dB.
+     */
+    static std::vector<double> meanLlrs(size_t N, float designSnr);
+
+    /*!
+     * \brief Get all bit channels, sorted from least to most reliable.
+     *
+     * Results are memoized, repeated calls return the same shared table.
+     */
+    static std::shared_ptr<const std::vector<unsigned>> reliabilityOrder(size_t N,
+                                                                         float designSnr);
+};
+
+} // namespace Construction
+} // namespace PolarCode
+
+#endif // PC_CON_GAUSSIANAPPROXIMATION_H
@@ -9,12 +9,13 @@
 #ifndef PC_DATAPOOL_TXX
 #define PC_DATAPOOL_TXX
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <iostream>
-#include <map>
-#include <stack>
+#include <vector>
 
+#include <polarcode/alignedmemory.h>
 #include <polarcode/avxconvenience.h>
 
 namespace PolarCode {
@@ -24,71 +25,108 @@ struct Block {
     size_t useCount;
     size_t size;
     mT* data;
+    Block<mT>* next;    ///< Intrusive link of the free list
+    unsigned sizeClass; ///< Capacity is (1 << sizeClass) elements
 };
 
 /*!
  * \brief A class that saves complexity in memory allocation, if blocks of few
  * distinct sizes are heavily re-used.
+ *
+ * Block sizes are rounded up to powers of two and every size class keeps an
+ * intrusive free list, so allocate() and release() are a few pointer
+ * operations. Fresh blocks are carved from zeroed slabs, which stay owned by
+ * the pool until it is destroyed. Once the free lists have grown to the
+ * working set of a decoder, no further heap allocations take place.
  */
 template <typename T, size_t alignment>
 class DataPool
 {
-    std::map<size_t, std::stack<Block<T>*>> freeBlocks;
+    static const unsigned classCount = 8 * sizeof(size_t);
+    static const size_t slabBytes = 16384; ///< Preferred slab size
+
+    Block<T>* mFreeBlocks[classCount];
+    size_t mFreeCount[classCount];
+    std::vector<void*> mSlabs;
+    std::vector<Block<T>*> mHeaders;
+
+    static unsigned sizeClass(size_t size)
+    {
+        // ceil(log2(size)), which is ctz() of the size rounded up to a power of two
+        size = std::max(alignment / sizeof(T), size);
+        return size > 1 ? classCount - __builtin_clzl(size - 1) : 0;
+    }
+
+    /*!
+     * \brief Add _count_ zeroed blocks of the given size class to its free list.
+     */
+    void grow(unsigned cls, size_t count)
+    {
+        const size_t blockBytes = sizeof(T) << cls;
+        void* ptr = alignedAlloc(blockBytes * count, alignment);
+        memset(ptr, 0, blockBytes * count);
+        mSlabs.push_back(ptr);
+
+        Block<T>* headers = new Block<T>[count];
+        mHeaders.push_back(headers);
+
+        for (size_t i = 0; i < count; ++i) {
+            headers[i].data =
+                reinterpret_cast<T*>(static_cast<char*>(ptr) + i * blockBytes);
+            headers[i].sizeClass = cls;
+            headers[i].next = mFreeBlocks[cls];
+            mFreeBlocks[cls] = headers + i;
+        }
+        mFreeCount[cls] += count;
+    }
 
 public:
-    DataPool() {}
+    DataPool()
+    {
+        std::fill(mFreeBlocks, mFreeBlocks + classCount, nullptr);
+        std::fill(mFreeCount, mFreeCount + classCount, 0);
+    }
 
     ~DataPool()
     {
-        for (auto& stack : freeBlocks) {
-            while (!stack.second.empty()) {
-                _mm_free(stack.second.top()->data);
-                delete stack.second.top();
-                stack.second.pop();
-            }
+        for (void* slab : mSlabs) {
+            alignedFree(slab);
+        }
+        for (Block<T>* headers : mHeaders) {
+            delete[] headers;
         }
     }
 
+    DataPool(const DataPool&) = delete;
+    DataPool& operator=(const DataPool&) = delete;
+
+    /*!
+     * \brief Get the number of unused blocks that could hold _size_ elements.
+     */
+    size_t freeBlockCount(size_t size) { return mFreeCount[sizeClass(size)]; }
+
     /*!
      * \brief Get a pointer to a data block of _size_ elements.
      *
-     * This function either allocates a new block or recalls a previously freed
-     * block from the stack of available blocks.
+     * This function either recalls a previously freed block from the free list
+     * of its size class or carves a new one from a fresh slab.
      *
      * \param size Number of elements to allocate.
      * \return Pointer to a new data block.
      */
     Block<T>* allocate(size_t size)
     {
-        Block<T>* block;
-
-        size = std::max(alignment / sizeof(T), size);
-
-        /* This change improves performance only slightly, but looks nice:
-         * Instead of searching the key, we simply try to access it and when failing,
-         * create a new element.
-         */
-        try {
-            (void)freeBlocks[size];
-        } catch (...) {
-            freeBlocks.insert({ size, std::stack<Block<T>*>() });
+        const unsigned cls = sizeClass(size);
+        if (mFreeBlocks[cls] == nullptr) {
+            grow(cls, std::max<size_t>(1, slabBytes / (sizeof(T) << cls)));
         }
 
-        if (freeBlocks[size].empty()) {
-            block = new Block<T>();
-            void* ptr = _mm_malloc(sizeof(T) * size, alignment);
-            if (ptr == nullptr) {
-                std::cerr << "Can't allocate aligned memory." << std::endl;
-            }
-            memset(ptr, 0, sizeof(T) * size);
-            block->data = reinterpret_cast<T*>(ptr);
-            block->useCount = 1;
-            block->size = size;
-        } else {
-            block = freeBlocks[size].top();
-            block->useCount = 1;
-            freeBlocks[size].pop();
-        }
+        Block<T>* block = mFreeBlocks[cls];
+        mFreeBlocks[cls] = block->next;
+        mFreeCount[cls]--;
+
+        block->useCount = 1;
+        block->size = size;
         return block;
     }
 
@@ -139,7 +177,9 @@ public:
             return;
         }
         if (--block->useCount == 0) {
-            freeBlocks[block->size].push(block);
+            block->next = mFreeBlocks[block->sizeClass];
+            mFreeBlocks[block->sizeClass] = block;
+            mFreeCount[block->sizeClass]++;
         }
         block = nullptr;
     }
@@ -45,6 +45,9 @@ public:
     void setSystematic(bool sys);
     void setErrorDetection(ErrorDetection::Detector* pDetector);
     void setSignal(const float* pLlr);
+
+    NodeProfile nodeProfile() const; ///< Profile of both internal decoders
+    void resetNodeProfile();
 };
 
 
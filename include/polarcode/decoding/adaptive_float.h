@@ -47,6 +47,9 @@ public:
     void setErrorDetection(ErrorDetection::Detector* pDetector);
     void setSignal(const float* pLlr);
 
+    NodeProfile nodeProfile() const; ///< Profile of both internal decoders
+    void resetNodeProfile();
+
     /*!
      * \brief Get decoder list size
      * \return size_t with Decoder List size.
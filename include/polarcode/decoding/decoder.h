@@ -13,6 +13,7 @@
 #include <string>
 
 #include <polarcode/bitcontainer.h>
+#include <polarcode/decoding/nodeprofile.h>
 #include <polarcode/errordetection/errordetector.h>
 
 namespace PolarCode {
@@ -30,6 +31,14 @@ struct CodingScheme {
 // scheme.
 extern std::vector<CodingScheme> codeRegistry;
 
+/*!
+ * \brief Look up a code in codeRegistry.
+ * \param blockLength Length of the Polar Code.
+ * \param frozenBits Set of frozen bits in the code word.
+ * \return The index of the matching scheme, or -1 if the code is not registered.
+ */
+int findCodingScheme(size_t blockLength, const std::vector<unsigned>& frozenBits);
+
 enum DecoderType { tFlexible, tFixed, tDepthFirst, tScan, tFastSscan };
 
 /*!
@@ -52,6 +61,7 @@ protected:
         mOutputContainer; ///< Final data container, gets filled for error detection
     std::vector<unsigned> mFrozenBits; ///< Indices for frozen bits
     bool mExternalContainers;          ///< On destruction, do not delete containers
+    NodeProfile mNodeProfile;          ///< Filled by profiling builds only
 
 public:
     Decoder();
@@ -75,12 +85,59 @@ public:
      */
     bool decode_vector(const char* pLlr, void* pData);
 
+    /*!
+     * \brief Decode a batch of consecutive frames.
+     *
+     * The frames are expected back to back in _pLlr_, each of blockLength()
+     * values. The packed information bits of frame i are written to
+     * _pData_ + i * ((infoLength() + 7) / 8). After a batch, packedOutput()
+     * does not necessarily hold the bits of the last frame.
+     *
+     * \param pLlr Pointer to nFrames * blockLength() float LLRs.
+     * \param nFrames Number of frames to decode.
+     * \param pData Destination of the packed information bits of all frames.
+     * \param pOk Optional array of nFrames flags for the error detection results.
+     * \return Number of frames without detected errors.
+     */
+    virtual size_t
+    decode_batch(const float* pLlr, size_t nFrames, void* pData, bool* pOk = nullptr);
+
+    /*!
+     * \brief Decode a batch of consecutive eight-bit integer LLR frames.
+     * \sa decode_batch(const float*, size_t, void*, bool*)
+     */
+    virtual size_t
+    decode_batch(const char* pLlr, size_t nFrames, void* pData, bool* pOk = nullptr);
+
+    /*!
+     * \brief Number of frames that decode_batch() decodes together.
+     *
+     * Batches of a multiple of this size keep every lane of an inter-frame
+     * decoder busy. Decoders that work frame by frame return one.
+     */
+    virtual size_t frameGroupSize() const { return 1; }
+
     /*!
      * \brief Decoder duration
      * \return Number of ticks in nanoseconds for last decoder call.
      */
     size_t duration_ns() { return mDecoderDuration; }
 
+    /*!
+     * \brief Get the performance counters per node type and length, accumulated
+     *        over all decode() calls since the last resetNodeProfile().
+     *
+     * The profile stays empty, unless the library is built with
+     * POLARCODE_NODE_PROFILING. Fast-SSC decoders, the SCL and SCAN float
+     * decoders are instrumented.
+     */
+    virtual NodeProfile nodeProfile() const;
+
+    /*!
+     * \brief Clear the node profile.
+     */
+    virtual void resetNodeProfile();
+
     /*!
      * \brief Set the decoder's parameters.
      * \param blockLength Number of code bits.
@@ -203,7 +260,15 @@ Decoder* makeDecoder(size_t blockLength,
  * \param blockLength size of a polar codeword
  * \param listSize if '1' FastSSC Decoder is returned. Else: SCL Decoder
  * \param frozenBits positions of frozen bits ordered in ascending order.
- * \param decoderType choose decoder type. ['char', 'float', 'mixed', 'scan', ]
+ * \param decoderType choose decoder type. ['char', 'float', 'mixed', 'scan', 'flat']
+ *        Adding 'interframe' to 'char' or 'float' selects the inter-frame Fast-SSC
+ *        decoder, which only pays off with decode_batch().
+ *        'flat' selects the Fast-SSC float decoder, which executes its node
+ *        tree as a flat instruction stream.
+ *
+ * The decoder is built for the best instruction set level available, see
+ * Dispatch::activeIsa(). Use decoders of a higher level than the calling code
+ * through the Decoder interface only.
  */
 Decoder* create(size_t blockLength,
                 size_t listSize,
@@ -0,0 +1,228 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PC_DEC_DECODERPLAN_H
+#define PC_DEC_DECODERPLAN_H
+
+#include <polarcode/isadispatch.h>
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace PolarCode {
+namespace Decoding {
+
+/*!
+ * \brief The immutable node tree of a tree decoder for one code.
+ *
+ * Tree decoders select a specialized node for every subcode by inspecting
+ * its frozen bits, which are split recursively. A plan records these
+ * decisions once, together with the memory layout of the node objects and
+ * their scratch buffers. Decoder instances for the same code then only bind
+ * a NodeMemory to the plan and construct their nodes in place.
+ *
+ * Plans are shared between all decoders of a process via get(), including those
+ * of the kernel modules.
+ */
+class POLARCODE_SHARED DecoderPlan
+{
+public:
+    /*!
+     * \brief A subcode and the node type selected for it.
+     */
+    struct Node {
+        unsigned kind;        ///< Node type, defined by the decoder implementation
+        unsigned blockLength; ///< Length of the subcode
+        const Node* left;     ///< Left child, nullptr if the subcode is not split
+        const Node* right;    ///< Right child, nullptr if the subcode is not split
+        size_t objectOffset;  ///< Position of the node object in a NodeMemory
+        size_t objectBytes;   ///< Space reserved for the node object
+        size_t scratchOffset; ///< Position of the node's buffers in a NodeMemory
+        size_t scratchBytes;  ///< Space reserved for the node's buffers
+    };
+
+    /*!
+     * \brief Memory a node type needs for a subcode.
+     */
+    struct NodeSize {
+        size_t objectBytes;  ///< Size of the node class
+        size_t scratchBytes; ///< Size of all buffers the node keeps
+    };
+
+    /*!
+     * \brief Select the node type of a subcode.
+     * \param frozenBits The frozen bits of the subcode.
+     * \param blockLength The length of the subcode.
+     * \return The node type, and whether the subcode is split into two halves.
+     */
+    typedef std::pair<unsigned, bool> (*classifier_t)(
+        const std::vector<unsigned>& frozenBits, size_t blockLength);
+
+    /*!
+     * \brief Get the memory of a node type.
+     * \param kind The node type, as returned by the classifier.
+     * \param blockLength The length of the subcode.
+     */
+    typedef NodeSize (*layout_t)(unsigned kind, size_t blockLength);
+
+    static const size_t OBJECT_ALIGNMENT = 64;  ///< Nodes may hold vector members
+    static const size_t SCRATCH_ALIGNMENT = 64; ///< Enough for any vector load
+
+private:
+    std::deque<Node> mNodes; ///< Stable storage, children point into it
+    const Node* mRoot;
+    size_t mObjectBytes, mScratchBytes;
+
+    const Node* build(const std::vector<unsigned>& frozenBits,
+                      size_t blockLength,
+                      classifier_t classify,
+                      layout_t layout);
+
+    /*!
+     * \brief get() for the decoders of an instruction set level, as their node
+     *        objects differ in size between the builds.
+     */
+    static std::shared_ptr<const DecoderPlan> get(Dispatch::IsaLevel isa,
+                                                  const std::string& decoderType,
+                                                  size_t blockLength,
+                                                  const std::vector<unsigned>& frozenBits,
+                                                  classifier_t classify,
+                                                  layout_t layout);
+
+public:
+    /*!
+     * \brief Build the plan of a code.
+     * \param blockLength Length of the Polar Code.
+     * \param frozenBits Set of frozen bits in the code word.
+     * \param classify Node selection of the decoder implementation.
+     * \param layout Node sizes of the decoder implementation, nullptr if it
+     *               does not construct node objects.
+     */
+    DecoderPlan(size_t blockLength,
+                const std::vector<unsigned>& frozenBits,
+                classifier_t classify,
+                layout_t layout);
+
+    DecoderPlan(const DecoderPlan&) = delete;
+    DecoderPlan& operator=(const DecoderPlan&) = delete;
+
+    const Node* root() const;
+    size_t nodeCount() const;
+    size_t objectBytes() const;  ///< Memory of all node objects
+    size_t scratchBytes() const; ///< Memory of all node buffers
+
+    /*!
+     * \brief Get the shared plan of a decoder type for a code.
+     *
+     * Plans are cached by the instruction set level of the caller's build,
+     * decoder type, block length and frozen bits. The first call for a code
+     * builds the plan, further calls return it while it is among the
+     * cacheLimit() most recently used ones.
+     * This function is thread-safe.
+     *
+     * \param decoderType Unique name of the decoder implementation.
+     * \param blockLength Length of the Polar Code.
+     * \param frozenBits Set of frozen bits in the code word.
+     * \param classify Node selection of the decoder implementation.
+     * \param layout Node sizes of the decoder implementation, or nullptr.
+     */
+    static std::shared_ptr<const DecoderPlan> get(const std::string& decoderType,
+                                                  size_t blockLength,
+                                                  const std::vector<unsigned>& frozenBits,
+                                                  classifier_t classify,
+                                                  layout_t layout)
+    {
+        // Inline, so that kernel modules pass their own level: they build with
+        // -fvisibility-inlines-hidden and thus keep a local copy of this function
+        return get(Dispatch::compiledIsa(),
+                   decoderType,
+                   blockLength,
+                   frozenBits,
+                   classify,
+                   layout);
+    }
+
+    /*!
+     * \brief Drop all cached plans. Plans still in use stay valid.
+     */
+    static void clearCache();
+
+    /*!
+     * \brief Get the number of cached plans.
+     */
+    static size_t cacheSize();
+
+    /*!
+     * \brief Set the number of plans to keep, dropping the least recently
+     *        used ones beyond it. The default is 64.
+     */
+    static void setCacheLimit(size_t limit);
+    static size_t cacheLimit();
+};
+
+/*!
+ * \brief The node objects and buffers of one decoder instance, laid out as
+ *        given by a plan.
+ *
+ * Both are a single allocation each, the buffers are zeroed. Decoders
+ * construct their nodes in place with create() and destroy them explicitly.
+ */
+class POLARCODE_SHARED NodeMemory
+{
+    std::shared_ptr<const DecoderPlan> mPlan;
+    char *mObjects, *mScratch;
+
+public:
+    explicit NodeMemory(std::shared_ptr<const DecoderPlan> plan);
+    ~NodeMemory();
+
+    NodeMemory(const NodeMemory&) = delete;
+    NodeMemory& operator=(const NodeMemory&) = delete;
+
+    const DecoderPlan& plan() const;
+
+    /*!
+     * \brief Construct the object of a plan node in its reserved space.
+     * \throw std::logic_error if the plan reserved too little space for _T_.
+     */
+    template <class T, typename... Args>
+    T* create(const DecoderPlan::Node* node, Args&&... args)
+    {
+        if (sizeof(T) > node->objectBytes ||
+            alignof(T) > DecoderPlan::OBJECT_ALIGNMENT) {
+            throw std::logic_error("Node object does not fit into its plan layout");
+        }
+        return new (mObjects + node->objectOffset) T(std::forward<Args>(args)...);
+    }
+
+    /*!
+     * \brief Get the buffers of a plan node.
+     * \param node The plan node.
+     * \param count Number of elements the node uses.
+     * \throw std::logic_error if the plan reserved less than _count_ elements.
+     */
+    template <typename T>
+    T* scratch(const DecoderPlan::Node* node, size_t count)
+    {
+        if (count * sizeof(T) > node->scratchBytes) {
+            throw std::logic_error("Node buffers do not fit into their plan layout");
+        }
+        return reinterpret_cast<T*>(mScratch + node->scratchOffset);
+    }
+};
+
+} // namespace Decoding
+} // namespace PolarCode
+
+#endif // PC_DEC_DECODERPLAN_H
@@ -0,0 +1,162 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PC_DEC_DECODERPOOL_H
+#define PC_DEC_DECODERPOOL_H
+
+#include <polarcode/decoding/decoder.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace PolarCode {
+namespace Decoding {
+
+/*!
+ * \brief A set of worker threads, each owning a private Decoder.
+ *
+ * Decoders keep mutable containers and data pools, so they must never be
+ * shared between threads. The pool creates one Decoder per worker and
+ * hands out frames through per-worker task queues. Submissions are
+ * spread round-robin and idle workers steal from the back of other queues,
+ * so a long task on one core does not hold up the rest.
+ */
+class DecoderPool
+{
+public:
+    /*!
+     * \brief Outcome of a single decoded frame.
+     */
+    struct Result {
+        std::vector<unsigned char> data; ///< Packed information bits
+        bool ok;                         ///< Error detector verdict
+    };
+
+    typedef std::function<void(const unsigned char* pData, bool ok)> callback_t;
+
+    /*!
+     * \brief Create a pool of decoders as returned by Decoding::create().
+     * \param blockLength Length of the Polar Code.
+     * \param listSize List size, '1' selects a Fast-SSC decoder.
+     * \param frozenBits Set of frozen bits in the code word.
+     * \param decoderType Decoder type, see Decoding::create().
+     * \param nWorkers Number of worker threads, 0 means one per hardware thread.
+     */
+    DecoderPool(size_t blockLength,
+                size_t listSize,
+                const std::vector<unsigned>& frozenBits,
+                const std::string& decoderType,
+                size_t nWorkers = 0);
+
+    /*!
+     * \brief Create a pool of custom decoders.
+     *
+     * _factory_ is called once per worker, from the constructing thread, and
+     * allows to set up error detection or systematic coding per decoder.
+     */
+    DecoderPool(const std::function<Decoder*()>& factory, size_t nWorkers = 0);
+    ~DecoderPool();
+
+    DecoderPool(const DecoderPool&) = delete;
+    DecoderPool& operator=(const DecoderPool&) = delete;
+
+    /*!
+     * \brief Decode a single frame asynchronously.
+     * \param pLlr blockLength() LLRs, copied before this call returns.
+     * \return A future holding the decoded information bits.
+     */
+    std::future<Result> submit(const float* pLlr);
+    std::future<Result> submit(const char* pLlr); ///< \sa submit(const float*)
+
+    /*!
+     * \brief Decode a single frame and hand the result to _callback_.
+     *
+     * The callback runs on the worker thread and must not block. _pData_ is
+     * only valid during the call. If decoding or the callback throws, the
+     * exception is rethrown by the next wait().
+     */
+    void submit(const float* pLlr, callback_t callback);
+    /// \sa submit(const float*, callback_t)
+    void submit(const char* pLlr, callback_t callback);
+
+    /*!
+     * \brief Decode many frames on all workers and wait for completion.
+     *
+     * The frames are split into contiguous chunks, which the workers decode
+     * with Decoder::decode_batch(), so inter-frame decoders keep their
+     * speedup. Input and output layout are the same as for
+     * Decoder::decode_batch().
+     *
+     * \return The number of frames which passed the error detection.
+     */
+    size_t
+    decode_batch(const float* pLlr, size_t nFrames, void* pData, bool* pOk = nullptr);
+    size_t
+    decode_batch(const char* pLlr, size_t nFrames, void* pData, bool* pOk = nullptr);
+
+    /*!
+     * \brief Block until every submitted frame has been decoded.
+     *
+     * Rethrows the first exception of a callback-style submission since the
+     * last call.
+     */
+    void wait();
+
+    size_t workerCount();
+    size_t blockLength();
+    size_t infoLength();
+
+private:
+    typedef std::function<void(Decoder*)> task_t;
+
+    struct Worker {
+        std::unique_ptr<Decoder> decoder;
+        std::deque<task_t> tasks;
+        std::mutex mutex;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::atomic<size_t> mNextWorker; ///< Round-robin submission counter
+    std::mutex mSleepMutex;          ///< Taken to sleep and wake only
+    std::condition_variable mWakeUp, mIdle;
+    std::atomic<size_t> mPending;  ///< Queued and running tasks
+    std::atomic<size_t> mQueued;   ///< Tasks waiting in any queue
+    std::atomic<size_t> mSleeping; ///< Workers blocked in mWakeUp
+    bool mStop;                    ///< Guarded by mSleepMutex
+    std::exception_ptr mError;     ///< Guarded by mSleepMutex
+    size_t mBlockLength, mInfoLength;
+    size_t mGroupSize; ///< Frames the decoders process at once
+
+    void start(const std::function<Decoder*()>& factory, size_t nWorkers);
+    void push(task_t task);
+    bool pop(size_t self, task_t& task);
+    void run(size_t self);
+    void fail(std::exception_ptr error);
+
+    template <typename T>
+    std::future<Result> submitFrame(const T* pLlr);
+    template <typename T>
+    void submitFrame(const T* pLlr, callback_t callback);
+    template <typename T>
+    size_t decodeChunks(const T* pLlr, size_t nFrames, void* pData, bool* pOk);
+};
+
+} // namespace Decoding
+} // namespace PolarCode
+
+#endif // PC_DEC_DECODERPOOL_H
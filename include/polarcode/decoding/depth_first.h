@@ -13,7 +13,6 @@
 #include <polarcode/decoding/avx_float.h>
 #include <polarcode/decoding/decoder.h>
 #include <polarcode/encoding/encoder.h>
-#include <queue>
 #include <vector>
 
 namespace PolarCode {
@@ -36,36 +35,72 @@ inline bool compareHints(DecoderHint& a, DecoderHint& b)
     return a.reliability < b.reliability;
 }
 
+/*!
+ * \brief A decoding trial, stored as its difference to the trial it was
+ *        derived from.
+ *
+ * The node options of a configuration are those of its ancestors, plus one
+ * decision node set to one option. All configurations of a frame live in one
+ * pool and refer to each other by index.
+ */
 struct Configuration {
-    int depth;
+    static const unsigned NO_PARENT = ~0u;
+
+    unsigned parent;   ///< Pool index of the parent configuration
+    unsigned decision; ///< Index of the configured decision node
+    int option;        ///< Option of that node
+    int depth;         ///< Number of ancestors
     float parentMetric;
-    std::vector<DecoderHint> nodeList;
-    std::vector<int> nodeOptions;
-    std::string output;
 };
 
-class compareConfigMetrics
-{
-public:
-    bool operator()(Configuration& a, Configuration& b)
-    {
-        return a.parentMetric < b.parentMetric;
-    }
+/*!
+ * \brief What the search needs to know about a decoded configuration.
+ */
+struct TrialSummary {
+    float metric;     ///< Total reliability of all decision nodes
+    unsigned weakest; ///< Weakest decision node the configuration leaves free
+    int optionCount;  ///< Options of that node, zero if all nodes are configured
 };
 
 class Manager
 {
     std::vector<Node*> mNodeList;
     Node* xmRootNode;
-    //	std::priority_queue<Configuration, std::vector<Configuration>,
-    // compareConfigMetrics> mConfigList;
-    std::queue<Configuration> mConfigList;
     std::vector<unsigned> mNodeRanking;
     int mTrialLimit;
 
-    Configuration mBestConfig;
+    /*!
+     * \brief Configurations of the current frame, in the order of creation.
+     *
+     * As trials run first in, first out, the pool from mQueueFront on is the
+     * queue. Its memory is reused for the next frame.
+     */
+    std::vector<Configuration> mConfigPool;
+    unsigned mQueueFront;
+
+    std::vector<int> mAppliedOptions;    ///< Options of the last decoding run
+    std::vector<unsigned> mAppliedFlips; ///< Decision nodes with options != 0
+    std::vector<int> mNextOptions;       ///< Scratch space, zero between trials
+    std::vector<char> mFixed;            ///< Scratch space, zero between trials
+
+    unsigned mBestConfig;
     float mBestMetric;
-    bool firstRun;
+    bool mStale; ///< The tree holds no configuration of the current frame
+
+    /*!
+     * \brief Set the options of a configuration and decode.
+     *
+     * Only the decision nodes from the first one whose option differs from the
+     * last decoding run on are re-decoded, everything before is reused.
+     */
+    void applyConfiguration(const std::vector<Configuration>& pool, unsigned index);
+
+    /*!
+     * \brief Summarize the tree's decoding result of a configuration.
+     */
+    void summarize(const std::vector<Configuration>& pool,
+                   unsigned index,
+                   TrialSummary* summary);
 
 public:
     Manager(int trialLimit);
@@ -81,6 +116,12 @@ public:
      */
     void pushDecoder(Node*);
 
+    /*!
+     * \brief Number of decision nodes pushed so far, which is also the index of
+     *        the next one in decoding order.
+     */
+    unsigned decisionCount();
+
     void setRootNode(Node*);
 
     void setNodeRanking(std::vector<unsigned>);
@@ -106,6 +147,39 @@ public:
      * \brief Fall back to best configuration seen so far.
      */
     void decodeBestConfig();
+
+    /*!
+     * \brief Number of configurations waiting to be tried.
+     */
+    unsigned queueSize();
+
+    /*!
+     * \brief Summarize the front configuration, which the tree must hold.
+     */
+    void summarizeFront(TrialSummary* summary);
+
+    /*!
+     * \brief Remove the front configuration from the queue after a failed trial
+     *        and queue its children.
+     */
+    void retireFront(const TrialSummary& summary);
+
+    /*!
+     * \brief Forget the state of the tree, for example after a new signal.
+     */
+    void invalidate();
+
+    /*!
+     * \brief Decode a configuration of another manager's search.
+     *
+     * The other manager must drive a tree of the same code. This lets several
+     * trees try the queued configurations of one search in parallel.
+     *
+     * \param search Manager holding the queue.
+     * \param offset Position of the configuration behind the queue's front.
+     * \param summary Receives the summary of the decoded configuration.
+     */
+    void decodeQueued(const Manager& search, unsigned offset, TrialSummary* summary);
 };
 
 class Node
@@ -123,6 +197,8 @@ protected:
     int mOptionCount;
     int mOption;
 
+    unsigned mFirstDecision, mDecisionEnd; ///< Decision nodes in this subtree
+
 public:
     Node();
     Node(Node* other);
@@ -138,6 +214,17 @@ public:
 
     virtual void decode();
 
+    /*!
+     * \brief Decode again from the given decision node on.
+     *
+     * All decision nodes before it must be configured as in the previous run,
+     * their results are reused. This default implementation decodes everything.
+     */
+    virtual void decodeFrom(unsigned decision);
+
+    unsigned firstDecision();
+    unsigned decisionEnd();
+
     float reliability();
     int optionCount();
     void setOption(int);
@@ -162,6 +249,7 @@ public:
     ~RateRNode();
     void setOutput(float*);
     void decode();
+    void decodeFrom(unsigned decision);
 };
 
 class ShortRateRNode : public RateRNode
@@ -178,6 +266,7 @@ public:
     ~ShortRateRNode();
     void setOutput(float*);
     void decode();
+    void decodeFrom(unsigned decision);
 };
 
 class RateZeroDecoder : public Node
@@ -224,6 +313,9 @@ public:
 
 Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent);
 
+struct Lane;
+class TrialTeam;
+
 } // namespace DepthFirstObjects
 
 class DepthFirst : public Decoder
@@ -234,12 +326,33 @@ class DepthFirst : public Decoder
     DepthFirstObjects::Manager* mManager;
     Encoding::Encoder* mEncoder;
 
+    size_t mTrialThreads;
+    std::vector<DepthFirstObjects::Lane*> mLanes; ///< Trees for parallel trials
+    DepthFirstObjects::TrialTeam* mTeam;
+
     void clear();
 
+    /*!
+     * \brief Run the remaining trials on all lanes, after the first one failed.
+     */
+    bool decodeParallel();
+
 public:
+    /*!
+     * \brief Create a decoder which flips its weakest decisions until the error
+     *        detection passes.
+     * \param blockLength Length of the Polar Code.
+     * \param trialLimit Maximum number of decoding trials per frame.
+     * \param frozenBits Set of frozen bits in the code word.
+     * \param trialThreads Number of threads to decode trials on. With more than
+     *        one, the decoder keeps a tree per thread and tries that many queued
+     *        configurations at once, trading cores for latency. The results are
+     *        those of trying them one after another.
+     */
     DepthFirst(size_t blockLength,
                size_t trialLimit,
-               const std::vector<unsigned>& frozenBits);
+               const std::vector<unsigned>& frozenBits,
+               size_t trialThreads = 1);
     ~DepthFirst();
 
     bool decode();
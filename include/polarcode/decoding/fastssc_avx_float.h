@@ -9,9 +9,9 @@
 #ifndef PC_DEC_FASTSSC_AVX_FLOAT_H
 #define PC_DEC_FASTSSC_AVX_FLOAT_H
 
-#include <polarcode/datapool.txx>
 #include <polarcode/decoding/avx_float.h>
 #include <polarcode/decoding/decoder.h>
+#include <polarcode/decoding/decoderplan.h>
 #include <polarcode/encoding/encoder.h>
 
 namespace PolarCode {
@@ -19,30 +19,26 @@ namespace Decoding {
 
 namespace FastSscAvx {
 
-typedef DataPool<float, 32> datapool_t;
-typedef Block<float> block_t;
-
 /*!
  * \brief A node of the polar decoding tree.
  */
 class Node
 {
 protected:
-    unsigned mBlockLength;  ///< Length of the subcode.
-    datapool_t* xmDataPool; ///< Pointer to a DataPool object.
-    block_t *mLlr, *mBit;
+    unsigned mBlockLength; ///< Length of the subcode.
+    NodeMemory* xmMemory;  ///< Objects and buffers of all nodes
+    float *mLlr, *mBit;    ///< Channel LLRs and code word, only owned by the root
     float *mInput, *mOutput;
 
 
 public:
-    Node();
     Node(Node* other);
     /*!
      * \brief Initialize a polar code's root node
      * \param blockLength Length of the code.
-     * \param pool Pointer to a DataPool, which provides lazy-copyable memory blocks.
+     * \param memory The memory to create the decoding tree in.
      */
-    Node(size_t blockLength, datapool_t* pool);
+    Node(size_t blockLength, NodeMemory* memory);
     virtual ~Node();
 
     virtual void decode(); ///< Execute a specialized decoding algorithm.
@@ -51,10 +47,9 @@ public:
     virtual void setOutput(float*);
 
     /*!
-     * \brief Get a pointer to the datapool.
-     * \return A pointer to the datapool.
+     * \brief Get the memory of the decoding tree.
      */
-    datapool_t* pool();
+    NodeMemory* memory();
 
     /*!
      * \brief Get the length of this code node.
@@ -77,25 +72,47 @@ public:
 
 enum ChildCreationFlags { BOTH, NO_LEFT = 0x01, NO_RIGHT = 0x02 };
 
+/*!
+ * \brief Node types of a DecoderPlan for this decoder.
+ */
+enum NodeKind {
+    RATE_ZERO,
+    RATE_ONE,
+    REPETITION,
+    SPC,
+    DOUBLE_REPETITION,
+    DOUBLE_SPC_SHORT8,
+    DOUBLE_SPC,
+    TRIPLE_REPETITION,
+    TYPE_FIVE,
+    REPETITION_RATE_ONE_SHORT8,
+    ZERO_SPC_SHORT8,
+    ZERO_SPC,
+    SHORT_RATE_R,
+    R_ONE,
+    ZERO_R,
+    RATE_R
+};
+
 /*!
  * \brief A Rate-R node redirects decoding to polar subcodes of lower complexity.
  */
 class RateRNode : public Node
 {
 protected:
-    Node *mLeft, ///< Left child node
-        *mRight; ///< Right child node
-    block_t *mLeftLlr,
+    Node *mLeft, ///< Left child node, nullptr if not created
+        *mRight; ///< Right child node, nullptr if not created
+    float *mLeftLlr,
         *mRightLlr; ///< Temporarily holds the LLRs child nodes have to decode.
 
 public:
     /*!
-     * \brief Using the set of frozen bits, specialized subcodes are selected.
-     * \param frozenBits The set of frozen bits of this code.
+     * \brief Create the child nodes selected by the plan.
+     * \param plan The plan node of this code.
      * \param parent The parent node, defining the length of this code.
      * \param flags Set to [NO_LEFT | NO_RIGHT] to disable child creation.
      */
-    RateRNode(const std::vector<unsigned>& frozenBits,
+    RateRNode(const DecoderPlan::Node* plan,
               Node* parent,
               ChildCreationFlags flags = BOTH);
     virtual ~RateRNode();
@@ -108,15 +125,15 @@ public:
  */
 class ShortRateRNode : public RateRNode
 {
-    block_t *mLeftBits, *mRightBits;
+    float *mLeftBits, *mRightBits;
 
 public:
     /*!
-     * \brief Using the set of frozen bits, specialized subcodes are selected.
-     * \param frozenBits The set of frozen bits of this code.
+     * \brief Create the child nodes selected by the plan.
+     * \param plan The plan node of this code.
      * \param parent The parent node, defining the length of this code.
      */
-    ShortRateRNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    ShortRateRNode(const DecoderPlan::Node* plan, Node* parent);
     virtual ~ShortRateRNode();
     void setOutput(float*);
     void decode();
@@ -214,11 +231,6 @@ public:
 
 class ZeroSpcDecoder : public Node
 {
-    unsigned* mFlipIndices;
-    block_t* mTempBlock;
-    float* mTempBlockPtr;
-    void findWeakLlr();
-
 public:
     ZeroSpcDecoder(Node* parent);
     ~ZeroSpcDecoder();
@@ -243,10 +255,10 @@ class ROneNode : public RateRNode
 public:
     /*!
      * \brief Initialize the right-rate-1 optimized decoder.
-     * \param frozenBits The set of frozen bits of both subcodes (apparently only left
-     * subcode has frozen bits). \param parent The parent node.
+     * \param plan The plan node of both subcodes (only the left one is used).
+     * \param parent The parent node.
      */
-    ROneNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    ROneNode(const DecoderPlan::Node* plan, Node* parent);
     ~ROneNode();
     void decode();
 };
@@ -259,21 +271,37 @@ class ZeroRNode : public RateRNode
 public:
     /*!
      * \brief Initialize the left-rate-0 optimized decoder.
-     * \param frozenBits The set of frozen bits for both subcodes.
+     * \param plan The plan node of both subcodes (only the right one is used).
      * \param parent The parent node.
      */
-    ZeroRNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    ZeroRNode(const DecoderPlan::Node* plan, Node* parent);
     ~ZeroRNode();
     void decode();
 };
 
 /*!
- * \brief Create a specialized decoder for the given set of frozen bits.
+ * \brief Select the specialized decoder for a subcode.
  * \param frozenBits The set of frozen bits.
+ * \param blockLength The length of the subcode.
+ * \return The NodeKind, and whether the subcode is split into two children.
+ */
+std::pair<unsigned, bool> classifyNode(const std::vector<unsigned>& frozenBits,
+                                       size_t blockLength);
+
+/*!
+ * \brief Get the memory of the node a plan node selects.
+ * \param kind The NodeKind.
+ * \param blockLength The length of the subcode.
+ */
+DecoderPlan::NodeSize nodeSize(unsigned kind, size_t blockLength);
+
+/*!
+ * \brief Create the specialized decoder selected by a plan node.
+ * \param plan The plan node, as built with classifyNode() and nodeSize().
  * \param parent The parent node from which the code length is fetched.
- * \return Pointer to a polymorphic decoder object.
+ * \return Pointer to a polymorphic decoder object in the parent's memory.
  */
-Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent);
+Node* createDecoder(const DecoderPlan::Node* plan, Node* parent);
 
 } // namespace FastSscAvx
 
@@ -282,13 +310,20 @@ Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent);
  */
 class FastSscAvxFloat : public Decoder
 {
-    FastSscAvx::Node *mNodeBase,       ///< General code information
-        *mRootNode;                    ///< Actual decoder
-    FastSscAvx::datapool_t* mDataPool; ///< Lazy-copy data-block pool
+    FastSscAvx::Node *mNodeBase, ///< General code information
+        *mRootNode;              ///< Actual decoder
+    NodeMemory* mMemory;         ///< Node tree laid out by the shared plan
     Encoding::Encoder* mEncoder;
 
     void clear();
 
+    /*!
+     * \brief Decode the LLRs in the root node and write the packed information
+     *        bits of this frame into _pData_.
+     * \return True, if no errors detected after decoding.
+     */
+    bool decodeFrame(unsigned char* pData);
+
 public:
     /*!
      * \brief Create a Fast-SSC decoder with AVX float-bit decoding.
@@ -300,6 +335,10 @@ public:
 
     bool decode();
     void initialize(size_t blockLength, const std::vector<unsigned>& frozenBits);
+    size_t
+    decode_batch(const float* pLlr, size_t nFrames, void* pData, bool* pOk = nullptr);
+    size_t
+    decode_batch(const char* pLlr, size_t nFrames, void* pData, bool* pOk = nullptr);
 };
 
 } // namespace Decoding
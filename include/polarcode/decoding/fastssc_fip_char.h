@@ -9,8 +9,8 @@
 #ifndef PC_DEC_FASTSSC_FIP_H
 #define PC_DEC_FASTSSC_FIP_H
 
-#include <polarcode/datapool.txx>
 #include <polarcode/decoding/decoder.h>
+#include <polarcode/decoding/decoderplan.h>
 #include <polarcode/decoding/fip_char.h>
 #include <polarcode/encoding/encoder.h>
 
@@ -24,35 +24,31 @@ namespace FastSscFip {
  */
 class Node
 {
-    typedef DataPool<fipv, BYTESPERVECTOR> datapool_t;
-    Block<fipv>*mLlr, *mBit;
+    fipv *mLlr, *mBit; ///< Channel LLRs and code word, only owned by the root
 
 protected:
     // xm = eXternal member (not owned by this Node)
-    datapool_t* xmDataPool; ///< Pointer to a DataPool object.
-    size_t mBlockLength,    ///< Length of the subcode.
-        mVecCount;          ///< Number of AVX-vectors the data can be stored in.
+    NodeMemory* xmMemory; ///< Objects and buffers of all nodes
+    size_t mBlockLength,  ///< Length of the subcode.
+        mVecCount;        ///< Number of AVX-vectors the data can be stored in.
 
 public:
-    Node();
     Node(Node* parent);
     /*!
      * \brief Initialize a polar code's root node
      * \param blockLength Length of the code.
-     * \param pool Pointer to a DataPool, which provides lazy-copyable memory blocks.
-     * \param softOutput Whether XOR or Boxplus will be used for bit combination.
+     * \param memory The memory to create the decoding tree in.
      */
-    Node(size_t blockLength, datapool_t* pool);
+    Node(size_t blockLength, NodeMemory* memory);
     virtual ~Node();
 
     virtual void decode(fipv* LlrIn,
                         fipv* BitsOut); ///< Execute a specialized decoding algorithm.
 
     /*!
-     * \brief Get a pointer to the datapool.
-     * \return A pointer to the datapool.
+     * \brief Get the memory of the decoding tree.
      */
-    datapool_t* pool();
+    NodeMemory* memory();
 
     /*!
      * \brief Get the length of this code node.
@@ -75,9 +71,6 @@ public:
 
 class ShortNode : public Node
 {
-protected:
-    Block<fipv>*mLeftBits, *mRightBits;
-
 public:
     ShortNode(Node* parent);
     virtual ~ShortNode();
@@ -93,15 +86,15 @@ class RateRNode : public Node
 protected:
     Node *mLeft,           ///< Left child node
         *mRight;           ///< Right child node
-    Block<fipv>* ChildLlr; ///< Temporarily holds the LLRs child nodes have to decode.
+    fipv* ChildLlr;        ///< Temporarily holds the LLRs child nodes have to decode.
 
 public:
     /*!
-     * \brief Using the set of frozen bits, specialized subcodes are selected.
-     * \param frozenBits The set of frozen bits of this code.
+     * \brief Create the child nodes selected by the plan.
+     * \param plan The plan node of this code.
      * \param parent The parent node, defining the length of this code.
      */
-    RateRNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    RateRNode(const DecoderPlan::Node* plan, Node* parent);
     ~RateRNode();
     void decode(fipv* LlrIn, fipv* BitsOut);
 };
@@ -114,15 +107,15 @@ class ShortRateRNode : public RateRNode
     void simplifiedRightRateOneDecodeShort(fipv* LlrIn, fipv* BitsOut);
 
 protected:
-    Block<fipv>*LeftBits, *RightBits;
+    fipv *LeftBits, *RightBits;
 
 public:
     /*!
-     * \brief Using the set of frozen bits, specialized subcodes are selected.
-     * \param frozenBits The set of frozen bits of this code.
+     * \brief Create the child nodes selected by the plan.
+     * \param plan The plan node of this code.
      * \param parent The parent node, defining the length of this code.
      */
-    ShortRateRNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    ShortRateRNode(const DecoderPlan::Node* plan, Node* parent);
     ~ShortRateRNode();
     void decode(fipv* LlrIn, fipv* BitsOut);
 };
@@ -137,10 +130,10 @@ class ROneNode : public RateRNode
 public:
     /*!
      * \brief Initialize the right-rate-1 optimized decoder.
-     * \param frozenBits The set of frozen bits of both subcodes (apparently only left
-     * subcode has frozen bits). \param parent The parent node.
+     * \param plan The plan node of both subcodes.
+     * \param parent The parent node.
      */
-    ROneNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    ROneNode(const DecoderPlan::Node* plan, Node* parent);
     ~ROneNode();
     void decode(fipv* LlrIn, fipv* BitsOut);
 };
@@ -155,10 +148,10 @@ class ShortROneNode : public ShortRateRNode
 public:
     /*!
      * \brief Initialize the right-rate-1 optimized decoder.
-     * \param frozenBits The set of frozen bits of both subcodes (apparently only left
-     * subcode has frozen bits). \param parent The parent node.
+     * \param plan The plan node of both subcodes.
+     * \param parent The parent node.
      */
-    ShortROneNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    ShortROneNode(const DecoderPlan::Node* plan, Node* parent);
     ~ShortROneNode();
     void decode(fipv* LlrIn, fipv* BitsOut);
 };
@@ -171,10 +164,10 @@ class ZeroRNode : public RateRNode
 public:
     /*!
      * \brief Initialize the left-rate-0 optimized decoder.
-     * \param frozenBits The set of frozen bits for both subcodes.
+     * \param plan The plan node of both subcodes.
      * \param parent The parent node.
      */
-    ZeroRNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    ZeroRNode(const DecoderPlan::Node* plan, Node* parent);
     ~ZeroRNode();
     void decode(fipv* LlrIn, fipv* BitsOut);
 };
@@ -187,10 +180,10 @@ class ShortZeroRNode : public ShortRateRNode
 public:
     /*!
      * \brief Initialize the left-rate-0 optimized decoder.
-     * \param frozenBits The set of frozen bits for both subcodes.
+     * \param plan The plan node of both subcodes.
      * \param parent The parent node.
      */
-    ShortZeroRNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    ShortZeroRNode(const DecoderPlan::Node* plan, Node* parent);
     ~ShortZeroRNode();
     void decode(fipv* LlrIn, fipv* BitsOut);
 };
@@ -283,12 +276,50 @@ public:
 };
 
 /*!
- * \brief Create a specialized decoder for the given set of frozen bits.
+ * \brief Node types of a DecoderPlan for this decoder.
+ */
+enum NodeKind {
+    RATE_ZERO,
+    RATE_ONE,
+    REPETITION,
+    SHORT_REPETITION,
+    SPC,
+    SHORT_SPC,
+    DOUBLE_REPETITION,
+    SHORT_ZERO_ONE,
+    SHORT_ZERO_SPC,
+    ZERO_SPC,
+    SHORT_R_ONE,
+    SHORT_ZERO_R,
+    SHORT_RATE_R,
+    R_ONE,
+    ZERO_R,
+    RATE_R
+};
+
+/*!
+ * \brief Select the specialized decoder for a subcode.
  * \param frozenBits The set of frozen bits.
+ * \param blockLength The length of the subcode.
+ * \return The NodeKind, and whether the subcode is split into two children.
+ */
+std::pair<unsigned, bool> classifyNode(const std::vector<unsigned>& frozenBits,
+                                       size_t blockLength);
+
+/*!
+ * \brief Get the memory of the node a plan node selects.
+ * \param kind The NodeKind.
+ * \param blockLength The length of the subcode.
+ */
+DecoderPlan::NodeSize nodeSize(unsigned kind, size_t blockLength);
+
+/*!
+ * \brief Create the specialized decoder selected by a plan node.
+ * \param plan The plan node, as built with classifyNode() and nodeSize().
  * \param parent The parent node from which the code length is fetched.
- * \return Pointer to a polymorphic decoder object.
+ * \return Pointer to a polymorphic decoder object in the parent's memory.
  */
-Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent);
+Node* createDecoder(const DecoderPlan::Node* plan, Node* parent);
 
 } // namespace FastSscFip
 
@@ -297,13 +328,20 @@ Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent);
  */
 class FastSscFipChar : public Decoder
 {
-    FastSscFip::Node *mNodeBase,               ///< General code information
-        *mRootNode;                            ///< Actual decoder
-    DataPool<fipv, BYTESPERVECTOR>* mDataPool; ///< Lazy-copy data-block pool
-    Encoding::Encoder* mEncoder;               ///< Encoder for non-systematic output
+    FastSscFip::Node *mNodeBase, ///< General code information
+        *mRootNode;              ///< Actual decoder
+    NodeMemory* mMemory;         ///< Node tree laid out by the shared plan
+    Encoding::Encoder* mEncoder; ///< Encoder for non-systematic output
 
     void clear();
 
+    /*!
+     * \brief Decode the LLRs in the root node and write the packed information
+     *        bits of this frame into _pData_.
+     * \return True, if no errors detected after decoding.
+     */
+    bool decodeFrame(unsigned char* pData);
+
 public:
     /*!
      * \brief Create a Fast-SSC decoder with AVX char-bit decoding.
@@ -315,6 +353,10 @@ public:
 
     bool decode();
     void initialize(size_t blockLength, const std::vector<unsigned>& frozenBits);
+    size_t
+    decode_batch(const float* pLlr, size_t nFrames, void* pData, bool* pOk = nullptr);
+    size_t
+    decode_batch(const char* pLlr, size_t nFrames, void* pData, bool* pOk = nullptr);
 };
 
 } // namespace Decoding
@@ -0,0 +1,140 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PC_DEC_FASTSSC_FLAT_H
+#define PC_DEC_FASTSSC_FLAT_H
+
+#include <polarcode/decoding/decoder.h>
+#include <polarcode/decoding/decoderplan.h>
+#include <polarcode/encoding/encoder.h>
+
+namespace PolarCode {
+namespace Decoding {
+
+/*!
+ * \brief Fast-SSC decoding by a flat instruction stream.
+ *
+ * The node tree of a code is compiled into a linear program once. Decoding
+ * a frame then is a single loop over that program, without virtual calls
+ * or pointer chasing, on one contiguous LLR and one contiguous bit buffer.
+ *
+ * A subcode of length n reads its LLRs at offset 2N-2n of the LLR buffer,
+ * the root LLRs sit at offset zero. Its bits are stored at its position in
+ * the code word, so COMBINE works in place.
+ */
+namespace FastSscFlat {
+
+/*!
+ * \brief Operations of the instruction stream.
+ */
+enum Opcode : unsigned char {
+    F,           ///< Left child LLRs of a rate-R node
+    G,           ///< Right child LLRs of a rate-R node
+    G_ZERO,      ///< Right child LLRs, if the left child is rate-0
+    REP,         ///< Repetition code
+    SPC,         ///< Single parity check code
+    R0,          ///< Rate-0 code
+    R1,          ///< Rate-1 code
+    COMBINE,     ///< Bits of a rate-R node from both children
+    COMBINE_ZERO ///< Bits of a rate-R node, if the left child is rate-0
+};
+
+/*!
+ * \brief One step of the decoding program.
+ *
+ * F and G read 2*length LLRs at _llrIn_ and write length LLRs to _llrOut_.
+ * Leaf operations decode length LLRs at _llrIn_ into the bits at _bits_.
+ * G reads and COMBINE updates the left child bits at _bits_.
+ */
+struct Instruction {
+    Opcode op;
+    unsigned length; ///< Length of the child or leaf subcode
+    unsigned llrIn;  ///< Offset into the LLR buffer
+    unsigned llrOut; ///< Offset into the LLR buffer
+    unsigned bits;   ///< Offset into the bit buffer
+};
+
+/*!
+ * \brief Node types of a DecoderPlan for this decoder.
+ */
+enum NodeKind { RATE_ZERO, RATE_ONE, REPETITION, SINGLE_PARITY_CHECK, RATE_R };
+
+/*!
+ * \brief Select the node type of a subcode.
+ * \param frozenBits The set of frozen bits.
+ * \param blockLength The length of the subcode.
+ * \return The NodeKind, and whether the subcode is split into two children.
+ */
+std::pair<unsigned, bool> classifyNode(const std::vector<unsigned>& frozenBits,
+                                       size_t blockLength);
+
+/*!
+ * \brief Flatten a plan into its instruction stream.
+ * \param plan The root node of a plan, as built with classifyNode().
+ * \return The program, executed front to back.
+ */
+std::vector<Instruction> compile(const DecoderPlan::Node* plan);
+
+/*!
+ * \brief Run a program.
+ * \param program The instructions.
+ * \param llr LLR buffer of 2N floats, holding the channel LLRs at offset zero.
+ * \param bits Bit buffer of N floats, receives the soft code word.
+ */
+void execute(const std::vector<Instruction>& program, float* llr, float* bits);
+
+} // namespace FastSscFlat
+
+/*!
+ * \brief Fast-SSC float decoder executing a flattened node tree.
+ *
+ * Works for any frozen set at runtime and is a drop-in alternative to
+ * FastSscAvxFloat, which walks a tree of polymorphic node objects.
+ */
+class FastSscFlatFloat : public Decoder
+{
+    std::shared_ptr<const DecoderPlan> mPlan;       ///< Shared node tree of this code
+    std::vector<FastSscFlat::Instruction> mProgram; ///< Compiled plan
+    float *mLlr, *mBit;                             ///< Scratch buffers of the program
+    Encoding::Encoder* mEncoder;
+
+    void clear();
+
+    /*!
+     * \brief Run the program on the LLRs in mLlr and write the packed
+     *        information bits of this frame into _pData_.
+     * \return True, if no errors detected after decoding.
+     */
+    bool decodeFrame(unsigned char* pData);
+
+public:
+    /*!
+     * \brief Create a flat Fast-SSC decoder.
+     * \param blockLength Length of the Polar Code.
+     * \param frozenBits Set of frozen bits in the code word.
+     */
+    FastSscFlatFloat(size_t blockLength, const std::vector<unsigned>& frozenBits);
+    ~FastSscFlatFloat();
+
+    bool decode();
+    void initialize(size_t blockLength, const std::vector<unsigned>& frozenBits);
+    size_t
+    decode_batch(const float* pLlr, size_t nFrames, void* pData, bool* pOk = nullptr);
+    size_t
+    decode_batch(const char* pLlr, size_t nFrames, void* pData, bool* pOk = nullptr);
+
+    /*!
+     * \brief Get the compiled program, e.g. for inspection.
+     */
+    const std::vector<FastSscFlat::Instruction>& program() const;
+};
+
+} // namespace Decoding
+} // namespace PolarCode
+
+#endif // PC_DEC_FASTSSC_FLAT_H
@@ -0,0 +1,242 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PC_DEC_FASTSSC_INTERFRAME_H
+#define PC_DEC_FASTSSC_INTERFRAME_H
+
+#include <polarcode/datapool.txx>
+#include <polarcode/decoding/avx_float.h>
+#include <polarcode/decoding/decoder.h>
+#include <polarcode/decoding/fip_char.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace PolarCode {
+namespace Decoding {
+
+/*!
+ * \brief Inter-frame Fast-SSC decoding.
+ *
+ * Instead of spreading the LLRs of one codeword over a vector, every vector
+ * holds the same codeword position of several independent frames, one frame
+ * per lane. The usual F/G kernels then decode all lanes at once and the node
+ * tree never needs the short-block shuffles of the intra-frame decoders.
+ */
+namespace FastSscInterFrame {
+
+/*!
+ * \brief Lane operations for eight frames of float LLRs per AVX vector.
+ */
+struct FloatLanes {
+    typedef __m256 vec_t;
+    typedef float llr_t;
+    typedef FloatContainer container_t;
+    static const unsigned laneCount = FLOATSPERVECTOR;
+
+    static vec_t frozen() { return _mm256_set1_ps(INFINITY); }
+    static vec_t f(vec_t left, vec_t right)
+    {
+        vec_t out;
+        FastSscAvx::F_function_calc(left, right, reinterpret_cast<float*>(&out));
+        return out;
+    }
+    static vec_t g(vec_t left, vec_t right, vec_t bits)
+    {
+        vec_t out;
+        FastSscAvx::G_function_calc(left, right, bits, reinterpret_cast<float*>(&out));
+        return out;
+    }
+    static vec_t add(vec_t a, vec_t b) { return _mm256_add_ps(a, b); }
+    static vec_t combine(vec_t a, vec_t b) { return _mm256_xor_ps(a, b); }
+    static vec_t hardDecode(vec_t x) { return FastSscAvx::hardDecode(x); }
+    static vec_t abs(vec_t x) { return FastSscAvx::_mm256_abs_ps(x); }
+    static vec_t min(vec_t a, vec_t b) { return _mm256_min_ps(a, b); }
+    static vec_t equal(vec_t a, vec_t b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+    static vec_t negative(vec_t x)
+    {
+        const vec_t ones = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        return _mm256_blendv_ps(_mm256_setzero_ps(), ones, x);
+    }
+    static vec_t and_(vec_t a, vec_t b) { return _mm256_and_ps(a, b); }
+    static vec_t andnot(vec_t a, vec_t b) { return _mm256_andnot_ps(a, b); }
+    static vec_t flip(vec_t x, vec_t mask)
+    {
+        return _mm256_xor_ps(x, _mm256_and_ps(mask, FastSscAvx::SIGN_MASK));
+    }
+    static uint64_t signs(vec_t x) { return _mm256_movemask_ps(x); }
+
+    static llr_t quantize(float llr) { return llr; }
+    static llr_t quantize(char llr) { return static_cast<float>(llr); }
+};
+
+/*!
+ * \brief Lane operations for BYTESPERVECTOR frames of 8-bit LLRs per vector.
+ */
+struct CharLanes {
+    typedef fipv vec_t;
+    typedef char llr_t;
+    typedef CharContainer container_t;
+    static const unsigned laneCount = BYTESPERVECTOR;
+
+    static vec_t frozen() { return fi_set1_epi8(127); }
+    static vec_t f(vec_t left, vec_t right)
+    {
+        vec_t out;
+        FastSscFip::F_function_calc(left, right, &out);
+        return out;
+    }
+    static vec_t g(vec_t left, vec_t right, vec_t bits)
+    {
+        vec_t out;
+        FastSscFip::G_function_calc(left, right, bits, &out);
+        return out;
+    }
+    static vec_t add(vec_t a, vec_t b) { return fi_adds_epi8(a, b); }
+    static vec_t combine(vec_t a, vec_t b) { return fi_xor(a, b); }
+    static vec_t hardDecode(vec_t x) { return FastSscFip::hardDecode(x); }
+    static vec_t abs(vec_t x) { return fi_abs_epi8(fi_max_epi8(x, fi_set1_epi8(-127))); }
+    static vec_t min(vec_t a, vec_t b) { return fi_min_epi8(a, b); }
+    static vec_t equal(vec_t a, vec_t b) { return fi_cmpeq_epi8(a, b); }
+    static vec_t negative(vec_t x) { return fi_cmpgt_epi8(fi_setzero(), x); }
+    static vec_t and_(vec_t a, vec_t b) { return fi_and(a, b); }
+    static vec_t andnot(vec_t a, vec_t b)
+    {
+        return fi_and(fi_xor(a, fi_set1_epi8(-1)), b);
+    }
+    static vec_t flip(vec_t x, vec_t mask)
+    {
+        return fi_blendv_epi8(x, fi_subs_epi8(fi_setzero(), x), mask);
+    }
+    static uint64_t signs(vec_t x) { return fi_movemask_epi8(x); }
+
+    static llr_t quantize(float llr)
+    {
+        // Same rounding and clamping as CharContainer::insertLlr()
+        return static_cast<char>(std::round(std::min(std::max(llr, -128.0f), 127.0f)));
+    }
+    static llr_t quantize(char llr) { return llr; }
+};
+
+/*!
+ * \brief A node of the inter-frame decoding tree.
+ *
+ * Element i of the LLR and bit arrays is one vector, whose lanes hold
+ * codeword position i of all frames decoded in parallel.
+ */
+template <class Lanes>
+class Node
+{
+public:
+    typedef typename Lanes::vec_t vec_t;
+    typedef DataPool<vec_t, sizeof(vec_t)> datapool_t;
+    typedef Block<vec_t> block_t;
+
+protected:
+    size_t mBlockLength;    ///< Length of the subcode.
+    datapool_t* xmDataPool; ///< Pointer to a DataPool object.
+
+public:
+    /*!
+     * \brief Initialize a polar code's root node
+     * \param blockLength Length of the code.
+     * \param pool Pointer to a DataPool, which provides memory blocks.
+     */
+    Node(size_t blockLength, datapool_t* pool);
+    Node(Node* parent);
+    virtual ~Node();
+
+    /*!
+     * \brief Decode all lanes of this subcode.
+     * \param LlrIn Interleaved LLRs, blockLength() vectors.
+     * \param BitsOut Interleaved soft bits, blockLength() vectors.
+     */
+    virtual void decode(vec_t* LlrIn, vec_t* BitsOut);
+
+    size_t blockLength();
+    datapool_t* pool();
+};
+
+/*!
+ * \brief Create a specialized inter-frame decoder for the given set of frozen bits.
+ * \param frozenBits The set of frozen bits of this subcode.
+ * \param parent Parent node, from which the block length and DataPool are taken.
+ * \return A pointer to the specialized decoder object.
+ */
+template <class Lanes>
+Node<Lanes>* createDecoder(const std::vector<unsigned>& frozenBits, Node<Lanes>* parent);
+
+} // namespace FastSscInterFrame
+
+/*!
+ * \brief Fast-SSC decoder that processes Lanes::laneCount frames at once.
+ *
+ * decode_batch() groups the frames, transposes their LLRs into the
+ * interleaved layout and decodes the whole group in one tree traversal.
+ * The single-frame interface decodes lane zero only and therefore brings
+ * no speedup over the intra-frame decoders.
+ */
+template <class Lanes>
+class FastSscInterFrameDecoder : public Decoder
+{
+    typedef typename Lanes::vec_t vec_t;
+    typedef typename Lanes::llr_t llr_t;
+    typedef FastSscInterFrame::Node<Lanes> node_t;
+
+    typename node_t::datapool_t* mDataPool; ///< Memory for the node tree
+    node_t *mNodeBase,                      ///< General code information
+        *mRootNode;                         ///< Actual decoder
+    typename node_t::block_t *mLlr, *mBit;  ///< Interleaved LLRs and bits
+    llr_t *mFrameLlr, *mFrameBit;           ///< Single-frame staging memory
+    std::vector<unsigned> mInfoPositions;
+
+    void clear();
+
+    /*!
+     * \brief Transpose the LLRs of up to Lanes::laneCount frames into mLlr.
+     */
+    template <typename T>
+    void loadFrames(const T* pLlr, size_t nFrames);
+
+    /*!
+     * \brief Write the packed information bits of the first _nFrames_ lanes
+     *        to _pData_, one frame after another.
+     */
+    void storeFrames(unsigned char* pData, size_t nFrames);
+
+    template <typename T>
+    size_t decodeGroups(const T* pLlr, size_t nFrames, void* pData, bool* pOk);
+
+public:
+    /*!
+     * \brief Create an inter-frame Fast-SSC decoder.
+     * \param blockLength Length of the Polar Code.
+     * \param frozenBits Set of frozen bits in the code word.
+     */
+    FastSscInterFrameDecoder(size_t blockLength, const std::vector<unsigned>& frozenBits);
+    ~FastSscInterFrameDecoder();
+
+    bool decode();
+    void initialize(size_t blockLength, const std::vector<unsigned>& frozenBits);
+    size_t
+    decode_batch(const float* pLlr, size_t nFrames, void* pData, bool* pOk = nullptr);
+    size_t
+    decode_batch(const char* pLlr, size_t nFrames, void* pData, bool* pOk = nullptr);
+    size_t frameGroupSize() const { return Lanes::laneCount; }
+};
+
+typedef FastSscInterFrameDecoder<FastSscInterFrame::FloatLanes> FastSscInterFrameFloat;
+typedef FastSscInterFrameDecoder<FastSscInterFrame::CharLanes> FastSscInterFrameChar;
+
+extern template class FastSscInterFrameDecoder<FastSscInterFrame::FloatLanes>;
+extern template class FastSscInterFrameDecoder<FastSscInterFrame::CharLanes>;
+
+} // namespace Decoding
+} // namespace PolarCode
+
+#endif // PC_DEC_FASTSSC_INTERFRAME_H
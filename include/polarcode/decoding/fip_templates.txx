@@ -35,7 +35,68 @@ inline void WriteFixedValue(char value, fipv *BitsOut) {
 	}
 }
 
-#ifdef __AVX2__
+#ifdef POLARCODE_AVX512
+
+template<unsigned blockLength>
+inline __mmask64 ShortVectorMask() {
+	return _cvtu64_mask64(blockLength >= 64 ? ~0ULL : (1ULL << blockLength) - 1);
+}
+
+template<unsigned blockLength>
+inline void ZeroPrepareShortVector(__m512i &vec) {
+	if(blockLength >= 64) return;
+	vec = _mm512_maskz_mov_epi8(ShortVectorMask<blockLength>(), vec);
+}
+
+template<unsigned blockLength>
+inline void SpcPrepareShortVector(__m512i &vec) {
+	if(blockLength >= 64) return;
+	vec = _mm512_mask_mov_epi8(_mm512_set1_epi8(127), ShortVectorMask<blockLength>(), vec);
+}
+
+template<unsigned shift>
+inline __m512i subVectorBackShiftBytes(__m512i x) {
+	switch (shift) {
+	case 1:
+		return _mm512_slli_epi16(x, 8);
+	case 2:
+		return _mm512_slli_epi32(x, 16);
+	case 4:
+		return _mm512_slli_epi64(x, 32);
+	case 8:
+		return _mm512_bslli_epi128(x, 8);
+	case 16:
+		return _mm512_maskz_shuffle_i64x2(0b11001100, x, x, 0b10000000);
+	case 32:
+		return _mm512_maskz_shuffle_i64x2(0b11110000, x, x, 0b01000000);
+	default:
+		std::cerr << "Subvector backshift of undefined size.";
+	}
+	return _mm512_setzero_si512();
+}
+
+template<unsigned shift>
+inline __m512i subVectorShiftBytes_epu8(__m512i x) {
+	switch(shift) {
+	case 1:
+		return _mm512_srli_epi16(x, 8);
+	case 2:
+		return _mm512_srli_epi32(x, 16);
+	case 4:
+		return _mm512_srli_epi64(x, 32);
+	case 8:
+		return _mm512_bsrli_epi128(x, 8);
+	case 16:
+		return _mm512_maskz_shuffle_i64x2(0b00110011, x, x, 0b00110001);
+	case 32:
+		return _mm512_maskz_shuffle_i64x2(0b00001111, x, x, 0b00001110);
+	default:
+		std::cerr << "Subvector shift of undefined size.";
+		return _mm512_setzero_si512();
+	}
+}
+
+#elif defined(__AVX2__)
 
 template<unsigned blockLength>
 inline void ZeroPrepareShortVector(__m256i &vec) {
@@ -364,7 +425,7 @@ inline void CombineBits(fipv *Left, fipv *Right, fipv *Out) {
 
 template<unsigned blockLength>
 inline void Combine_0R(fipv *Bits) {
-	const unsigned vecLength = blockLength / 8;
+	constexpr unsigned vecLength = nBit2cvecCount(blockLength);
 	for(unsigned i = 0; i < vecLength; ++i) {
 		fi_store(Bits + i, fi_load(Bits + vecLength + i));
 	}
@@ -405,12 +466,17 @@ inline void Combine_0RShort<8>(fipv *Bits, fipv *RightBits) {
 	BitPtr[0] = BitPtr[1] = RightBitPtr[0];
 }
 
-#ifdef __AVX2__
+#ifdef POLARCODE_AVX512
+template<>
+inline void Combine_0RShort<32>(__m512i *Bits, __m512i *RightBits) {
+	__m256i half = _mm256_loadu_si256(reinterpret_cast<__m256i*>(RightBits));
+	_mm512_store_si512(Bits, _mm512_broadcast_i64x4(half));
+}
+#elif defined(__AVX2__)
 template<>
 inline void Combine_0RShort<16>(__m256i *Bits, __m256i *RightBits) {
-	__m256i vec = _mm256_loadu_si256(RightBits);
-	_mm256_store_si256(Bits, vec);
-	_mm256_store_si256(Bits+1, vec);
+	__m128i half = _mm_loadu_si128(reinterpret_cast<__m128i*>(RightBits));
+	_mm256_store_si256(Bits, _mm256_set_m128i(half, half));
 }
 #endif
 
@@ -474,10 +540,8 @@ inline void SpcDecode(fipv *LlrIn, fipv *BitsOut) {
 			fi_store(BitsOut + i, vecIn);
 		}
 
-		unsigned char parity = reduce_xor(parVec) & 0x80;
-
 		// If there was an error, try to correct it
-		if(parity) {
+		if(sign_parity_epi8(parVec)) {
 			for(unsigned i = 0; i < vecCount; i++) {
 				fipv vecIn = fi_load(LlrIn + i);
 
@@ -501,7 +565,7 @@ inline void SpcDecode(fipv *LlrIn, fipv *BitsOut) {
 		fi_store(BitsOut, vecIn);
 
 		// Flip least reliable bit, if neccessary
-		if(reduce_xor(vecIn) & 0x80) {
+		if(sign_parity_epi8(vecIn)) {
 			fipv abs = fi_abs_epi8(vecIn);
 			unsigned vecMin = minpos_epu8(abs);
 			unsigned char *BitPtr = reinterpret_cast<unsigned char*>(BitsOut);
@@ -516,7 +580,7 @@ inline void ZeroSpcDecode(fipv *LlrIn, fipv *BitsOut) {
 	constexpr size_t subBlockLength = blockLength / 2;
 	constexpr unsigned vecCount = (subBlockLength + (BYTESPERVECTOR - 1)) / BYTESPERVECTOR;
 	unsigned minIdx = 0;
-	unsigned char parity;
+	bool parity;
 	char testAbs;
 
 	if (blockLength >= BYTESPERVECTOR) {
@@ -548,7 +612,7 @@ inline void ZeroSpcDecode(fipv *LlrIn, fipv *BitsOut) {
 				}
 			}
 		}
-		parity = reduce_xor(parVec) & 0x80;
+		parity = sign_parity_epi8(parVec);
 	} else {
 		fipv left = fi_load(LlrIn);
 		fipv right = subVectorShiftBytes_epu8<subBlockLength>(left);
@@ -564,7 +628,7 @@ inline void ZeroSpcDecode(fipv *LlrIn, fipv *BitsOut) {
 		// Flip least reliable bit, if neccessary
 		fipv abs = fi_abs_epi8(llr);
 		minIdx = minpos_epu8(abs, &testAbs);
-		parity = reduce_xor(llr) & 0x80;
+		parity = sign_parity_epi8(llr);
 	}
 
 	// Flip least reliable bit, if neccessary
@@ -9,6 +9,7 @@
 #ifndef PC_DEC_FIXED_CHAR_H
 #define PC_DEC_FIXED_CHAR_H
 
+#include <polarcode/avxconvenience.h>
 #include <polarcode/decoding/decoder.h>
 #include <polarcode/encoding/encoder.h>
 
@@ -40,7 +41,7 @@ private:
     }
 };
 
-class FixedDecoder : public AlignedNew<32>
+class FixedDecoder : public AlignedNew<BYTESPERVECTOR>
 {
 public:
     FixedDecoder();
@@ -48,16 +49,36 @@ public:
     virtual void decode(void* LlrIn, void* BitsOut) = 0;
 };
 
+/*!
+ * \brief Create the eight-bit integer decoder kernel of a catalogue entry.
+ * \param scheme Index into codeRegistry.
+ * \return The unrolled decoder, or nullptr for an unknown scheme.
+ */
 FixedDecoder* createFixedDecoder(unsigned int scheme);
 
+/*!
+ * \brief Create the floating point decoder of a catalogue entry.
+ * \param scheme Index into codeRegistry.
+ * \return A TemplatizedFloat decoder, or nullptr for an unknown scheme.
+ */
+Decoder* createFixedFloatDecoder(unsigned int scheme);
+
 } // namespace FixedDecoding
 
+/*!
+ * \brief The Fast-SSC decoder with eight-bit integer LLRs, generated for one code
+ *        of the catalogue.
+ */
 class FixedChar : public Decoder
 {
     FixedDecoding::FixedDecoder* mDecoder;
     Encoding::Encoder* mEncoder;
 
 public:
+    /*!
+     * \brief Create the decoder of a catalogue entry.
+     * \param scheme Index into codeRegistry.
+     */
     FixedChar(unsigned int scheme);
     ~FixedChar();
 
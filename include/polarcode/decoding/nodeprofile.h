@@ -0,0 +1,141 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PC_DEC_NODEPROFILE_H
+#define PC_DEC_NODEPROFILE_H
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace PolarCode {
+namespace Decoding {
+
+/*!
+ * \brief Accumulated hardware counters of one kind of decoding step.
+ */
+struct NodeCounters {
+    uint64_t calls;        ///< Number of executions
+    uint64_t cycles;       ///< Time stamp counter ticks
+    uint64_t instructions; ///< Retired instructions, zero without perf events
+    uint64_t cacheMisses;  ///< Last level cache misses, zero without perf events
+};
+
+/*!
+ * \brief Performance counters of a decoder, per node type and node length.
+ *
+ * Decoders fill their profile only if the library is built with
+ * POLARCODE_NODE_PROFILING (CMake option ENABLE_NODE_PROFILING). Counters of
+ * a node exclude the nodes it calls, so all entries add up to the total.
+ * Cycles come from rdtsc. Instructions and cache misses come from
+ * perf_event_open() counters, read with rdpmc if the kernel permits user space
+ * access, and are zero otherwise. No system call is made per node.
+ */
+class NodeProfile
+{
+public:
+    typedef std::pair<std::string, unsigned> key_t; ///< Node type and length
+
+    /*!
+     * \brief Order keys by name and length, allowing lookups by string literal
+     *        without allocating.
+     */
+    struct KeyLess {
+        typedef void is_transparent;
+
+        template <typename A, typename B>
+        bool operator()(const A& a, const B& b) const
+        {
+            int order = std::string_view(a.first).compare(b.first);
+            return order < 0 || (order == 0 && a.second < b.second);
+        }
+    };
+
+    typedef std::map<key_t, NodeCounters, KeyLess> entries_t;
+
+    void record(const char* kind, unsigned length, const NodeCounters& counters);
+    void merge(const NodeProfile& other);
+    void clear();
+    bool empty() const;
+
+    const entries_t& entries() const;
+
+    /*!
+     * \brief Write a CSV table with a header row, one row per entry.
+     */
+    void writeCsv(std::ostream& stream) const;
+
+    /*!
+     * \brief Write the header row of writeCsv().
+     * \param columnNames Leading columns, quoted and each followed by a comma.
+     */
+    static void writeCsvHeader(std::ostream& stream, const std::string& columnNames = "");
+
+    /*!
+     * \brief Write the rows of writeCsv(), to put several profiles into one table.
+     * \param columns Leading columns of every row, each followed by a comma.
+     */
+    void writeCsvRows(std::ostream& stream, const std::string& columns = "") const;
+
+private:
+    entries_t mEntries;
+};
+
+#ifdef POLARCODE_NODE_PROFILING
+
+namespace Profiling {
+
+/*!
+ * \brief Directs node measurements of the current thread into a profile.
+ */
+class DecoderScope
+{
+    NodeProfile* mPrevious;
+
+public:
+    explicit DecoderScope(NodeProfile* profile);
+    ~DecoderScope();
+};
+
+/*!
+ * \brief Measures its own lifetime, minus that of nested NodeScopes.
+ */
+class NodeScope
+{
+    const char* mKind;
+    unsigned mLength;
+    NodeCounters mStart;
+    NodeCounters mNested; ///< Counters of nested scopes, to be subtracted
+    NodeScope* mParent;
+
+public:
+    NodeScope(const char* kind, unsigned length);
+    ~NodeScope();
+};
+
+} // namespace Profiling
+
+#define PC_PROFILE_DECODER(profile) \
+    ::PolarCode::Decoding::Profiling::DecoderScope profileDecoderScope(profile)
+#define PC_PROFILE_NODE(kind, length) \
+    ::PolarCode::Decoding::Profiling::NodeScope profileNodeScope(kind, length)
+
+#else
+
+#define PC_PROFILE_DECODER(profile)
+#define PC_PROFILE_NODE(kind, length)
+
+#endif
+
+} // namespace Decoding
+} // namespace PolarCode
+
+#endif // PC_DEC_NODEPROFILE_H
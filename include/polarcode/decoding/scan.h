@@ -22,19 +22,32 @@ namespace Decoding {
  * "Low-Complexity Soft-Output Decoding of Polar Codes"
  * by Ubaid U. Fayyaz and John R. Barry
  *
+ * Each level of the factor graph keeps its messages in natural order, so the
+ * two halves a node combines are contiguous and processed with AVX (AVX-512
+ * in POLARCODE_AVX512 builds) vectors.
+ *
+ * Callers can enable early termination. Decoding then stops after the first
+ * iteration whose information bits pass the error detection, or whose
+ * information bits equal those of the previous iteration. The check is
+ * skipped for detectors without check bits.
  */
 class Scan : public Decoder
 {
-    std::vector<float> mLlr, mEven, mOdd;
-    std::vector<float> mSystematicOutput;
+    float *mLlr, *mEven, *mOdd;
     std::vector<bool> mBooleanFrozen;
-    unsigned int mLevelCount, mN, mIterationLimit;
+    std::vector<unsigned char> mPreviousOutput; ///< Information bits of last iteration
+    unsigned int mLevelCount, mN, mIterationLimit, mIterationCount;
+    bool mEarlyTermination;
 
-    unsigned int addressToIndex(unsigned level, unsigned group, unsigned bit);
+    float* llr(unsigned level);
+    float* even(unsigned level);
+    float* odd(unsigned level, unsigned group);
 
     void updatellrmap(unsigned level, unsigned group);
     void updatebitmap(unsigned level, unsigned group);
-
+    void calculateOutput();
+    bool stop(bool success);
+    void clear();
 
 public:
     Scan(size_t blockLength,
@@ -48,7 +61,29 @@ public:
                     const std::vector<unsigned>& frozenBits);
     void setIterationLimit(unsigned iterationLimit);
 
-    void getExtrinsicChannelInformation(float*);
+    /*!
+     * \brief Enable or disable early termination, which is disabled by default.
+     */
+    void setEarlyTermination(bool enable);
+
+    /*!
+     * \brief Number of iterations the last decode() call ran.
+     */
+    unsigned iterationCount() { return mIterationCount; }
+
+    /*!
+     * \brief Get the extrinsic LLRs of the code bits, as fed back to a
+     *        demapper or equalizer in iterative receivers.
+     * \param eLlr Memory for blockLength() floats.
+     */
+    void getExtrinsicChannelInformation(float* eLlr);
+
+    /*!
+     * \brief Get the a-posteriori LLRs of the code bits, channel plus extrinsic
+     *        information, regardless of systematic coding.
+     * \param pLlr Memory for blockLength() floats.
+     */
+    void getPosteriorChannelInformation(float* pLlr);
 
     /*!
      * \brief Get decoder list size
@@ -9,10 +9,12 @@
 #ifndef PC_DEC_SCL_AVX_H
 #define PC_DEC_SCL_AVX_H
 
-#include <polarcode/datapool.txx>
+#include <polarcode/patharena.txx>
 #include <polarcode/decoding/avx_float.h>
 #include <polarcode/decoding/decoder.h>
+#include <polarcode/decoding/decoderplan.h>
 #include <polarcode/encoding/butterfly_fip_packed.h>
+#include <array>
 #include <map>
 #include <vector>
 
@@ -20,8 +22,7 @@ namespace PolarCode {
 namespace Decoding {
 
 namespace SclAvx {
-typedef DataPool<float, 32> datapool_t;
-typedef Block<float> block_t;
+typedef PathArena<float, 32> patharena_t;
 
 /*!
  * \brief This class manages the collection of decoding paths.
@@ -32,19 +33,22 @@ typedef Block<float> block_t;
  */
 class PathList
 {
-    std::vector<std::vector<block_t*>> mLlrTree;
-    std::vector<std::vector<block_t*>> mBitTree;
-    std::vector<std::vector<block_t*>> mLeftBitTree;
+    // Slot of every buffer, indexed by path * mStageCount + stage
+    std::vector<patharena_t::slot_t> mLlrTree;
+    std::vector<patharena_t::slot_t> mBitTree;
+    std::vector<patharena_t::slot_t> mLeftBitTree;
     std::vector<float> mMetric;
-    std::vector<std::vector<block_t*>> mNextLlrTree;
-    std::vector<std::vector<block_t*>> mNextBitTree;
-    std::vector<std::vector<block_t*>> mNextLeftBitTree;
+    std::vector<patharena_t::slot_t> mNextLlrTree;
+    std::vector<patharena_t::slot_t> mNextBitTree;
+    std::vector<patharena_t::slot_t> mNextLeftBitTree;
     std::vector<float> mNextMetric;
     //	std::vector<unsigned> mCorrectedNodeIds;
     //	std::vector<unsigned> mNextCorrectedNodeIds;
     unsigned mPathLimit, mPathCount, mNextPathCount;
     unsigned mStageCount;
-    datapool_t* xmDataPool;
+    patharena_t* mArena;
+
+    unsigned index(unsigned path, unsigned stage) { return path * mStageCount + stage; }
 
     float mApparentlyBestMetric; ///< Information for statistics calculation
     float mSelectedPathMetric;   ///< Information for statistics calculation
@@ -56,9 +60,11 @@ public:
      * \brief Create a PathList object to manage list decoding.
      * \param listSize Maximum number of paths.
      * \param stageCount Depth of recursion.
-     * \param dataPool Data pool which provides an easy lazy-copy container.
+     *
+     * The buffers of all paths and stages are taken from a PathArena, which
+     * is allocated here once, so that decoding runs without heap allocations.
      */
-    PathList(size_t listSize, size_t stageCount, datapool_t* dataPool);
+    PathList(size_t listSize, size_t stageCount);
     ~PathList();
 
     /*!
@@ -148,7 +154,7 @@ public:
     void allocateStage(unsigned stage);
 
     /*!
-     * \brief Return LLR- and bit-blocks to the data pool for the given stage.
+     * \brief Return LLR- and bit-blocks to the arena for the given stage.
      *
      * \param stage
      */
@@ -236,6 +242,27 @@ public:
     void setNextPathCount(unsigned);
 };
 
+/*!
+ * \brief Candidate lists and LLR buffer of the leaf decoders.
+ *
+ * Leaves decode one after another, so all of them share the workspace of
+ * their decoder, which is sized for the whole code and the list size.
+ */
+struct Workspace {
+    std::vector<unsigned> indices;
+    std::vector<float> metrics;
+    std::vector<std::array<unsigned, 4>> bitFlipHints;
+    std::vector<unsigned> bitFlipCount;
+    std::vector<float> results;
+    float* temp; ///< AVX aligned copy of a leaf's LLRs
+
+    Workspace(size_t blockLength, size_t listSize);
+    ~Workspace();
+
+    Workspace(const Workspace&) = delete;
+    Workspace& operator=(const Workspace&) = delete;
+};
+
 /*!
  * \brief A node of the decoding tree.
  */
@@ -243,7 +270,8 @@ class Node
 {
 protected:
     // xm = eXternal member (not owned by this Node)
-    datapool_t* xmDataPool; ///< Pointer to a DataPool object.
+    NodeMemory* xmMemory;   ///< Objects of all nodes
+    Workspace* xmWorkspace; ///< Buffers shared by all leaves
     unsigned mBlockLength,  ///< Length of the subcode.
         mBitCount,          ///< Number of AVX-aligned bits the data can be stored in.
         mStage,             ///< Recursion depth of this node
@@ -253,7 +281,6 @@ protected:
     PathList* xmPathList;   ///< Pointer to PathList object.
 
 public:
-    Node();
 
     /*!
      * \brief Create a node and copy parameters of another.
@@ -265,10 +292,15 @@ public:
      * \brief Initialize a node by given parameters.
      * \param blockLength Length of the subcode.
      * \param listSize Limit for number of concurrently active paths.
-     * \param pool Pointer to a DataPool.
+     * \param memory The memory to create the decoding tree in.
+     * \param workspace The buffers of the leaf decoders.
      * \param pathList Pointer to the PathList to use.
      */
-    Node(size_t blockLength, size_t listSize, datapool_t* pool, PathList* pathList);
+    Node(size_t blockLength,
+         size_t listSize,
+         NodeMemory* memory,
+         Workspace* workspace,
+         PathList* pathList);
 
     virtual ~Node();
 
@@ -278,10 +310,9 @@ public:
     virtual void decode();
 
     /*!
-     * \brief Get a pointer to the DataPool.
-     * \return A pointer to the DataPool.
+     * \brief Get the memory of the decoding tree.
      */
-    datapool_t* pool();
+    NodeMemory* memory();
 
     /*!
      * \brief Get the block length of this node.
@@ -317,14 +348,13 @@ protected:
         *mRight; ///< Right child node
 
 public:
-    RateRNode();
 
     /*!
-     * \brief Create a decoder node.
-     * \param frozenBits The set of frozen bits for this code.
+     * \brief Create the child nodes selected by the plan.
+     * \param plan The plan node of this code.
      * \param parent The parent node to copy all information from.
      */
-    RateRNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    RateRNode(const DecoderPlan::Node* plan, Node* parent);
     ~RateRNode();
     void decode();
     //	unsigned lastId();
@@ -337,11 +367,11 @@ class ShortRateRNode : public RateRNode
 
 public:
     /*!
-     * \brief Create a decoder node.
-     * \param frozenBits The set of frozen bits for this code.
+     * \brief Create the child nodes selected by the plan.
+     * \param plan The plan node of this code.
      * \param parent The parent node to copy all information from.
      */
-    ShortRateRNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    ShortRateRNode(const DecoderPlan::Node* plan, Node* parent);
     ~ShortRateRNode();
     void decode();
     //	unsigned lastId();
@@ -357,10 +387,10 @@ public:
 
 class RateOneDecoder : public Node
 {
-    std::vector<unsigned> mIndices;
-    std::vector<float> mMetrics;
-    std::vector<std::vector<unsigned>> mBitFlipHints;
-    block_t* mTempBlock;
+    std::vector<unsigned>& mIndices;
+    std::vector<float>& mMetrics;
+    std::vector<std::array<unsigned, 4>>& mBitFlipHints;
+    std::vector<unsigned>& mBitFlipCount;
     float* mTemp;
 
 public:
@@ -371,9 +401,9 @@ public:
 
 class RepetitionDecoder : public Node
 {
-    std::vector<unsigned> mIndices;
-    std::vector<float> mMetrics;
-    std::vector<float> mResults;
+    std::vector<unsigned>& mIndices;
+    std::vector<float>& mMetrics;
+    std::vector<float>& mResults;
 
 public:
     RepetitionDecoder(Node* parent);
@@ -383,11 +413,10 @@ public:
 
 class SpcDecoder : public Node
 {
-    std::vector<unsigned> mIndices;
-    std::vector<float> mMetrics;
-    std::vector<std::array<unsigned, 4>> mBitFlipHints;
-    std::vector<unsigned> mBitFlipCount;
-    block_t* mTempBlock;
+    std::vector<unsigned>& mIndices;
+    std::vector<float>& mMetrics;
+    std::vector<std::array<unsigned, 4>>& mBitFlipHints;
+    std::vector<unsigned>& mBitFlipCount;
     float* mTemp;
 
 public:
@@ -396,7 +425,34 @@ public:
     void decode();
 };
 
-Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent);
+/*!
+ * \brief Node types of a DecoderPlan for this decoder.
+ */
+enum NodeKind { RATE_ZERO, RATE_ONE, REPETITION, SPC, SHORT_RATE_R, RATE_R };
+
+/*!
+ * \brief Select the specialized decoder for a subcode.
+ * \param frozenBits The set of frozen bits.
+ * \param blockLength The length of the subcode.
+ * \return The NodeKind, and whether the subcode is split into two children.
+ */
+std::pair<unsigned, bool> classifyNode(const std::vector<unsigned>& frozenBits,
+                                       size_t blockLength);
+
+/*!
+ * \brief Get the memory of the node a plan node selects.
+ * \param kind The NodeKind.
+ * \param blockLength The length of the subcode.
+ */
+DecoderPlan::NodeSize nodeSize(unsigned kind, size_t blockLength);
+
+/*!
+ * \brief Create the specialized decoder selected by a plan node.
+ * \param plan The plan node, as built with classifyNode() and nodeSize().
+ * \param parent The parent node to copy all information from.
+ * \return Pointer to a polymorphic decoder object in the parent's memory.
+ */
+Node* createDecoder(const DecoderPlan::Node* plan, Node* parent);
 
 } // namespace SclAvx
 
@@ -408,9 +464,12 @@ class SclAvxFloat : public Decoder
 {
     size_t mListSize;
     SclAvx::Node *mNodeBase, *mRootNode;
-    SclAvx::datapool_t* mDataPool;
+    NodeMemory* mMemory;           ///< Node tree laid out by the shared plan
+    SclAvx::Workspace* mWorkspace; ///< Buffers of the leaf decoders
     SclAvx::PathList* mPathList;
     Encoding::Encoder* mEncoder;
+    std::vector<unsigned char> mCandidateBits; ///< Information bits of every path
+    std::vector<void*> mCandidates;            ///< Pointers into mCandidateBits
 
     void clear();
     void makeInitialPathList();
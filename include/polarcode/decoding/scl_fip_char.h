@@ -9,8 +9,9 @@
 #ifndef PC_DEC_SCL_FIP_H
 #define PC_DEC_SCL_FIP_H
 
-#include <polarcode/datapool.txx>
+#include <polarcode/patharena.txx>
 #include <polarcode/decoding/decoder.h>
+#include <polarcode/decoding/decoderplan.h>
 #include <polarcode/decoding/fip_char.h>
 #include <polarcode/encoding/encoder.h>
 #include <array>
@@ -22,8 +23,7 @@ namespace Decoding {
 
 namespace SclFip {
 
-typedef DataPool<fipv, BYTESPERVECTOR> datapool_t;
-typedef Block<fipv> block_t;
+typedef PathArena<fipv, BYTESPERVECTOR> patharena_t;
 
 /*!
  * \brief This class manages the collection of decoding paths.
@@ -34,17 +34,20 @@ typedef Block<fipv> block_t;
  */
 class PathList
 {
-    std::vector<std::vector<block_t*>> mLlrTree;
-    std::vector<std::vector<block_t*>> mBitTree;
-    std::vector<std::vector<block_t*>> mLeftBitTree;
+    // Slot of every buffer, indexed by path * mStageCount + stage
+    std::vector<patharena_t::slot_t> mLlrTree;
+    std::vector<patharena_t::slot_t> mBitTree;
+    std::vector<patharena_t::slot_t> mLeftBitTree;
     std::vector<long> mMetric;
-    std::vector<std::vector<block_t*>> mNextLlrTree;
-    std::vector<std::vector<block_t*>> mNextBitTree;
-    std::vector<std::vector<block_t*>> mNextLeftBitTree;
+    std::vector<patharena_t::slot_t> mNextLlrTree;
+    std::vector<patharena_t::slot_t> mNextBitTree;
+    std::vector<patharena_t::slot_t> mNextLeftBitTree;
     std::vector<long> mNextMetric;
     unsigned mPathLimit, mPathCount, mNextPathCount;
     unsigned mStageCount;
-    datapool_t* xmDataPool;
+    patharena_t* mArena;
+
+    unsigned index(unsigned path, unsigned stage) { return path * mStageCount + stage; }
 
 public:
     PathList();
@@ -53,9 +56,11 @@ public:
      * \brief Create a PathList object to manage list decoding.
      * \param listSize Maximum number of paths.
      * \param stageCount Depth of recursion.
-     * \param dataPool Data pool which provides an easy lazy-copy container.
+     *
+     * The buffers of all paths and stages are taken from a PathArena, which
+     * is allocated here once, so that decoding runs without heap allocations.
      */
-    PathList(size_t listSize, size_t stageCount, datapool_t* dataPool);
+    PathList(size_t listSize, size_t stageCount);
     ~PathList();
 
     /*!
@@ -146,7 +151,7 @@ public:
     void allocateStage(unsigned stage);
 
     /*!
-     * \brief Return LLR- and bit-blocks to the data pool for the given stage.
+     * \brief Return LLR- and bit-blocks to the arena for the given stage.
      *
      * \param stage
      */
@@ -234,6 +239,27 @@ public:
     void setNextPathCount(unsigned);
 };
 
+/*!
+ * \brief Candidate lists and LLR buffer of the leaf decoders.
+ *
+ * Leaves decode one after another, so all of them share the workspace of
+ * their decoder, which is sized for the whole code and the list size.
+ */
+struct Workspace {
+    std::vector<unsigned> indices;
+    std::vector<long> metrics;
+    std::vector<std::array<unsigned, 4>> bitFlipHints;
+    std::vector<unsigned> bitFlipCount;
+    std::vector<char> results;
+    fipv* temp; ///< Copy of a leaf's LLRs, at least two vectors
+
+    Workspace(size_t blockLength, size_t listSize);
+    ~Workspace();
+
+    Workspace(const Workspace&) = delete;
+    Workspace& operator=(const Workspace&) = delete;
+};
+
 /*!
  * \brief A node of the decoding tree.
  */
@@ -241,7 +267,8 @@ class Node
 {
 protected:
     // xm = eXternal member (not owned by this Node)
-    datapool_t* xmDataPool; ///< Pointer to a DataPool object.
+    NodeMemory* xmMemory;   ///< Objects of all nodes
+    Workspace* xmWorkspace; ///< Buffers shared by all leaves
     unsigned mBlockLength,  ///< Length of the subcode.
         mVecCount,          ///< Number of AVX-vectors the data can be stored in.
         mStage,             ///< Recursion depth of this node
@@ -249,8 +276,6 @@ protected:
     PathList* xmPathList;   ///< Pointer to PathList object.
 
 public:
-    Node();
-
     /*!
      * \brief Create a node and copy parameters of another.
      * \param other The reference node.
@@ -261,10 +286,15 @@ public:
      * \brief Initialize a node by given parameters.
      * \param blockLength Length of the subcode.
      * \param listSize Limit for number of concurrently active paths.
-     * \param pool Pointer to a DataPool.
+     * \param memory The memory to create the decoding tree in.
+     * \param workspace The buffers of the leaf decoders.
      * \param pathList Pointer to the PathList to use.
      */
-    Node(size_t blockLength, size_t listSize, datapool_t* pool, PathList* pathList);
+    Node(size_t blockLength,
+         size_t listSize,
+         NodeMemory* memory,
+         Workspace* workspace,
+         PathList* pathList);
 
     virtual ~Node();
 
@@ -274,10 +304,9 @@ public:
     virtual void decode();
 
     /*!
-     * \brief Get a pointer to the DataPool.
-     * \return A pointer to the DataPool.
+     * \brief Get the memory of the decoding tree.
      */
-    datapool_t* pool();
+    NodeMemory* memory();
 
     /*!
      * \brief Get the block length of this node.
@@ -309,11 +338,11 @@ protected:
 
 public:
     /*!
-     * \brief Create a decoder node.
-     * \param frozenBits The set of frozen bits for this code.
+     * \brief Create the child nodes selected by the plan.
+     * \param plan The plan node of this code.
      * \param parent The parent node to copy all information from.
      */
-    RateRNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    RateRNode(const DecoderPlan::Node* plan, Node* parent);
     ~RateRNode();
     void decode();
 };
@@ -322,20 +351,17 @@ class ShortRateRNode : public RateRNode
 {
 public:
     /*!
-     * \brief Create a decoder node.
-     * \param frozenBits The set of frozen bits for this code.
+     * \brief Create the child nodes selected by the plan.
+     * \param plan The plan node of this code.
      * \param parent The parent node to copy all information from.
      */
-    ShortRateRNode(const std::vector<unsigned>& frozenBits, Node* parent);
+    ShortRateRNode(const DecoderPlan::Node* plan, Node* parent);
     ~ShortRateRNode();
     void decode();
 };
 
 class RateZeroDecoder : public Node
 {
-    std::vector<unsigned> mIndices;
-    std::vector<long> mMetrics;
-
 public:
     RateZeroDecoder(Node* parent);
     ~RateZeroDecoder();
@@ -344,10 +370,11 @@ public:
 
 class RateOneDecoder : public Node
 {
-    std::vector<unsigned> mIndices;
-    std::vector<long> mMetrics;
-    std::vector<std::array<unsigned, 2>> mBitFlipHints;
-    std::vector<unsigned> mBitFlipCount;
+    std::vector<unsigned>& mIndices;
+    std::vector<long>& mMetrics;
+    std::vector<std::array<unsigned, 4>>& mBitFlipHints;
+    std::vector<unsigned>& mBitFlipCount;
+    fipv* mTemp;
 
 public:
     RateOneDecoder(Node* parent);
@@ -357,9 +384,9 @@ public:
 
 class RepetitionDecoder : public Node
 {
-    std::vector<unsigned> mIndices;
-    std::vector<long> mMetrics;
-    std::vector<char> mResults;
+    std::vector<unsigned>& mIndices;
+    std::vector<long>& mMetrics;
+    std::vector<char>& mResults;
 
 public:
     RepetitionDecoder(Node* parent);
@@ -369,10 +396,11 @@ public:
 
 class SpcDecoder : public Node
 {
-    std::vector<unsigned> mIndices;
-    std::vector<long> mMetrics;
-    std::vector<std::array<unsigned, 4>> mBitFlipHints;
-    std::vector<unsigned> mBitFlipCount;
+    std::vector<unsigned>& mIndices;
+    std::vector<long>& mMetrics;
+    std::vector<std::array<unsigned, 4>>& mBitFlipHints;
+    std::vector<unsigned>& mBitFlipCount;
+    fipv* mTemp;
 
 public:
     SpcDecoder(Node* parent);
@@ -381,7 +409,34 @@ public:
 };
 
 
-Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent);
+/*!
+ * \brief Node types of a DecoderPlan for this decoder.
+ */
+enum NodeKind { RATE_ZERO, RATE_ONE, REPETITION, SPC, SHORT_RATE_R, RATE_R };
+
+/*!
+ * \brief Select the specialized decoder for a subcode.
+ * \param frozenBits The set of frozen bits.
+ * \param blockLength The length of the subcode.
+ * \return The NodeKind, and whether the subcode is split into two children.
+ */
+std::pair<unsigned, bool> classifyNode(const std::vector<unsigned>& frozenBits,
+                                       size_t blockLength);
+
+/*!
+ * \brief Get the memory of the node a plan node selects.
+ * \param kind The NodeKind.
+ * \param blockLength The length of the subcode.
+ */
+DecoderPlan::NodeSize nodeSize(unsigned kind, size_t blockLength);
+
+/*!
+ * \brief Create the specialized decoder selected by a plan node.
+ * \param plan The plan node, as built with classifyNode() and nodeSize().
+ * \param parent The parent node to copy all information from.
+ * \return Pointer to a polymorphic decoder object in the parent's memory.
+ */
+Node* createDecoder(const DecoderPlan::Node* plan, Node* parent);
 
 } // namespace SclFip
 
@@ -393,9 +448,12 @@ class SclFipChar : public Decoder
 {
     size_t mListSize;
     SclFip::Node *mNodeBase, *mRootNode;
-    SclFip::datapool_t* mDataPool;
+    NodeMemory* mMemory;           ///< Node tree laid out by the shared plan
+    SclFip::Workspace* mWorkspace; ///< Buffers of the leaf decoders
     SclFip::PathList* mPathList;
     Encoding::Encoder* mEncoder;
+    std::vector<unsigned char> mCandidateBits; ///< Information bits of every path
+    std::vector<void*> mCandidates;            ///< Pointers into mCandidateBits
 
     void clear();
     void makeInitialPathList();
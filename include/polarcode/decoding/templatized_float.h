@@ -11,6 +11,7 @@
 
 #include <polarcode/avxconvenience.h>
 #include <polarcode/decoding/decoder.h>
+#include <polarcode/encoding/butterfly_fip_packed.h>
 
 #include <array>
 #include <cmath>
@@ -20,28 +21,24 @@ namespace PolarCode {
 namespace Decoding {
 namespace TemplatizedFloatCalc {
 
-inline float float_or(float& a, float& b)
+// Bit operations on floats go through HybridFloat, as pointer casts would
+// break strict aliasing in the unrolled decoders.
+inline float float_or(float a, float b)
 {
-    union {
-        unsigned int iRet;
-        float fRet;
-    };
-    unsigned int* iA = reinterpret_cast<unsigned int*>(&a);
-    unsigned int* iB = reinterpret_cast<unsigned int*>(&b);
-    iRet = *iA | *iB;
-    return fRet;
+    HybridFloat hA, hB;
+    hA.f = a;
+    hB.f = b;
+    hA.u |= hB.u;
+    return hA.f;
 }
 
-inline float float_xor(float& a, float& b)
+inline float float_xor(float a, float b)
 {
-    union {
-        unsigned int iRet;
-        float fRet;
-    };
-    unsigned int* iA = reinterpret_cast<unsigned int*>(&a);
-    unsigned int* iB = reinterpret_cast<unsigned int*>(&b);
-    iRet = *iA ^ *iB;
-    return fRet;
+    HybridFloat hA, hB;
+    hA.f = a;
+    hB.f = b;
+    hA.u ^= hB.u;
+    return hA.f;
 }
 
 inline __m256 hardDecode(__m256 x)
@@ -52,10 +49,8 @@ inline __m256 hardDecode(__m256 x)
 
 inline float hardDecode(float x)
 {
-    /*	unsigned int *iX = reinterpret_cast<unsigned int*>(&x);
-            *iX &= 0x80000000U;
-            return x;*/
-    return (x < 0) ? -0.0f : 0.0f;
+    // Combined bits are sign-XORed floats, test the sign bit instead of comparing
+    return std::signbit(x) ? -0.0f : 0.0f;
 }
 
 inline void F_function_calc(__m256& Left, __m256& Right, float* Out)
@@ -69,17 +64,13 @@ inline void F_function_calc(__m256& Left, __m256& Right, float* Out)
     _mm256_store_ps(Out, _mm256_or_ps(sgnV, minV));
 }
 
-inline float F_function_signXor(float& fa, float& fb)
+inline float F_function_signXor(float fa, float fb)
 {
-    unsigned int* ia = reinterpret_cast<unsigned int*>(&fa);
-    unsigned int* ib = reinterpret_cast<unsigned int*>(&fb);
-    union {
-        float fRet;
-        unsigned int iRet;
-    };
-
-    iRet = (*ia ^ *ib) & 0x80000000U;
-    return fRet;
+    HybridFloat hA, hB;
+    hA.f = fa;
+    hB.f = fb;
+    hA.u = (hA.u ^ hB.u) & 0x80000000U;
+    return hA.f;
 }
 
 inline float F_function_calc(float Left, float Right)
@@ -259,10 +250,7 @@ inline void decodeRepetition(float* input, float* output)
 template <const int size>
 inline void decodeSpc(float* input, float* output)
 {
-    union {
-        float fParity;
-        unsigned int iParity;
-    };
+    HybridFloat parity;
     unsigned minIdx = 0;
     float testAbs, minAbs = INFINITY;
 
@@ -285,15 +273,14 @@ inline void decodeSpc(float* input, float* output)
         }
 
         // Flip least reliable bit, if neccessary
-        fParity = reduce_xor_ps(parVec);
+        parity.f = reduce_xor_ps(parVec);
 
     } else {
-        unsigned int* iInput = reinterpret_cast<unsigned int*>(input);
-        iParity = 0;
+        parity.f = 0.0f;
         minAbs = fabs(input[0]);
         for (unsigned i = 0; i < size; ++i) {
             output[i] = input[i];
-            iParity ^= iInput[i];
+            parity.f = TemplatizedFloatCalc::float_xor(parity.f, input[i]);
             testAbs = fabs(input[i]);
             if (testAbs < minAbs) {
                 minAbs = testAbs;
@@ -301,8 +288,8 @@ inline void decodeSpc(float* input, float* output)
             }
         }
     }
-    iParity &= 0x80000000;
-    reinterpret_cast<unsigned int*>(output)[minIdx] ^= iParity;
+    parity.u &= 0x80000000;
+    output[minIdx] = TemplatizedFloatCalc::float_xor(output[minIdx], parity.f);
 }
 
 template <const int size>
@@ -346,7 +333,7 @@ class TemplatizedFloat : public Decoder
     inline void decodeRateR(float input[size], float output[size])
     {
         using namespace TemplatizedFloatCalc;
-        float llr[size / 2];
+        alignas(32) float llr[size / 2];
 
         F_function<size / 2>(input, llr);
         decodeNode<begin, size / 2>(llr, output);
@@ -359,7 +346,7 @@ class TemplatizedFloat : public Decoder
     inline void decodeROne(float input[size], float output[size])
     {
         using namespace TemplatizedFloatCalc;
-        float llr[size / 2];
+        alignas(32) float llr[size / 2];
 
         F_function<size / 2>(input, llr);
         decodeNode<begin, size / 2>(llr, output);
@@ -370,7 +357,7 @@ class TemplatizedFloat : public Decoder
     inline void decodeZeroR(float input[size], float output[size])
     {
         using namespace TemplatizedFloatCalc;
-        float llr[size / 2];
+        alignas(32) float llr[size / 2];
 
         G_function_0R<size / 2>(input, llr);
         decodeNode<begin + size / 2, size / 2>(llr, output + size / 2);
@@ -383,16 +370,13 @@ class TemplatizedFloat : public Decoder
     {
         constexpr int frozenBitCount = partialSum<begin, size, N>(frozenBitSet);
         /* Simplified decoding */
-        if (size > 1) {
-            if (frozenBitCount == size - 1) {
-                return decodeRepetition<size>(input, output);
-            } else if (frozenBitCount == 1) {
-                return decodeSpc<size>(input, output);
-            } // else: continue below
-        }
-        if (frozenBitCount == size) {
+        if constexpr (size > 1 && frozenBitCount == size - 1) {
+            return decodeRepetition<size>(input, output);
+        } else if constexpr (size > 1 && frozenBitCount == 1) {
+            return decodeSpc<size>(input, output);
+        } else if constexpr (frozenBitCount == size) {
             return decodeRateZero<size>(output);
-        } else if (frozenBitCount == 0) {
+        } else if constexpr (frozenBitCount == 0) {
             return decodeRateOne<size>(input, output);
         } else {
             constexpr int leftFrozenBitCount =
@@ -400,9 +384,9 @@ class TemplatizedFloat : public Decoder
             constexpr int rightFrozenBitCount =
                 partialSum<begin + size / 2, size / 2, N>(frozenBitSet);
 
-            if (rightFrozenBitCount == 0 && size < 8) {
+            if constexpr (rightFrozenBitCount == 0 && size < 8) {
                 return decodeROne<begin, size>(input, output);
-            } else if (leftFrozenBitCount == size / 2) {
+            } else if constexpr (leftFrozenBitCount == size / 2) {
                 return decodeZeroR<begin, size>(input, output);
             } else {
                 return decodeRateR<begin, size>(input, output);
@@ -423,22 +407,39 @@ class TemplatizedFloat : public Decoder
         */
     }
 
+    Encoding::Encoder* mEncoder; ///< Encoder for non-systematic output
+
 public:
+    /*!
+     * \brief Create a decoder, which is unrolled for the given code at compile time.
+     * \param frozenBits Frozen bit indices, matching the flags in _frozenBitSet_.
+     */
     TemplatizedFloat(std::vector<unsigned> frozenBits)
     {
+        mBlockLength = N;
+        mFrozenBits.assign(frozenBits.begin(), frozenBits.end());
+        mEncoder = new Encoding::ButterflyFipPacked(N, mFrozenBits);
+        mEncoder->setSystematic(false);
         mLlrContainer = new FloatContainer(N);
         mBitContainer = new FloatContainer(N, frozenBits);
-        mOutputContainer = new unsigned char[(N - frozenBits.size()) / 8];
+        // The packed encoder writes whole 32-bit chunks of information bits.
+        mOutputContainer = new unsigned char[(N - frozenBits.size() + 31) / 32 * 4];
     }
 
-    ~TemplatizedFloat() {}
+    ~TemplatizedFloat() { delete mEncoder; }
 
     bool decode()
     {
-        decodeNode<0, N>(dynamic_cast<FloatContainer*>(mLlrContainer)->data(),
-                         dynamic_cast<FloatContainer*>(mBitContainer)->data());
-        mBitContainer->getPackedInformationBits(mOutputContainer);
-        return true;
+        float* bits = static_cast<FloatContainer*>(mBitContainer)->data();
+        decodeNode<0, N>(static_cast<FloatContainer*>(mLlrContainer)->data(), bits);
+        if (!mSystematic) {
+            mEncoder->setFloatCodeword(bits);
+            mEncoder->encode();
+            mEncoder->getInformation(mOutputContainer);
+        } else {
+            mBitContainer->getPackedInformationBits(mOutputContainer);
+        }
+        return mErrorDetector->check(mOutputContainer, (N - mFrozenBits.size() + 7) / 8);
     }
 };
 
@@ -165,6 +165,14 @@ public:
     void encode();
 };
 
+/*!
+ * \brief Create the packed butterfly encoder, built for the best instruction set
+ *        level available (see Dispatch::activeIsa()).
+ * \param blockLength Number of code bits.
+ * \param frozenBits A set of frozen channel indices.
+ */
+Encoder* create(size_t blockLength, const std::vector<unsigned>& frozenBits);
+
 } // namespace Encoding
 } // namespace PolarCode
 
@@ -9,6 +9,7 @@
 #ifndef PC_ERR_CRC11NR_H
 #define PC_ERR_CRC11NR_H
 
+#include <polarcode/errordetection/crcengine.h>
 #include <polarcode/errordetection/errordetector.h>
 
 namespace PolarCode {
@@ -27,7 +28,7 @@ namespace ErrorDetection {
  */
 class CRC11NR : public Detector
 {
-    uint16_t gen(uint16_t* data, int bitsize);
+    CrcEngine mEngine;
 
 public:
     CRC11NR();
@@ -9,6 +9,7 @@
 #ifndef PC_ERR_CRC16_H
 #define PC_ERR_CRC16_H
 
+#include <polarcode/errordetection/crcengine.h>
 #include <polarcode/errordetection/errordetector.h>
 
 namespace PolarCode {
@@ -27,7 +28,7 @@ namespace ErrorDetection {
  */
 class CRC16 : public Detector
 {
-    uint16_t gen(uint16_t* data, int byteSize);
+    CrcEngine mEngine;
 
 public:
     CRC16();
@@ -9,6 +9,7 @@
 #ifndef PC_ERR_CRC16NR_H
 #define PC_ERR_CRC16NR_H
 
+#include <polarcode/errordetection/crcengine.h>
 #include <polarcode/errordetection/errordetector.h>
 
 namespace PolarCode {
@@ -29,7 +30,7 @@ namespace ErrorDetection {
  */
 class CRC16NR : public Detector
 {
-    uint16_t gen(uint16_t* data, int bitSize);
+    CrcEngine mEngine;
 
 public:
     CRC16NR();
@@ -9,6 +9,7 @@
 #ifndef PC_ERR_CRC24NRC_H
 #define PC_ERR_CRC24NRC_H
 
+#include <polarcode/errordetection/crcengine.h>
 #include <polarcode/errordetection/errordetector.h>
 
 namespace PolarCode {
@@ -28,7 +29,7 @@ namespace ErrorDetection {
  */
 class CRC24NRC : public Detector
 {
-    uint32_t gen(uint32_t* data, size_t bitSize);
+    CrcEngine mEngine;
 
 public:
     CRC24NRC();
@@ -9,6 +9,7 @@
 #ifndef PC_ERR_CRC6NR_H
 #define PC_ERR_CRC6NR_H
 
+#include <polarcode/errordetection/crcengine.h>
 #include <polarcode/errordetection/errordetector.h>
 
 namespace PolarCode {
@@ -25,7 +26,7 @@ namespace ErrorDetection {
  */
 class CRC6NR : public Detector
 {
-    uint8_t gen(uint8_t* data, int bitSize);
+    CrcEngine mEngine;
 
 public:
     CRC6NR();
@@ -9,6 +9,7 @@
 #ifndef PC_ERR_CRC8_H
 #define PC_ERR_CRC8_H
 
+#include <polarcode/errordetection/crcengine.h>
 #include <polarcode/errordetection/errordetector.h>
 
 namespace PolarCode {
@@ -25,8 +26,7 @@ namespace ErrorDetection {
  */
 class CRC8 : public Detector
 {
-    unsigned char table[256];
-    unsigned char gen(unsigned char* data, int bytes);
+    CrcEngine mEngine;
 
 public:
     CRC8();
@@ -0,0 +1,106 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PC_ERR_CRCENGINE_H
+#define PC_ERR_CRCENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PolarCode {
+namespace ErrorDetection {
+
+/*!
+ * \brief Shared checksum engine for non-reflected CRCs of up to 32 bits.
+ *
+ * The register is kept left-aligned in 32 bits, so one implementation serves
+ * all widths. If the target supports PCLMULQDQ, messages are folded 16 bytes
+ * at a time by carry-less multiplication and finished with a Barrett
+ * reduction, which needs no lookup tables. Short messages, tails and targets
+ * without PCLMULQDQ use slice-by-8 tables.
+ *
+ * Checksums are stored big-endian in the last (width + 7) / 8 bytes of a
+ * buffer, which is the layout of all byte-aligned detectors in this library.
+ */
+class CrcEngine
+{
+public:
+    static const unsigned laneCount = 8; ///< Buffers processed side by side
+
+private:
+    unsigned mWidth;
+    uint32_t mPolynomial;  ///< Left-aligned generator, without the x^32 term
+    uint32_t mInit;        ///< Left-aligned initial register
+    uint64_t mFoldHigh;    ///< x^192 mod P
+    uint64_t mFoldLow;     ///< x^128 mod P
+    uint64_t mReduce96;    ///< x^96 mod P
+    uint64_t mReduce64;    ///< x^64 mod P
+    uint64_t mBarrett;     ///< floor(x^64 / P)
+    uint32_t mTable[8][256];
+
+    uint32_t update(uint32_t reg, const uint8_t* data, size_t bytes) const;
+    void updateLanes(uint32_t* reg, const uint8_t* const* data, unsigned lanes,
+                     size_t bytes) const;
+    size_t checkBytes() const { return (mWidth + 7) / 8; }
+    uint32_t storedChecksum(const uint8_t* data, size_t bytes) const;
+
+public:
+    /*!
+     * \brief Prepare tables and folding constants for a CRC.
+     * \param width Number of checksum bits, 1 to 32.
+     * \param polynomial Generator polynomial without its leading term.
+     * \param init Initial register value.
+     */
+    CrcEngine(unsigned width, uint32_t polynomial, uint32_t init = 0);
+
+    /*!
+     * \brief Calculate the checksum of _bytes_ bytes.
+     */
+    uint32_t calculate(const void* data, size_t bytes) const;
+
+    /*!
+     * \brief Calculate the checksum of the first _bits_ bits, MSB first.
+     */
+    uint32_t calculateBits(const void* data, size_t bits) const;
+
+    /*!
+     * \brief Calculate the checksums of many buffers of equal length.
+     *
+     * Up to laneCount buffers are processed in an interleaved loop, whose
+     * independent dependency chains keep the multipliers busy.
+     *
+     * \param data Pointers to the buffers.
+     * \param nArrays Number of buffers.
+     * \param bytes Number of bytes per buffer.
+     * \param checksums Output, one checksum per buffer.
+     */
+    void calculate(const void* const* data, size_t nArrays, size_t bytes,
+                   uint32_t* checksums) const;
+
+    /*!
+     * \brief Write the checksum of the leading bytes into the trailing bytes.
+     * \param data Buffer of _bytes_ bytes, including the checksum.
+     */
+    void generate(void* data, size_t bytes) const;
+
+    /*!
+     * \brief Check a buffer which ends with its checksum.
+     */
+    bool check(const void* data, size_t bytes) const;
+
+    /*!
+     * \brief Find the first of _nArrays_ buffers with a valid checksum.
+     * \return The index of the first valid buffer, or -1.
+     */
+    int multiCheck(const void* const* data, size_t nArrays, size_t bytes) const;
+};
+
+} // namespace ErrorDetection
+} // namespace PolarCode
+
+#endif // PC_ERR_CRCENGINE_H
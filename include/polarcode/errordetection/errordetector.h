@@ -80,7 +80,8 @@ public:
 /*!
  * \brief Create new Detector with specified parameters
  *
- * Serves as a wrapper to ease Detector creation
+ * Serves as a wrapper to ease Detector creation. The CRC code is built for the
+ * best instruction set level available, see Dispatch::activeIsa().
  *
  * \param size Checksum size in bits, must align to bytes, e.g. 0, 8, 16, ...
  * \param type Detector type. Currently CRC or CMAC.
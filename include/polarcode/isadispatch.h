@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PC_ISADISPATCH_H
+#define PC_ISADISPATCH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Marks classes and functions that hold process-wide state, like caches
+ *        and counters.
+ *
+ * Kernel modules are built with hidden symbols and without these sources, so
+ * that they use the one instance of the base library.
+ */
+#define POLARCODE_SHARED __attribute__((visibility("default")))
+
+namespace PolarCode {
+
+namespace Decoding {
+class Decoder;
+}
+namespace Encoding {
+class Encoder;
+}
+namespace ErrorDetection {
+class Detector;
+}
+
+namespace Dispatch {
+
+/*!
+ * \brief Instruction set levels the library can be built for, in ascending order.
+ *
+ * IsaAvx runs the 8-bit kernels on 128-bit SSE4.2 vectors and the float kernels
+ * on 256-bit AVX vectors, as the float kernels have no SSE fallback. It does not
+ * need RDRAND, which IsaAvx2 and above require.
+ */
+enum IsaLevel { IsaAvx, IsaAvx2, IsaAvx512 };
+
+/*!
+ * \brief The level this part of the library was compiled for.
+ */
+IsaLevel compiledIsa();
+
+/*!
+ * \brief The highest level the executing CPU supports.
+ */
+IsaLevel cpuIsa();
+
+/*!
+ * \brief The level to run at: the CPU's level, lowered by the environment
+ *        variable POLARCODE_ISA ("avx", "avx2" or "avx512") for benchmarking.
+ *
+ * The result is never lower than compiledIsa(), as the library itself needs it.
+ */
+IsaLevel selectedIsa();
+
+/*!
+ * \brief The level Decoding::create() and the other factories actually run at.
+ *
+ * Equals selectedIsa(), unless the library was built without ENABLE_ISA_DISPATCH
+ * or the kernel module of that level could not be loaded.
+ */
+IsaLevel activeIsa();
+
+const char* isaName(IsaLevel level);
+
+/*!
+ * \brief Parse a level name as used by POLARCODE_ISA.
+ * \return False, if the name is unknown.
+ */
+bool parseIsa(const std::string& name, IsaLevel* level);
+
+/*!
+ * \brief The factories of one build of the library.
+ *
+ * With ENABLE_ISA_DISPATCH, the library is additionally built as a kernel module
+ * per higher level (libPolarCodeKernels_avx2.so, ...). Objects created by a
+ * module are used through their virtual interface only.
+ */
+struct KernelTable {
+    IsaLevel isa;
+    Decoding::Decoder* (*createDecoder)(size_t blockLength,
+                                        size_t listSize,
+                                        const std::vector<unsigned>& frozenBits,
+                                        std::string decoderType);
+    Encoding::Encoder* (*createEncoder)(size_t blockLength,
+                                        const std::vector<unsigned>& frozenBits);
+    ErrorDetection::Detector* (*createDetector)(unsigned size, std::string type);
+};
+
+/*!
+ * \brief Load the kernel module of a level, regardless of selectedIsa().
+ *
+ * The module is installed next to this library, or else found through the
+ * library search path. It stays loaded until the process exits.
+ *
+ * \return nullptr, if the library was built without ENABLE_ISA_DISPATCH or the
+ *         module cannot be loaded.
+ */
+const KernelTable* loadModule(IsaLevel level);
+
+/*!
+ * \brief The kernel module for selectedIsa(), loaded on first use.
+ * \return nullptr, if the factories of this build are to be used.
+ */
+const KernelTable* moduleKernels();
+
+} // namespace Dispatch
+} // namespace PolarCode
+
+#endif // PC_ISADISPATCH_H
@@ -0,0 +1,159 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PC_PATHARENA_TXX
+#define PC_PATHARENA_TXX
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include <polarcode/alignedmemory.h>
+#include <polarcode/avxconvenience.h>
+
+namespace PolarCode {
+
+/*!
+ * \brief Fixed memory for the per-stage buffers of a list decoder.
+ *
+ * All slots of all stages are carved out of a single aligned allocation when
+ * the arena is constructed. A slot is addressed by its index, which encodes
+ * the stage, and carries a use counter for lazy copying like a DataPool
+ * block. Allocating and releasing a slot only moves its index on the free
+ * stack of its stage, so decoding never touches the heap.
+ */
+template <typename T, size_t alignment>
+class PathArena
+{
+public:
+    typedef unsigned slot_t;
+    static constexpr slot_t noSlot = ~0u;
+
+private:
+    T* mMemory;
+    size_t mBytes;
+    size_t mSlotsPerStage;
+    std::vector<size_t> mStageSize;   ///< Elements per slot of every stage
+    std::vector<T*> mData;            ///< First element of every slot
+    std::vector<unsigned> mUseCount;  ///< Reference counter of every slot
+    std::vector<slot_t> mFreeSlots;   ///< One stack of mSlotsPerStage per stage
+    std::vector<unsigned> mFreeCount; ///< Height of the free stacks
+
+public:
+    /*!
+     * \brief Carve the slots of all stages from one allocation.
+     * \param stageSize Number of elements a slot of each stage must hold.
+     * \param slotsPerStage Number of slots available in every stage.
+     */
+    PathArena(const std::vector<size_t>& stageSize, size_t slotsPerStage)
+        : mSlotsPerStage(slotsPerStage), mStageSize(stageSize)
+    {
+        const size_t stageCount = stageSize.size();
+        const size_t vecSize = alignment / sizeof(T);
+        std::vector<size_t> slotBytes(stageCount);
+
+        mBytes = 0;
+        for (size_t stage = 0; stage < stageCount; ++stage) {
+            size_t elements = (stageSize[stage] + vecSize - 1) / vecSize * vecSize;
+            slotBytes[stage] = elements * sizeof(T);
+            mBytes += slotBytes[stage] * slotsPerStage;
+        }
+
+        mMemory = static_cast<T*>(alignedAlloc(mBytes, alignment));
+        memset(mMemory, 0, mBytes);
+
+        mData.resize(stageCount * slotsPerStage);
+        mUseCount.assign(stageCount * slotsPerStage, 0);
+        mFreeSlots.resize(stageCount * slotsPerStage);
+        mFreeCount.assign(stageCount, slotsPerStage);
+
+        char* ptr = reinterpret_cast<char*>(mMemory);
+        for (size_t stage = 0; stage < stageCount; ++stage) {
+            for (size_t i = 0; i < slotsPerStage; ++i) {
+                slot_t slot = stage * slotsPerStage + i;
+                mData[slot] = reinterpret_cast<T*>(ptr);
+                ptr += slotBytes[stage];
+                // Pop order follows the address order
+                mFreeSlots[stage * slotsPerStage + slotsPerStage - 1 - i] = slot;
+            }
+        }
+    }
+
+    ~PathArena() { alignedFree(mMemory); }
+
+    PathArena(const PathArena&) = delete;
+    PathArena& operator=(const PathArena&) = delete;
+
+    /*!
+     * \brief Take an unused slot of the given stage.
+     */
+    slot_t allocate(unsigned stage)
+    {
+        if (mFreeCount[stage] == 0) {
+            throw std::runtime_error("PathArena: no free slot left in stage");
+        }
+        slot_t slot = mFreeSlots[stage * mSlotsPerStage + --mFreeCount[stage]];
+        mUseCount[slot] = 1;
+        return slot;
+    }
+
+    /*!
+     * \brief Share a slot by increasing its use counter.
+     */
+    slot_t lazyDuplicate(slot_t slot)
+    {
+        mUseCount[slot]++;
+        return slot;
+    }
+
+    /*!
+     * \brief Give the caller a private copy of _slot_, if it is shared.
+     */
+    void prepareForWrite(slot_t& slot)
+    {
+        if (mUseCount[slot] > 1) {
+            const unsigned stage = slot / mSlotsPerStage;
+            slot_t copy = allocate(stage);
+            memcpy(mData[copy], mData[slot], sizeof(T) * mStageSize[stage]);
+            mUseCount[slot]--;
+            slot = copy;
+        }
+    }
+
+    /*!
+     * \brief Drop a reference, returning the slot to its stage when unused.
+     */
+    void release(slot_t& slot)
+    {
+        if (slot == noSlot) {
+            return;
+        }
+        if (--mUseCount[slot] == 0) {
+            const unsigned stage = slot / mSlotsPerStage;
+            mFreeSlots[stage * mSlotsPerStage + mFreeCount[stage]++] = slot;
+        }
+        slot = noSlot;
+    }
+
+    T* data(slot_t slot) { return mData[slot]; }
+
+    /*!
+     * \brief Get the number of unused slots in _stage_.
+     */
+    size_t freeSlotCount(unsigned stage) { return mFreeCount[stage]; }
+
+    /*!
+     * \brief Get the size of the underlying allocation.
+     */
+    size_t bytes() { return mBytes; }
+};
+
+} // namespace PolarCode
+#endif
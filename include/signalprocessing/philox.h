@@ -0,0 +1,102 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PCDSP_PHILOX_H
+#define PCDSP_PHILOX_H
+
+#include <alignednew.h>
+#include <immintrin.h>
+#include <cstdint>
+
+namespace SignalProcessing {
+namespace Random {
+
+/*!
+ * \brief Counter-based pseudo-random number generator (Philox4x32-10).
+ *
+ * Every output is a keyed hash of its position, so there is no state to
+ * guard and any position can be reached in constant time. The sequence is
+ * addressed by a 64-bit seed (the key), a 32-bit stream, a 64-bit block and
+ * the draw index within that block. Giving every simulation job its own
+ * stream and calling setBlock() per frame makes runs reproducible and
+ * resumable, independent of thread scheduling.
+ *
+ * Eight counters are hashed at once in AVX2 lanes. An object is not
+ * thread-safe, each thread owns its own generator instead.
+ */
+class Philox : public AlignedNew<32>
+{
+    __m256i mCounter; ///< Draw index of all lanes, interleaved
+    uint32_t mKey[2];
+    uint32_t mStream;
+    uint64_t mBlock;
+
+    __m256 mNormal[2]; ///< Second half of the last Box-Muller transform
+    bool mHasNormal;
+
+public:
+    /*!
+     * \brief Create a generator with a seed from std::random_device.
+     */
+    Philox();
+
+    /*!
+     * \brief Create a generator for a given seed and stream.
+     */
+    Philox(uint64_t seed, uint32_t stream = 0);
+    ~Philox();
+
+    /*!
+     * \brief Select a new sequence and restart at its block zero.
+     * \param seed The key of the generator.
+     * \param stream Independent sequence of this seed, e.g. a job or worker index.
+     */
+    void seed(uint64_t seed, uint32_t stream = 0);
+
+    /*!
+     * \brief Jump to the first draw of a block of the current stream.
+     */
+    void setBlock(uint64_t block);
+
+    /*!
+     * \brief Get 32 uniformly distributed 32-bit words.
+     * \param out Four destination vectors.
+     */
+    void generate(__m256i* out);
+
+    /*!
+     * \brief Fill a buffer with random bytes.
+     */
+    void fill(void* data, size_t bytes);
+
+    /*!
+     * \brief Get two AVX-vectors á 8 normal distributed random numbers.
+     * \param a Pointer to first destination.
+     * \param b Pointer to second destination.
+     */
+    void getNormDist(__m256* a, __m256* b);
+
+    /*!
+     * \brief Get two vectors of Rayleigh distributed values.
+     * \param a Pointer to first destination.
+     * \param b Pointer to second destination.
+     */
+    void getRayleighDist(__m256* a, __m256* b);
+
+    /*!
+     * \brief Hash a single counter, for reference and testing.
+     * \param counter The four counter words, replaced by the output.
+     * \param key The two key words.
+     */
+    static void hash(uint32_t* counter, const uint32_t* key);
+};
+
+} // namespace Random
+} // namespace SignalProcessing
+
+#endif // PCDSP_PHILOX_H
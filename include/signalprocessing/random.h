@@ -20,11 +20,13 @@ namespace Random {
 
 /*!
  * \brief Pseudo-random number generator
+ *
+ * Uniform numbers come from RDRAND if the target has it, or else from a
+ * linear congruential generator seeded by the clock, as on the 'avx' level.
  */
 class Generator : public AlignedNew<32>
 {
 #ifndef __RDRND__
-#warning RDRND not used
     struct {
         LCG<uint64_t> Generator; ///< Linear congruential generator
         std::mutex Mutex;        ///< Mutex for multi-threading compatability
@@ -9,7 +9,7 @@
 #ifndef PCDSP_TRANSMITTER_AWGN_H
 #define PCDSP_TRANSMITTER_AWGN_H
 
-#include <signalprocessing/random.h>
+#include <signalprocessing/philox.h>
 #include <signalprocessing/transmission/transmitter.h>
 
 namespace SignalProcessing {
@@ -33,12 +33,14 @@ namespace Transmission {
  */
 class Awgn : public Transmitter
 {
-    Random::Generator* mRandGen;
+    Random::Philox* mRandGen;
 
     float mEsNoLog, mEsNoLin, mNoiseMagnitude;
 
-    void transmit_simple();
-    void transmit_vectorized();
+    /*!
+     * \brief Add noise to _size_ symbols, masking the last partial vectors.
+     */
+    void addNoise(float* signal, size_t size);
 
 public:
     Awgn();
@@ -49,6 +51,18 @@ public:
     Awgn(float EsN0_dB);
     ~Awgn();
 
+    /*!
+     * \brief Make the noise reproducible.
+     * \param seed The seed of the noise generator.
+     * \param stream Independent noise sequence of this seed.
+     */
+    void seed(uint64_t seed, uint32_t stream);
+
+    /*!
+     * \brief Restart the noise sequence at the given block of the stream.
+     */
+    void setBlock(uint64_t block);
+
     /*!
      * \brief Set a new SNR given in dB.
      */
@@ -72,6 +86,29 @@ public:
     float EsNoLin();
 
     void transmit();
+
+    /*!
+     * \brief Add noise to a batch of frames in one contiguous buffer.
+     *
+     * Frame f receives the noise of block _firstBlock_ + f, which equals the
+     * noise of transmit() after setBlock(firstBlock + f). Afterwards, the
+     * generator is set to the block following the batch.
+     *
+     * \param signal The frames, back to back.
+     * \param frameLength Number of symbols per frame, any length is allowed.
+     * \param nFrames Number of frames.
+     * \param firstBlock Noise block of the first frame.
+     */
+    void transmit_batch(float* signal,
+                        size_t frameLength,
+                        size_t nFrames,
+                        uint64_t firstBlock);
+
+    /*!
+     * \brief Write the noise of transmit_batch() into a buffer.
+     * \param noise Destination of frameLength*nFrames values.
+     */
+    void getNoise(float* noise, size_t frameLength, size_t nFrames, uint64_t firstBlock);
 };
 
 } // namespace Transmission
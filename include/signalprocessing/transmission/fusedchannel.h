@@ -0,0 +1,98 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PCDSP_TRANSMITTER_FUSEDCHANNEL_H
+#define PCDSP_TRANSMITTER_FUSEDCHANNEL_H
+
+#include <signalprocessing/philox.h>
+#include <cstddef>
+#include <vector>
+
+namespace SignalProcessing {
+namespace Transmission {
+
+/*!
+ * \brief Modulation, AWGN, demodulation and scaling in a single pass.
+ *
+ * The separate Modem and Transmitter objects each pass over a whole signal
+ * vector. This channel reads packed code bits and writes decoder-ready LLRs,
+ * processing 16 symbols at a time in registers.
+ *
+ * The result is bit-identical to Bpsk or Ask modulation, Awgn with the same
+ * seed, stream and block, demodulation and Scale, in that order.
+ */
+class FusedChannel
+{
+    Random::Philox* mRandGen;
+
+    unsigned mBitsPerSymbol;
+    float mPowerNormalizer, mNormalMagnitude;
+    float mEsNoLog, mEsNoLin, mNoiseMagnitude;
+    float mAmplification;
+
+    std::vector<float> mAskLlr; ///< Demodulated bits of 16 ASK symbols
+
+    template <typename LlrType>
+    void transmitFrame(const unsigned char* bits, size_t bitCount, LlrType* llr);
+
+public:
+    /*!
+     * \brief Create a fused channel, with a randomly seeded noise generator.
+     * \param bitsPerSymbol One for BPSK, more for amplitude shift keying.
+     */
+    FusedChannel(unsigned bitsPerSymbol = 1);
+    ~FusedChannel();
+
+    /*!
+     * \brief Set the modulation, normalized to unit power as in Ask.
+     */
+    void setBitsPerSymbol(unsigned bps, bool normalizeOutput = true);
+
+    /*!
+     * \brief Set SNR in dB.
+     */
+    void setEsN0(float);
+
+    /*!
+     * \brief Set SNR by linear ratio.
+     */
+    void setEsN0Linear(float);
+
+    /*!
+     * \brief Set the factor applied to all LLRs, to optimize 8-bit quantization.
+     */
+    void setAmplification(float);
+
+    /*!
+     * \brief Make the noise reproducible, see Awgn::seed().
+     */
+    void seed(uint64_t seed, uint32_t stream);
+
+    /*!
+     * \brief Restart the noise sequence at the given block of the stream.
+     */
+    void setBlock(uint64_t block);
+
+    /*!
+     * \brief Transmit a frame and get its floating point LLRs.
+     * \param bits Packed code bits, most significant bit first.
+     * \param bitCount Number of code bits.
+     * \param llr Destination of bitCount LLRs.
+     */
+    void transmit(const unsigned char* bits, size_t bitCount, float* llr);
+
+    /*!
+     * \brief Transmit a frame and get its LLRs rounded and saturated to 8 bits.
+     */
+    void transmit(const unsigned char* bits, size_t bitCount, char* llr);
+};
+
+} // namespace Transmission
+} // namespace SignalProcessing
+
+#endif // PCDSP_TRANSMITTER_FUSEDCHANNEL_H
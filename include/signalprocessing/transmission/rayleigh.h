@@ -9,7 +9,7 @@
 #ifndef PCDSP_TRANSMITTER_RAYLEIGH_H
 #define PCDSP_TRANSMITTER_RAYLEIGH_H
 
-#include <signalprocessing/random.h>
+#include <signalprocessing/philox.h>
 #include <signalprocessing/transmission/transmitter.h>
 
 namespace SignalProcessing {
@@ -20,11 +20,10 @@ namespace Transmission {
  */
 class Rayleigh : public Transmitter
 {
-    Random::Generator* mRandGen;
+    Random::Philox* mRandGen;
 
     float mEsNoLog, mEsNoLin, mNoiseMagnitude;
 
-    void transmit_simple();
     void transmit_vectorized();
 
 public:
@@ -36,6 +35,18 @@ public:
     Rayleigh(float EsN0_dB);
     ~Rayleigh();
 
+    /*!
+     * \brief Make the noise reproducible.
+     * \param seed The seed of the noise generator.
+     * \param stream Independent noise sequence of this seed.
+     */
+    void seed(uint64_t seed, uint32_t stream);
+
+    /*!
+     * \brief Restart the noise sequence at the given block of the stream.
+     */
+    void setBlock(uint64_t block);
+
     /*!
      * \brief Set a new SNR given in dB.
      */
@@ -9,11 +9,26 @@
 #ifndef PCDSP_TRANSMITTER_H
 #define PCDSP_TRANSMITTER_H
 
+#include <immintrin.h>
 #include <vector>
 
 namespace SignalProcessing {
 namespace Transmission {
 
+/*!
+ * \brief Select the first _count_ of eight float lanes, all lanes for count >= 8.
+ *
+ * For masked loads and stores of the last partial vectors of a signal. The lanes
+ * are compared as floats, which needs AVX only.
+ */
+inline __m256i laneMask(int count)
+{
+    return _mm256_castps_si256(
+        _mm256_cmp_ps(_mm256_set1_ps(static_cast<float>(count)),
+                      _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f),
+                      _CMP_GT_OQ));
+}
+
 /*!
  * \brief A skeleton class for any kind of transmission models, such as AWGN-
  * channels, Rayleigh-fading channels and the like.
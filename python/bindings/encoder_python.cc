@@ -15,7 +15,6 @@
 
 #include <cstdint>
 
-#include <polarcode/encoding/butterfly_fip_packed.h>
 #include <polarcode/encoding/encoder.h>
 #include <polarcode/errordetection/errordetector.h>
 
@@ -25,8 +24,8 @@ void bind_encoder(py::module& m)
 {
     using namespace PolarCode::Encoding;
     using namespace PolarCode::ErrorDetection;
-    py::class_<ButterflyFipPacked>(m, "PolarEncoder")
-        .def(py::init<size_t, std::vector<unsigned>>(),
+    py::class_<Encoder>(m, "PolarEncoder")
+        .def(py::init(&PolarCode::Encoding::create),
              py::arg("blockLength"),
              py::arg("frozenBitPositions"))
         .def("blockLength", &Encoder::blockLength)
@@ -37,13 +36,13 @@ void bind_encoder(py::module& m)
         .def("getErrorDetectionMode", &Encoder::getErrorDetectionMode)
         .def(
             "setErrorDetection",
-            [](ButterflyFipPacked& self, unsigned size, std::string type) {
+            [](Encoder& self, unsigned size, std::string type) {
                 self.setErrorDetection(PolarCode::ErrorDetection::create(size, type));
             },
             py::arg("size") = 0,
             py::arg("type") = "crc")
         .def("encode_vector",
-             [](ButterflyFipPacked& self,
+             [](Encoder& self,
                 const py::array_t<uint8_t, py::array::c_style | py::array::forcecast>&
                     array) {
                  py::buffer_info inb = array.request();
@@ -80,9 +80,8 @@ void Simulator::configure()
 
 
     {
-        PolarCode::Construction::Bhattacharrya constructor(
-            mJob->N, mJob->K, mJob->designSNR);
-        std::vector<unsigned> frozen = constructor.construct();
+        std::vector<unsigned> frozen =
+            PolarCode::Construction::frozen_bits(mJob->N, mJob->K, mJob->designSNR);
         mJob->frozenSet.resize(blockLength);
         unsigned frozenCounter = 0;
         for (unsigned bit = 0; bit < blockLength; ++bit) {
@@ -177,9 +176,7 @@ void SimulationWorker::run()
 
 void SimulationWorker::selectFrozenBits()
 {
-    mConstructor =
-        new PolarCode::Construction::Bhattacharrya(mJob->N, mJob->K, mJob->designSNR);
-    mFrozenBits = mConstructor->construct();
+    mFrozenBits = PolarCode::Construction::frozen_bits(mJob->N, mJob->K, mJob->designSNR);
 }
 
 void SimulationWorker::setCoders()
@@ -318,7 +315,6 @@ void SimulationWorker::cleanup()
 
     delete mDecoder;
     delete mEncoder;
-    delete mConstructor;
 }
 
 } // namespace SimulationErrorLocator
@@ -16,7 +16,7 @@
 #include <vector>
 
 
-#include <polarcode/construction/bhattacharrya.h>
+#include <polarcode/construction/constructor.h>
 #include <polarcode/decoding/errorlocator.h>
 #include <polarcode/encoding/encoder.h>
 
@@ -109,7 +109,6 @@ class SimulationWorker
 {
     Simulator* mSim;
     DataPoint* mJob;
-    PolarCode::Construction::Bhattacharrya* mConstructor;
     PolarCode::Encoding::Encoder* mEncoder;
     PolarCode::Decoding::ErrorLocator *mDecoder, *mReferenceDecoder;
 
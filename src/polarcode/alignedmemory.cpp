@@ -0,0 +1,40 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <polarcode/alignedmemory.h>
+#include <algorithm>
+#include <atomic>
+#include <mm_malloc.h>
+#include <new>
+
+namespace PolarCode {
+
+namespace {
+
+std::atomic<size_t> allocationCount(0);
+
+} // namespace
+
+void* alignedAlloc(size_t bytes, size_t alignment)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = _mm_malloc(std::max<size_t>(1, bytes), alignment);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void alignedFree(void* ptr) { _mm_free(ptr); }
+
+size_t alignedAllocationCount()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+} // namespace PolarCode
@@ -146,6 +146,122 @@ __m256i subVectorBackShiftBytes_epu8(__m256i x, int shift)
         throw std::invalid_argument("Subvector shift of undefined size.");
     }
 }
+
+#ifdef POLARCODE_AVX512
+unsigned minpos_epu8(__m512i x, char* val)
+{
+    // Fold the vector until eight words hold the candidates for the minimum
+    const __m256i x32 =
+        _mm256_min_epu8(_mm512_castsi512_si256(x), _mm512_extracti64x4_epi64(x, 1));
+    const __m128i x16 =
+        _mm_min_epu8(_mm256_castsi256_si128(x32), _mm256_extracti128_si256(x32, 1));
+    const __m128i x8 = _mm_min_epu8(x16, _mm_srli_si128(x16, 8));
+    const char minimum = _mm_cvtsi128_si32(_mm_minpos_epu16(_mm_cvtepu8_epi16(x8)));
+
+    // The first byte equal to the minimum
+    const __mmask64 positions = _mm512_cmpeq_epi8_mask(x, _mm512_set1_epi8(minimum));
+
+    if (val != nullptr) {
+        *val = minimum;
+    }
+
+    return _tzcnt_u64(positions);
+}
+
+/*
+ * Shifts by 16 and 32 bytes move 128-bit lanes within or across the 256-bit
+ * halves, lanes without a source are zeroed by the mask.
+ */
+__m512i subVectorShift_epu8(__m512i x, int shift)
+{
+    static const __m512i mask[4] = { _mm512_set1_epi8(0b0101010 - 128),
+                                     _mm512_set1_epi8(0b1001100 - 128),
+                                     _mm512_setzero_si512(),
+                                     _mm512_set1_epi8(0b1110000 - 128) };
+    __m512i y;
+    switch (shift) {
+    case 1:
+    case 2:
+    case 4:
+        y = _mm512_slli_epi16(x, shift);
+        return _mm512_and_si512(y, mask[shift - 1]);
+    case 8:
+    case 16:
+    case 32:
+    case 64:
+    case 128:
+    case 256:
+        return subVectorShiftBytes_epu8(x, shift / 8);
+    default:
+        throw std::invalid_argument("Subvector shift of undefined size.");
+    }
+}
+
+__m512i subVectorShiftBytes_epu8(__m512i x, int shift)
+{
+    switch (shift) {
+    case 1:
+        return _mm512_srli_epi16(x, 8);
+    case 2:
+        return _mm512_srli_epi32(x, 16);
+    case 4:
+        return _mm512_srli_epi64(x, 32);
+    case 8:
+        return _mm512_bsrli_epi128(x, 8);
+    case 16:
+        return _mm512_maskz_shuffle_i64x2(0b00110011, x, x, 0b00110001);
+    case 32:
+        return _mm512_maskz_shuffle_i64x2(0b00001111, x, x, 0b00001110);
+    default:
+        throw std::invalid_argument("Subvector shift of undefined size.");
+    }
+}
+
+__m512i subVectorBackShift_epu8(__m512i x, int shift)
+{
+    static const __m512i mask[4] = { _mm512_set1_epi8(0b01010101),
+                                     _mm512_set1_epi8(0b00110011),
+                                     _mm512_setzero_si512(),
+                                     _mm512_set1_epi8(0b00001111) };
+    __m512i y;
+    switch (shift) {
+    case 1:
+    case 2:
+    case 4:
+        y = _mm512_srli_epi16(x, shift);
+        return _mm512_and_si512(y, mask[shift - 1]);
+    case 8:
+    case 16:
+    case 32:
+    case 64:
+    case 128:
+    case 256:
+        return subVectorBackShiftBytes_epu8(x, shift / 8);
+    default:
+        throw std::invalid_argument("Subvector shift of undefined size.");
+    }
+}
+
+__m512i subVectorBackShiftBytes_epu8(__m512i x, int shift)
+{
+    switch (shift) {
+    case 1:
+        return _mm512_slli_epi16(x, 8);
+    case 2:
+        return _mm512_slli_epi32(x, 16);
+    case 4:
+        return _mm512_slli_epi64(x, 32);
+    case 8:
+        return _mm512_bslli_epi128(x, 8);
+    case 16:
+        return _mm512_maskz_shuffle_i64x2(0b11001100, x, x, 0b10000000);
+    case 32:
+        return _mm512_maskz_shuffle_i64x2(0b11110000, x, x, 0b01000000);
+    default:
+        throw std::invalid_argument("Subvector shift of undefined size.");
+    }
+}
+#endif
 #else
 
 unsigned minpos_epu8(__m128i x, char* val)
@@ -465,6 +465,7 @@ void vectorizedFtoC(char* cPtr, const float* fPtr, const unsigned size)
     }
 }
 
+#ifdef __AVX2__
 void convert_f32_to_int8_large(char* cPtr, const float* fPtr, const unsigned size)
 {
     /*
@@ -501,12 +502,17 @@ void convert_f32_to_int8_large(char* cPtr, const float* fPtr, const unsigned siz
         cPtr += 32;
     }
 }
+#endif
 
 void CharContainer::insertLlr(const float* pLlr)
 {
+#ifdef __AVX2__
     if (mElementCount >= 32) {
         convert_f32_to_int8_large(mData, pLlr, mElementCount);
-    } else if (mElementCount >= 8) {
+        return;
+    }
+#endif
+    if (mElementCount >= 8) {
         vectorizedFtoC(mData, pLlr, mElementCount);
     } else {
         for (unsigned int bit = 0; bit < mElementCount; ++bit) {
@@ -523,8 +529,21 @@ void CharContainer::getPackedBits(void* pData)
     unsigned char* uData = reinterpret_cast<unsigned char*>(mData);
     unsigned char* charPtr = static_cast<unsigned char*>(pData);
     unsigned char currentByte;
+    unsigned int byte = 0;
+
+#ifdef POLARCODE_AVX512
+    // Hard decide 64 LLRs into a mask register. Bytes are reversed per group of
+    // eight first, as the first bit of a group becomes the most significant one.
+    const __m512i reverse =
+        _mm512_broadcast_i32x4(_mm_set_epi64x(0x08090A0B0C0D0E0F, 0x0001020304050607));
+    for (; byte + 8 <= nBytes; byte += 8) {
+        const __m512i llr = _mm512_loadu_si512(uData + byte * 8);
+        const uint64_t bits = _mm512_movepi8_mask(_mm512_shuffle_epi8(llr, reverse));
+        memcpy(charPtr + byte, &bits, sizeof(bits));
+    }
+#endif
 
-    for (unsigned int byte = 0; byte < nBytes; ++byte) {
+    for (; byte < nBytes; ++byte) {
         currentByte = 0;
         for (unsigned int bit = 0; bit < 8; ++bit) {
             currentByte |= (uData[byte * 8 + bit] & 0x80) >> bit;
@@ -959,7 +978,8 @@ Problem:
 void PackedContainer::insertCharBits(const void* pData)
 {
     unsigned int nBytes = mElementCount / 8;
-    unsigned char* outPtr = reinterpret_cast<unsigned char*>(mData);
+    unsigned char* outPtr =
+        reinterpret_cast<unsigned char*>(mData) + (mFakeSize - mElementCount) / 8;
     const unsigned char* inPtr = static_cast<const unsigned char*>(pData);
     unsigned char currentByte;
 
@@ -0,0 +1,185 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <polarcode/construction/constructioncache.h>
+#include <polarcode/construction/constructor.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <iomanip>
+#include <sstream>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace PolarCode {
+namespace Construction {
+
+ConstructionCache::ConstructionCache() {}
+
+ConstructionCache::~ConstructionCache() {}
+
+ConstructionCache& ConstructionCache::global()
+{
+    static ConstructionCache cache;
+    return cache;
+}
+
+ConstructionCache::frozen_t ConstructionCache::frozenBits(size_t N,
+                                                          size_t K,
+                                                          float designSnr,
+                                                          const std::string& type)
+{
+    const key_t key(constructorName(type), N, K, designSnr);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mEntries.find(key);
+        if (it != mEntries.end()) {
+            return it->second;
+        }
+    }
+
+    // Construct without holding the lock, a concurrent duplicate is dropped
+    frozen_t frozenBits = std::make_shared<const std::vector<unsigned>>(
+        create(N, K, designSnr, type)->construct());
+
+    std::string fileName;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto inserted = mEntries.emplace(key, frozenBits);
+        if (!inserted.second) {
+            return inserted.first->second;
+        }
+        fileName = mFileName;
+    }
+    if (!fileName.empty()) {
+        append(fileName, key, *frozenBits);
+    }
+    return frozenBits;
+}
+
+namespace {
+
+/*
+ * Parse a cache file line. The frozen bits must be N-K unique indices below N,
+ * otherwise the line is rejected.
+ */
+bool parseLine(const std::string& line,
+               std::string& method,
+               size_t& N,
+               size_t& K,
+               float& designSnr,
+               std::vector<unsigned>& frozenBits)
+{
+    std::istringstream fields(line);
+    if (!(fields >> method >> N >> K >> designSnr) || K > N) {
+        return false;
+    }
+    frozenBits.clear();
+    unsigned bit;
+    while (fields >> bit) {
+        if (bit >= N || frozenBits.size() == N - K) {
+            return false;
+        }
+        frozenBits.push_back(bit);
+    }
+    if (!fields.eof() || frozenBits.size() != N - K) {
+        return false;
+    }
+    std::sort(frozenBits.begin(), frozenBits.end());
+    return std::adjacent_find(frozenBits.begin(), frozenBits.end()) == frozenBits.end();
+}
+
+} // namespace
+
+void ConstructionCache::append(const std::string& fileName,
+                               const key_t& key,
+                               const std::vector<unsigned>& frozenBits)
+{
+    std::ostringstream line;
+    line << std::get<0>(key) << ' ' << std::get<1>(key) << ' ' << std::get<2>(key) << ' '
+         << std::setprecision(9) << std::get<3>(key);
+    for (unsigned bit : frozenBits) {
+        line << ' ' << bit;
+    }
+    line << '\n';
+    const std::string record = line.str();
+
+    // Processes sharing the file append whole lines under an exclusive lock
+    int fd = ::open(fileName.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    if (::flock(fd, LOCK_EX) == 0) {
+        const char* data = record.data();
+        size_t left = record.size();
+        while (left > 0) {
+            ssize_t written = ::write(fd, data, left);
+            if (written <= 0) {
+                break;
+            }
+            data += written;
+            left -= written;
+        }
+        ::flock(fd, LOCK_UN);
+    }
+    ::close(fd);
+}
+
+size_t ConstructionCache::attachFile(const std::string& fileName)
+{
+    // Read under a shared lock, so no half-written line of a concurrent
+    // process is seen
+    std::string content;
+    int fd = ::open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        if (::flock(fd, LOCK_SH) == 0) {
+            char buffer[4096];
+            ssize_t count;
+            while ((count = ::read(fd, buffer, sizeof(buffer))) > 0) {
+                content.append(buffer, count);
+            }
+            ::flock(fd, LOCK_UN);
+        }
+        ::close(fd);
+    }
+
+    std::map<key_t, frozen_t> entries;
+    std::istringstream file(content);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string method;
+        size_t N, K;
+        float designSnr;
+        std::vector<unsigned> frozenBits;
+        if (parseLine(line, method, N, K, designSnr, frozenBits)) {
+            entries[key_t(method, N, K, designSnr)] =
+                std::make_shared<const std::vector<unsigned>>(std::move(frozenBits));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFileName = fileName;
+    for (auto& entry : entries) {
+        mEntries[entry.first] = entry.second;
+    }
+    return entries.size();
+}
+
+void ConstructionCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+}
+
+size_t ConstructionCache::size()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+} // namespace Construction
+} // namespace PolarCode
@@ -8,8 +8,10 @@
 
 #include <polarcode/construction/betaexpansion.h>
 #include <polarcode/construction/bhattacharrya.h>
+#include <polarcode/construction/constructioncache.h>
 #include <polarcode/construction/constructor.h>
 #include <polarcode/construction/fiveGList.h>
+#include <polarcode/construction/gaussianapproximation.h>
 #include <algorithm>
 #include <cmath>
 #include <memory>
@@ -38,28 +40,48 @@ void Constructor::setInformationLength(size_t newInformationLength)
 
 void Constructor::setDesignSnr(float designSnr) { mDesignSnr = designSnr; }
 
-std::vector<unsigned> frozen_bits(const int blockLength,
-                                  const int infoLength,
-                                  const float designSnr,
-                                  const std::string& constructor_type)
+std::string constructorName(const std::string& constructor_type)
 {
     auto ctype(constructor_type);
     std::transform(ctype.begin(), ctype.end(), ctype.begin(), [](unsigned char c) {
         return std::tolower(c);
     });
-    std::unique_ptr<PolarCode::Construction::Constructor> constructor;
     if (ctype.find("be") != std::string::npos) {
-        constructor = std::make_unique<PolarCode::Construction::BetaExpansion>(
-            blockLength, infoLength, designSnr);
+        return "BE";
     } else if (ctype.find("5g") != std::string::npos) {
-        constructor = std::make_unique<PolarCode::Construction::FiveGList>(
-            blockLength, infoLength, designSnr);
+        return "5G";
+    } else if (ctype.find("ga") != std::string::npos) {
+        return "GA";
     } else {
-        constructor = std::make_unique<PolarCode::Construction::Bhattacharrya>(
-            blockLength, infoLength, designSnr);
+        return "BB";
     }
+}
 
-    return constructor->construct();
+std::unique_ptr<Constructor> create(const size_t blockLength,
+                                    const size_t infoLength,
+                                    const float designSnr,
+                                    const std::string& constructor_type)
+{
+    const size_t N = blockLength, K = infoLength;
+    const std::string name = constructorName(constructor_type);
+    if (name == "BE") {
+        return std::make_unique<BetaExpansion>(N, K, designSnr);
+    } else if (name == "5G") {
+        return std::make_unique<FiveGList>(N, K, designSnr);
+    } else if (name == "GA") {
+        return std::make_unique<GaussianApproximation>(N, K, designSnr);
+    } else {
+        return std::make_unique<Bhattacharrya>(N, K, designSnr);
+    }
+}
+
+std::vector<unsigned> frozen_bits(const int blockLength,
+                                  const int infoLength,
+                                  const float designSnr,
+                                  const std::string& constructor_type)
+{
+    return *ConstructionCache::global().frozenBits(
+        blockLength, infoLength, designSnr, constructor_type);
 }
 
 } // namespace Construction
@@ -35,9 +35,18 @@ std::vector<unsigned> FiveGList::construct()
         throw std::invalid_argument(error_msg);
     }
 
+    // The sequence is nested, shorter codes use its indices below N in order.
     const unsigned frozen_bit_length = mBlockLength - mInformationLength;
-    std::vector<unsigned> frozenBits(RELIABILITY_TABLE.begin(),
-                                     RELIABILITY_TABLE.begin() + frozen_bit_length);
+    std::vector<unsigned> frozenBits;
+    frozenBits.reserve(frozen_bit_length);
+    for (unsigned index : RELIABILITY_TABLE) {
+        if (frozenBits.size() == frozen_bit_length) {
+            break;
+        }
+        if (index < mBlockLength) {
+            frozenBits.push_back(index);
+        }
+    }
     std::sort(frozenBits.begin(), frozenBits.end());
     return frozenBits;
 }
@@ -0,0 +1,161 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <fmt/core.h>
+#include <polarcode/construction/gaussianapproximation.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace PolarCode {
+namespace Construction {
+
+namespace {
+
+double inverseQuadraticExponential(double y, double a, double b, double r)
+{
+    return (b - std::sqrt(4.0 * a * std::log(y / r) + b * b)) / (2.0 * a);
+}
+
+/*!
+ * \brief Four-segment approximation of phi(t) by Dai et al.
+ */
+double phi(double t)
+{
+    if (t <= 0.1910) {
+        return std::exp(0.1047 * t * t - 0.4992 * t);
+    } else if (t <= 0.7420) {
+        return 0.9981 * std::exp(0.05315 * t * t - 0.4795 * t);
+    } else if (t <= 9.2254) {
+        return std::exp(-0.4527 * std::pow(t, 0.86) + 0.0218);
+    } else {
+        return std::exp(-0.2832 * t - 0.4254);
+    }
+}
+
+/*!
+ * \brief Inverse of phi(), segment bounds are phi() at the bounds above.
+ */
+double phiInverse(double y)
+{
+    if (y >= 1.0) {
+        return 0.0;
+    } else if (y > 0.9125360939445893) {
+        return inverseQuadraticExponential(y, 0.1047, 0.4992, 1.0);
+    } else if (y > 0.7200545321883631) {
+        return inverseQuadraticExponential(y, 0.05315, 0.4795, 0.9981);
+    } else if (y > 0.047929057387273905) {
+        return std::pow((0.0218 - std::log(y)) / 0.4527, 1.0 / 0.86);
+    } else {
+        return -(std::log(y) + 0.4254) / 0.2832;
+    }
+}
+
+/*!
+ * \brief Mean LLRs of the check-node channels of a stage, in place.
+ */
+void checkNodeMeans(double* mean, size_t count)
+{
+    const double shortcut = 11.673;
+    for (size_t i = 0; i < count; ++i) {
+        if (mean[i] <= shortcut) {
+            const double p = 1.0 - phi(mean[i]);
+            mean[i] = phiInverse(1.0 - p * p);
+        } else {
+            mean[i] -= 2.4476;
+        }
+    }
+}
+
+} // namespace
+
+GaussianApproximation::GaussianApproximation() {}
+
+GaussianApproximation::GaussianApproximation(size_t N, size_t K)
+{
+    setBlockLength(N);
+    setInformationLength(K);
+}
+
+GaussianApproximation::GaussianApproximation(size_t N, size_t K, float designSnr)
+{
+    setBlockLength(N);
+    setInformationLength(K);
+    setDesignSnr(designSnr);
+}
+
+GaussianApproximation::~GaussianApproximation() {}
+
+std::vector<unsigned> GaussianApproximation::construct()
+{
+    if (mBlockLength < mInformationLength) {
+        std::string error_msg =
+            fmt::format("Invalid polar code({}, {})", mBlockLength, mInformationLength);
+        throw std::invalid_argument(error_msg);
+    }
+
+    auto order = reliabilityOrder(mBlockLength, mDesignSnr);
+    std::vector<unsigned> frozenBits(order->begin(),
+                                     order->begin() + mBlockLength - mInformationLength);
+    std::sort(frozenBits.begin(), frozenBits.end());
+    return frozenBits;
+}
+
+std::vector<double> GaussianApproximation::meanLlrs(size_t N, float designSnr)
+{
+    std::vector<double> mean(N, 2.0 * std::pow(10.0, designSnr / 10.0));
+    std::vector<double> stageMean(N / 2);
+
+    // Gather the check-node inputs of a stage into one contiguous array
+    for (size_t B = N / 2; B > 0; B /= 2) {
+        const size_t count = N / (2 * B);
+        for (size_t i = 0; i < count; ++i) {
+            stageMean[i] = mean[i * 2 * B];
+        }
+        checkNodeMeans(stageMean.data(), count);
+        for (size_t i = 0; i < count; ++i) {
+            mean[i * 2 * B + B] = 2.0 * mean[i * 2 * B];
+            mean[i * 2 * B] = stageMean[i];
+        }
+    }
+    return mean;
+}
+
+std::shared_ptr<const std::vector<unsigned>>
+GaussianApproximation::reliabilityOrder(size_t N, float designSnr)
+{
+    typedef std::shared_ptr<const std::vector<unsigned>> order_t;
+    static std::mutex cacheMutex;
+    static std::map<std::pair<size_t, float>, order_t> cache;
+
+    const auto key = std::make_pair(N, designSnr);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            return it->second;
+        }
+    }
+
+    const std::vector<double> mean = meanLlrs(N, designSnr);
+    auto order = std::make_shared<std::vector<unsigned>>(N);
+    std::iota(order->begin(), order->end(), 0);
+    std::stable_sort(order->begin(), order->end(), [&mean](unsigned a, unsigned b) {
+        return mean[a] < mean[b];
+    });
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return cache.emplace(key, std::move(order)).first->second;
+}
+
+} // namespace Construction
+} // namespace PolarCode
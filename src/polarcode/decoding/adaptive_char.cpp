@@ -62,6 +62,19 @@ void AdaptiveChar::setSignal(const float* pLlr)
     mListDecoder->setSignal(pLlr);
 }
 
+NodeProfile AdaptiveChar::nodeProfile() const
+{
+    NodeProfile profile = mFastDecoder->nodeProfile();
+    profile.merge(mListDecoder->nodeProfile());
+    return profile;
+}
+
+void AdaptiveChar::resetNodeProfile()
+{
+    mFastDecoder->resetNodeProfile();
+    mListDecoder->resetNodeProfile();
+}
+
 
 } // namespace Decoding
 } // namespace PolarCode
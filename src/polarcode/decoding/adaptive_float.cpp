@@ -62,6 +62,19 @@ void AdaptiveFloat::setSignal(const float* pLlr)
     mListDecoder->setSignal(pLlr);
 }
 
+NodeProfile AdaptiveFloat::nodeProfile() const
+{
+    NodeProfile profile = mFastDecoder->nodeProfile();
+    profile.merge(mListDecoder->nodeProfile());
+    return profile;
+}
+
+void AdaptiveFloat::resetNodeProfile()
+{
+    mFastDecoder->resetNodeProfile();
+    mListDecoder->resetNodeProfile();
+}
+
 
 } // namespace Decoding
 } // namespace PolarCode
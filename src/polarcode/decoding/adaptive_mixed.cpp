@@ -62,6 +62,19 @@ void AdaptiveMixed::setSignal(const float* pLlr)
     mListDecoder->setSignal(pLlr);
 }
 
+NodeProfile AdaptiveMixed::nodeProfile() const
+{
+    NodeProfile profile = mFastDecoder->nodeProfile();
+    profile.merge(mListDecoder->nodeProfile());
+    return profile;
+}
+
+void AdaptiveMixed::resetNodeProfile()
+{
+    mFastDecoder->resetNodeProfile();
+    mListDecoder->resetNodeProfile();
+}
+
 
 } // namespace Decoding
 } // namespace PolarCode
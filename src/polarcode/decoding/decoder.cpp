@@ -10,11 +10,15 @@
 #include <polarcode/decoding/decoder.h>
 #include <polarcode/decoding/fastssc_avx_float.h>
 #include <polarcode/decoding/fastssc_fip_char.h>
+#include <polarcode/decoding/fastssc_flat.h>
+#include <polarcode/decoding/fastssc_interframe.h>
+#include <polarcode/decoding/fixed_fip_char.h>
 #include <polarcode/decoding/scan.h>
 #include <polarcode/decoding/scl_avx_float.h>
 #include <polarcode/decoding/scl_fip_char.h>
 #include <polarcode/errordetection/crc8.h>
 #include <polarcode/errordetection/dummy.h>
+#include <polarcode/isadispatch.h>
 #include <algorithm>
 #include <chrono>
 #include <cstring>
@@ -28,6 +32,10 @@ Decoder* create(size_t blockLength,
                 const std::vector<unsigned>& frozenBits,
                 std::string decoderType)
 {
+    if (const Dispatch::KernelTable* kernels = Dispatch::moduleKernels()) {
+        return kernels->createDecoder(blockLength, listSize, frozenBits, decoderType);
+    }
+
     std::transform(decoderType.begin(),
                    decoderType.end(),
                    decoderType.begin(),
@@ -41,6 +49,11 @@ Decoder* create(size_t blockLength,
         decoderFlag = 2;
     } else if (decoderType.find("scan") != std::string::npos) {
         decoderFlag = 3;
+    } else if (decoderType.find("flat") != std::string::npos) {
+        if (listSize > 1) {
+            throw std::logic_error("Flat Fast-SSC decoding requires list size 1!");
+        }
+        return makeDecoder(blockLength, listSize, frozenBits, 8);
     } else {
         throw std::logic_error("Unknown PolarDecoder type!");
     }
@@ -48,6 +61,13 @@ Decoder* create(size_t blockLength,
     if (listSize < 2 && decoderFlag != 0) {
         decoderFlag = 1;
     }
+
+    if (decoderType.find("interframe") != std::string::npos) {
+        if (listSize > 1) {
+            throw std::logic_error("Inter-frame decoding requires list size 1!");
+        }
+        decoderFlag += 4;
+    }
     return makeDecoder(blockLength, listSize, frozenBits, decoderFlag);
 }
 
@@ -57,11 +77,31 @@ Decoder* makeDecoder(size_t blockLength,
                      int decoder_impl)
 {
     Decoder* dec;
-    if (listSize == 1) {
+    int scheme = -1;
+    if (listSize == 1 && (decoder_impl == 0 || decoder_impl == 1)) {
+        // Prefer the decoders generated for the code catalogue
+        scheme = findCodingScheme(blockLength, frozenBits);
+    }
+    if (scheme >= 0) {
+        if (decoder_impl == 1) {
+            dec = FixedDecoding::createFixedFloatDecoder(scheme);
+        } else {
+            dec = new FixedChar(scheme);
+        }
+    } else if (listSize == 1) {
         switch (decoder_impl) {
         case 1:
             dec = new FastSscAvxFloat(blockLength, frozenBits);
             break;
+        case 4:
+            dec = new FastSscInterFrameChar(blockLength, frozenBits);
+            break;
+        case 5:
+            dec = new FastSscInterFrameFloat(blockLength, frozenBits);
+            break;
+        case 8:
+            dec = new FastSscFlatFloat(blockLength, frozenBits);
+            break;
         default:
             dec = new FastSscFipChar(blockLength, frozenBits);
             break;
@@ -87,7 +127,8 @@ Decoder* makeDecoder(size_t blockLength,
 }
 
 Decoder::Decoder()
-    : mErrorDetector(&ErrorDetection::globalDummyDetector),
+    : mDecoderDuration(0),
+      mErrorDetector(&ErrorDetection::globalDummyDetector),
       mBlockLength(0),
       mSystematic(true),
       mLlrContainer(nullptr),
@@ -135,6 +176,10 @@ void Decoder::setErrorDetection(ErrorDetection::Detector* pDetector)
     mErrorDetector = pDetector;
 }
 
+NodeProfile Decoder::nodeProfile() const { return mNodeProfile; }
+
+void Decoder::resetNodeProfile() { mNodeProfile.clear(); }
+
 void Decoder::setSignal(const float* pLlr) { mLlrContainer->insertLlr(pLlr); }
 
 void Decoder::setSignal(const char* pLlr) { mLlrContainer->insertLlr(pLlr); }
@@ -153,16 +198,15 @@ void Decoder::getSoftInformation(void* pData)
 
 bool Decoder::decode_vector(const float* pLlr, void* pData)
 {
-    //	std::cout << "float decoder CPP\n";
-    // std::chrono::high_resolution_clock::time_point start =
-    //     std::chrono::high_resolution_clock::now();
+    std::chrono::high_resolution_clock::time_point start =
+        std::chrono::high_resolution_clock::now();
     setSignal(pLlr);
     bool res = decode();
     getDecodedInformationBits(pData);
-    // std::chrono::high_resolution_clock::time_point end =
-    //     std::chrono::high_resolution_clock::now();
-    // mDecoderDuration =
-    //     std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    std::chrono::high_resolution_clock::time_point end =
+        std::chrono::high_resolution_clock::now();
+    mDecoderDuration =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
     return res;
 }
 
@@ -180,6 +224,40 @@ bool Decoder::decode_vector(const char* pLlr, void* pData)
     return res;
 }
 
+size_t Decoder::decode_batch(const float* pLlr, size_t nFrames, void* pData, bool* pOk)
+{
+    const size_t infoBytes = (infoLength() + 7) / 8;
+    unsigned char* data = static_cast<unsigned char*>(pData);
+    size_t passed = 0;
+    for (size_t frame = 0; frame < nFrames; ++frame) {
+        setSignal(pLlr + frame * mBlockLength);
+        bool res = decode();
+        getDecodedInformationBits(data + frame * infoBytes);
+        if (pOk) {
+            pOk[frame] = res;
+        }
+        passed += res;
+    }
+    return passed;
+}
+
+size_t Decoder::decode_batch(const char* pLlr, size_t nFrames, void* pData, bool* pOk)
+{
+    const size_t infoBytes = (infoLength() + 7) / 8;
+    unsigned char* data = static_cast<unsigned char*>(pData);
+    size_t passed = 0;
+    for (size_t frame = 0; frame < nFrames; ++frame) {
+        setSignal(pLlr + frame * mBlockLength);
+        bool res = decode();
+        getDecodedInformationBits(data + frame * infoBytes);
+        if (pOk) {
+            pOk[frame] = res;
+        }
+        passed += res;
+    }
+    return passed;
+}
+
 UndefinedDecoder::UndefinedDecoder() {}
 
 UndefinedDecoder::~UndefinedDecoder() {}
@@ -7,13 +7,15 @@
  */
 
 #include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
 #include <polarcode/avxconvenience.h>
-#include <polarcode/construction/bhattacharrya.h>
+#include <polarcode/construction/constructor.h>
 
 using namespace std;
 
@@ -24,89 +26,50 @@ struct CodingScheme {
     float designSnr;
 };
 
-vector<CodingScheme> createRegistry()
+/*!
+ * \brief Bytes per vector of the library build the decoders are generated for,
+ *        which may differ from the generator's own build.
+ */
+unsigned vectorBytes = BYTESPERVECTOR;
+
+/*!
+ * \brief Read the code catalogue.
+ *
+ * Every line holds one code: block length, information length, design-SNR
+ * and construction method (see PolarCode::Construction::create()).
+ * Empty lines and lines starting with '#' are ignored.
+ */
+vector<CodingScheme> createRegistry(const char* catalogueFile)
 {
     vector<CodingScheme> reg;
-    float dSnr = -0.25;
-    CodingScheme scheme = { 16384, 8192, {}, true, dSnr };
-
-    PolarCode::Construction::Bhattacharrya* constructor =
-        new PolarCode::Construction::Bhattacharrya();
-
-    reg.clear();
-
-    constructor->setBlockLength(scheme.blockLength);
-    constructor->setInformationLength(scheme.infoLength);
-    constructor->setParameterByDesignSNR(scheme.designSnr);
-
-
-    /*	//-1.59 dB
-            dSnr = -1.59;
-            constructor->setParameterByDesignSNR(dSnr);
-            scheme.frozenBits = constructor->construct();
-            scheme.designSnr = dSnr;
-            reg.push_back(scheme);
-
-            //0.0 dB
-            dSnr = 0.0;
-            constructor->setParameterByDesignSNR(dSnr);
-            scheme.frozenBits = constructor->construct();
-            scheme.designSnr = dSnr;
-            reg.push_back(scheme);
-
-            //1.0 dB
-            dSnr = 1.0;
-            constructor->setParameterByDesignSNR(dSnr);
-            scheme.frozenBits = constructor->construct();
-            scheme.designSnr = dSnr;
-            reg.push_back(scheme);*/
-
-
-    /*	//Rate 1/8
-            scheme.infoLength = scheme.blockLength / 8;
-            constructor->setBlockLength(scheme.blockLength);
-            constructor->setInformationLength(scheme.infoLength);
-            scheme.frozenBits = constructor->construct();
-            reg.push_back(scheme);
-
-            //Rate 1/4
-            scheme.infoLength = scheme.blockLength / 4;
-            constructor->setBlockLength(scheme.blockLength);
-            constructor->setInformationLength(scheme.infoLength);
-            scheme.frozenBits = constructor->construct();
-            reg.push_back(scheme);
-
-            //Rate 1/2
-            scheme.infoLength = scheme.blockLength / 2;
-            constructor->setBlockLength(scheme.blockLength);
-            constructor->setInformationLength(scheme.infoLength);
-            scheme.frozenBits = constructor->construct();
-            reg.push_back(scheme);
-    */
-
-    // N=1024, K=512
-    scheme.blockLength = 1024;
-    scheme.infoLength = scheme.blockLength / 2;
-    constructor->setBlockLength(scheme.blockLength);
-    constructor->setInformationLength(scheme.infoLength);
-    scheme.frozenBits = constructor->construct();
-    reg.push_back(scheme);
-
-    /*	//N=4096, K=2048
-            scheme.blockLength = 4096;
-            scheme.infoLength = scheme.blockLength / 2;
-            constructor->setBlockLength(scheme.blockLength);
-            constructor->setInformationLength(scheme.infoLength);
-            scheme.frozenBits = constructor->construct();
-            reg.push_back(scheme);*/
-
-    /*	//N=32768, K=8192
-            scheme.blockLength = 32768;
-            scheme.infoLength = scheme.blockLength / 2;
-            constructor->setBlockLength(scheme.blockLength);
-            constructor->setInformationLength(scheme.infoLength);
-            scheme.frozenBits = constructor->construct();
-            reg.push_back(scheme);*/
+    ifstream catalogue(catalogueFile);
+    if (!catalogue.is_open()) {
+        cout << "Catalogue " << catalogueFile << " can't be opened." << endl;
+        exit(3);
+    }
+
+    string line;
+    while (getline(catalogue, line)) {
+        istringstream fields(line);
+        CodingScheme scheme = { 0, 0, {}, true, 0.0 };
+        string type;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (!(fields >> scheme.blockLength >> scheme.infoLength >> scheme.designSnr >>
+              type) ||
+            scheme.blockLength < 2 * vectorBytes ||
+            (scheme.blockLength & (scheme.blockLength - 1)) ||
+            scheme.infoLength > scheme.blockLength) {
+            cout << "Invalid catalogue entry: " << line << endl;
+            exit(3);
+        }
+        scheme.frozenBits =
+            PolarCode::Construction::create(
+                scheme.blockLength, scheme.infoLength, scheme.designSnr, type)
+                ->construct();
+        reg.push_back(scheme);
+    }
     return reg;
 }
 
@@ -144,7 +107,7 @@ string writeDecoder(unsigned length,
     unsigned frozenLength = frozenBits.size();
     unsigned stage = log2(length);
     unsigned rightBitAddress =
-        bitAddress + ((length / 2 + (BYTESPERVECTOR - 1)) / BYTESPERVECTOR);
+        bitAddress + ((length / 2 + (vectorBytes - 1)) / vectorBytes);
     string sstage = to_string(stage);
 
     string inputLlr, lowerLlr;
@@ -165,14 +128,14 @@ string writeDecoder(unsigned length,
         outputBits = "vBitPtr";
         break;
     case DECLEFT:
-        if (length < BYTESPERVECTOR) {
+        if (length < vectorBytes) {
             outputBits = "&mBitL[" + sstage + "]";
         } else {
             outputBits = "vBitPtr+" + to_string(bitAddress);
         }
         break;
     case DECRIGHT:
-        if (length < BYTESPERVECTOR) {
+        if (length < vectorBytes) {
             outputBits = "&mBitR[" + sstage + "]";
         } else {
             outputBits = "vBitPtr+" + to_string(bitAddress);
@@ -182,7 +145,7 @@ string writeDecoder(unsigned length,
         exit(1);
     }
 
-    if (length <= BYTESPERVECTOR) {
+    if (length <= vectorBytes) {
         leftBits = "&mBitL[" + to_string(stage - 1) + "]";
         rightBits = "&mBitR[" + to_string(stage - 1) + "]";
     } else {
@@ -229,7 +192,7 @@ string writeDecoder(unsigned length,
     }
 
     // Left Rate 0, Right: Rate 1
-    if (length <= BYTESPERVECTOR) {
+    if (length <= vectorBytes) {
         if (leftFrozen.size() == length / 2 && rightFrozen.size() == 0) {
             ret = "	ZeroOneDecodeShort<" + sLength + ">(" + inputLlr + ", " +
                   outputBits + ");\n";
@@ -242,7 +205,7 @@ string writeDecoder(unsigned length,
         ret += "	G_function_0R<" + sHalfLength + ">(" + inputLlr + ", " +
                lowerLlr + ");\n";
         ret += writeDecoder(length / 2, rightFrozen, rightBitAddress, DECRIGHT);
-        if (length <= BYTESPERVECTOR) {
+        if (length <= vectorBytes) {
             ret += "	Combine_0RShort<" + sHalfLength + ">(" + outputBits + ", " +
                    rightBits + ");\n";
         } else {
@@ -255,7 +218,7 @@ string writeDecoder(unsigned length,
     if (rightFrozen.size() == 0) {
         ret = "	F_function<" + sHalfLength + ">(" + inputLlr + ", " + lowerLlr + ");\n";
         ret += writeDecoder(length / 2, leftFrozen, bitAddress, DECLEFT);
-        if (length <= BYTESPERVECTOR) {
+        if (length <= vectorBytes) {
             ret += "	simplifiedRightRateOneDecodeShort<" + sHalfLength + ">(" +
                    inputLlr + ", " + leftBits + ", " + outputBits + ");\n";
         } else {
@@ -272,7 +235,7 @@ string writeDecoder(unsigned length,
     ret += "	G_function<" + sHalfLength + ">(" + inputLlr + ", " + lowerLlr + ", " +
            leftBits + ");\n";
     ret += writeDecoder(length / 2, rightFrozen, rightBitAddress, DECRIGHT);
-    if (length <= 32) {
+    if (length <= vectorBytes) {
         ret += "	CombineBits<" + sHalfLength + ">(" + leftBits + ", " + rightBits +
                ", " + outputBits + ");\n";
     } else {
@@ -284,8 +247,18 @@ string writeDecoder(unsigned length,
 int main(int argc, char** argv)
 {
     cout << "This is the factory for fixed decoder creation." << endl;
-    if (argc != 2)
+    if (argc != 3 && argc != 4) {
+        cout << "Usage: " << argv[0] << " <output.cpp> <catalogue> [<vector bytes>]"
+             << endl;
         return 1;
+    }
+    if (argc == 4) {
+        vectorBytes = atoi(argv[3]);
+        if (vectorBytes != 16 && vectorBytes != 32 && vectorBytes != 64) {
+            cout << "Unsupported vector size: " << argv[3] << endl;
+            return 1;
+        }
+    }
 
     ofstream file(argv[1]);
     if (!file.is_open()) {
@@ -293,20 +266,24 @@ int main(int argc, char** argv)
         return 2;
     }
 
-    std::vector<CodingScheme> registry = createRegistry();
+    std::vector<CodingScheme> registry = createRegistry(argv[2]);
 
     // Write header
 
     file << R"TREWQ(#include <polarcode/decoding/fip_templates.txx>
 #include <immintrin.h>
 #include <polarcode/decoding/fixed_fip_char.h>
+#include <polarcode/decoding/templatized_float.h>
 #include <array>
 
 namespace PolarCode {
 namespace Decoding {
 
-std::vector<CodingScheme> codeRegistry = {
 )TREWQ";
+    file << "static_assert(BYTESPERVECTOR == " << vectorBytes
+         << ", \"Decoders were generated for another vector size\");" << endl
+         << endl
+         << "std::vector<CodingScheme> codeRegistry = {" << endl;
 
 
     // Define the code registry
@@ -332,15 +309,10 @@ std::vector<CodingScheme> codeRegistry = {
 
     for (unsigned i = 0; i < registry.size(); ++i) {
         file << "class Fix_" << i << " : public FixedDecoder {" << endl
-#ifdef __AVX2__
-             << "	std::array<__m256i, 5> mBitL, mBitR;" << endl
-             << "	std::array<__m256i*, " << (log2(registry[i].blockLength) - 1)
-             << "> mLlr;" << endl
-#else
-             << "	std::array<__m128i, 4> mBitL, mBitR;" << endl
-             << "	std::array<__m128i*, " << (log2(registry[i].blockLength) - 1)
-             << "> mLlr;" << endl
-#endif
+             << "	std::array<fipv, " << log2(vectorBytes) << "> mBitL, mBitR;"
+             << endl
+             << "	std::array<fipv*, " << log2(registry[i].blockLength) << "> mLlr;"
+             << endl
              << endl
              << "public:" << endl
              << "	Fix_" << i << "();" << endl
@@ -358,13 +330,9 @@ std::vector<CodingScheme> codeRegistry = {
         file << "Fix_" << i << "::Fix_" << i << "() {" << endl
              << "	for(unsigned i = 0; i < " << (log2(registry[i].blockLength))
              << "; ++i) {" << endl
-#ifdef __AVX2__
-             << "		mLlr[i] = (__m256i*)_mm_malloc(std::max(1 << i, 32), 32);"
-             << endl
-#else
-             << "		mLlr[i] = (__m128i*)_mm_malloc(std::max(1 << i, 16), 16);"
+             << "		mLlr[i] = (fipv*)_mm_malloc(std::max(1 << i, BYTESPERVECTOR), "
+                "BYTESPERVECTOR);"
              << endl
-#endif
              << "	}" << endl
              << "}" << endl
              << endl;
@@ -382,13 +350,8 @@ std::vector<CodingScheme> codeRegistry = {
         string func =
             writeDecoder(registry[i].blockLength, registry[i].frozenBits, 0, DECTOP);
         file << "void Fix_" << i << "::decode(void* LlrIn, void* BitsOut) {" << endl
-#ifdef __AVX2__
-             << "	__m256i *vLlrPtr = (__m256i*)LlrIn;" << endl
-             << "	__m256i *vBitPtr = (__m256i*)BitsOut;" << endl
-#else
-             << "	__m128i *vLlrPtr = (__m128i*)LlrIn;" << endl
-             << "	__m128i *vBitPtr = (__m128i*)BitsOut;" << endl
-#endif
+             << "	fipv *vLlrPtr = (fipv*)LlrIn;" << endl
+             << "	fipv *vBitPtr = (fipv*)BitsOut;" << endl
              << endl
              << func << endl
              << "}" << endl
@@ -405,6 +368,36 @@ std::vector<CodingScheme> codeRegistry = {
         file << "		case " << i << ": return new Fix_" << i << "();\n";
     }
 
+    file << "		default: return nullptr;" << endl
+         << "	}" << endl
+         << "}" << endl
+         << endl;
+
+
+    // Float decoders are unrolled by the compiler from the frozen bit flags
+
+    for (unsigned i = 0; i < registry.size(); ++i) {
+        vector<int> flags(registry[i].blockLength, 0);
+        for (unsigned bit : registry[i].frozenBits) {
+            flags[bit] = 1;
+        }
+        file << "constexpr std::array<int, " << registry[i].blockLength << "> Flags_" << i
+             << " = {";
+        for (unsigned j = 0; j < flags.size(); ++j) {
+            file << flags[j] << (j + 1 < flags.size() ? "," : "");
+        }
+        file << "};" << endl << endl;
+    }
+
+    file << "Decoder* createFixedFloatDecoder(unsigned int scheme) {\n\tswitch(scheme) "
+            "{\n";
+
+    for (unsigned i = 0; i < registry.size(); ++i) {
+        file << "		case " << i << ": return new TemplatizedFloat<"
+             << registry[i].blockLength << ", Flags_" << i << ">(codeRegistry[" << i
+             << "].frozenBits);\n";
+    }
+
     file << "		default: return nullptr;" << endl
          << "	}" << endl
          << "}" << endl
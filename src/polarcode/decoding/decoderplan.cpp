@@ -0,0 +1,196 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <polarcode/alignedmemory.h>
+#include <polarcode/avxconvenience.h>
+#include <polarcode/decoding/decoderplan.h>
+#include <polarcode/polarcode.h>
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace PolarCode {
+namespace Decoding {
+
+namespace {
+
+typedef std::tuple<Dispatch::IsaLevel, std::string, size_t, std::vector<unsigned>>
+    plankey_t;
+typedef std::pair<plankey_t, std::shared_ptr<const DecoderPlan>> planentry_t;
+
+/*
+ * Plans in order of use, most recent first, and an index into that list.
+ */
+struct PlanCache {
+    std::mutex mutex;
+    size_t limit = 64;
+    std::list<planentry_t> plans;
+    std::map<plankey_t, std::list<planentry_t>::iterator> index;
+
+    void trim()
+    {
+        while (plans.size() > limit) {
+            index.erase(plans.back().first);
+            plans.pop_back();
+        }
+    }
+};
+
+PlanCache& planCache()
+{
+    static PlanCache cache;
+    return cache;
+}
+
+size_t alignUp(size_t bytes, size_t alignment)
+{
+    return (bytes + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+DecoderPlan::DecoderPlan(size_t blockLength,
+                         const std::vector<unsigned>& frozenBits,
+                         classifier_t classify,
+                         layout_t layout)
+    : mObjectBytes(0), mScratchBytes(0)
+{
+    mRoot = build(frozenBits, blockLength, classify, layout);
+}
+
+const DecoderPlan::Node* DecoderPlan::build(const std::vector<unsigned>& frozenBits,
+                                            size_t blockLength,
+                                            classifier_t classify,
+                                            layout_t layout)
+{
+    std::pair<unsigned, bool> selection = classify(frozenBits, blockLength);
+    NodeSize size = layout ? layout(selection.first, blockLength) : NodeSize{ 0, 0 };
+
+    // Nodes are laid out in construction order, parents before their children
+    Node node = { selection.first, unsigned(blockLength), nullptr, nullptr };
+    node.objectOffset = mObjectBytes;
+    node.objectBytes = size.objectBytes;
+    node.scratchOffset = mScratchBytes;
+    node.scratchBytes = size.scratchBytes;
+    mObjectBytes += alignUp(size.objectBytes, OBJECT_ALIGNMENT);
+    mScratchBytes += alignUp(size.scratchBytes, SCRATCH_ALIGNMENT);
+
+    mNodes.push_back(node);
+    Node* stored = &mNodes.back();
+
+    if (selection.second) {
+        std::vector<unsigned> leftFrozenBits, rightFrozenBits;
+        splitFrozenBits(frozenBits, blockLength / 2, leftFrozenBits, rightFrozenBits);
+        stored->left = build(leftFrozenBits, blockLength / 2, classify, layout);
+        stored->right = build(rightFrozenBits, blockLength / 2, classify, layout);
+    }
+    return stored;
+}
+
+const DecoderPlan::Node* DecoderPlan::root() const { return mRoot; }
+
+size_t DecoderPlan::nodeCount() const { return mNodes.size(); }
+
+size_t DecoderPlan::objectBytes() const { return mObjectBytes; }
+
+size_t DecoderPlan::scratchBytes() const { return mScratchBytes; }
+
+std::shared_ptr<const DecoderPlan>
+DecoderPlan::get(Dispatch::IsaLevel isa,
+                 const std::string& decoderType,
+                 size_t blockLength,
+                 const std::vector<unsigned>& frozenBits,
+                 classifier_t classify,
+                 layout_t layout)
+{
+    PlanCache& cache = planCache();
+    plankey_t key(isa, decoderType, blockLength, frozenBits);
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = cache.index.find(key);
+        if (it != cache.index.end()) {
+            cache.plans.splice(cache.plans.begin(), cache.plans, it->second);
+            return it->second->second;
+        }
+    }
+
+    // Build without holding the lock, a concurrent duplicate is dropped
+    auto plan =
+        std::make_shared<const DecoderPlan>(blockLength, frozenBits, classify, layout);
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.index.find(key);
+    if (it != cache.index.end()) {
+        return it->second->second;
+    }
+    cache.plans.emplace_front(key, plan);
+    cache.index.emplace(std::move(key), cache.plans.begin());
+    cache.trim();
+    return plan;
+}
+
+void DecoderPlan::clearCache()
+{
+    PlanCache& cache = planCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.index.clear();
+    cache.plans.clear();
+}
+
+size_t DecoderPlan::cacheSize()
+{
+    PlanCache& cache = planCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.plans.size();
+}
+
+void DecoderPlan::setCacheLimit(size_t limit)
+{
+    PlanCache& cache = planCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.limit = limit;
+    cache.trim();
+}
+
+size_t DecoderPlan::cacheLimit()
+{
+    PlanCache& cache = planCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.limit;
+}
+
+
+NodeMemory::NodeMemory(std::shared_ptr<const DecoderPlan> plan)
+    : mPlan(std::move(plan)), mObjects(nullptr), mScratch(nullptr)
+{
+    mObjects = static_cast<char*>(
+        alignedAlloc(mPlan->objectBytes(), DecoderPlan::OBJECT_ALIGNMENT));
+    try {
+        mScratch = static_cast<char*>(
+            alignedAlloc(mPlan->scratchBytes(), DecoderPlan::SCRATCH_ALIGNMENT));
+    } catch (...) {
+        alignedFree(mObjects);
+        throw;
+    }
+    memset(mScratch, 0, mPlan->scratchBytes());
+}
+
+NodeMemory::~NodeMemory()
+{
+    alignedFree(mObjects);
+    alignedFree(mScratch);
+}
+
+const DecoderPlan& NodeMemory::plan() const { return *mPlan; }
+
+} // namespace Decoding
+} // namespace PolarCode
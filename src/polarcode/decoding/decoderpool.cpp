@@ -0,0 +1,273 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <polarcode/decoding/decoderpool.h>
+
+#include <algorithm>
+
+namespace PolarCode {
+namespace Decoding {
+
+DecoderPool::DecoderPool(size_t blockLength,
+                         size_t listSize,
+                         const std::vector<unsigned>& frozenBits,
+                         const std::string& decoderType,
+                         size_t nWorkers)
+    : mNextWorker(0), mPending(0), mQueued(0), mSleeping(0), mStop(false)
+{
+    start([&]() { return create(blockLength, listSize, frozenBits, decoderType); },
+          nWorkers);
+}
+
+DecoderPool::DecoderPool(const std::function<Decoder*()>& factory, size_t nWorkers)
+    : mNextWorker(0), mPending(0), mQueued(0), mSleeping(0), mStop(false)
+{
+    start(factory, nWorkers);
+}
+
+DecoderPool::~DecoderPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mStop = true;
+    }
+    mWakeUp.notify_all();
+    for (auto& worker : mWorkers) {
+        worker->thread.join();
+    }
+}
+
+void DecoderPool::start(const std::function<Decoder*()>& factory, size_t nWorkers)
+{
+    if (nWorkers == 0) {
+        nWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // All decoders exist before the first thread starts, so a throwing
+    // factory leaves no threads behind.
+    for (size_t i = 0; i < nWorkers; ++i) {
+        mWorkers.emplace_back(new Worker());
+        mWorkers.back()->decoder.reset(factory());
+    }
+    mBlockLength = mWorkers.front()->decoder->blockLength();
+    mInfoLength = mWorkers.front()->decoder->infoLength();
+    mGroupSize = mWorkers.front()->decoder->frameGroupSize();
+
+    for (size_t i = 0; i < nWorkers; ++i) {
+        mWorkers[i]->thread = std::thread(&DecoderPool::run, this, i);
+    }
+}
+
+void DecoderPool::push(task_t task)
+{
+    // Counters go first: a worker which sees the task also sees the count.
+    ++mPending;
+    ++mQueued;
+
+    Worker& worker = *mWorkers[mNextWorker++ % mWorkers.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+
+    // A worker registers as sleeping before it checks mQueued, so either it
+    // sees the new task or we see it and wait until it blocks in wait().
+    if (mSleeping > 0) {
+        { std::lock_guard<std::mutex> lock(mSleepMutex); }
+        mWakeUp.notify_one();
+    }
+}
+
+bool DecoderPool::pop(size_t self, task_t& task)
+{
+    const size_t nWorkers = mWorkers.size();
+
+    // Own queue from the front, other queues from the back
+    for (size_t i = 0; i < nWorkers; ++i) {
+        Worker& worker = *mWorkers[(self + i) % nWorkers];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+        } else {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
+
+void DecoderPool::run(size_t self)
+{
+    Decoder* decoder = mWorkers[self]->decoder.get();
+    task_t task;
+
+    for (;;) {
+        if (pop(self, task)) {
+            --mQueued;
+            task(decoder);
+            task = nullptr;
+
+            if (--mPending == 0) {
+                { std::lock_guard<std::mutex> lock(mSleepMutex); }
+                mIdle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        ++mSleeping;
+        mWakeUp.wait(lock, [this]() { return mStop || mQueued > 0; });
+        --mSleeping;
+        if (mStop && mQueued == 0) {
+            return;
+        }
+    }
+}
+
+void DecoderPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mSleepMutex);
+    mIdle.wait(lock, [this]() { return mPending == 0; });
+    if (mError) {
+        std::exception_ptr error = mError;
+        mError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void DecoderPool::fail(std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock(mSleepMutex);
+    if (!mError) {
+        mError = error;
+    }
+}
+
+size_t DecoderPool::workerCount() { return mWorkers.size(); }
+
+size_t DecoderPool::blockLength() { return mBlockLength; }
+
+size_t DecoderPool::infoLength() { return mInfoLength; }
+
+template <typename T>
+std::future<DecoderPool::Result> DecoderPool::submitFrame(const T* pLlr)
+{
+    auto llr = std::make_shared<std::vector<T>>(pLlr, pLlr + mBlockLength);
+    auto promise = std::make_shared<std::promise<Result>>();
+    const size_t infoBytes = (mInfoLength + 7) / 8;
+
+    push([llr, promise, infoBytes](Decoder* decoder) {
+        try {
+            Result result;
+            result.data.resize(infoBytes);
+            result.ok = decoder->decode_vector(llr->data(), result.data.data());
+            promise->set_value(std::move(result));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return promise->get_future();
+}
+
+template <typename T>
+void DecoderPool::submitFrame(const T* pLlr, callback_t callback)
+{
+    auto llr = std::make_shared<std::vector<T>>(pLlr, pLlr + mBlockLength);
+    const size_t infoBytes = (mInfoLength + 7) / 8;
+
+    push([this, llr, callback, infoBytes](Decoder* decoder) {
+        try {
+            std::vector<unsigned char> data(infoBytes);
+            bool ok = decoder->decode_vector(llr->data(), data.data());
+            callback(data.data(), ok);
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    });
+}
+
+template <typename T>
+size_t DecoderPool::decodeChunks(const T* pLlr, size_t nFrames, void* pData, bool* pOk)
+{
+    // A few chunks per worker for balancing, each a whole number of
+    // inter-frame groups.
+    const size_t groupSize = mGroupSize;
+    size_t chunkSize = (nFrames + 4 * mWorkers.size() - 1) / (4 * mWorkers.size());
+    chunkSize = std::max(groupSize, (chunkSize + groupSize - 1) / groupSize * groupSize);
+
+    const size_t infoBytes = (mInfoLength + 7) / 8;
+    unsigned char* out = static_cast<unsigned char*>(pData);
+    std::vector<std::future<size_t>> chunks;
+
+    for (size_t first = 0; first < nFrames; first += chunkSize) {
+        const size_t count = std::min(chunkSize, nFrames - first);
+        const T* llr = pLlr + first * mBlockLength;
+        unsigned char* data = out + first * infoBytes;
+        bool* ok = pOk ? pOk + first : nullptr;
+
+        auto promise = std::make_shared<std::promise<size_t>>();
+        chunks.push_back(promise->get_future());
+        push([=](Decoder* decoder) {
+            try {
+                promise->set_value(decoder->decode_batch(llr, count, data, ok));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+    }
+
+    size_t passed = 0;
+    for (auto& chunk : chunks) {
+        passed += chunk.get();
+    }
+    return passed;
+}
+
+std::future<DecoderPool::Result> DecoderPool::submit(const float* pLlr)
+{
+    return submitFrame(pLlr);
+}
+
+std::future<DecoderPool::Result> DecoderPool::submit(const char* pLlr)
+{
+    return submitFrame(pLlr);
+}
+
+void DecoderPool::submit(const float* pLlr, callback_t callback)
+{
+    submitFrame(pLlr, callback);
+}
+
+void DecoderPool::submit(const char* pLlr, callback_t callback)
+{
+    submitFrame(pLlr, callback);
+}
+
+size_t DecoderPool::decode_batch(const float* pLlr,
+                                 size_t nFrames,
+                                 void* pData,
+                                 bool* pOk)
+{
+    return decodeChunks(pLlr, nFrames, pData, pOk);
+}
+
+size_t DecoderPool::decode_batch(const char* pLlr,
+                                 size_t nFrames,
+                                 void* pData,
+                                 bool* pOk)
+{
+    return decodeChunks(pLlr, nFrames, pData, pOk);
+}
+
+} // namespace Decoding
+} // namespace PolarCode
@@ -10,28 +10,134 @@
 #include <polarcode/encoding/butterfly_fip_packed.h>
 #include <polarcode/polarcode.h>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
 #include <list>
+#include <mutex>
+#include <thread>
 
 namespace PolarCode {
 namespace Decoding {
 
 namespace DepthFirstObjects {
 
-Manager::Manager(int trialLimit) : mTrialLimit(trialLimit) { mNodeList.clear(); }
+Manager::Manager(int trialLimit)
+    : mTrialLimit(trialLimit),
+      mQueueFront(0),
+      mBestConfig(0),
+      mBestMetric(0.0f),
+      mStale(true)
+{
+    mNodeList.clear();
+}
 
 Manager::~Manager() {}
 
 void Manager::pushDecoder(Node* node) { mNodeList.push_back(node); }
 
+unsigned Manager::decisionCount() { return mNodeList.size(); }
+
 void Manager::setRootNode(Node* node) { xmRootNode = node; }
 
+unsigned Manager::queueSize() { return mConfigPool.size() - mQueueFront; }
+
+void Manager::applyConfiguration(const std::vector<Configuration>& pool, unsigned index)
+{
+    const unsigned nodeCount = mNodeList.size();
+    unsigned first = nodeCount;
+
+    for (unsigned i = index; i != Configuration::NO_PARENT; i = pool[i].parent) {
+        mNextOptions[pool[i].decision] = pool[i].option;
+    }
+
+    // Find the first decision node to be changed
+    for (unsigned decision : mAppliedFlips) {
+        if (mNextOptions[decision] != mAppliedOptions[decision]) {
+            first = std::min(first, decision);
+        }
+        mAppliedOptions[decision] = 0;
+    }
+    mAppliedFlips.clear();
+    for (unsigned i = index; i != Configuration::NO_PARENT; i = pool[i].parent) {
+        if (pool[i].option != mAppliedOptions[pool[i].decision]) {
+            first = std::min(first, pool[i].decision);
+        }
+    }
+    if (mStale) {
+        first = 0;
+        mStale = false;
+    }
+
+    // Configure the nodes to be decoded again and remember the new options
+    for (unsigned i = index; i != Configuration::NO_PARENT; i = pool[i].parent) {
+        const Configuration& config = pool[i];
+        mNextOptions[config.decision] = 0;
+        if (config.option != 0) {
+            mAppliedOptions[config.decision] = config.option;
+            mAppliedFlips.push_back(config.decision);
+            if (config.decision >= first) {
+                mNodeList[config.decision]->setOption(config.option);
+            }
+        }
+    }
+
+    if (first < nodeCount) {
+        xmRootNode->decodeFrom(first);
+    }
+}
+
+void Manager::summarize(const std::vector<Configuration>& pool,
+                        unsigned index,
+                        TrialSummary* summary)
+{
+    for (unsigned i = index; i != Configuration::NO_PARENT; i = pool[i].parent) {
+        mFixed[pool[i].decision] = 1;
+    }
+
+    // Collect the path's total reliability and find the weakest node, excluding
+    // the configured ones to prevent double configuring of already considered
+    // nodes
+    Node* weakestNode = nullptr;
+    summary->metric = 0.0f;
+    summary->weakest = 0;
+    summary->optionCount = 0;
+    for (unsigned decision = 0; decision < mNodeList.size(); ++decision) {
+        Node* node = mNodeList[decision];
+        float reliability = node->reliability();
+        summary->metric += reliability;
+        if (!mFixed[decision] &&
+            (weakestNode == nullptr || reliability < weakestNode->reliability())) {
+            weakestNode = node;
+            summary->weakest = decision;
+            summary->optionCount = node->optionCount();
+        }
+    }
+
+    for (unsigned i = index; i != Configuration::NO_PARENT; i = pool[i].parent) {
+        mFixed[pool[i].decision] = 0;
+    }
+}
+
+void Manager::invalidate()
+{
+    const unsigned nodeCount = mNodeList.size();
+    mAppliedOptions.assign(nodeCount, 0);
+    mAppliedFlips.clear();
+    mNextOptions.assign(nodeCount, 0);
+    mFixed.assign(nodeCount, 0);
+    mStale = true;
+}
+
 void Manager::decode()
 {
+    invalidate();
     xmRootNode->decode();
+    mStale = false;
 
-    // mConfigList.clear();
-    while (!mConfigList.empty())
-        mConfigList.pop();
+    mConfigPool.clear();
+    mQueueFront = 0;
 
     // Create initial configurations, including the base that has just been decoded
     std::vector<DecoderHint> hintList;
@@ -50,117 +156,78 @@ void Manager::decode()
 
     // Sort all nodes
     std::sort(hintList.begin(), hintList.end(), myCompareHints);
-    firstRun = true;
 
     // Create configurations
-    int nodeRank = 0;
+    unsigned nodeRank = 0;
     do {
-        int optionCount = hintList[nodeRank].node->optionCount();
-        Configuration conf;
-        conf.depth = 0;
-        conf.parentMetric = metric;
-        conf.nodeList = hintList;
-        if (nodeRank != 0) {
-            std::rotate(conf.nodeList.begin(),
-                        conf.nodeList.begin() + nodeRank,
-                        conf.nodeList.begin() + nodeRank + 1);
-        }
-
-        for (int i = (nodeRank == 0 ? 0 : 1); i < optionCount; ++i) {
-            conf.nodeOptions.clear();
-            conf.nodeOptions.push_back(i); // Set option for weakest node
-
-            mConfigList.push(conf);
+        Node* node = hintList[nodeRank].node;
+        for (int i = (nodeRank == 0 ? 0 : 1); i < node->optionCount(); ++i) {
+            // Set option for the node of this rank
+            mConfigPool.push_back(
+                { Configuration::NO_PARENT, node->firstDecision(), i, 0, metric });
         }
         nodeRank++;
-    } while (
-        (nodeRank < mTrialLimit * 2 / 3 || hintList[nodeRank].reliability < log(9)) &&
-        mConfigList.size() < (unsigned)mTrialLimit);
+    } while (nodeRank < hintList.size() &&
+             ((int)nodeRank < mTrialLimit * 2 / 3 ||
+              hintList[nodeRank].reliability < log(9)) &&
+             queueSize() < (unsigned)mTrialLimit);
 
+    // The first configuration changes nothing, it is what has just been decoded
     mBestMetric = metric;
-    mBestConfig = mConfigList.front();
+    mBestConfig = mQueueFront;
 }
 
 
-void Manager::decodeNext()
+void Manager::summarizeFront(TrialSummary* summary)
 {
-    Configuration currentConfig = mConfigList.front();
-    mConfigList.pop();
-    int depth = currentConfig.depth;
-    float metric = 0.0f;
-
-    if (mConfigList.size() < (unsigned)mTrialLimit) {
-        std::vector<DecoderHint> hintList;
-
-        if (!firstRun) {
-            // Collect a new list of reliabilities
-            hintList.clear();
-            for (auto hint : currentConfig.nodeList) {
-                metric += hint.node->reliability();
-                hintList.push_back({ hint.node, hint.node->reliability() });
-            }
-            // Sort all nodes, excluding the current configuration
-            // to prevent double configuring of already considered nodes
-            auto myCompareHints = [](const DecoderHint a, const DecoderHint b) -> bool {
-                return a.reliability < b.reliability;
-            };
-            std::sort(hintList.begin() + depth + 1, hintList.end(), myCompareHints);
-        } else {
-            hintList = currentConfig.nodeList;
-            metric = currentConfig.parentMetric;
-            firstRun = false;
-        }
+    summarize(mConfigPool, mQueueFront, summary);
+}
 
-        // Create new configurations based on changing the most unreliable node
-        DecoderHint& weakestNode = hintList.at(depth + 1);
-        int optionCount = weakestNode.node->optionCount();
-
-        for (int i = 0; i < optionCount; ++i) {
-            Configuration conf;
-            conf.depth = depth + 1;
-            conf.parentMetric = metric;
-            conf.nodeList = hintList;
-            conf.nodeOptions = currentConfig.nodeOptions;
-            conf.nodeOptions.push_back(i);
-            mConfigList.push(conf);
-        }
-    } else {
-        if (!firstRun) {
-            for (auto hint : currentConfig.nodeList) {
-                metric += hint.node->reliability();
-            }
-        } else {
-            metric = currentConfig.parentMetric;
-            firstRun = false;
+void Manager::retireFront(const TrialSummary& summary)
+{
+    unsigned current = mQueueFront++;
+
+    // Create new configurations based on changing the most unreliable node
+    if (queueSize() < (unsigned)mTrialLimit) {
+        for (int i = 0; i < summary.optionCount; ++i) {
+            mConfigPool.push_back({ current,
+                                    summary.weakest,
+                                    i,
+                                    mConfigPool[current].depth + 1,
+                                    summary.metric });
         }
     }
 
     // Save current config, if it is better than previous ones
-    if (metric > mBestMetric) {
-        mBestConfig = currentConfig;
-        mBestMetric = metric;
+    if (summary.metric > mBestMetric) {
+        mBestConfig = current;
+        mBestMetric = summary.metric;
     }
+}
 
-    // Configure every node according to the next configuration
-    const Configuration& newConfig = mConfigList.front();
-    depth = newConfig.depth;
-    for (int i = 0; i <= depth; ++i) {
-        newConfig.nodeList[i].node->setOption(newConfig.nodeOptions[i]);
+void Manager::decodeNext()
+{
+    if (queueSize() == 0) {
+        return;
     }
 
-    // Decode
-    xmRootNode->decode();
-}
+    // The tree holds the decoding result of the front configuration
+    TrialSummary summary;
+    summarizeFront(&summary);
+    retireFront(summary);
 
-void Manager::decodeBestConfig()
-{
-    int depth = mBestConfig.depth;
-    for (int i = 0; i <= depth; ++i) {
-        mBestConfig.nodeList[i].node->setOption(mBestConfig.nodeOptions[i]);
+    if (queueSize() > 0) {
+        applyConfiguration(mConfigPool, mQueueFront);
     }
+}
 
-    // Decode
-    xmRootNode->decode();
+void Manager::decodeBestConfig() { applyConfiguration(mConfigPool, mBestConfig); }
+
+void Manager::decodeQueued(const Manager& search, unsigned offset, TrialSummary* summary)
+{
+    const unsigned index = search.mQueueFront + offset;
+    applyConfiguration(search.mConfigPool, index);
+    summarize(search.mConfigPool, index, summary);
 }
 
 
@@ -174,7 +241,9 @@ Node::Node()
       mOutput(nullptr),
       mReliability(INFINITY),
       mOptionCount(0),
-      mOption(0)
+      mOption(0),
+      mFirstDecision(0),
+      mDecisionEnd(0)
 {
 }
 
@@ -188,7 +257,9 @@ Node::Node(unsigned blockLength, datapool_t* pool, Manager* manager)
       mOutput(mBit->data),
       mReliability(INFINITY),
       mOptionCount(0),
-      mOption(0)
+      mOption(0),
+      mFirstDecision(0),
+      mDecisionEnd(0)
 {
 }
 
@@ -202,7 +273,9 @@ Node::Node(Node* other)
       mOutput(other->mOutput),
       mReliability(INFINITY),
       mOptionCount(0),
-      mOption(0)
+      mOption(0),
+      mFirstDecision(xmManager->decisionCount()),
+      mDecisionEnd(mFirstDecision)
 {
 }
 
@@ -227,6 +300,12 @@ void Node::decode()
     // Should never be called
 }
 
+void Node::decodeFrom(unsigned) { decode(); }
+
+unsigned Node::firstDecision() { return mFirstDecision; }
+
+unsigned Node::decisionEnd() { return mDecisionEnd; }
+
 float Node::reliability() { return mReliability; }
 
 int Node::optionCount() { return mOptionCount; }
@@ -257,6 +336,8 @@ RateRNode::RateRNode(const std::vector<unsigned>& frozenBits, Node* parent) : No
     mRight = createDecoder(rightFrozenBits, this);
     mRight->setInput(mRightLlr->data);
     mRight->setOutput(mOutput + mBlockLength);
+
+    mDecisionEnd = xmManager->decisionCount();
 }
 
 RateRNode::~RateRNode()
@@ -283,6 +364,26 @@ void RateRNode::decode()
     FastSscAvx::Combine(mOutput, mBlockLength);
 }
 
+void RateRNode::decodeFrom(unsigned decision)
+{
+    if (decision <= mFirstDecision) {
+        decode();
+        return;
+    }
+
+    // Combining is its own inverse, so this restores the left child's bits,
+    // which both children resume from
+    FastSscAvx::Combine(mOutput, mBlockLength);
+    if (decision < mLeft->decisionEnd()) {
+        mLeft->decodeFrom(decision);
+        FastSscAvx::G_function(mInput, mRightLlr->data, mOutput, mBlockLength);
+        mRight->decode();
+    } else {
+        mRight->decodeFrom(decision);
+    }
+    FastSscAvx::Combine(mOutput, mBlockLength);
+}
+
 /*************
  * ShortRateRNode
  * ***********/
@@ -314,6 +415,23 @@ void ShortRateRNode::decode()
         mLeftBits->data, mRightBits->data, mOutput, mBlockLength);
 }
 
+void ShortRateRNode::decodeFrom(unsigned decision)
+{
+    if (decision <= mFirstDecision) {
+        decode();
+        return;
+    }
+    if (decision < mLeft->decisionEnd()) {
+        mLeft->decodeFrom(decision);
+        FastSscAvx::G_function(mInput, mRightLlr->data, mLeftBits->data, mBlockLength);
+        mRight->decode();
+    } else {
+        mRight->decodeFrom(decision);
+    }
+    FastSscAvx::CombineBitsShort(
+        mLeftBits->data, mRightBits->data, mOutput, mBlockLength);
+}
+
 /*************
  * RateZeroDecoder
  * ***********/
@@ -331,6 +449,7 @@ void RateZeroDecoder::decode() { memFloatFill(mOutput, INFINITY, mBlockLength);
 RateOneDecoder::RateOneDecoder(Node* parent) : Node(parent)
 {
     xmManager->pushDecoder(this);
+    mDecisionEnd = mFirstDecision + 1;
     mOptionCount = /*mBlockLength == 1 ?*/ 2 /*: 4*/;
     mFlipIndices = new unsigned[mBlockLength];
     mTempBlock = xmDataPool->allocate(mBlockLength);
@@ -401,6 +520,7 @@ void RateOneDecoder::decode()
 RepetitionDecoder::RepetitionDecoder(Node* parent) : Node(parent)
 {
     xmManager->pushDecoder(this);
+    mDecisionEnd = mFirstDecision + 1;
     mOptionCount = 2;
 }
 
@@ -450,6 +570,7 @@ void RepetitionDecoder::decode()
 SpcDecoder::SpcDecoder(Node* parent) : Node(parent)
 {
     xmManager->pushDecoder(this);
+    mDecisionEnd = mFirstDecision + 1;
     mOptionCount = 2;
     mFlipIndices = new unsigned[mBlockLength];
     mTempBlock = xmDataPool->allocate(mBlockLength);
@@ -551,11 +672,169 @@ Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent)
     }
 }
 
+/*************
+ * Lane
+ * ***********/
+
+/*!
+ * \brief A tree of its own, trying configurations of the main tree's search.
+ */
+struct Lane {
+    datapool_t pool;
+    Manager manager;
+    Node base;
+    Node* root;
+    FloatContainer bits;
+    Encoding::ButterflyFipPacked encoder;
+    std::vector<unsigned char> output; ///< Information bits of the last trial
+    TrialSummary summary;              ///< Summary of the last trial
+    bool fresh; ///< The signal has to be fetched for a new frame
+
+    Lane(size_t blockLength, size_t trialLimit, const std::vector<unsigned>& frozenBits)
+        : manager(trialLimit),
+          base(blockLength, &pool, &manager),
+          root(createDecoder(frozenBits, &base)),
+          bits(base.output(), blockLength),
+          encoder(blockLength, frozenBits),
+          output((blockLength - frozenBits.size() + 7) / 8 + 8),
+          fresh(true)
+    {
+        manager.setRootNode(root);
+        bits.setFrozenBits(frozenBits);
+        encoder.setSystematic(false);
+    }
+
+    ~Lane() { delete root; }
+
+    void decode(const Manager& search, unsigned offset, Node* mainBase, bool systematic)
+    {
+        if (fresh) {
+            memcpy(base.input(), mainBase->input(), base.blockLength() * sizeof(float));
+            manager.invalidate();
+            fresh = false;
+        }
+        manager.decodeQueued(search, offset, &summary);
+        if (!systematic) {
+            encoder.setFloatCodeword(bits.data());
+            encoder.encode();
+            encoder.getInformation(output.data());
+        } else {
+            bits.getPackedInformationBits(output.data());
+        }
+    }
+};
+
+/*************
+ * TrialTeam
+ * ***********/
+
+/*!
+ * \brief Threads running a task for lanes 1 and up, while the calling thread
+ *        runs it for lane 0.
+ *
+ * A trial takes only microseconds, less than waking a sleeping thread. So
+ * idle threads spin for a while before they block. They yield now and then,
+ * in case there are more threads than cores.
+ */
+class TrialTeam
+{
+    static const unsigned SPIN_LIMIT = 1 << 16; ///< Pause instructions before sleeping
+    static const unsigned YIELD_INTERVAL = 256;
+
+    std::function<void(unsigned)> mTask;
+    std::vector<std::thread> mThreads;
+
+    /*!
+     * \brief Round counter in the upper, number of busy lanes in the lower half.
+     */
+    std::atomic<uint64_t> mRound;
+    std::atomic<unsigned> mPending; ///< Busy lanes of other threads
+    std::atomic<bool> mStop;
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+
+    void work(unsigned lane)
+    {
+        uint64_t seen = 0;
+        for (;;) {
+            uint64_t round;
+            unsigned spins = 0;
+            while ((round = mRound.load(std::memory_order_acquire)) == seen) {
+                if (++spins < SPIN_LIMIT) {
+                    pause(spins);
+                } else {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    mWakeUp.wait(lock, [&] { return mRound.load() != seen; });
+                }
+            }
+            seen = round;
+            if (mStop.load(std::memory_order_relaxed)) {
+                return;
+            }
+            if (lane < (round & 0xFFFFFFFF)) {
+                mTask(lane);
+                mPending.fetch_sub(1, std::memory_order_release);
+            }
+        }
+    }
+
+    static void pause(unsigned spins)
+    {
+        _mm_pause();
+        if (spins % YIELD_INTERVAL == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    void startRound(unsigned laneCount)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            uint64_t round = (mRound.load(std::memory_order_relaxed) >> 32) + 1;
+            mRound.store(round << 32 | laneCount, std::memory_order_release);
+        }
+        mWakeUp.notify_all();
+    }
+
+public:
+    TrialTeam(unsigned laneCount, const std::function<void(unsigned)>& task)
+        : mTask(task), mRound(0), mPending(0), mStop(false)
+    {
+        for (unsigned lane = 1; lane < laneCount; ++lane) {
+            mThreads.emplace_back(&TrialTeam::work, this, lane);
+        }
+    }
+
+    ~TrialTeam()
+    {
+        mStop.store(true, std::memory_order_relaxed);
+        startRound(0);
+        for (auto& thread : mThreads) {
+            thread.join();
+        }
+    }
+
+    /*!
+     * \brief Run the task for lanes 0 to _laneCount_ - 1 and wait for all of them.
+     */
+    void run(unsigned laneCount)
+    {
+        mPending.store(laneCount - 1, std::memory_order_relaxed);
+        startRound(laneCount);
+        mTask(0);
+        for (unsigned spins = 1; mPending.load(std::memory_order_acquire) != 0; ++spins) {
+            pause(spins);
+        }
+    }
+};
+
 } // namespace DepthFirstObjects
 
 DepthFirst::DepthFirst(size_t blockLength,
                        size_t trialLimit,
-                       const std::vector<unsigned>& frozenBits)
+                       const std::vector<unsigned>& frozenBits,
+                       size_t trialThreads)
+    : mTrialThreads(trialThreads), mTeam(nullptr)
 {
     mTrialLimit = trialLimit;
     initialize(blockLength, frozenBits);
@@ -565,6 +844,12 @@ DepthFirst::~DepthFirst() { clear(); }
 
 void DepthFirst::clear()
 {
+    delete mTeam;
+    mTeam = nullptr;
+    for (DepthFirstObjects::Lane* lane : mLanes) {
+        delete lane;
+    }
+    mLanes.clear();
     delete mEncoder;
     delete mRootNode;
     delete mNodeBase;
@@ -594,6 +879,16 @@ void DepthFirst::initialize(size_t blockLength, const std::vector<unsigned>& fro
     mOutputContainer = new unsigned char[(mBlockLength - frozenBits.size() + 7) / 8];
 
     mManager->setRootNode(mRootNode);
+
+    if (mTrialThreads > 1 && mTrialLimit > 1) {
+        for (size_t i = 0; i < mTrialThreads; ++i) {
+            mLanes.push_back(
+                new DepthFirstObjects::Lane(mBlockLength, mTrialLimit, mFrozenBits));
+        }
+        mTeam = new DepthFirstObjects::TrialTeam(mLanes.size(), [this](unsigned lane) {
+            mLanes[lane]->decode(*mManager, lane, mNodeBase, mSystematic);
+        });
+    }
 }
 
 bool DepthFirst::decode()
@@ -617,6 +912,9 @@ bool DepthFirst::decode()
                                         (mBlockLength - mFrozenBits.size() + 7) / 8);
 
         if (!success && run < mTrialLimit) {
+            if (mTeam != nullptr) {
+                return decodeParallel();
+            }
             ++run;
             mManager->decodeNext();
         } else {
@@ -637,6 +935,46 @@ bool DepthFirst::decode()
     return success;
 }
 
+bool DepthFirst::decodeParallel()
+{
+    using namespace DepthFirstObjects;
+    const size_t infoBytes = (mBlockLength - mFrozenBits.size() + 7) / 8;
+
+    // The main tree holds the first trial, which failed
+    TrialSummary summary;
+    mManager->summarizeFront(&summary);
+    mManager->retireFront(summary);
+
+    for (Lane* lane : mLanes) {
+        lane->fresh = true;
+    }
+
+    Lane* last = nullptr;
+    bool success = false;
+    unsigned trial = 1;
+    while (!success && trial < mTrialLimit && mManager->queueSize() > 0) {
+        const unsigned laneCount = std::min(
+            { (unsigned)mLanes.size(), mTrialLimit - trial, mManager->queueSize() });
+        mTeam->run(laneCount);
+        trial += laneCount;
+
+        // Evaluate in queue order, for the same outcome as sequential trials
+        for (unsigned i = 0; i < laneCount && !success; ++i) {
+            last = mLanes[i];
+            success = mErrorDetector->check(last->output.data(), infoBytes);
+            if (!success) {
+                mManager->retireFront(last->summary);
+            }
+        }
+    }
+
+    if (last != nullptr) {
+        memcpy(mOutputContainer, last->output.data(), infoBytes);
+        memcpy(mNodeBase->output(), last->base.output(), mBlockLength * sizeof(float));
+    }
+    return success;
+}
+
 
 } // namespace Decoding
 } // namespace PolarCode
@@ -6,10 +6,12 @@
  *
  */
 
+#include <polarcode/alignedmemory.h>
 #include <polarcode/decoding/fastssc_avx_float.h>
 #include <polarcode/encoding/butterfly_fip_packed.h>
 #include <polarcode/polarcode.h>
 
+#include <algorithm>
 #include <iostream>
 #include <numeric>
 #include <string>
@@ -39,40 +41,44 @@ inline void memFloatFill(float* dst, float value, const size_t blockLength)
     }
 }
 
-Node::Node()
-    : mBlockLength(0),
-      xmDataPool(nullptr),
-      mLlr(nullptr),
-      mBit(nullptr),
-      mInput(nullptr),
-      mOutput(nullptr)
+/*
+ * Floats of a buffer for _length_ LLRs or bits. Short nodes process a whole
+ * AVX vector, so buffers never hold less than eight values.
+ */
+inline size_t bufferLength(size_t length) { return std::max<size_t>(8, length); }
+
+inline float* allocateBuffer(size_t length)
 {
+    const size_t bytes = bufferLength(length) * sizeof(float);
+    float* buffer = static_cast<float*>(alignedAlloc(bytes, 32));
+    memset(buffer, 0, bytes);
+    return buffer;
 }
 
 Node::Node(Node* other)
     : mBlockLength(other->mBlockLength),
-      xmDataPool(other->xmDataPool),
-      mLlr(xmDataPool->allocate(mBlockLength)),
-      mBit(xmDataPool->allocate(mBlockLength)),
+      xmMemory(other->xmMemory),
+      mLlr(nullptr),
+      mBit(nullptr),
       mInput(other->mInput),
       mOutput(other->mOutput)
 {
 }
 
-Node::Node(size_t blockLength, datapool_t* pool)
+Node::Node(size_t blockLength, NodeMemory* memory)
     : mBlockLength(blockLength),
-      xmDataPool(pool),
-      mLlr(pool->allocate(blockLength)),
-      mBit(pool->allocate(blockLength)),
-      mInput(mLlr->data),
-      mOutput(mBit->data)
+      xmMemory(memory),
+      mLlr(allocateBuffer(blockLength)),
+      mBit(allocateBuffer(blockLength)),
+      mInput(mLlr),
+      mOutput(mBit)
 {
 }
 
 Node::~Node()
 {
-    xmDataPool->release(mLlr);
-    xmDataPool->release(mBit);
+    alignedFree(mLlr);
+    alignedFree(mBit);
 }
 
 void Node::decode() {}
@@ -83,7 +89,7 @@ void Node::setOutput(float* output) { mOutput = output; }
 
 unsigned Node::blockLength() { return mBlockLength; }
 
-datapool_t* Node::pool() { return xmDataPool; }
+NodeMemory* Node::memory() { return xmMemory; }
 
 float* Node::input() { return mInput; }
 
@@ -94,102 +100,111 @@ float* Node::output() { return mOutput; }
  * RateRNode
  * ***********/
 
-RateRNode::RateRNode(const std::vector<unsigned>& frozenBits,
+RateRNode::RateRNode(const DecoderPlan::Node* plan,
                      Node* parent,
                      ChildCreationFlags flags)
     : Node(parent)
 {
     mBlockLength /= 2;
 
-    std::vector<unsigned> leftFrozenBits, rightFrozenBits;
-    splitFrozenBits(frozenBits, mBlockLength, leftFrozenBits, rightFrozenBits);
+    mLeftLlr = xmMemory->scratch<float>(plan, 2 * bufferLength(mBlockLength));
+    mRightLlr = mLeftLlr + bufferLength(mBlockLength);
 
-    if (flags & NO_LEFT) {
-        mLeft = new Node();
-    } else {
-        // fmt::print("ctor: left  RateR( {} / {})\n", mBlockLength,
-        // leftFrozenBits.size());
-        mLeft = createDecoder(leftFrozenBits, this);
-    }
+    mLeft = (flags & NO_LEFT) ? nullptr : createDecoder(plan->left, this);
+    mRight = (flags & NO_RIGHT) ? nullptr : createDecoder(plan->right, this);
 
-    if (flags & NO_RIGHT) {
-        mRight = new Node();
-    } else {
-        // fmt::print("ctor: right RateR( {} / {})\n", mBlockLength,
-        // rightFrozenBits.size());
-        mRight = createDecoder(rightFrozenBits, this);
+    if (mLeft != nullptr) {
+        mLeft->setInput(mLeftLlr);
     }
-
-    mLeftLlr = xmDataPool->allocate(mBlockLength);
-    mRightLlr = xmDataPool->allocate(mBlockLength);
-
-    mLeft->setInput(mLeftLlr->data);
-    mRight->setInput(mRightLlr->data);
-
-    mLeft->setOutput(mOutput);
-    mRight->setOutput(mOutput + mBlockLength);
+    if (mRight != nullptr) {
+        mRight->setInput(mRightLlr);
+    }
+    RateRNode::setOutput(mOutput);
 }
 
 RateRNode::~RateRNode()
 {
-    delete mLeft;
-    delete mRight;
-    xmDataPool->release(mLeftLlr);
-    xmDataPool->release(mRightLlr);
+    // Children live in the decoder's NodeMemory, which frees them as a whole
+    if (mLeft != nullptr) {
+        mLeft->~Node();
+    }
+    if (mRight != nullptr) {
+        mRight->~Node();
+    }
 }
 
 void RateRNode::setOutput(float* output)
 {
     mOutput = output;
-    mLeft->setOutput(mOutput);
-    mRight->setOutput(mOutput + mBlockLength);
+    if (mLeft != nullptr) {
+        mLeft->setOutput(mOutput);
+    }
+    if (mRight != nullptr) {
+        mRight->setOutput(mOutput + mBlockLength);
+    }
 }
 
 void RateRNode::decode()
 {
-    F_function(mInput, mLeftLlr->data, mBlockLength);
+    {
+        PC_PROFILE_NODE("FastSscAvx::RateRNode F", mBlockLength);
+        F_function(mInput, mLeftLlr, mBlockLength);
+    }
     mLeft->decode();
-    G_function(mInput, mRightLlr->data, mOutput, mBlockLength);
+    {
+        PC_PROFILE_NODE("FastSscAvx::RateRNode G", mBlockLength);
+        G_function(mInput, mRightLlr, mOutput, mBlockLength);
+    }
     mRight->decode();
-    Combine(mOutput, mBlockLength);
+    {
+        PC_PROFILE_NODE("FastSscAvx::RateRNode Combine", mBlockLength);
+        Combine(mOutput, mBlockLength);
+    }
 }
 
 /*************
  * ShortRateRNode
  * ***********/
 
-ShortRateRNode::ShortRateRNode(const std::vector<unsigned>& frozenBits, Node* parent)
-    : RateRNode(frozenBits, parent),
-      mLeftBits(xmDataPool->allocate(8)),
-      mRightBits(xmDataPool->allocate(8))
+ShortRateRNode::ShortRateRNode(const DecoderPlan::Node* plan, Node* parent)
+    : RateRNode(plan, parent)
 {
-    mLeft->setOutput(mLeftBits->data);
-    mRight->setOutput(mRightBits->data);
+    // The child bits follow the child LLRs of RateRNode
+    const size_t llrLength = 2 * bufferLength(mBlockLength);
+    mLeftBits = xmMemory->scratch<float>(plan, llrLength + 16) + llrLength;
+    mRightBits = mLeftBits + 8;
+    mLeft->setOutput(mLeftBits);
+    mRight->setOutput(mRightBits);
 }
 
-ShortRateRNode::~ShortRateRNode()
-{
-    xmDataPool->release(mLeftBits);
-    xmDataPool->release(mRightBits);
-}
+ShortRateRNode::~ShortRateRNode() {}
 
 void ShortRateRNode::setOutput(float* output) { mOutput = output; }
 
 void ShortRateRNode::decode()
 {
-    F_function(mInput, mLeftLlr->data, mBlockLength);
+    {
+        PC_PROFILE_NODE("FastSscAvx::ShortRateRNode F", mBlockLength);
+        F_function(mInput, mLeftLlr, mBlockLength);
+    }
     mLeft->decode();
-    G_function(mInput, mRightLlr->data, mLeftBits->data, mBlockLength);
+    {
+        PC_PROFILE_NODE("FastSscAvx::ShortRateRNode G", mBlockLength);
+        G_function(mInput, mRightLlr, mLeftBits, mBlockLength);
+    }
     mRight->decode();
-    CombineBitsShort(mLeftBits->data, mRightBits->data, mOutput, mBlockLength);
+    {
+        PC_PROFILE_NODE("FastSscAvx::ShortRateRNode Combine", mBlockLength);
+        CombineBitsShort(mLeftBits, mRightBits, mOutput, mBlockLength);
+    }
 }
 
 /*************
  * ROneNode
  * ***********/
 
-ROneNode::ROneNode(const std::vector<unsigned>& frozenBits, Node* parent)
-    : RateRNode(frozenBits, parent, NO_RIGHT)
+ROneNode::ROneNode(const DecoderPlan::Node* plan, Node* parent)
+    : RateRNode(plan, parent, NO_RIGHT)
 {
 }
 
@@ -197,9 +212,15 @@ ROneNode::~ROneNode() {}
 
 void ROneNode::decode()
 {
-    F_function(mInput, mLeftLlr->data, mBlockLength);
+    {
+        PC_PROFILE_NODE("FastSscAvx::ROneNode F", mBlockLength);
+        F_function(mInput, mLeftLlr, mBlockLength);
+    }
     mLeft->decode();
-    rightDecode();
+    {
+        PC_PROFILE_NODE("FastSscAvx::ROneNode G and Combine", mBlockLength);
+        rightDecode();
+    }
 }
 
 void ROneNode::rightDecode()
@@ -222,8 +243,8 @@ void ROneNode::rightDecode()
  * ZeroRNode
  * ***********/
 
-ZeroRNode::ZeroRNode(const std::vector<unsigned>& frozenBits, Node* parent)
-    : RateRNode(frozenBits, parent, NO_LEFT)
+ZeroRNode::ZeroRNode(const DecoderPlan::Node* plan, Node* parent)
+    : RateRNode(plan, parent, NO_LEFT)
 {
 }
 
@@ -231,9 +252,15 @@ ZeroRNode::~ZeroRNode() {}
 
 void ZeroRNode::decode()
 {
-    G_function_0R(mInput, mRightLlr->data, mBlockLength);
+    {
+        PC_PROFILE_NODE("FastSscAvx::ZeroRNode G", mBlockLength);
+        G_function_0R(mInput, mRightLlr, mBlockLength);
+    }
     mRight->decode();
-    Combine_0R(mOutput, mBlockLength);
+    {
+        PC_PROFILE_NODE("FastSscAvx::ZeroRNode Combine", mBlockLength);
+        Combine_0R(mOutput, mBlockLength);
+    }
 }
 
 /*************
@@ -244,7 +271,11 @@ RateZeroDecoder::RateZeroDecoder(Node* parent) : Node(parent) {}
 
 RateZeroDecoder::~RateZeroDecoder() {}
 
-void RateZeroDecoder::decode() { memFloatFill(mOutput, INFINITY, mBlockLength); }
+void RateZeroDecoder::decode()
+{
+    PC_PROFILE_NODE("FastSscAvx::RateZeroDecoder", mBlockLength);
+    memFloatFill(mOutput, INFINITY, mBlockLength);
+}
 
 /*************
  * RateOneDecoder
@@ -256,6 +287,7 @@ RateOneDecoder::~RateOneDecoder() {}
 
 void RateOneDecoder::decode()
 {
+    PC_PROFILE_NODE("FastSscAvx::RateOneDecoder", mBlockLength);
     for (unsigned i = 0; i < mBlockLength; i += 8) {
         __m256 llr = _mm256_load_ps(mInput + i);
         _mm256_store_ps(mOutput + i, llr);
@@ -272,6 +304,7 @@ RepetitionDecoder::~RepetitionDecoder() {}
 
 void RepetitionDecoder::decode()
 {
+    PC_PROFILE_NODE("FastSscAvx::RepetitionDecoder", mBlockLength);
     __m256 LlrSum = _mm256_setzero_ps();
 
     RepetitionPrepare(mInput, mBlockLength);
@@ -302,6 +335,7 @@ DoubleRepetitionDecoder::~DoubleRepetitionDecoder() {}
 
 void DoubleRepetitionDecoder::decode()
 {
+    PC_PROFILE_NODE("FastSscAvx::DoubleRepetitionDecoder", mBlockLength);
     __m256 llr_sum = _mm256_setzero_ps();
 
     RepetitionPrepare(mInput, mBlockLength);
@@ -341,6 +375,7 @@ SpcDecoder::~SpcDecoder() {}
 
 void SpcDecoder::decode()
 {
+    PC_PROFILE_NODE("FastSscAvx::SpcDecoder", mBlockLength);
     const __m256 sgnMask = _mm256_set1_ps(-0.0);
     __m256 parVec = _mm256_setzero_ps();
     unsigned minIdx = 0;
@@ -424,6 +459,7 @@ DoubleSpcDecoder::~DoubleSpcDecoder() {}
 
 void DoubleSpcDecoder::decode()
 {
+    PC_PROFILE_NODE("FastSscAvx::DoubleSpcDecoder", mBlockLength);
     // SpcPrepare(mInput, mBlockLength);
     const float* llrs = mInput;
 
@@ -447,9 +483,9 @@ void DoubleSpcDecoder::decode()
     const __m256 mask = _mm256_cmp_ps(minvalues, twoMin, _CMP_EQ_OQ);
 
     const unsigned even_idx_mask =
-        __tzcnt_u32(_mm256_movemask_ps(_mm256_and_ps(mask, EVEN_MASK)));
+        __builtin_ctz(_mm256_movemask_ps(_mm256_and_ps(mask, EVEN_MASK)));
     const unsigned odd_idx_mask =
-        __tzcnt_u32(_mm256_movemask_ps(_mm256_and_ps(mask, ODD_MASK)));
+        __builtin_ctz(_mm256_movemask_ps(_mm256_and_ps(mask, ODD_MASK)));
 
     const unsigned even_idx = minindices[even_idx_mask];
     const unsigned odd_idx = minindices[odd_idx_mask];
@@ -472,6 +508,7 @@ DoubleSpcDecoderShort8::~DoubleSpcDecoderShort8() {}
 
 void DoubleSpcDecoderShort8::decode()
 {
+    PC_PROFILE_NODE("FastSscAvx::DoubleSpcDecoderShort8", mBlockLength);
     const __m256 values = _mm256_load_ps(mInput);
     const __m256 minvalues = _mm256_abs_ps(values);
 
@@ -492,16 +529,13 @@ void DoubleSpcDecoderShort8::decode()
  * ZeroSpcDecoder
  * ***********/
 
-ZeroSpcDecoder::ZeroSpcDecoder(Node* parent) : Node(parent)
-{
-    mTempBlock = xmDataPool->allocate(mBlockLength);
-    mTempBlockPtr = mTempBlock->data;
-}
+ZeroSpcDecoder::ZeroSpcDecoder(Node* parent) : Node(parent) {}
 
-ZeroSpcDecoder::~ZeroSpcDecoder() { xmDataPool->release(mTempBlock); }
+ZeroSpcDecoder::~ZeroSpcDecoder() {}
 
 void ZeroSpcDecoder::decode()
 {
+    PC_PROFILE_NODE("FastSscAvx::ZeroSpcDecoder", mBlockLength);
     const __m256 sgnMask = _mm256_set1_ps(-0.0);
     const size_t subBlockLength = mBlockLength / 2;
     __m256 parVec = _mm256_setzero_ps();
@@ -555,6 +589,7 @@ ZeroSpcDecoderShort8::~ZeroSpcDecoderShort8() {}
 
 void ZeroSpcDecoderShort8::decode()
 {
+    PC_PROFILE_NODE("FastSscAvx::ZeroSpcDecoderShort8", mBlockLength);
     const __m256 input = _mm256_load_ps(mInput);
     const __m256 swaplane = _mm256_permute2f128_ps(input, input, 0b00000001);
 
@@ -571,6 +606,7 @@ TripleRepetitionDecoder::~TripleRepetitionDecoder() {}
 
 void TripleRepetitionDecoder::decode()
 {
+    PC_PROFILE_NODE("FastSscAvx::TripleRepetitionDecoder", mBlockLength);
     __m256 input = _mm256_setzero_ps();
     for (unsigned i = 0; i < mBlockLength; i += 8) {
         const __m256 part = _mm256_load_ps(mInput + i);
@@ -717,6 +753,7 @@ RepetitionRateOneDecoderShort8::~RepetitionRateOneDecoderShort8() {}
 
 void RepetitionRateOneDecoderShort8::decode()
 {
+    PC_PROFILE_NODE("FastSscAvx::RepetitionRateOneDecoderShort8", mBlockLength);
     const __m256 input = _mm256_load_ps(mInput);
 
     const __m256 swaplane = _mm256_permute2f128_ps(input, input, 0b00000001);
@@ -761,6 +798,7 @@ TypeFiveDecoder::~TypeFiveDecoder() {}
 
 void TypeFiveDecoder::decode()
 {
+    PC_PROFILE_NODE("FastSscAvx::TypeFiveDecoder", mBlockLength);
     __m256 llrs = _mm256_setzero_ps();
 
     for (unsigned i = 0; i < mBlockLength; i += 8) {
@@ -794,26 +832,25 @@ void TypeFiveDecoder::decode()
 // End of decoder definitions
 
 
-Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent)
+std::pair<unsigned, bool> classifyNode(const std::vector<unsigned>& frozenBits,
+                                       size_t blockLength)
 {
-
-    size_t blockLength = parent->blockLength();
     size_t frozenBitCount = frozenBits.size();
 
     // Begin with the two most simple codes:
     if (frozenBitCount == blockLength) {
-        return new RateZeroDecoder(parent);
+        return { RATE_ZERO, false };
     }
     if (frozenBitCount == 0) {
-        return new RateOneDecoder(parent);
+        return { RATE_ONE, false };
     }
 
     // Following are "one bit unlike the others" codes:
     if (frozenBitCount == (blockLength - 1)) {
-        return new RepetitionDecoder(parent);
+        return { REPETITION, false };
     }
     if (frozenBitCount == 1) {
-        return new SpcDecoder(parent);
+        return { SPC, false };
     }
 
     // Following are "interleaved one bit unlike the others" codes:
@@ -823,14 +860,14 @@ Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent)
                 throw std::invalid_argument(fmt::format("{}", frozenBits));
             }
         }
-        return new DoubleRepetitionDecoder(parent);
+        return { DOUBLE_REPETITION, false };
     }
 
     if (frozenBitCount == 2 and frozenBits[0] == 0 and frozenBits[1] == 1) {
         if (blockLength == 8) {
-            return new DoubleSpcDecoderShort8(parent);
+            return { DOUBLE_SPC_SHORT8, false };
         } else {
-            return new DoubleSpcDecoder(parent);
+            return { DOUBLE_SPC, false };
         }
     }
 
@@ -841,24 +878,24 @@ Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent)
                 throw std::invalid_argument(fmt::format("{}", frozenBits));
             }
         }
-        return new TripleRepetitionDecoder(parent);
+        return { TRIPLE_REPETITION, false };
     }
 
     if (frozenBitCount == blockLength - 4 and
         frozenBits[frozenBitCount - 1] == blockLength - 4 and
         frozenBits[frozenBitCount - 2] == blockLength - 6) {
-        return new TypeFiveDecoder(parent);
+        return { TYPE_FIVE, false };
     }
 
     if (blockLength == 8 and frozenBitCount == 3 and frozenBits[0] == 0 and
         frozenBits[1] == 1 and frozenBits[2] == 2) {
-        return new RepetitionRateOneDecoderShort8(parent);
+        return { REPETITION_RATE_ONE_SHORT8, false };
     }
 
     if (blockLength == 8 and frozenBitCount == 5 and
         frozenBits[frozenBitCount - 1] == blockLength - 4 and
         frozenBits[frozenBitCount - 2] == blockLength - 5) {
-        return new ZeroSpcDecoderShort8(parent);
+        return { ZERO_SPC_SHORT8, false };
     }
 
     if (blockLength == 8) {
@@ -871,7 +908,7 @@ Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent)
 
     // Fallback: No special code available, split into smaller subcodes
     if (blockLength <= 8) {
-        return new ShortRateRNode(frozenBits, parent);
+        return { SHORT_RATE_R, true };
     } else {
         std::vector<unsigned> leftFrozenBits, rightFrozenBits;
         splitFrozenBits(frozenBits, blockLength / 2, leftFrozenBits, rightFrozenBits);
@@ -879,19 +916,104 @@ Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent)
         // Last case of optimization:
         // Common child node combination(s)
         if (leftFrozenBits.size() == blockLength / 2 && rightFrozenBits.size() == 1) {
-            return new ZeroSpcDecoder(parent);
+            return { ZERO_SPC, false };
         }
 
         // Minor optimization:
         // Right rate-1
         if (rightFrozenBits.size() == 0) {
-            return new ROneNode(frozenBits, parent);
+            return { R_ONE, true };
         }
         // Left rate-0
         if (leftFrozenBits.size() == blockLength / 2) {
-            return new ZeroRNode(frozenBits, parent);
+            return { ZERO_R, true };
         }
-        return new RateRNode(frozenBits, parent);
+        return { RATE_R, true };
+    }
+}
+
+template <class T>
+DecoderPlan::NodeSize leafSize()
+{
+    return { sizeof(T), 0 };
+}
+
+DecoderPlan::NodeSize nodeSize(unsigned kind, size_t blockLength)
+{
+    // Split nodes keep the LLRs of both children
+    const size_t childLlrBytes = 2 * bufferLength(blockLength / 2) * sizeof(float);
+    switch (kind) {
+    case RATE_ZERO:
+        return leafSize<RateZeroDecoder>();
+    case RATE_ONE:
+        return leafSize<RateOneDecoder>();
+    case REPETITION:
+        return leafSize<RepetitionDecoder>();
+    case SPC:
+        return leafSize<SpcDecoder>();
+    case DOUBLE_REPETITION:
+        return leafSize<DoubleRepetitionDecoder>();
+    case DOUBLE_SPC_SHORT8:
+        return leafSize<DoubleSpcDecoderShort8>();
+    case DOUBLE_SPC:
+        return leafSize<DoubleSpcDecoder>();
+    case TRIPLE_REPETITION:
+        return leafSize<TripleRepetitionDecoder>();
+    case TYPE_FIVE:
+        return leafSize<TypeFiveDecoder>();
+    case REPETITION_RATE_ONE_SHORT8:
+        return leafSize<RepetitionRateOneDecoderShort8>();
+    case ZERO_SPC_SHORT8:
+        return leafSize<ZeroSpcDecoderShort8>();
+    case ZERO_SPC:
+        return leafSize<ZeroSpcDecoder>();
+    case SHORT_RATE_R:
+        return { sizeof(ShortRateRNode), childLlrBytes + 16 * sizeof(float) };
+    case R_ONE:
+        return { sizeof(ROneNode), childLlrBytes };
+    case ZERO_R:
+        return { sizeof(ZeroRNode), childLlrBytes };
+    default:
+        return { sizeof(RateRNode), childLlrBytes };
+    }
+}
+
+Node* createDecoder(const DecoderPlan::Node* plan, Node* parent)
+{
+    NodeMemory* memory = parent->memory();
+    switch (plan->kind) {
+    case RATE_ZERO:
+        return memory->create<RateZeroDecoder>(plan, parent);
+    case RATE_ONE:
+        return memory->create<RateOneDecoder>(plan, parent);
+    case REPETITION:
+        return memory->create<RepetitionDecoder>(plan, parent);
+    case SPC:
+        return memory->create<SpcDecoder>(plan, parent);
+    case DOUBLE_REPETITION:
+        return memory->create<DoubleRepetitionDecoder>(plan, parent);
+    case DOUBLE_SPC_SHORT8:
+        return memory->create<DoubleSpcDecoderShort8>(plan, parent);
+    case DOUBLE_SPC:
+        return memory->create<DoubleSpcDecoder>(plan, parent);
+    case TRIPLE_REPETITION:
+        return memory->create<TripleRepetitionDecoder>(plan, parent);
+    case TYPE_FIVE:
+        return memory->create<TypeFiveDecoder>(plan, parent);
+    case REPETITION_RATE_ONE_SHORT8:
+        return memory->create<RepetitionRateOneDecoderShort8>(plan, parent);
+    case ZERO_SPC_SHORT8:
+        return memory->create<ZeroSpcDecoderShort8>(plan, parent);
+    case ZERO_SPC:
+        return memory->create<ZeroSpcDecoder>(plan, parent);
+    case SHORT_RATE_R:
+        return memory->create<ShortRateRNode>(plan, plan, parent);
+    case R_ONE:
+        return memory->create<ROneNode>(plan, plan, parent);
+    case ZERO_R:
+        return memory->create<ZeroRNode>(plan, plan, parent);
+    default:
+        return memory->create<RateRNode>(plan, plan, parent);
     }
 }
 
@@ -908,9 +1030,9 @@ FastSscAvxFloat::~FastSscAvxFloat() { clear(); }
 void FastSscAvxFloat::clear()
 {
     delete mEncoder;
-    delete mRootNode;
+    mRootNode->~Node();
     delete mNodeBase;
-    delete mDataPool;
+    delete mMemory;
 }
 
 void FastSscAvxFloat::initialize(size_t blockLength,
@@ -927,31 +1049,90 @@ void FastSscAvxFloat::initialize(size_t blockLength,
     mFrozenBits.assign(frozenBits.begin(), frozenBits.end());
     mEncoder = new Encoding::ButterflyFipPacked(mBlockLength, mFrozenBits);
     mEncoder->setSystematic(false);
-    mDataPool = new DataPool<float, 32>();
-    mNodeBase = new FastSscAvx::Node(mBlockLength, mDataPool);
-    mRootNode = FastSscAvx::createDecoder(mFrozenBits, mNodeBase);
+    mMemory = new NodeMemory(DecoderPlan::get("FastSscAvxFloat",
+                                              mBlockLength,
+                                              mFrozenBits,
+                                              FastSscAvx::classifyNode,
+                                              FastSscAvx::nodeSize));
+    mNodeBase = new FastSscAvx::Node(mBlockLength, mMemory);
+    mRootNode = FastSscAvx::createDecoder(mMemory->plan().root(), mNodeBase);
     mLlrContainer = new FloatContainer(mNodeBase->input(), mBlockLength);
     mBitContainer = new FloatContainer(mNodeBase->output(), mBlockLength);
     mLlrContainer->setFrozenBits(mFrozenBits);
     mBitContainer->setFrozenBits(mFrozenBits);
-    mOutputContainer = new unsigned char[(mBlockLength - mFrozenBits.size() + 7) / 8];
+    // The packed encoder writes whole 32-bit chunks of information bits.
+    mOutputContainer =
+        new unsigned char[(mBlockLength - mFrozenBits.size() + 31) / 32 * 4];
 }
 
-bool FastSscAvxFloat::decode()
+bool FastSscAvxFloat::decodeFrame(unsigned char* pData)
 {
+    PC_PROFILE_DECODER(&mNodeProfile);
+    const size_t infoBytes = (mBlockLength - mFrozenBits.size() + 7) / 8;
+
     mRootNode->decode();
 
     if (!mSystematic) {
-        mEncoder->setFloatCodeword(dynamic_cast<FloatContainer*>(mBitContainer)->data());
+        mEncoder->setFloatCodeword(mNodeBase->output());
         mEncoder->encode();
+        // The packed encoder output may write beyond infoBytes, so it is
+        // always collected in our own output container first.
         mEncoder->getInformation(mOutputContainer);
+        if (pData != mOutputContainer) {
+            memcpy(pData, mOutputContainer, infoBytes);
+        }
     } else {
-        mBitContainer->getPackedInformationBits(mOutputContainer);
+        mBitContainer->getPackedInformationBits(pData);
     }
 
-    bool result = mErrorDetector->check(mOutputContainer,
-                                        (mBlockLength - mFrozenBits.size() + 7) / 8);
-    return result;
+    return mErrorDetector->check(pData, infoBytes);
+}
+
+bool FastSscAvxFloat::decode() { return decodeFrame(mOutputContainer); }
+
+size_t FastSscAvxFloat::decode_batch(const float* pLlr,
+                                     size_t nFrames,
+                                     void* pData,
+                                     bool* pOk)
+{
+    const size_t infoBytes = (mBlockLength - mFrozenBits.size() + 7) / 8;
+    unsigned char* data = static_cast<unsigned char*>(pData);
+    float* llr = mNodeBase->input();
+    size_t passed = 0;
+
+    for (size_t frame = 0; frame < nFrames; ++frame) {
+        memcpy(llr, pLlr + frame * mBlockLength, sizeof(float) * mBlockLength);
+        bool res = decodeFrame(data + frame * infoBytes);
+        if (pOk) {
+            pOk[frame] = res;
+        }
+        passed += res;
+    }
+    return passed;
+}
+
+size_t FastSscAvxFloat::decode_batch(const char* pLlr,
+                                     size_t nFrames,
+                                     void* pData,
+                                     bool* pOk)
+{
+    const size_t infoBytes = (mBlockLength - mFrozenBits.size() + 7) / 8;
+    unsigned char* data = static_cast<unsigned char*>(pData);
+    float* llr = mNodeBase->input();
+    size_t passed = 0;
+
+    for (size_t frame = 0; frame < nFrames; ++frame) {
+        const char* frameLlr = pLlr + frame * mBlockLength;
+        for (unsigned i = 0; i < mBlockLength; ++i) {
+            llr[i] = static_cast<float>(frameLlr[i]);
+        }
+        bool res = decodeFrame(data + frame * infoBytes);
+        if (pOk) {
+            pOk[frame] = res;
+        }
+        passed += res;
+    }
+    return passed;
 }
 
 
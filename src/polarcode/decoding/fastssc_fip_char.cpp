@@ -6,6 +6,7 @@
  *
  */
 
+#include <polarcode/alignedmemory.h>
 #include <polarcode/decoding/fastssc_fip_char.h>
 #include <polarcode/encoding/butterfly_fip_packed.h>
 #include <polarcode/polarcode.h>
@@ -22,24 +23,31 @@ namespace Decoding {
 namespace FastSscFip {
 
 
-Node::Node()
-    : mLlr(nullptr), mBit(nullptr), xmDataPool(nullptr), mBlockLength(0), mVecCount(0)
+namespace {
+
+fipv* allocateVectors(size_t count)
 {
+    fipv* vectors =
+        static_cast<fipv*>(alignedAlloc(count * BYTESPERVECTOR, BYTESPERVECTOR));
+    memset(vectors, 0, count * BYTESPERVECTOR);
+    return vectors;
 }
 
+} // namespace
+
 Node::Node(Node* parent)
     : mLlr(nullptr),
       mBit(nullptr),
-      xmDataPool(parent->pool()),
+      xmMemory(parent->memory()),
       mBlockLength(parent->blockLength()),
       mVecCount(nBit2cvecCount(mBlockLength))
 {
 }
 
-Node::Node(size_t blockLength, datapool_t* pool)
-    : mLlr(pool->allocate(nBit2cvecCount(blockLength))),
-      mBit(pool->allocate(nBit2cvecCount(blockLength))),
-      xmDataPool(pool),
+Node::Node(size_t blockLength, NodeMemory* memory)
+    : mLlr(allocateVectors(nBit2cvecCount(blockLength))),
+      mBit(allocateVectors(nBit2cvecCount(blockLength))),
+      xmMemory(memory),
       mBlockLength(blockLength),
       mVecCount(nBit2cvecCount(blockLength))
 {
@@ -47,76 +55,63 @@ Node::Node(size_t blockLength, datapool_t* pool)
 
 Node::~Node()
 {
-    if (mLlr != nullptr)
-        xmDataPool->release(mLlr);
-    if (mBit != nullptr)
-        xmDataPool->release(mBit);
+    alignedFree(mLlr);
+    alignedFree(mBit);
 }
 
 void Node::decode(fipv*, fipv*) {}
 
 size_t Node::blockLength() { return mBlockLength; }
 
-Node::datapool_t* Node::pool() { return xmDataPool; }
+NodeMemory* Node::memory() { return xmMemory; }
 
-fipv* Node::input() { return mLlr->data; }
+fipv* Node::input() { return mLlr; }
 
-fipv* Node::output() { return mBit->data; }
+fipv* Node::output() { return mBit; }
 
-ShortNode::ShortNode(Node* parent)
-    : Node(parent),
-      mLeftBits(xmDataPool->allocate(mVecCount)),
-      mRightBits(xmDataPool->allocate(mVecCount))
-{
-}
+ShortNode::ShortNode(Node* parent) : Node(parent) {}
 
-ShortNode::~ShortNode()
-{
-    xmDataPool->release(mLeftBits);
-    xmDataPool->release(mRightBits);
-}
+ShortNode::~ShortNode() {}
 
 
 // Constructors of nodes
 
-RateRNode::RateRNode(const std::vector<unsigned>& frozenBits, Node* parent) : Node(parent)
+RateRNode::RateRNode(const DecoderPlan::Node* plan, Node* parent) : Node(parent)
 {
     mBlockLength /= 2;
     mVecCount = nBit2cvecCount(mBlockLength);
 
-    std::vector<unsigned> leftFrozenBits, rightFrozenBits;
-    splitFrozenBits(frozenBits, mBlockLength, leftFrozenBits, rightFrozenBits);
-
-    mLeft = createDecoder(leftFrozenBits, this);
-    mRight = createDecoder(rightFrozenBits, this);
+    ChildLlr = xmMemory->scratch<fipv>(plan, mVecCount);
 
-    ChildLlr = xmDataPool->allocate(mVecCount);
+    mLeft = createDecoder(plan->left, this);
+    mRight = createDecoder(plan->right, this);
 }
 
-ShortRateRNode::ShortRateRNode(const std::vector<unsigned>& frozenBits, Node* parent)
-    : RateRNode(frozenBits, parent),
-      LeftBits(xmDataPool->allocate(mVecCount)),
-      RightBits(xmDataPool->allocate(mVecCount))
+ShortRateRNode::ShortRateRNode(const DecoderPlan::Node* plan, Node* parent)
+    : RateRNode(plan, parent)
 {
+    // The child bits follow the child LLRs of RateRNode
+    LeftBits = xmMemory->scratch<fipv>(plan, 3 * mVecCount) + mVecCount;
+    RightBits = LeftBits + mVecCount;
 }
 
-ROneNode::ROneNode(const std::vector<unsigned>& frozenBits, Node* parent)
-    : RateRNode(frozenBits, parent)
+ROneNode::ROneNode(const DecoderPlan::Node* plan, Node* parent)
+    : RateRNode(plan, parent)
 {
 }
 
-ShortROneNode::ShortROneNode(const std::vector<unsigned>& frozenBits, Node* parent)
-    : ShortRateRNode(frozenBits, parent)
+ShortROneNode::ShortROneNode(const DecoderPlan::Node* plan, Node* parent)
+    : ShortRateRNode(plan, parent)
 {
 }
 
-ZeroRNode::ZeroRNode(const std::vector<unsigned>& frozenBits, Node* parent)
-    : RateRNode(frozenBits, parent)
+ZeroRNode::ZeroRNode(const DecoderPlan::Node* plan, Node* parent)
+    : RateRNode(plan, parent)
 {
 }
 
-ShortZeroRNode::ShortZeroRNode(const std::vector<unsigned>& frozenBits, Node* parent)
-    : ShortRateRNode(frozenBits, parent)
+ShortZeroRNode::ShortZeroRNode(const DecoderPlan::Node* plan, Node* parent)
+    : ShortRateRNode(plan, parent)
 {
 }
 
@@ -155,18 +150,12 @@ ShortZeroOneDecoder::ShortZeroOneDecoder(Node* parent)
 
 RateRNode::~RateRNode()
 {
-    if (mLeft)
-        delete mLeft;
-    if (mRight)
-        delete mRight;
-    xmDataPool->release(ChildLlr);
+    // Children live in the decoder's NodeMemory, which frees them as a whole
+    mLeft->~Node();
+    mRight->~Node();
 }
 
-ShortRateRNode::~ShortRateRNode()
-{
-    xmDataPool->release(LeftBits);
-    xmDataPool->release(RightBits);
-}
+ShortRateRNode::~ShortRateRNode() {}
 
 ROneNode::~ROneNode() {}
 
@@ -201,6 +190,7 @@ ShortZeroOneDecoder::~ShortZeroOneDecoder() {}
 
 void RateZeroDecoder::decode(fipv*, fipv* BitsOut)
 {
+    PC_PROFILE_NODE("FastSscFip::RateZeroDecoder", mBlockLength);
     const fipv inf = fi_set1_epi8(127);
     for (unsigned i = 0; i < mVecCount; ++i) {
         fi_store(BitsOut + i, inf);
@@ -209,6 +199,7 @@ void RateZeroDecoder::decode(fipv*, fipv* BitsOut)
 
 void RateOneDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 {
+    PC_PROFILE_NODE("FastSscFip::RateOneDecoder", mBlockLength);
     for (unsigned i = 0; i < mVecCount; ++i) {
         fi_store(BitsOut + i, fi_load(LlrIn + i));
     }
@@ -224,6 +215,7 @@ void RateOneDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 */
 void RepetitionDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 {
+    PC_PROFILE_NODE("FastSscFip::RepetitionDecoder", mBlockLength);
     fipv LlrSum = fi_setzero();
 
     // Accumulate vectors
@@ -248,6 +240,7 @@ void RepetitionDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 */
 void DoubleRepetitionDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 {
+    PC_PROFILE_NODE("FastSscFip::DoubleRepetitionDecoder", mBlockLength);
     fipv LlrSum = fi_setzero();
 
     // Accumulate vectors
@@ -264,6 +257,7 @@ void DoubleRepetitionDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 
 void ShortRepetitionDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 {
+    PC_PROFILE_NODE("FastSscFip::ShortRepetitionDecoder", mBlockLength);
     RepetitionPrepare(LlrIn, mBlockLength);
 
     // Get sum and save decoding result
@@ -273,6 +267,7 @@ void ShortRepetitionDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 
 void SpcDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 {
+    PC_PROFILE_NODE("FastSscFip::SpcDecoder", mBlockLength);
     fipv parVec = fi_setzero();
     unsigned minIdx = 0;
     char testAbs, minAbs = 127;
@@ -295,8 +290,7 @@ void SpcDecoder::decode(fipv* LlrIn, fipv* BitsOut)
     }
 
     // Flip least reliable bit, if neccessary
-    unsigned char parity = reduce_xor(parVec) & 0x80;
-    if (parity) {
+    if (sign_parity_epi8(parVec)) {
         char* BitPtr = reinterpret_cast<char*>(BitsOut);
         BitPtr[minIdx] = -BitPtr[minIdx];
     }
@@ -304,13 +298,14 @@ void SpcDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 
 void ShortSpcDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 {
+    PC_PROFILE_NODE("FastSscFip::ShortSpcDecoder", mBlockLength);
     SpcPrepare(LlrIn, mBlockLength);
 
     fipv vecIn = fi_load(LlrIn);
     fi_store(BitsOut, vecIn);
 
     // Flip least reliable bit, if neccessary
-    if (reduce_xor(vecIn) & 0x80) {
+    if (sign_parity_epi8(vecIn)) {
         fipv abs = fi_abs_epi8(vecIn);
         unsigned vecMin = minpos_epu8(abs);
         unsigned char* BitPtr = reinterpret_cast<unsigned char*>(BitsOut);
@@ -320,6 +315,7 @@ void ShortSpcDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 
 void ZeroSpcDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 {
+    PC_PROFILE_NODE("FastSscFip::ZeroSpcDecoder", mBlockLength);
     unsigned char* BitPtr = reinterpret_cast<unsigned char*>(BitsOut);
     fipv parVec = fi_setzero();
     unsigned minIdx = 0;
@@ -351,8 +347,7 @@ void ZeroSpcDecoder::decode(fipv* LlrIn, fipv* BitsOut)
     }
 
     // Flip least reliable bit, if neccessary
-    unsigned char parity = reduce_xor(parVec) & 0x80;
-    if (parity) {
+    if (sign_parity_epi8(parVec)) {
         BitPtr[minIdx] = -BitPtr[minIdx];
         BitPtr[minIdx + mSubBlockLength] = -BitPtr[minIdx + mSubBlockLength];
     }
@@ -360,6 +355,7 @@ void ZeroSpcDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 
 void ShortZeroSpcDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 {
+    PC_PROFILE_NODE("FastSscFip::ShortZeroSpcDecoder", mBlockLength);
     unsigned char* BitPtr = reinterpret_cast<unsigned char*>(BitsOut);
 
     // G-function with only frozen bits
@@ -375,8 +371,7 @@ void ShortZeroSpcDecoder::decode(fipv* LlrIn, fipv* BitsOut)
     memset(llr_c + mSubBlockLength, 127, BYTESPERVECTOR - mSubBlockLength);
 
     // Flip least reliable bit, if neccessary
-    unsigned char parity = reduce_xor(llr) & 0x80;
-    if (parity) {
+    if (sign_parity_epi8(llr)) {
         fipv abs = fi_abs_epi8(llr);
         unsigned vecMin = minpos_epu8(abs);
         llr_c[vecMin] = -llr_c[vecMin];
@@ -389,6 +384,7 @@ void ShortZeroSpcDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 
 void ShortZeroOneDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 {
+    PC_PROFILE_NODE("FastSscFip::ShortZeroOneDecoder", mBlockLength);
     fipv subLlrLeft, subLlrRight;
 
     G_function_0RShort(LlrIn, &subLlrLeft, mSubBlockLength);
@@ -400,37 +396,51 @@ void ShortZeroOneDecoder::decode(fipv* LlrIn, fipv* BitsOut)
 
 void RateRNode::decode(fipv* LlrIn, fipv* BitsOut)
 {
-    F_function(LlrIn, ChildLlr->data, mBlockLength);
-
-    mLeft->decode(ChildLlr->data, BitsOut);
-
-    G_function(LlrIn, ChildLlr->data, BitsOut, mBlockLength);
-
-    mRight->decode(ChildLlr->data, BitsOut + mVecCount);
-
-    CombineInPlace(BitsOut, mVecCount);
+    {
+        PC_PROFILE_NODE("FastSscFip::RateRNode F", mBlockLength);
+        F_function(LlrIn, ChildLlr, mBlockLength);
+    }
+    mLeft->decode(ChildLlr, BitsOut);
+    {
+        PC_PROFILE_NODE("FastSscFip::RateRNode G", mBlockLength);
+        G_function(LlrIn, ChildLlr, BitsOut, mBlockLength);
+    }
+    mRight->decode(ChildLlr, BitsOut + mVecCount);
+    {
+        PC_PROFILE_NODE("FastSscFip::RateRNode Combine", mBlockLength);
+        CombineInPlace(BitsOut, mVecCount);
+    }
 }
 
 void ShortRateRNode::decode(fipv* LlrIn, fipv* BitsOut)
 {
-    F_function(LlrIn, ChildLlr->data, mBlockLength);
-
-    mLeft->decode(ChildLlr->data, LeftBits->data);
-
-    G_function(LlrIn, ChildLlr->data, LeftBits->data, mBlockLength);
-
-    mRight->decode(ChildLlr->data, RightBits->data);
-
-    CombineBitsShort(LeftBits->data, RightBits->data, BitsOut, mBlockLength);
+    {
+        PC_PROFILE_NODE("FastSscFip::ShortRateRNode F", mBlockLength);
+        F_function(LlrIn, ChildLlr, mBlockLength);
+    }
+    mLeft->decode(ChildLlr, LeftBits);
+    {
+        PC_PROFILE_NODE("FastSscFip::ShortRateRNode G", mBlockLength);
+        G_function(LlrIn, ChildLlr, LeftBits, mBlockLength);
+    }
+    mRight->decode(ChildLlr, RightBits);
+    {
+        PC_PROFILE_NODE("FastSscFip::ShortRateRNode Combine", mBlockLength);
+        CombineBitsShort(LeftBits, RightBits, BitsOut, mBlockLength);
+    }
 }
 
 void ROneNode::decode(fipv* LlrIn, fipv* BitsOut)
 {
-    F_function(LlrIn, ChildLlr->data, mBlockLength);
-
-    mLeft->decode(ChildLlr->data, BitsOut);
-
-    simplifiedRightRateOneDecode(LlrIn, BitsOut);
+    {
+        PC_PROFILE_NODE("FastSscFip::ROneNode F", mBlockLength);
+        F_function(LlrIn, ChildLlr, mBlockLength);
+    }
+    mLeft->decode(ChildLlr, BitsOut);
+    {
+        PC_PROFILE_NODE("FastSscFip::ROneNode G and Combine", mBlockLength);
+        simplifiedRightRateOneDecode(LlrIn, BitsOut);
+    }
 }
 
 void ROneNode::simplifiedRightRateOneDecode(fipv* LlrIn, fipv* BitsOut)
@@ -450,11 +460,15 @@ void ROneNode::simplifiedRightRateOneDecode(fipv* LlrIn, fipv* BitsOut)
 
 void ShortROneNode::decode(fipv* LlrIn, fipv* BitsOut)
 {
-    F_function(LlrIn, ChildLlr->data, mBlockLength);
-
-    mLeft->decode(ChildLlr->data, BitsOut);
-
-    simplifiedRightRateOneDecodeShort(LlrIn, BitsOut);
+    {
+        PC_PROFILE_NODE("FastSscFip::ShortROneNode F", mBlockLength);
+        F_function(LlrIn, ChildLlr, mBlockLength);
+    }
+    mLeft->decode(ChildLlr, BitsOut);
+    {
+        PC_PROFILE_NODE("FastSscFip::ShortROneNode G and Combine", mBlockLength);
+        simplifiedRightRateOneDecodeShort(LlrIn, BitsOut);
+    }
 }
 
 void ShortROneNode::simplifiedRightRateOneDecodeShort(fipv* LlrIn, fipv* BitsOut)
@@ -475,55 +489,63 @@ void ShortROneNode::simplifiedRightRateOneDecodeShort(fipv* LlrIn, fipv* BitsOut
 
 void ZeroRNode::decode(fipv* LlrIn, fipv* BitsOut)
 {
-    G_function_0R(LlrIn, ChildLlr->data, mBlockLength);
-
-    mRight->decode(ChildLlr->data, BitsOut + mVecCount);
-
-    Combine_0R(BitsOut, mBlockLength);
+    {
+        PC_PROFILE_NODE("FastSscFip::ZeroRNode G", mBlockLength);
+        G_function_0R(LlrIn, ChildLlr, mBlockLength);
+    }
+    mRight->decode(ChildLlr, BitsOut + mVecCount);
+    {
+        PC_PROFILE_NODE("FastSscFip::ZeroRNode Combine", mBlockLength);
+        Combine_0R(BitsOut, mBlockLength);
+    }
 }
 
 void ShortZeroRNode::decode(fipv* LlrIn, fipv* BitsOut)
 {
-    G_function_0RShort(LlrIn, ChildLlr->data, mBlockLength);
-
-    mRight->decode(ChildLlr->data, RightBits->data);
-
-    Combine_0RShort(BitsOut, RightBits->data, mBlockLength);
+    {
+        PC_PROFILE_NODE("FastSscFip::ShortZeroRNode G", mBlockLength);
+        G_function_0RShort(LlrIn, ChildLlr, mBlockLength);
+    }
+    mRight->decode(ChildLlr, RightBits);
+    {
+        PC_PROFILE_NODE("FastSscFip::ShortZeroRNode Combine", mBlockLength);
+        Combine_0RShort(BitsOut, RightBits, mBlockLength);
+    }
 }
 
 // End of mass defining
 
-Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent)
+std::pair<unsigned, bool> classifyNode(const std::vector<unsigned>& frozenBits,
+                                       size_t blockLength)
 {
-    size_t blockLength = parent->blockLength();
     size_t frozenBitCount = frozenBits.size();
 
     // Begin with the two most simple codes:
     if (frozenBitCount == blockLength) {
-        return new RateZeroDecoder(parent);
+        return { RATE_ZERO, false };
     }
     if (frozenBitCount == 0) {
-        return new RateOneDecoder(parent);
+        return { RATE_ONE, false };
     }
 
     // Following are "one bit unlike the others" codes:
     if (frozenBitCount == (blockLength - 1)) {
         if (blockLength <= BYTESPERVECTOR) {
-            return new ShortRepetitionDecoder(parent);
+            return { SHORT_REPETITION, false };
         } else {
-            return new RepetitionDecoder(parent);
+            return { REPETITION, false };
         }
     }
     if (frozenBitCount == 1) {
         if (blockLength <= BYTESPERVECTOR) {
-            return new ShortSpcDecoder(parent);
+            return { SHORT_SPC, false };
         } else {
-            return new SpcDecoder(parent);
+            return { SPC, false };
         }
     }
 
     if (frozenBitCount == blockLength - 2 and blockLength >= BYTESPERVECTOR) {
-        return new DoubleRepetitionDecoder(parent);
+        return { DOUBLE_REPETITION, false };
     }
 
     // Precalculate subcodes to find special child node combinations
@@ -532,39 +554,124 @@ Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent)
 
     if (blockLength <= BYTESPERVECTOR) {
         if (leftFrozenBits.size() == blockLength / 2 && rightFrozenBits.size() == 0) {
-            return new ShortZeroOneDecoder(parent);
+            return { SHORT_ZERO_ONE, false };
         }
 
         if (leftFrozenBits.size() == blockLength / 2 && rightFrozenBits.size() == 1) {
-            return new ShortZeroSpcDecoder(parent);
+            return { SHORT_ZERO_SPC, false };
         }
 
         // Fallback: No special decoder available
         if (rightFrozenBits.size() == 0) {
-            return new ShortROneNode(frozenBits, parent);
+            return { SHORT_R_ONE, true };
         }
 
         if (leftFrozenBits.size() == blockLength / 2) {
-            return new ShortZeroRNode(frozenBits, parent);
+            return { SHORT_ZERO_R, true };
         }
 
-        return new ShortRateRNode(frozenBits, parent);
+        return { SHORT_RATE_R, true };
     } else {
         if (leftFrozenBits.size() == blockLength / 2 && rightFrozenBits.size() == 1) {
-            return new ZeroSpcDecoder(parent);
+            return { ZERO_SPC, false };
         }
         // Minor optimization:
 
         // Right rate-1
         if (rightFrozenBits.size() == 0) {
-            return new ROneNode(frozenBits, parent);
+            return { R_ONE, true };
         }
         // Left rate-0
         if (leftFrozenBits.size() == blockLength / 2) {
-            return new ZeroRNode(frozenBits, parent);
+            return { ZERO_R, true };
         }
 
-        return new RateRNode(frozenBits, parent);
+        return { RATE_R, true };
+    }
+}
+
+template <class T>
+DecoderPlan::NodeSize leafSize()
+{
+    return { sizeof(T), 0 };
+}
+
+DecoderPlan::NodeSize nodeSize(unsigned kind, size_t blockLength)
+{
+    const size_t childBytes = nBit2cvecCount(blockLength / 2) * BYTESPERVECTOR;
+    switch (kind) {
+    case RATE_ZERO:
+        return leafSize<RateZeroDecoder>();
+    case RATE_ONE:
+        return leafSize<RateOneDecoder>();
+    case REPETITION:
+        return leafSize<RepetitionDecoder>();
+    case SHORT_REPETITION:
+        return leafSize<ShortRepetitionDecoder>();
+    case SPC:
+        return leafSize<SpcDecoder>();
+    case SHORT_SPC:
+        return leafSize<ShortSpcDecoder>();
+    case DOUBLE_REPETITION:
+        return leafSize<DoubleRepetitionDecoder>();
+    case SHORT_ZERO_ONE:
+        return leafSize<ShortZeroOneDecoder>();
+    case SHORT_ZERO_SPC:
+        return leafSize<ShortZeroSpcDecoder>();
+    case ZERO_SPC:
+        return leafSize<ZeroSpcDecoder>();
+    // Split nodes keep the child LLRs, short ones also both child bit halves
+    case SHORT_R_ONE:
+        return { sizeof(ShortROneNode), 3 * childBytes };
+    case SHORT_ZERO_R:
+        return { sizeof(ShortZeroRNode), 3 * childBytes };
+    case SHORT_RATE_R:
+        return { sizeof(ShortRateRNode), 3 * childBytes };
+    case R_ONE:
+        return { sizeof(ROneNode), childBytes };
+    case ZERO_R:
+        return { sizeof(ZeroRNode), childBytes };
+    default:
+        return { sizeof(RateRNode), childBytes };
+    }
+}
+
+Node* createDecoder(const DecoderPlan::Node* plan, Node* parent)
+{
+    NodeMemory* memory = parent->memory();
+    switch (plan->kind) {
+    case RATE_ZERO:
+        return memory->create<RateZeroDecoder>(plan, parent);
+    case RATE_ONE:
+        return memory->create<RateOneDecoder>(plan, parent);
+    case REPETITION:
+        return memory->create<RepetitionDecoder>(plan, parent);
+    case SHORT_REPETITION:
+        return memory->create<ShortRepetitionDecoder>(plan, parent);
+    case SPC:
+        return memory->create<SpcDecoder>(plan, parent);
+    case SHORT_SPC:
+        return memory->create<ShortSpcDecoder>(plan, parent);
+    case DOUBLE_REPETITION:
+        return memory->create<DoubleRepetitionDecoder>(plan, parent);
+    case SHORT_ZERO_ONE:
+        return memory->create<ShortZeroOneDecoder>(plan, parent);
+    case SHORT_ZERO_SPC:
+        return memory->create<ShortZeroSpcDecoder>(plan, parent);
+    case ZERO_SPC:
+        return memory->create<ZeroSpcDecoder>(plan, parent);
+    case SHORT_R_ONE:
+        return memory->create<ShortROneNode>(plan, plan, parent);
+    case SHORT_ZERO_R:
+        return memory->create<ShortZeroRNode>(plan, plan, parent);
+    case SHORT_RATE_R:
+        return memory->create<ShortRateRNode>(plan, plan, parent);
+    case R_ONE:
+        return memory->create<ROneNode>(plan, plan, parent);
+    case ZERO_R:
+        return memory->create<ZeroRNode>(plan, plan, parent);
+    default:
+        return memory->create<RateRNode>(plan, plan, parent);
     }
 }
 
@@ -581,9 +688,9 @@ FastSscFipChar::~FastSscFipChar() { clear(); }
 void FastSscFipChar::clear()
 {
     delete mEncoder;
-    delete mRootNode;
+    mRootNode->~Node();
     delete mNodeBase;
-    delete mDataPool;
+    delete mMemory;
 }
 
 void FastSscFipChar::initialize(size_t blockLength,
@@ -601,32 +708,88 @@ void FastSscFipChar::initialize(size_t blockLength,
     mEncoder = new Encoding::ButterflyFipPacked(mBlockLength, mFrozenBits);
     mEncoder->setSystematic(false);
 
-    mDataPool = new DataPool<fipv, BYTESPERVECTOR>();
-    mNodeBase = new FastSscFip::Node(blockLength, mDataPool);
-    mRootNode = FastSscFip::createDecoder(frozenBits, mNodeBase);
+    mMemory = new NodeMemory(DecoderPlan::get("FastSscFipChar",
+                                              mBlockLength,
+                                              mFrozenBits,
+                                              FastSscFip::classifyNode,
+                                              FastSscFip::nodeSize));
+    mNodeBase = new FastSscFip::Node(blockLength, mMemory);
+    mRootNode = FastSscFip::createDecoder(mMemory->plan().root(), mNodeBase);
     mLlrContainer =
         new CharContainer(reinterpret_cast<char*>(mNodeBase->input()), mBlockLength);
     mBitContainer =
         new CharContainer(reinterpret_cast<char*>(mNodeBase->output()), mBlockLength);
     mLlrContainer->setFrozenBits(mFrozenBits);
     mBitContainer->setFrozenBits(mFrozenBits);
-    mOutputContainer = new unsigned char[(mBlockLength - frozenBits.size() + 7) / 8];
+    // The packed encoder writes whole 32-bit chunks of information bits.
+    mOutputContainer =
+        new unsigned char[(mBlockLength - frozenBits.size() + 31) / 32 * 4];
 }
 
-bool FastSscFipChar::decode()
+bool FastSscFipChar::decodeFrame(unsigned char* pData)
 {
+    PC_PROFILE_DECODER(&mNodeProfile);
+    const size_t infoBytes = (mBlockLength - mFrozenBits.size() + 7) / 8;
+
     mRootNode->decode(mNodeBase->input(), mNodeBase->output());
     if (!mSystematic) {
-        mEncoder->setCharCodeword(dynamic_cast<CharContainer*>(mBitContainer)->data());
+        mEncoder->setCharCodeword(reinterpret_cast<char*>(mNodeBase->output()));
         mEncoder->encode();
+        // The packed encoder output may write beyond infoBytes, so it is
+        // always collected in our own output container first.
         mEncoder->getInformation(mOutputContainer);
+        if (pData != mOutputContainer) {
+            memcpy(pData, mOutputContainer, infoBytes);
+        }
     } else {
-        mBitContainer->getPackedInformationBits(mOutputContainer);
+        mBitContainer->getPackedInformationBits(pData);
     }
 
-    bool result = mErrorDetector->check(mOutputContainer,
-                                        (mBlockLength - mFrozenBits.size() + 7) / 8);
-    return result;
+    return mErrorDetector->check(pData, infoBytes);
+}
+
+bool FastSscFipChar::decode() { return decodeFrame(mOutputContainer); }
+
+size_t FastSscFipChar::decode_batch(const float* pLlr,
+                                    size_t nFrames,
+                                    void* pData,
+                                    bool* pOk)
+{
+    const size_t infoBytes = (mBlockLength - mFrozenBits.size() + 7) / 8;
+    unsigned char* data = static_cast<unsigned char*>(pData);
+    size_t passed = 0;
+
+    for (size_t frame = 0; frame < nFrames; ++frame) {
+        // Quantization is done by the container
+        mLlrContainer->insertLlr(pLlr + frame * mBlockLength);
+        bool res = decodeFrame(data + frame * infoBytes);
+        if (pOk) {
+            pOk[frame] = res;
+        }
+        passed += res;
+    }
+    return passed;
+}
+
+size_t FastSscFipChar::decode_batch(const char* pLlr,
+                                    size_t nFrames,
+                                    void* pData,
+                                    bool* pOk)
+{
+    const size_t infoBytes = (mBlockLength - mFrozenBits.size() + 7) / 8;
+    unsigned char* data = static_cast<unsigned char*>(pData);
+    char* llr = reinterpret_cast<char*>(mNodeBase->input());
+    size_t passed = 0;
+
+    for (size_t frame = 0; frame < nFrames; ++frame) {
+        memcpy(llr, pLlr + frame * mBlockLength, mBlockLength);
+        bool res = decodeFrame(data + frame * infoBytes);
+        if (pOk) {
+            pOk[frame] = res;
+        }
+        passed += res;
+    }
+    return passed;
 }
 
 
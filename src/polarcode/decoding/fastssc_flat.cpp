@@ -0,0 +1,395 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <polarcode/decoding/avx_float.h>
+#include <polarcode/decoding/fastssc_flat.h>
+#include <polarcode/encoding/butterfly_fip_packed.h>
+#include <polarcode/polarcode.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace PolarCode {
+namespace Decoding {
+
+namespace FastSscFlat {
+
+namespace {
+
+using TemplatizedFloatCalc::float_xor;
+
+// Subcodes of length four, which are common below the length-8 nodes, use
+// half vectors. Shorter ones are decoded bit by bit.
+const __m128 HALF_SIGN_MASK = _mm_set1_ps(-0.0f);
+
+void fill(float* dst, float value, unsigned length)
+{
+    if (length >= 8) {
+        const __m256 vec = _mm256_set1_ps(value);
+        for (unsigned i = 0; i < length; i += 8) {
+            _mm256_store_ps(dst + i, vec);
+        }
+    } else {
+        std::fill(dst, dst + length, value);
+    }
+}
+
+void f(const float* in, float* out, unsigned length)
+{
+    if (length >= 8) {
+        FastSscAvx::F_function(const_cast<float*>(in), out, length);
+    } else if (length == 4) {
+        const __m128 left = _mm_load_ps(in);
+        const __m128 right = _mm_load_ps(in + 4);
+        const __m128 sign = _mm_and_ps(HALF_SIGN_MASK, _mm_xor_ps(left, right));
+        const __m128 min = _mm_min_ps(_mm_andnot_ps(HALF_SIGN_MASK, left),
+                                      _mm_andnot_ps(HALF_SIGN_MASK, right));
+        _mm_store_ps(out, _mm_or_ps(sign, min));
+    } else {
+        for (unsigned i = 0; i < length; ++i) {
+            out[i] = TemplatizedFloatCalc::F_function_calc(in[i], in[i + length]);
+        }
+    }
+}
+
+void g(const float* in, float* out, const float* bits, unsigned length)
+{
+    if (length >= 8) {
+        FastSscAvx::G_function(
+            const_cast<float*>(in), out, const_cast<float*>(bits), length);
+    } else if (length == 4) {
+        const __m128 sign = _mm_and_ps(HALF_SIGN_MASK, _mm_load_ps(bits));
+        const __m128 left = _mm_xor_ps(sign, _mm_load_ps(in));
+        _mm_store_ps(out, _mm_add_ps(left, _mm_load_ps(in + 4)));
+    } else {
+        for (unsigned i = 0; i < length; ++i) {
+            const float sign = TemplatizedFloatCalc::hardDecode(bits[i]);
+            out[i] = float_xor(in[i], sign) + in[i + length];
+        }
+    }
+}
+
+void gZero(const float* in, float* out, unsigned length)
+{
+    if (length >= 8) {
+        FastSscAvx::G_function_0R(const_cast<float*>(in), out, length);
+    } else if (length == 4) {
+        _mm_store_ps(out, _mm_add_ps(_mm_load_ps(in), _mm_load_ps(in + 4)));
+    } else {
+        for (unsigned i = 0; i < length; ++i) {
+            out[i] = in[i] + in[i + length];
+        }
+    }
+}
+
+void combine(float* bits, unsigned length)
+{
+    if (length >= 8) {
+        FastSscAvx::Combine(bits, length);
+    } else if (length == 4) {
+        _mm_store_ps(bits, _mm_xor_ps(_mm_load_ps(bits), _mm_load_ps(bits + 4)));
+    } else {
+        for (unsigned i = 0; i < length; ++i) {
+            bits[i] = float_xor(bits[i], bits[i + length]);
+        }
+    }
+}
+
+void repetition(const float* in, float* bits, unsigned length)
+{
+    float sum = 0.0f;
+    if (length >= 8) {
+        __m256 llrSum = _mm256_setzero_ps();
+        for (unsigned i = 0; i < length; i += 8) {
+            llrSum = _mm256_add_ps(llrSum, _mm256_load_ps(in + i));
+        }
+        sum = reduce_add_ps(llrSum);
+    } else {
+        for (unsigned i = 0; i < length; ++i) {
+            sum += in[i];
+        }
+    }
+    fill(bits, sum, length);
+}
+
+void singleParityCheck(const float* in, float* bits, unsigned length)
+{
+    unsigned minIdx = 0;
+    bool parity = false;
+
+    if (length >= 8) {
+        __m256 parVec = _mm256_setzero_ps();
+        float testAbs, minAbs = INFINITY;
+        for (unsigned i = 0; i < length; i += 8) {
+            const __m256 vecIn = _mm256_load_ps(in + i);
+            _mm256_store_ps(bits + i, vecIn);
+            parVec = _mm256_xor_ps(parVec, vecIn);
+
+            const unsigned vecMin =
+                _mm256_minidx_ps(FastSscAvx::_mm256_abs_ps(vecIn), &testAbs);
+            if (testAbs < minAbs) {
+                minIdx = vecMin + i;
+                minAbs = testAbs;
+            }
+        }
+        parity = std::signbit(reduce_xor_ps(parVec));
+    } else {
+        float minAbs = INFINITY;
+        for (unsigned i = 0; i < length; ++i) {
+            bits[i] = in[i];
+            parity ^= std::signbit(in[i]);
+            if (std::fabs(in[i]) < minAbs) {
+                minIdx = i;
+                minAbs = std::fabs(in[i]);
+            }
+        }
+    }
+
+    // Flip the least reliable bit, if the parity check fails
+    if (parity) {
+        bits[minIdx] = -bits[minIdx];
+    }
+}
+
+void compileNode(const DecoderPlan::Node* node,
+                 unsigned blockLength,
+                 unsigned bits,
+                 std::vector<Instruction>& program)
+{
+    const unsigned length = node->blockLength;
+    const unsigned llrIn = 2 * blockLength - 2 * length;
+
+    switch (node->kind) {
+    case RATE_ZERO:
+        program.push_back({ R0, length, llrIn, 0, bits });
+        break;
+    case RATE_ONE:
+        program.push_back({ R1, length, llrIn, 0, bits });
+        break;
+    case REPETITION:
+        program.push_back({ REP, length, llrIn, 0, bits });
+        break;
+    case SINGLE_PARITY_CHECK:
+        program.push_back({ SPC, length, llrIn, 0, bits });
+        break;
+    default: {
+        const unsigned half = length / 2;
+        const unsigned llrOut = 2 * blockLength - length;
+        if (node->left->kind == RATE_ZERO) {
+            program.push_back({ G_ZERO, half, llrIn, llrOut, bits });
+            compileNode(node->right, blockLength, bits + half, program);
+            program.push_back({ COMBINE_ZERO, half, 0, 0, bits });
+        } else {
+            program.push_back({ F, half, llrIn, llrOut, bits });
+            compileNode(node->left, blockLength, bits, program);
+            program.push_back({ G, half, llrIn, llrOut, bits });
+            compileNode(node->right, blockLength, bits + half, program);
+            program.push_back({ COMBINE, half, 0, 0, bits });
+        }
+        break;
+    }
+    }
+}
+
+} // namespace
+
+std::pair<unsigned, bool> classifyNode(const std::vector<unsigned>& frozenBits,
+                                       size_t blockLength)
+{
+    const size_t frozenBitCount = frozenBits.size();
+
+    if (frozenBitCount == blockLength) {
+        return { RATE_ZERO, false };
+    }
+    if (frozenBitCount == 0) {
+        return { RATE_ONE, false };
+    }
+    // Only the last bit carries information
+    if (frozenBitCount == blockLength - 1 && frozenBits.back() == blockLength - 2) {
+        return { REPETITION, false };
+    }
+    // Only the first bit is frozen
+    if (frozenBitCount == 1 && frozenBits.front() == 0) {
+        return { SINGLE_PARITY_CHECK, false };
+    }
+    return { RATE_R, true };
+}
+
+std::vector<Instruction> compile(const DecoderPlan::Node* plan)
+{
+    std::vector<Instruction> program;
+    compileNode(plan, plan->blockLength, 0, program);
+    return program;
+}
+
+void execute(const std::vector<Instruction>& program, float* llr, float* bits)
+{
+    for (const Instruction& instruction : program) {
+        const unsigned length = instruction.length;
+        const float* in = llr + instruction.llrIn;
+        float* out = llr + instruction.llrOut;
+        float* bitPtr = bits + instruction.bits;
+
+        switch (instruction.op) {
+        case F:
+            f(in, out, length);
+            break;
+        case G:
+            g(in, out, bitPtr, length);
+            break;
+        case G_ZERO:
+            gZero(in, out, length);
+            break;
+        case REP:
+            repetition(in, bitPtr, length);
+            break;
+        case SPC:
+            singleParityCheck(in, bitPtr, length);
+            break;
+        case R0:
+            fill(bitPtr, INFINITY, length);
+            break;
+        case R1:
+            memcpy(bitPtr, in, length * sizeof(float));
+            break;
+        case COMBINE:
+            combine(bitPtr, length);
+            break;
+        case COMBINE_ZERO:
+            memcpy(bitPtr, bitPtr + length, length * sizeof(float));
+            break;
+        }
+    }
+}
+
+} // namespace FastSscFlat
+
+FastSscFlatFloat::FastSscFlatFloat(size_t blockLength,
+                                   const std::vector<unsigned>& frozenBits)
+{
+    initialize(blockLength, frozenBits);
+}
+
+FastSscFlatFloat::~FastSscFlatFloat() { clear(); }
+
+void FastSscFlatFloat::clear()
+{
+    delete mEncoder;
+    _mm_free(mLlr);
+    _mm_free(mBit);
+}
+
+void FastSscFlatFloat::initialize(size_t blockLength,
+                                  const std::vector<unsigned>& frozenBits)
+{
+    if (blockLength == mBlockLength && frozenBits == mFrozenBits) {
+        return;
+    }
+    if (mBlockLength != 0) {
+        clear();
+        delete mLlrContainer;
+        delete mBitContainer;
+        delete[] mOutputContainer;
+    }
+    mBlockLength = blockLength;
+    mFrozenBits.assign(frozenBits.begin(), frozenBits.end());
+    mEncoder = new Encoding::ButterflyFipPacked(mBlockLength, mFrozenBits);
+    mEncoder->setSystematic(false);
+
+    // The program replaces node objects, so the plan needs no layout
+    mPlan = DecoderPlan::get("FastSscFlatFloat",
+                             mBlockLength,
+                             mFrozenBits,
+                             FastSscFlat::classifyNode,
+                             nullptr);
+    mProgram = FastSscFlat::compile(mPlan->root());
+
+    mLlr = static_cast<float*>(_mm_malloc(2 * mBlockLength * sizeof(float), 32));
+    mBit = static_cast<float*>(_mm_malloc(nBit2fCount(mBlockLength) * sizeof(float), 32));
+    mLlrContainer = new FloatContainer(mLlr, mBlockLength);
+    mBitContainer = new FloatContainer(mBit, mBlockLength);
+    mLlrContainer->setFrozenBits(mFrozenBits);
+    mBitContainer->setFrozenBits(mFrozenBits);
+    // The packed encoder writes whole 32-bit chunks of information bits.
+    mOutputContainer =
+        new unsigned char[(mBlockLength - mFrozenBits.size() + 31) / 32 * 4];
+}
+
+bool FastSscFlatFloat::decodeFrame(unsigned char* pData)
+{
+    const size_t infoBytes = (mBlockLength - mFrozenBits.size() + 7) / 8;
+
+    FastSscFlat::execute(mProgram, mLlr, mBit);
+
+    if (!mSystematic) {
+        mEncoder->setFloatCodeword(mBit);
+        mEncoder->encode();
+        mEncoder->getInformation(mOutputContainer);
+        if (pData != mOutputContainer) {
+            memcpy(pData, mOutputContainer, infoBytes);
+        }
+    } else {
+        mBitContainer->getPackedInformationBits(pData);
+    }
+
+    return mErrorDetector->check(pData, infoBytes);
+}
+
+bool FastSscFlatFloat::decode() { return decodeFrame(mOutputContainer); }
+
+size_t FastSscFlatFloat::decode_batch(const float* pLlr,
+                                      size_t nFrames,
+                                      void* pData,
+                                      bool* pOk)
+{
+    const size_t infoBytes = (mBlockLength - mFrozenBits.size() + 7) / 8;
+    unsigned char* data = static_cast<unsigned char*>(pData);
+    size_t passed = 0;
+
+    for (size_t frame = 0; frame < nFrames; ++frame) {
+        memcpy(mLlr, pLlr + frame * mBlockLength, sizeof(float) * mBlockLength);
+        bool res = decodeFrame(data + frame * infoBytes);
+        if (pOk) {
+            pOk[frame] = res;
+        }
+        passed += res;
+    }
+    return passed;
+}
+
+size_t FastSscFlatFloat::decode_batch(const char* pLlr,
+                                      size_t nFrames,
+                                      void* pData,
+                                      bool* pOk)
+{
+    const size_t infoBytes = (mBlockLength - mFrozenBits.size() + 7) / 8;
+    unsigned char* data = static_cast<unsigned char*>(pData);
+    size_t passed = 0;
+
+    for (size_t frame = 0; frame < nFrames; ++frame) {
+        const char* frameLlr = pLlr + frame * mBlockLength;
+        for (unsigned i = 0; i < mBlockLength; ++i) {
+            mLlr[i] = static_cast<float>(frameLlr[i]);
+        }
+        bool res = decodeFrame(data + frame * infoBytes);
+        if (pOk) {
+            pOk[frame] = res;
+        }
+        passed += res;
+    }
+    return passed;
+}
+
+const std::vector<FastSscFlat::Instruction>& FastSscFlatFloat::program() const
+{
+    return mProgram;
+}
+
+} // namespace Decoding
+} // namespace PolarCode
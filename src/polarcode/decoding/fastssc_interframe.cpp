@@ -0,0 +1,555 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <polarcode/decoding/fastssc_interframe.h>
+#include <polarcode/polarcode.h>
+
+#include <cstring>
+#include <type_traits>
+
+namespace PolarCode {
+namespace Decoding {
+
+namespace FastSscInterFrame {
+
+template <class Lanes>
+Node<Lanes>::Node(size_t blockLength, datapool_t* pool)
+    : mBlockLength(blockLength), xmDataPool(pool)
+{
+}
+
+template <class Lanes>
+Node<Lanes>::Node(Node* parent)
+    : mBlockLength(parent->mBlockLength), xmDataPool(parent->xmDataPool)
+{
+}
+
+template <class Lanes>
+Node<Lanes>::~Node()
+{
+}
+
+template <class Lanes>
+void Node<Lanes>::decode(vec_t*, vec_t*)
+{
+}
+
+template <class Lanes>
+size_t Node<Lanes>::blockLength()
+{
+    return mBlockLength;
+}
+
+template <class Lanes>
+typename Node<Lanes>::datapool_t* Node<Lanes>::pool()
+{
+    return xmDataPool;
+}
+
+namespace {
+
+/*************
+ * RateRNode
+ * ***********/
+
+template <class Lanes>
+class RateRNode : public Node<Lanes>
+{
+protected:
+    typedef typename Lanes::vec_t vec_t;
+    using Node<Lanes>::mBlockLength;
+    using Node<Lanes>::xmDataPool;
+
+    Node<Lanes> *mLeft, *mRight;
+    typename Node<Lanes>::block_t* mChildLlr;
+
+public:
+    RateRNode(const std::vector<unsigned>& frozenBits, Node<Lanes>* parent)
+        : Node<Lanes>(parent)
+    {
+        mBlockLength /= 2;
+
+        std::vector<unsigned> leftFrozenBits, rightFrozenBits;
+        splitFrozenBits(frozenBits, mBlockLength, leftFrozenBits, rightFrozenBits);
+
+        mLeft = createDecoder(leftFrozenBits, this);
+        mRight = createDecoder(rightFrozenBits, this);
+        mChildLlr = xmDataPool->allocate(mBlockLength);
+    }
+
+    ~RateRNode()
+    {
+        delete mLeft;
+        delete mRight;
+        xmDataPool->release(mChildLlr);
+    }
+
+    void decode(vec_t* LlrIn, vec_t* BitsOut)
+    {
+        const size_t n = mBlockLength;
+        vec_t* child = mChildLlr->data;
+
+        for (size_t i = 0; i < n; ++i) {
+            child[i] = Lanes::f(LlrIn[i], LlrIn[i + n]);
+        }
+        mLeft->decode(child, BitsOut);
+        for (size_t i = 0; i < n; ++i) {
+            child[i] = Lanes::g(LlrIn[i], LlrIn[i + n], BitsOut[i]);
+        }
+        mRight->decode(child, BitsOut + n);
+        for (size_t i = 0; i < n; ++i) {
+            BitsOut[i] = Lanes::combine(BitsOut[i], BitsOut[i + n]);
+        }
+    }
+};
+
+/*************
+ * ZeroRNode
+ * ***********/
+
+template <class Lanes>
+class ZeroRNode : public RateRNode<Lanes>
+{
+    typedef typename Lanes::vec_t vec_t;
+    using RateRNode<Lanes>::mBlockLength;
+    using RateRNode<Lanes>::mRight;
+    using RateRNode<Lanes>::mChildLlr;
+
+public:
+    ZeroRNode(const std::vector<unsigned>& frozenBits, Node<Lanes>* parent)
+        : RateRNode<Lanes>(frozenBits, parent)
+    {
+    }
+
+    void decode(vec_t* LlrIn, vec_t* BitsOut)
+    {
+        const size_t n = mBlockLength;
+        vec_t* child = mChildLlr->data;
+
+        // Left bits are all zero, so G degenerates to a sum
+        for (size_t i = 0; i < n; ++i) {
+            child[i] = Lanes::add(LlrIn[i], LlrIn[i + n]);
+        }
+        mRight->decode(child, BitsOut + n);
+        for (size_t i = 0; i < n; ++i) {
+            BitsOut[i] = BitsOut[i + n];
+        }
+    }
+};
+
+/*************
+ * ROneNode
+ * ***********/
+
+template <class Lanes>
+class ROneNode : public RateRNode<Lanes>
+{
+    typedef typename Lanes::vec_t vec_t;
+    using RateRNode<Lanes>::mBlockLength;
+    using RateRNode<Lanes>::mLeft;
+    using RateRNode<Lanes>::mChildLlr;
+
+public:
+    ROneNode(const std::vector<unsigned>& frozenBits, Node<Lanes>* parent)
+        : RateRNode<Lanes>(frozenBits, parent)
+    {
+    }
+
+    void decode(vec_t* LlrIn, vec_t* BitsOut)
+    {
+        const size_t n = mBlockLength;
+        vec_t* child = mChildLlr->data;
+
+        for (size_t i = 0; i < n; ++i) {
+            child[i] = Lanes::f(LlrIn[i], LlrIn[i + n]);
+        }
+        mLeft->decode(child, BitsOut);
+
+        // Right child is rate-1: its bits are the G-function output itself
+        for (size_t i = 0; i < n; ++i) {
+            const vec_t right = Lanes::g(LlrIn[i], LlrIn[i + n], BitsOut[i]);
+            BitsOut[i] = Lanes::combine(BitsOut[i], right);
+            BitsOut[i + n] = right;
+        }
+    }
+};
+
+/*************
+ * Leaf nodes
+ * ***********/
+
+template <class Lanes>
+class RateZeroDecoder : public Node<Lanes>
+{
+    typedef typename Lanes::vec_t vec_t;
+    using Node<Lanes>::mBlockLength;
+
+public:
+    RateZeroDecoder(Node<Lanes>* parent) : Node<Lanes>(parent) {}
+
+    void decode(vec_t*, vec_t* BitsOut)
+    {
+        const vec_t frozen = Lanes::frozen();
+        for (size_t i = 0; i < mBlockLength; ++i) {
+            BitsOut[i] = frozen;
+        }
+    }
+};
+
+template <class Lanes>
+class RateOneDecoder : public Node<Lanes>
+{
+    typedef typename Lanes::vec_t vec_t;
+    using Node<Lanes>::mBlockLength;
+
+public:
+    RateOneDecoder(Node<Lanes>* parent) : Node<Lanes>(parent) {}
+
+    void decode(vec_t* LlrIn, vec_t* BitsOut)
+    {
+        for (size_t i = 0; i < mBlockLength; ++i) {
+            BitsOut[i] = LlrIn[i];
+        }
+    }
+};
+
+template <class Lanes>
+class RepetitionDecoder : public Node<Lanes>
+{
+    typedef typename Lanes::vec_t vec_t;
+    using Node<Lanes>::mBlockLength;
+
+public:
+    RepetitionDecoder(Node<Lanes>* parent) : Node<Lanes>(parent) {}
+
+    void decode(vec_t* LlrIn, vec_t* BitsOut)
+    {
+        // Each lane sums up its own frame, no horizontal reduction needed.
+        vec_t sum = LlrIn[0];
+        for (size_t i = 1; i < mBlockLength; ++i) {
+            sum = Lanes::add(sum, LlrIn[i]);
+        }
+        for (size_t i = 0; i < mBlockLength; ++i) {
+            BitsOut[i] = sum;
+        }
+    }
+};
+
+template <class Lanes>
+class SpcDecoder : public Node<Lanes>
+{
+    typedef typename Lanes::vec_t vec_t;
+    using Node<Lanes>::mBlockLength;
+
+public:
+    SpcDecoder(Node<Lanes>* parent) : Node<Lanes>(parent) {}
+
+    void decode(vec_t* LlrIn, vec_t* BitsOut)
+    {
+        vec_t parity = LlrIn[0];
+        vec_t minAbs = Lanes::abs(LlrIn[0]);
+        BitsOut[0] = LlrIn[0];
+        for (size_t i = 1; i < mBlockLength; ++i) {
+            parity = Lanes::combine(parity, LlrIn[i]);
+            minAbs = Lanes::min(minAbs, Lanes::abs(LlrIn[i]));
+            BitsOut[i] = LlrIn[i];
+        }
+
+        // Flip the first least reliable bit of every lane with odd parity
+        vec_t pending = Lanes::negative(parity);
+        if (Lanes::signs(pending) == 0) {
+            return;
+        }
+        for (size_t i = 0; i < mBlockLength; ++i) {
+            const vec_t flip =
+                Lanes::and_(pending, Lanes::equal(Lanes::abs(BitsOut[i]), minAbs));
+            BitsOut[i] = Lanes::flip(BitsOut[i], flip);
+            pending = Lanes::andnot(flip, pending);
+        }
+    }
+};
+
+} // namespace
+
+template <class Lanes>
+Node<Lanes>* createDecoder(const std::vector<unsigned>& frozenBits, Node<Lanes>* parent)
+{
+    const size_t blockLength = parent->blockLength();
+    const size_t frozenBitCount = frozenBits.size();
+
+    if (frozenBitCount == blockLength) {
+        return new RateZeroDecoder<Lanes>(parent);
+    }
+    if (frozenBitCount == 0) {
+        return new RateOneDecoder<Lanes>(parent);
+    }
+    if (frozenBitCount == blockLength - 1 && frozenBits.back() == blockLength - 2) {
+        return new RepetitionDecoder<Lanes>(parent);
+    }
+    if (frozenBitCount == 1 && frozenBits.front() == 0) {
+        return new SpcDecoder<Lanes>(parent);
+    }
+
+    std::vector<unsigned> leftFrozenBits, rightFrozenBits;
+    splitFrozenBits(frozenBits, blockLength / 2, leftFrozenBits, rightFrozenBits);
+
+    if (leftFrozenBits.size() == blockLength / 2) {
+        return new ZeroRNode<Lanes>(frozenBits, parent);
+    }
+    if (rightFrozenBits.empty()) {
+        return new ROneNode<Lanes>(frozenBits, parent);
+    }
+    return new RateRNode<Lanes>(frozenBits, parent);
+}
+
+} // namespace FastSscInterFrame
+
+namespace {
+
+/*!
+ * \brief Transpose an 8x8 block of floats held in eight AVX registers.
+ */
+inline void transpose8_ps(__m256* r)
+{
+    __m256 t[8], tt[8];
+    for (unsigned i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for (unsigned i = 0; i < 8; i += 4) {
+        tt[i] = _mm256_shuffle_ps(t[i], t[i + 2], 0x44);
+        tt[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], 0xEE);
+        tt[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0x44);
+        tt[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0xEE);
+    }
+    for (unsigned i = 0; i < 4; ++i) {
+        r[i] = _mm256_permute2f128_ps(tt[i], tt[i + 4], 0x20);
+        r[i + 4] = _mm256_permute2f128_ps(tt[i], tt[i + 4], 0x31);
+    }
+}
+
+} // namespace
+
+template <class Lanes>
+FastSscInterFrameDecoder<Lanes>::FastSscInterFrameDecoder(
+    size_t blockLength, const std::vector<unsigned>& frozenBits)
+    : mDataPool(nullptr),
+      mNodeBase(nullptr),
+      mRootNode(nullptr),
+      mLlr(nullptr),
+      mBit(nullptr),
+      mFrameLlr(nullptr),
+      mFrameBit(nullptr)
+{
+    initialize(blockLength, frozenBits);
+}
+
+template <class Lanes>
+FastSscInterFrameDecoder<Lanes>::~FastSscInterFrameDecoder()
+{
+    clear();
+}
+
+template <class Lanes>
+void FastSscInterFrameDecoder<Lanes>::clear()
+{
+    delete mRootNode;
+    if (mDataPool) {
+        mDataPool->release(mLlr);
+        mDataPool->release(mBit);
+    }
+    delete mNodeBase;
+    delete mDataPool;
+    delete mLlrContainer;
+    delete mBitContainer;
+    delete[] mOutputContainer;
+    _mm_free(mFrameLlr);
+    _mm_free(mFrameBit);
+    mLlrContainer = nullptr;
+    mBitContainer = nullptr;
+    mOutputContainer = nullptr;
+}
+
+template <class Lanes>
+void FastSscInterFrameDecoder<Lanes>::initialize(size_t blockLength,
+                                                 const std::vector<unsigned>& frozenBits)
+{
+    typedef typename Lanes::container_t container_t;
+
+    if (blockLength == mBlockLength && frozenBits == mFrozenBits) {
+        return;
+    }
+    if (mBlockLength != 0) {
+        clear();
+    }
+    mBlockLength = blockLength;
+    mFrozenBits.assign(frozenBits.begin(), frozenBits.end());
+
+    mInfoPositions.clear();
+    auto frozen = mFrozenBits.begin();
+    for (unsigned i = 0; i < mBlockLength; ++i) {
+        if (frozen != mFrozenBits.end() && *frozen == i) {
+            ++frozen;
+        } else {
+            mInfoPositions.push_back(i);
+        }
+    }
+
+    mDataPool = new typename node_t::datapool_t();
+    mNodeBase = new node_t(mBlockLength, mDataPool);
+    mRootNode = FastSscInterFrame::createDecoder(mFrozenBits, mNodeBase);
+    mLlr = mDataPool->allocate(mBlockLength);
+    mBit = mDataPool->allocate(mBlockLength);
+
+    mFrameLlr = static_cast<llr_t*>(_mm_malloc(mBlockLength * sizeof(llr_t), 32));
+    mFrameBit = static_cast<llr_t*>(_mm_malloc(mBlockLength * sizeof(llr_t), 32));
+    mLlrContainer = new container_t(mFrameLlr, mBlockLength);
+    mBitContainer = new container_t(mFrameBit, mBlockLength);
+    mLlrContainer->setFrozenBits(mFrozenBits);
+    mBitContainer->setFrozenBits(mFrozenBits);
+    mOutputContainer = new unsigned char[(mBlockLength - mFrozenBits.size() + 7) / 8];
+}
+
+template <class Lanes>
+template <typename T>
+void FastSscInterFrameDecoder<Lanes>::loadFrames(const T* pLlr, size_t nFrames)
+{
+    const unsigned lanes = Lanes::laneCount;
+
+    if constexpr (std::is_same<llr_t, float>::value && std::is_same<T, float>::value) {
+        if (mBlockLength % 8 == 0) {
+            __m256 rows[8];
+            for (size_t i = 0; i < mBlockLength; i += 8) {
+                for (unsigned f = 0; f < 8; ++f) {
+                    rows[f] = f < nFrames ? _mm256_loadu_ps(pLlr + f * mBlockLength + i)
+                                          : _mm256_setzero_ps();
+                }
+                transpose8_ps(rows);
+                for (unsigned j = 0; j < 8; ++j) {
+                    mLlr->data[i + j] = rows[j];
+                }
+            }
+            return;
+        }
+    }
+
+    if (nFrames < lanes) {
+        memset(mLlr->data, 0, mBlockLength * sizeof(vec_t));
+    }
+    llr_t* dst = reinterpret_cast<llr_t*>(mLlr->data);
+    for (size_t f = 0; f < nFrames; ++f) {
+        const T* src = pLlr + f * mBlockLength;
+        for (size_t i = 0; i < mBlockLength; ++i) {
+            dst[i * lanes + f] = Lanes::quantize(src[i]);
+        }
+    }
+}
+
+template <class Lanes>
+void FastSscInterFrameDecoder<Lanes>::storeFrames(unsigned char* pData, size_t nFrames)
+{
+    const size_t infoLength = mInfoPositions.size();
+    const size_t infoBytes = (infoLength + 7) / 8;
+    vec_t* bits = mBit->data;
+
+    if (!mSystematic) {
+        // Re-encode all lanes at once: the polar transform is its own inverse.
+        for (size_t i = 0; i < mBlockLength; ++i) {
+            bits[i] = Lanes::hardDecode(bits[i]);
+        }
+        for (size_t stage = 1; stage < mBlockLength; stage <<= 1) {
+            for (size_t block = 0; block < mBlockLength; block += 2 * stage) {
+                for (size_t i = block; i < block + stage; ++i) {
+                    bits[i] = Lanes::combine(bits[i], bits[i + stage]);
+                }
+            }
+        }
+    }
+
+    uint64_t masks[8];
+    for (size_t byte = 0; byte < infoBytes; ++byte) {
+        for (unsigned j = 0; j < 8; ++j) {
+            const size_t bit = byte * 8 + j;
+            masks[j] = bit < infoLength ? Lanes::signs(bits[mInfoPositions[bit]]) : 0;
+        }
+        for (size_t f = 0; f < nFrames; ++f) {
+            unsigned char value = 0;
+            for (unsigned j = 0; j < 8; ++j) {
+                value |= ((masks[j] >> f) & 1) << (7 - j);
+            }
+            pData[f * infoBytes + byte] = value;
+        }
+    }
+}
+
+template <class Lanes>
+bool FastSscInterFrameDecoder<Lanes>::decode()
+{
+    loadFrames(mFrameLlr, 1);
+    mRootNode->decode(mLlr->data, mBit->data);
+
+    const llr_t* bits = reinterpret_cast<const llr_t*>(mBit->data);
+    for (size_t i = 0; i < mBlockLength; ++i) {
+        mFrameBit[i] = bits[i * Lanes::laneCount];
+    }
+
+    storeFrames(mOutputContainer, 1);
+    return mErrorDetector->check(mOutputContainer, (infoLength() + 7) / 8);
+}
+
+template <class Lanes>
+template <typename T>
+size_t FastSscInterFrameDecoder<Lanes>::decodeGroups(const T* pLlr,
+                                                     size_t nFrames,
+                                                     void* pData,
+                                                     bool* pOk)
+{
+    const size_t infoBytes = (infoLength() + 7) / 8;
+    unsigned char* out = static_cast<unsigned char*>(pData);
+    size_t passed = 0;
+
+    for (size_t first = 0; first < nFrames; first += Lanes::laneCount) {
+        const size_t count = std::min<size_t>(Lanes::laneCount, nFrames - first);
+        loadFrames(pLlr + first * mBlockLength, count);
+        mRootNode->decode(mLlr->data, mBit->data);
+        storeFrames(out + first * infoBytes, count);
+
+        for (size_t f = first; f < first + count; ++f) {
+            const bool ok = mErrorDetector->check(out + f * infoBytes, infoBytes);
+            passed += ok;
+            if (pOk) {
+                pOk[f] = ok;
+            }
+        }
+    }
+    return passed;
+}
+
+template <class Lanes>
+size_t FastSscInterFrameDecoder<Lanes>::decode_batch(const float* pLlr,
+                                                     size_t nFrames,
+                                                     void* pData,
+                                                     bool* pOk)
+{
+    return decodeGroups(pLlr, nFrames, pData, pOk);
+}
+
+template <class Lanes>
+size_t FastSscInterFrameDecoder<Lanes>::decode_batch(const char* pLlr,
+                                                     size_t nFrames,
+                                                     void* pData,
+                                                     bool* pOk)
+{
+    return decodeGroups(pLlr, nFrames, pData, pOk);
+}
+
+template class FastSscInterFrameDecoder<FastSscInterFrame::FloatLanes>;
+template class FastSscInterFrameDecoder<FastSscInterFrame::CharLanes>;
+
+} // namespace Decoding
+} // namespace PolarCode
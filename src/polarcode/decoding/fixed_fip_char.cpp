@@ -9,10 +9,24 @@
 #include <polarcode/decoding/fixed_fip_char.h>
 #include <polarcode/encoding/butterfly_fip_packed.h>
 #include <polarcode/errordetection/dummy.h>
+#include <algorithm>
 
 namespace PolarCode {
 namespace Decoding {
 
+int findCodingScheme(size_t blockLength, const std::vector<unsigned>& frozenBits)
+{
+    std::vector<unsigned> sortedFrozenBits(frozenBits);
+    std::sort(sortedFrozenBits.begin(), sortedFrozenBits.end());
+    for (size_t scheme = 0; scheme < codeRegistry.size(); ++scheme) {
+        if (codeRegistry[scheme].blockLength == blockLength &&
+            codeRegistry[scheme].frozenBits == sortedFrozenBits) {
+            return scheme;
+        }
+    }
+    return -1;
+}
+
 namespace FixedDecoding {
 
 FixedDecoder::FixedDecoder() {}
@@ -34,7 +48,8 @@ FixedChar::FixedChar(unsigned int scheme)
     mEncoder->setSystematic(false);
     mLlrContainer = new CharContainer(mBlockLength, mFrozenBits);
     mBitContainer = new CharContainer(mBlockLength, mFrozenBits);
-    mOutputContainer = new unsigned char[(codeRegistry[scheme].infoLength + 7) / 8];
+    // The packed encoder writes whole 32-bit chunks of information bits.
+    mOutputContainer = new unsigned char[(codeRegistry[scheme].infoLength + 31) / 32 * 4];
 }
 
 FixedChar::~FixedChar()
@@ -45,11 +60,11 @@ FixedChar::~FixedChar()
 
 bool FixedChar::decode()
 {
-    mDecoder->decode(reinterpret_cast<CharContainer*>(mLlrContainer)->data(),
-                     reinterpret_cast<CharContainer*>(mBitContainer)->data());
+    mDecoder->decode(static_cast<CharContainer*>(mLlrContainer)->data(),
+                     static_cast<CharContainer*>(mBitContainer)->data());
 
     if (!mSystematic) {
-        mEncoder->setCharCodeword(dynamic_cast<CharContainer*>(mBitContainer)->data());
+        mEncoder->setCharCodeword(static_cast<CharContainer*>(mBitContainer)->data());
         mEncoder->encode();
         mEncoder->getInformation(mOutputContainer);
     } else {
@@ -0,0 +1,219 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <polarcode/decoding/nodeprofile.h>
+
+#ifdef POLARCODE_NODE_PROFILING
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <x86intrin.h>
+#include <cstring>
+#endif
+
+namespace PolarCode {
+namespace Decoding {
+
+void NodeProfile::record(const char* kind, unsigned length, const NodeCounters& counters)
+{
+    auto it = mEntries.find(std::make_pair(kind, length));
+    if (it == mEntries.end()) {
+        it = mEntries.emplace(key_t(kind, length), NodeCounters{ 0, 0, 0, 0 }).first;
+    }
+    NodeCounters& entry = it->second;
+    entry.calls += counters.calls;
+    entry.cycles += counters.cycles;
+    entry.instructions += counters.instructions;
+    entry.cacheMisses += counters.cacheMisses;
+}
+
+void NodeProfile::merge(const NodeProfile& other)
+{
+    for (auto& entry : other.mEntries) {
+        record(entry.first.first.c_str(), entry.first.second, entry.second);
+    }
+}
+
+void NodeProfile::clear() { mEntries.clear(); }
+
+bool NodeProfile::empty() const { return mEntries.empty(); }
+
+const NodeProfile::entries_t& NodeProfile::entries() const { return mEntries; }
+
+void NodeProfile::writeCsv(std::ostream& stream) const
+{
+    writeCsvHeader(stream);
+    writeCsvRows(stream);
+}
+
+void NodeProfile::writeCsvHeader(std::ostream& stream, const std::string& columnNames)
+{
+    stream << columnNames
+           << "\"Node\",\"Length\",\"Calls\",\"Cycles\",\"Instructions\",\"Cache "
+              "misses\",\"Cycles per call\""
+           << std::endl;
+}
+
+void NodeProfile::writeCsvRows(std::ostream& stream, const std::string& columns) const
+{
+    for (auto& entry : mEntries) {
+        const NodeCounters& counters = entry.second;
+        stream << columns << '"' << entry.first.first << "\","
+               << entry.first.second << ',' << counters.calls << ','
+               << counters.cycles << ',' << counters.instructions << ','
+               << counters.cacheMisses << ','
+               << double(counters.cycles) / counters.calls << std::endl;
+    }
+}
+
+#ifdef POLARCODE_NODE_PROFILING
+
+namespace Profiling {
+
+namespace {
+
+/*!
+ * \brief A perf event of the calling thread in user space, read with rdpmc.
+ *
+ * Reading the counter through the mapped control page needs no system call,
+ * so short nodes are not dominated by the measurement. Without user space
+ * access to the counters, the event reads zero.
+ */
+class PerfCounter
+{
+    int mFd;
+    perf_event_mmap_page* mPage;
+
+public:
+    PerfCounter(uint64_t config, int groupFd) : mPage(nullptr)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        mFd = syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+        if (mFd < 0) {
+            return;
+        }
+        void* page =
+            mmap(nullptr, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, mFd, 0);
+        if (page == MAP_FAILED) {
+            return;
+        }
+        mPage = static_cast<perf_event_mmap_page*>(page);
+        if (!mPage->cap_user_rdpmc) {
+            munmap(mPage, sysconf(_SC_PAGESIZE));
+            mPage = nullptr;
+        }
+    }
+
+    ~PerfCounter()
+    {
+        if (mPage != nullptr) {
+            munmap(mPage, sysconf(_SC_PAGESIZE));
+        }
+        if (mFd >= 0) {
+            close(mFd);
+        }
+    }
+
+    int fd() const { return mFd; }
+
+    uint64_t read() const
+    {
+        if (mPage == nullptr) {
+            return 0;
+        }
+        // The kernel bumps the lock while it updates the page, retry then
+        uint32_t sequence;
+        uint64_t count;
+        do {
+            sequence = mPage->lock;
+            __atomic_signal_fence(__ATOMIC_SEQ_CST);
+            const uint32_t index = mPage->index;
+            count = mPage->offset;
+            if (index != 0) {
+                const unsigned shift = 64 - mPage->pmc_width;
+                count += int64_t(__rdpmc(index - 1) << shift) >> shift;
+            }
+            __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        } while (mPage->lock != sequence);
+        return count;
+    }
+};
+
+/*!
+ * \brief Instructions and cache misses, scheduled together as a group.
+ */
+struct PerfGroup {
+    PerfCounter instructions{ PERF_COUNT_HW_INSTRUCTIONS, -1 };
+    PerfCounter cacheMisses{ PERF_COUNT_HW_CACHE_MISSES, instructions.fd() };
+};
+
+thread_local NodeProfile* tProfile = nullptr;
+thread_local NodeScope* tScope = nullptr;
+
+NodeCounters now()
+{
+    static thread_local PerfGroup perf;
+    NodeCounters counters;
+    counters.calls = 0;
+    counters.instructions = perf.instructions.read();
+    counters.cacheMisses = perf.cacheMisses.read();
+    counters.cycles = __rdtsc();
+    return counters;
+}
+
+} // namespace
+
+DecoderScope::DecoderScope(NodeProfile* profile) : mPrevious(tProfile)
+{
+    tProfile = profile;
+}
+
+DecoderScope::~DecoderScope() { tProfile = mPrevious; }
+
+NodeScope::NodeScope(const char* kind, unsigned length)
+    : mKind(kind), mLength(length), mNested{ 0, 0, 0, 0 }, mParent(tScope)
+{
+    tScope = this;
+    mStart = now();
+}
+
+NodeScope::~NodeScope()
+{
+    NodeCounters end = now();
+    NodeCounters total = { 1,
+                           end.cycles - mStart.cycles,
+                           end.instructions - mStart.instructions,
+                           end.cacheMisses - mStart.cacheMisses };
+    tScope = mParent;
+    if (mParent != nullptr) {
+        mParent->mNested.cycles += total.cycles;
+        mParent->mNested.instructions += total.instructions;
+        mParent->mNested.cacheMisses += total.cacheMisses;
+    }
+    if (tProfile != nullptr) {
+        NodeCounters own = { 1,
+                             total.cycles - mNested.cycles,
+                             total.instructions - mNested.instructions,
+                             total.cacheMisses - mNested.cacheMisses };
+        tProfile->record(mKind, mLength, own);
+    }
+}
+
+} // namespace Profiling
+
+#endif // POLARCODE_NODE_PROFILING
+
+} // namespace Decoding
+} // namespace PolarCode
@@ -6,122 +6,261 @@
  *
  */
 
+#include <polarcode/alignedmemory.h>
+#include <polarcode/decoding/avx_float.h>
 #include <polarcode/decoding/scan.h>
 #include <polarcode/decoding/templatized_float.h>
 #include <cmath>
-//#define SCAN_DEBUG_OUTPUT
+#include <cstring>
 
 namespace PolarCode {
 namespace Decoding {
 
+namespace {
+
+/*
+ * Vector operations of the SCAN kernels, one set per register width. Loads
+ * and stores are unaligned, as the output container is only aligned for AVX.
+ */
+struct ScalarOps {
+    typedef float vec_t;
+    static const unsigned SIZE = 1;
+
+    static vec_t load(const float* ptr) { return *ptr; }
+    static void store(float* ptr, vec_t x) { *ptr = x; }
+    static vec_t add(vec_t a, vec_t b) { return a + b; }
+    static vec_t boxplus(vec_t a, vec_t b)
+    {
+        return TemplatizedFloatCalc::F_function_calc(a, b);
+    }
+};
+
+struct AvxOps {
+    typedef __m256 vec_t;
+    static const unsigned SIZE = 8;
+
+    static vec_t load(const float* ptr) { return _mm256_loadu_ps(ptr); }
+    static void store(float* ptr, vec_t x) { _mm256_storeu_ps(ptr, x); }
+    static vec_t add(vec_t a, vec_t b) { return _mm256_add_ps(a, b); }
+    static vec_t boxplus(vec_t a, vec_t b) { return FastSscAvx::_mm256_polarf_ps(a, b); }
+};
+
+#ifdef POLARCODE_AVX512
+struct Avx512Ops {
+    typedef __m512 vec_t;
+    static const unsigned SIZE = 16;
+
+    static vec_t load(const float* ptr) { return _mm512_loadu_ps(ptr); }
+    static void store(float* ptr, vec_t x) { _mm512_storeu_ps(ptr, x); }
+    static vec_t add(vec_t a, vec_t b) { return _mm512_add_ps(a, b); }
+    static vec_t boxplus(vec_t a, vec_t b)
+    {
+        // Float logic needs AVX-512DQ, so work on the bit patterns. Magnitudes
+        // compare like unsigned integers, NaNs lose against numbers as in fmin().
+        const __m512i bitsA = _mm512_castps_si512(a);
+        const __m512i bitsB = _mm512_castps_si512(b);
+        const __m512i magnitude = _mm512_set1_epi32(0x7FFFFFFF);
+        const __m512i sign =
+            _mm512_andnot_si512(magnitude, _mm512_xor_si512(bitsA, bitsB));
+        const __m512i minV = _mm512_min_epu32(_mm512_and_si512(bitsA, magnitude),
+                                              _mm512_and_si512(bitsB, magnitude));
+        return _mm512_castsi512_ps(_mm512_or_si512(sign, minV));
+    }
+};
+#endif
+
+/*
+ * The kernels process a group of _size_ messages. The group on the channel
+ * side of a level consists of two halves of _size_ messages each.
+ */
+
+/*!
+ * \brief L(l) of an odd group: upper half plus lower half boxplus E(l).
+ */
+struct OddGroupLlr {
+    template <class Ops>
+    static void
+    apply(unsigned size, float* llr, const float* channelLlr, const float* even)
+    {
+        for (unsigned i = 0; i < size; i += Ops::SIZE) {
+            Ops::store(llr + i,
+                       Ops::add(Ops::load(channelLlr + size + i),
+                                Ops::boxplus(Ops::load(channelLlr + i),
+                                             Ops::load(even + i))));
+        }
+    }
+};
+
+/*!
+ * \brief L(l) of an even group: lower half boxplus [upper half plus O(l)].
+ */
+struct EvenGroupLlr {
+    template <class Ops>
+    static void
+    apply(unsigned size, float* llr, const float* channelLlr, const float* odd)
+    {
+        for (unsigned i = 0; i < size; i += Ops::SIZE) {
+            const typename Ops::vec_t t =
+                Ops::add(Ops::load(channelLlr + size + i), Ops::load(odd + i));
+            Ops::store(llr + i, Ops::boxplus(Ops::load(channelLlr + i), t));
+        }
+    }
+};
+
+/*!
+ * \brief Both halves of the bit messages toward the channel, from E(l), O(l)
+ *        and the channel side LLRs.
+ */
+struct GroupBits {
+    template <class Ops>
+    static void apply(unsigned size,
+                      float* bits,
+                      const float* channelLlr,
+                      const float* even,
+                      const float* odd)
+    {
+        for (unsigned i = 0; i < size; i += Ops::SIZE) {
+            const typename Ops::vec_t e = Ops::load(even + i);
+            const typename Ops::vec_t o = Ops::load(odd + i);
+            const typename Ops::vec_t t = Ops::add(o, Ops::load(channelLlr + size + i));
+            Ops::store(bits + i, Ops::boxplus(e, t));
+            Ops::store(bits + size + i,
+                       Ops::add(o, Ops::boxplus(e, Ops::load(channelLlr + i))));
+        }
+    }
+};
+
+struct Sum {
+    template <class Ops>
+    static void apply(unsigned size, float* out, const float* a, const float* b)
+    {
+        for (unsigned i = 0; i < size; i += Ops::SIZE) {
+            Ops::store(out + i, Ops::add(Ops::load(a + i), Ops::load(b + i)));
+        }
+    }
+};
+
+/*!
+ * \brief Run a kernel with the widest vectors that fit into _size_, which is a
+ *        power of two.
+ */
+template <class Kernel, typename... Args>
+inline void run(unsigned size, Args... args)
+{
+#ifdef POLARCODE_AVX512
+    if (size >= Avx512Ops::SIZE) {
+        Kernel::template apply<Avx512Ops>(size, args...);
+        return;
+    }
+#endif
+    if (size >= AvxOps::SIZE) {
+        Kernel::template apply<AvxOps>(size, args...);
+    } else {
+        Kernel::template apply<ScalarOps>(size, args...);
+    }
+}
+
+} // namespace
+
 Scan::Scan(size_t blockLength,
            unsigned iterationLimit,
            const std::vector<unsigned>& frozenBits)
+    : mLlr(nullptr),
+      mEven(nullptr),
+      mOdd(nullptr),
+      mIterationCount(0),
+      mEarlyTermination(false)
 {
     initialize(blockLength, iterationLimit, frozenBits);
 }
 
-Scan::~Scan() {}
+Scan::~Scan() { clear(); }
+
+void Scan::clear()
+{
+    alignedFree(mLlr);
+    alignedFree(mEven);
+    alignedFree(mOdd);
+}
 
 void Scan::setIterationLimit(unsigned iterationLimit)
 {
     mIterationLimit = iterationLimit;
 }
 
+void Scan::setEarlyTermination(bool enable) { mEarlyTermination = enable; }
+
 void Scan::initialize(size_t blockLength,
                       unsigned iterationLimit,
                       const std::vector<unsigned>& frozenBits)
 {
+    mIterationLimit = iterationLimit;
+    if (blockLength == mBlockLength && frozenBits == mFrozenBits) {
+        return;
+    }
+    if (mBlockLength != 0) {
+        clear();
+        delete mLlrContainer;
+        delete mBitContainer;
+        delete[] mOutputContainer;
+    }
     mBlockLength = blockLength;
     mFrozenBits.assign(frozenBits.begin(), frozenBits.end());
-    mIterationLimit = iterationLimit;
 
     mN = log2(blockLength);
     mLevelCount = mN + 1;
 
     {
-        mBooleanFrozen.resize(mBlockLength);
-        unsigned idx = 0;
-        for (unsigned i = 0; i < mBlockLength; ++i) {
-            if (i == mFrozenBits[idx]) {
-                mBooleanFrozen[i] = true;
-                ++idx;
-            } else {
-                mBooleanFrozen[i] = false;
-            }
+        mBooleanFrozen.assign(mBlockLength, false);
+        for (unsigned i : mFrozenBits) {
+            mBooleanFrozen[i] = true;
         }
     }
 
-    mLlrContainer = new FloatContainer(mBlockLength, mFrozenBits);
+    // Level l holds blockLength >> l messages, levels are stored back to back
+    mLlr = static_cast<float*>(alignedAlloc(2 * mBlockLength * sizeof(float), 64));
+    mEven = static_cast<float*>(alignedAlloc(2 * mBlockLength * sizeof(float), 64));
+    // Levels 1 to n hold all their odd groups, blockLength / 2 messages each
+    mOdd =
+        static_cast<float*>(alignedAlloc(mN * mBlockLength / 2 * sizeof(float), 64));
+
+    // The channel LLRs are level 0 of mLlr
+    mLlrContainer = new FloatContainer(mLlr, mBlockLength);
+    mLlrContainer->setFrozenBits(mFrozenBits);
     mBitContainer = new FloatContainer(mBlockLength, mFrozenBits);
-    mOutputContainer = new unsigned char[(mBlockLength + 7) / 8];
+    mOutputContainer = new unsigned char[(mBlockLength - mFrozenBits.size() + 7) / 8];
+    mPreviousOutput.resize((mBlockLength - mFrozenBits.size() + 7) / 8);
+}
 
-    mSystematicOutput.resize(mBlockLength);
-    mLlr.resize(2 * mBlockLength - 1);
-    mEven.resize(2 * mBlockLength - 1);
-    mOdd.resize(mLevelCount * mBlockLength / 2);
+float* Scan::llr(unsigned level)
+{
+    return mLlr + 2 * mBlockLength - (2 * mBlockLength >> level);
 }
 
-static inline unsigned evenIndex(unsigned n, unsigned level, unsigned bit)
+float* Scan::even(unsigned level)
 {
-    return bit + (1 << (n + 1)) - (1 << (n + 1 - level));
+    return mEven + 2 * mBlockLength - (2 * mBlockLength >> level);
 }
 
-static inline unsigned oddIndex(unsigned n, unsigned level, unsigned group, unsigned bit)
+float* Scan::odd(unsigned level, unsigned group)
 {
-    if (level == n) {
-        // Left shift by -1 is invalid. Instead, do the correct right shift.
-        return bit + (group >> 1) + ((level - 1) << (n - 1));
-    } else {
-        return bit + ((group - 1) << (n - 1 - level)) + ((level - 1) << (n - 1));
-    }
+    return mOdd + (level - 1) * mBlockLength / 2 + (group >> 1) * (mBlockLength >> level);
 }
 
 void Scan::updatellrmap(unsigned level, unsigned group)
 {
     if (level == 0)
         return;
-    unsigned leftGroup = group / 2;
     if ((group & 1) == 0) {
-        updatellrmap(level - 1, leftGroup);
+        updatellrmap(level - 1, group / 2);
     }
     unsigned groupSize = 1 << (mN - level);
+    PC_PROFILE_NODE("Scan::updatellrmap", groupSize);
 
     if (group & 1) {
-        for (unsigned node = 0; node < groupSize; ++node) {
-            mLlr[evenIndex(mN, level, node)] =
-                mLlr[evenIndex(mN, level - 1, 2 * node + 1)] +
-                TemplatizedFloatCalc::F_function_calc(
-                    mLlr[evenIndex(mN, level - 1, 2 * node)],
-                    mEven[evenIndex(mN, level, node)]);
-#ifdef SCAN_DEBUG_OUTPUT
-            std::cout << "L(" << level << "," << node << ") = "
-                      << "L(" << (level - 1) << "," << (2 * node + 1) << ") + "
-                      << "L(" << (level - 1) << "," << (2 * node) << ") BP "
-                      << "E(" << level << "," << node
-                      << "): " << mLlr[evenIndex(mN, level, node)] << " = "
-                      << mLlr[evenIndex(mN, level - 1, 2 * node + 1)] << " + "
-                      << mLlr[evenIndex(mN, level - 1, 2 * node)] << " BP "
-                      << mEven[evenIndex(mN, level, node)] << std::endl;
-#endif
-        }
+        run<OddGroupLlr>(groupSize, llr(level), llr(level - 1), even(level));
     } else {
-        for (unsigned node = 0; node < groupSize; ++node) {
-            float t = mLlr[evenIndex(mN, level - 1, 2 * node + 1)] +
-                      mOdd[oddIndex(mN, level, group + 1, node)];
-            mLlr[evenIndex(mN, level, node)] = TemplatizedFloatCalc::F_function_calc(
-                mLlr[evenIndex(mN, level - 1, 2 * node)], t);
-#ifdef SCAN_DEBUG_OUTPUT
-            std::cout << "L(" << level << "," << node << ") = "
-                      << "L(" << (level - 1) << "," << (2 * node) << ") BP ["
-                      << "L(" << (level - 1) << "," << (2 * node + 1) << ") + "
-                      << "O(" << level << "," << (group + 1) << "," << node
-                      << ")]: " << mLlr[evenIndex(mN, level, node)] << " = "
-                      << mLlr[evenIndex(mN, level - 1, 2 * node)] << " BP ["
-                      << mLlr[evenIndex(mN, level - 1, 2 * node + 1)] << " + "
-                      << mOdd[oddIndex(mN, level, group + 1, node)] << "]" << std::endl;
-#endif
-        }
+        run<EvenGroupLlr>(groupSize, llr(level), llr(level - 1), odd(level, group + 1));
     }
 }
 
@@ -130,177 +269,89 @@ void Scan::updatebitmap(unsigned level, unsigned group)
     if (group & 1) {
         unsigned leftGroup = group / 2;
         unsigned groupSize = 1 << (mN - level);
-        if (leftGroup & 1) {
-            for (unsigned node = 0; node < groupSize; ++node) {
-                float t = mOdd[oddIndex(mN, level, group, node)] +
-                          mLlr[evenIndex(mN, level - 1, 2 * node + 1)];
-                mOdd[oddIndex(mN, level - 1, leftGroup, 2 * node)] =
-                    TemplatizedFloatCalc::F_function_calc(
-                        mEven[evenIndex(mN, level, node)], t);
-#ifdef SCAN_DEBUG_OUTPUT
-                std::cout << "O(" << (level - 1) << "," << leftGroup << "," << (2 * node)
-                          << ") = "
-                          << "E(" << level << "," << node << ") BP ["
-                          << "O(" << level << "," << group << "," << node << ") + "
-                          << "L(" << (level - 1) << "," << (2 * node + 1)
-                          << ")]: " << mOdd[oddIndex(mN, level - 1, leftGroup, 2 * node)]
-                          << " = " << mEven[evenIndex(mN, level, node)] << " BP ["
-                          << mOdd[oddIndex(mN, level, group, node)] << " + "
-                          << mLlr[evenIndex(mN, level - 1, 2 * node + 1)] << "]"
-                          << std::endl;
-#endif
+        PC_PROFILE_NODE("Scan::updatebitmap", groupSize);
 
-                mOdd[oddIndex(mN, level - 1, leftGroup, 2 * node + 1)] =
-                    mOdd[oddIndex(mN, level, group, node)] +
-                    TemplatizedFloatCalc::F_function_calc(
-                        mEven[evenIndex(mN, level, node)],
-                        mLlr[evenIndex(mN, level - 1, 2 * node)]);
-#ifdef SCAN_DEBUG_OUTPUT
-                std::cout << "O(" << (level - 1) << "," << leftGroup << ","
-                          << (2 * node + 1) << ") = "
-                          << "O(" << level << "," << group << "," << node << ") + "
-                          << "E(" << level << "," << node << ") BP "
-                          << "L(" << (level - 1) << "," << (2 * node) << "): "
-                          << mOdd[oddIndex(mN, level - 1, leftGroup, 2 * node + 1)]
-                          << " = " << mOdd[oddIndex(mN, level, group, node)] << " + "
-                          << mEven[evenIndex(mN, level, node)] << " BP "
-                          << mLlr[evenIndex(mN, level - 1, 2 * node)] << std::endl;
-#endif
-            }
-        } else {
-            for (unsigned node = 0; node < groupSize; ++node) {
-                float t = mOdd[oddIndex(mN, level, group, node)] +
-                          mLlr[evenIndex(mN, level - 1, 2 * node + 1)];
-                mEven[evenIndex(mN, level - 1, 2 * node)] =
-                    TemplatizedFloatCalc::F_function_calc(
-                        mEven[evenIndex(mN, level, node)], t);
-#ifdef SCAN_DEBUG_OUTPUT
-                std::cout << "E(" << (level - 1) << "," << (2 * node) << ") = "
-                          << "E(" << level << "," << node << ") BP ["
-                          << "O(" << level << "," << group << "," << node << ") + "
-                          << "L(" << (level - 1) << "," << (2 * node + 1)
-                          << ")]: " << mEven[evenIndex(mN, level - 1, 2 * node)] << " = "
-                          << mEven[evenIndex(mN, level, node)] << " BP ["
-                          << mOdd[oddIndex(mN, level, group, node)] << " + "
-                          << mLlr[evenIndex(mN, level - 1, 2 * node + 1)] << "]"
-                          << std::endl;
-#endif
+        float* bits = (leftGroup & 1) ? odd(level - 1, leftGroup) : even(level - 1);
+        run<GroupBits>(groupSize, bits, llr(level - 1), even(level), odd(level, group));
 
-                mEven[evenIndex(mN, level - 1, 2 * node + 1)] =
-                    mOdd[oddIndex(mN, level, group, node)] +
-                    TemplatizedFloatCalc::F_function_calc(
-                        mEven[evenIndex(mN, level, node)],
-                        mLlr[evenIndex(mN, level - 1, 2 * node)]);
-#ifdef SCAN_DEBUG_OUTPUT
-                std::cout << "E(" << (level - 1) << "," << (2 * node + 1) << ") = "
-                          << "O(" << level << "," << group << "," << node << ") + "
-                          << "E(" << level << "," << node << ") BP "
-                          << "L(" << (level - 1) << "," << (2 * node)
-                          << "): " << mEven[evenIndex(mN, level - 1, 2 * node + 1)]
-                          << " = " << mOdd[oddIndex(mN, level, group, node)] << " + "
-                          << mEven[evenIndex(mN, level, node)] << " BP "
-                          << mLlr[evenIndex(mN, level - 1, 2 * node)] << std::endl;
-#endif
-            }
-        }
         if (leftGroup & 1) {
             updatebitmap(level - 1, leftGroup);
         }
     }
 }
 
-inline unsigned int bit_reverse(unsigned int v, unsigned int nbits)
-{
-    v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
-    v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
-    v = ((v >> 4) & 0x0F0F0F0F) | ((v & 0x0F0F0F0F) << 4);
-    v = ((v >> 8) & 0x00FF00FF) | ((v & 0x00FF00FF) << 8);
-    v = (v >> 16) | (v << 16);
-    v >>= (32 - nbits);
-    return v;
-}
-
 bool Scan::decode()
 {
-    mLlr.assign(mLlr.size(), 0.0f);
-    mEven.assign(mEven.size(), 0.0f);
-    mOdd.assign(mOdd.size(), 0.0f);
-
-    float* channelLlr = dynamic_cast<FloatContainer*>(mLlrContainer)->data();
-    // L(0,0,i) LLRs from channel
-    for (unsigned i = 0; i < mBlockLength; ++i) {
-        mLlr[evenIndex(mN, 0, bit_reverse(i, mN))] = channelLlr[i];
-    }
+    PC_PROFILE_DECODER(&mNodeProfile);
+    memset(mEven, 0, 2 * mBlockLength * sizeof(float));
+    memset(mOdd, 0, mN * mBlockLength / 2 * sizeof(float));
 
     for (unsigned i = 1; i < mBlockLength; i += 2) {
         if (mBooleanFrozen[i]) {
-#ifdef SCAN_DEBUG_OUTPUT
-            std::cout << "O(" << mN << "," << i << ",0) = inf" << std::endl;
-#endif
-            mOdd[oddIndex(mN, mN, i, 0)] = INFINITY;
+            *odd(mN, i) = INFINITY;
         }
     }
 
-    // Decoding
-    for (unsigned i = 0; i < mIterationLimit; ++i) {
-#ifdef SCAN_DEBUG_OUTPUT
-        std::cout << "Iteration " << i << std::endl;
-#endif
+    // The bit LLRs are the non-systematic output
+    float* bitLlr = dynamic_cast<FloatContainer*>(mBitContainer)->data();
+    bool success = false;
+
+    for (mIterationCount = 0; mIterationCount < mIterationLimit;) {
         for (unsigned group = 0; group < mBlockLength; ++group) {
-#ifdef SCAN_DEBUG_OUTPUT
-            std::cout << "Group " << group << std::endl;
-#endif
             updatellrmap(mN, group);
-            mSystematicOutput[group] = mLlr[evenIndex(mN, mN, 0)];
+            float* bit = (group & 1) ? odd(mN, group) : even(mN);
+            if ((group & 1) == 0) {
+                *bit = mBooleanFrozen[group] ? INFINITY : 0.0f;
+            }
+            bitLlr[group] = *llr(mN) + *bit;
             if (group & 1) {
-                mSystematicOutput[group] += mOdd[oddIndex(mN, mN, group, 0)];
                 updatebitmap(mN, group);
-            } else {
-                if (mBooleanFrozen[group]) {
-                    mEven[evenIndex(mN, mN, 0)] = INFINITY;
-#ifdef SCAN_DEBUG_OUTPUT
-                    std::cout << "E(" << mN << ",0) = inf" << std::endl;
-#endif
-                } else {
-                    mEven[evenIndex(mN, mN, 0)] = 0.0f;
-#ifdef SCAN_DEBUG_OUTPUT
-                    std::cout << "E(" << mN << ",0) = 0" << std::endl;
-#endif
-                }
-                mSystematicOutput[group] += mEven[evenIndex(mN, mN, 0)];
             }
         }
-    }
+        ++mIterationCount;
 
-    float* outputLlr = dynamic_cast<FloatContainer*>(mBitContainer)->data();
-
-    if (mSystematic) {
-        // apply extrinsic LLRs
-        for (unsigned i = 0; i < mBlockLength; i++) {
-            unsigned idx = evenIndex(mN, 0, i);
-            mLlr[idx] += mEven[idx];
-        }
-
-        for (unsigned i = 0; i < mBlockLength; i++) {
-            outputLlr[i] = mLlr[evenIndex(mN, 0, bit_reverse(i, mN))];
-        }
-    } else {
-        for (unsigned i = 0; i < mBlockLength; i++) {
-            outputLlr[i] = mSystematicOutput[bit_reverse(i, mN)];
+        if (mEarlyTermination || mIterationCount == mIterationLimit) {
+            calculateOutput();
+            success = mErrorDetector->check(mOutputContainer,
+                                            (mBlockLength - mFrozenBits.size() + 7) / 8);
+            if (mEarlyTermination && stop(success)) {
+                break;
+            }
         }
     }
+    return success;
+}
 
+void Scan::calculateOutput()
+{
+    if (mSystematic) {
+        // Channel plus extrinsic LLRs
+        float* outputLlr = dynamic_cast<FloatContainer*>(mBitContainer)->data();
+        run<Sum>(mBlockLength, outputLlr, llr(0), even(0));
+    }
     mBitContainer->getPackedInformationBits(mOutputContainer);
-    bool result = mErrorDetector->check(mOutputContainer,
-                                        (mBlockLength - mFrozenBits.size() + 7) / 8);
-    return result;
 }
 
-void Scan::getExtrinsicChannelInformation(float* eLlr)
+bool Scan::stop(bool success)
 {
-    for (unsigned i = 0; i < mBlockLength; i++) {
-        eLlr[i] = mEven[evenIndex(mN, 0, bit_reverse(i, mN))];
+    if (success && mErrorDetector->getCheckBitCount() > 0) {
+        return true;
     }
+    bool converged =
+        mIterationCount > 1 &&
+        memcmp(mPreviousOutput.data(), mOutputContainer, mPreviousOutput.size()) == 0;
+    memcpy(mPreviousOutput.data(), mOutputContainer, mPreviousOutput.size());
+    return converged;
+}
+
+void Scan::getExtrinsicChannelInformation(float* eLlr)
+{
+    memcpy(eLlr, even(0), mBlockLength * sizeof(float));
+}
+
+void Scan::getPosteriorChannelInformation(float* pLlr)
+{
+    run<Sum>(mBlockLength, pLlr, llr(0), even(0));
 }
 
 } // namespace Decoding
@@ -6,51 +6,60 @@
  *
  */
 
+#include <polarcode/alignedmemory.h>
 #include <polarcode/arrayfuncs.h>
 #include <polarcode/decoding/scl_avx_float.h>
 #include <polarcode/polarcode.h>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 namespace PolarCode {
 namespace Decoding {
 
 namespace SclAvx {
 
-PathList::PathList() {}
+PathList::PathList() : mPathCount(0), mArena(nullptr) {}
 
-PathList::PathList(size_t listSize, size_t stageCount, datapool_t* dataPool)
+PathList::PathList(size_t listSize, size_t stageCount)
     : mPathLimit(listSize),
       mPathCount(0),
       mNextPathCount(0),
-      mStageCount(stageCount),
-      xmDataPool(dataPool)
+      mStageCount(stageCount)
 {
-    mLlrTree.resize(listSize);
-    mBitTree.resize(listSize);
-    mLeftBitTree.resize(listSize);
+    const size_t slotCount = listSize * stageCount;
+    mLlrTree.assign(slotCount, patharena_t::noSlot);
+    mBitTree.assign(slotCount, patharena_t::noSlot);
+    mLeftBitTree.assign(slotCount, patharena_t::noSlot);
     mMetric.assign(listSize, 0);
-    mNextLlrTree.resize(listSize);
-    mNextBitTree.resize(listSize);
-    mNextLeftBitTree.resize(listSize);
+    mNextLlrTree.assign(slotCount, patharena_t::noSlot);
+    mNextBitTree.assign(slotCount, patharena_t::noSlot);
+    mNextLeftBitTree.assign(slotCount, patharena_t::noSlot);
     mNextMetric.assign(listSize, 0);
-    for (unsigned i = 0; i < mPathLimit; ++i) {
-        mLlrTree[i].resize(stageCount);
-        mBitTree[i].resize(stageCount);
-        mLeftBitTree[i].resize(stageCount);
-        mNextLlrTree[i].resize(stageCount);
-        mNextBitTree[i].resize(stageCount);
-        mNextLeftBitTree[i].resize(stageCount);
+
+    // Every path holds three slots per stage. Writing to a lazy copy swaps a
+    // shared slot for a private one, so no stage ever needs more.
+    std::vector<size_t> stageSize(stageCount);
+    for (unsigned stage = 0; stage < stageCount; ++stage) {
+        stageSize[stage] = nBit2fCount(1 << stage);
     }
+    mArena = new patharena_t(stageSize, 3 * listSize);
 }
 
-PathList::~PathList() { clear(); }
+PathList::~PathList()
+{
+    if (mArena != nullptr) {
+        clear();
+        delete mArena;
+    }
+}
 
 void PathList::clear()
 {
     for (unsigned path = 0; path < mPathCount; ++path) {
-        xmDataPool->release(mLlrTree[path][mStageCount - 1]);
-        xmDataPool->release(mBitTree[path][mStageCount - 1]);
-        xmDataPool->release(mLeftBitTree[path][mStageCount - 1]);
+        mArena->release(mLlrTree[index(path, mStageCount - 1)]);
+        mArena->release(mBitTree[index(path, mStageCount - 1)]);
+        mArena->release(mLeftBitTree[index(path, mStageCount - 1)]);
     }
     mPathCount = 0;
 }
@@ -58,35 +67,35 @@ void PathList::clear()
 void PathList::duplicatePath(unsigned destination, unsigned source, unsigned stage)
 {
     for (unsigned i = stage; i < mStageCount; ++i) {
-        mNextLlrTree[destination][i] = xmDataPool->lazyDuplicate(mLlrTree[source][i]);
-        mNextBitTree[destination][i] = xmDataPool->lazyDuplicate(mBitTree[source][i]);
-        mNextLeftBitTree[destination][i] =
-            xmDataPool->lazyDuplicate(mLeftBitTree[source][i]);
+        const unsigned from = index(source, i), to = index(destination, i);
+        mNextLlrTree[to] = mArena->lazyDuplicate(mLlrTree[from]);
+        mNextBitTree[to] = mArena->lazyDuplicate(mBitTree[from]);
+        mNextLeftBitTree[to] = mArena->lazyDuplicate(mLeftBitTree[from]);
     }
 }
 
 void PathList::getWriteAccessToLlr(unsigned path, unsigned stage)
 {
-    xmDataPool->prepareForWrite(mLlrTree[path][stage]);
+    mArena->prepareForWrite(mLlrTree[index(path, stage)]);
 }
 
 void PathList::getWriteAccessToBit(unsigned path, unsigned stage)
 {
-    xmDataPool->prepareForWrite(mBitTree[path][stage]);
+    mArena->prepareForWrite(mBitTree[index(path, stage)]);
 }
 
 void PathList::getWriteAccessToNextBit(unsigned path, unsigned stage)
 {
-    xmDataPool->prepareForWrite(mNextBitTree[path][stage]);
+    mArena->prepareForWrite(mNextBitTree[index(path, stage)]);
 }
 
 void PathList::clearOldPaths(unsigned stage)
 {
     for (unsigned path = 0; path < mPathCount; ++path) {
         for (unsigned i = stage; i < mStageCount; ++i) {
-            xmDataPool->release(mLlrTree[path][i]);
-            xmDataPool->release(mBitTree[path][i]);
-            xmDataPool->release(mLeftBitTree[path][i]);
+            mArena->release(mLlrTree[index(path, i)]);
+            mArena->release(mBitTree[index(path, i)]);
+            mArena->release(mLeftBitTree[index(path, i)]);
         }
     }
 }
@@ -103,6 +112,7 @@ void PathList::switchToNext()
 void PathList::setFirstPath(void* pLlr)
 {
     mPathCount = 1;
+    mMetric[0] = 0; // Metrics must not carry over from the previous frame
     allocateStage(mStageCount - 1);
 
     memcpy(Llr(0, mStageCount-1), pLlr, 2<<mStageCount /* 4*bitCount = 4*(1<<stage) =  4*(1<<(stageCount-1)) = 2*(1<<stageCount) = 2<<stageCount */);
@@ -110,54 +120,53 @@ void PathList::setFirstPath(void* pLlr)
 
 void PathList::allocateStage(unsigned stage)
 {
-    unsigned expandedBitCount = nBit2fCount(1 << stage);
     for (unsigned path = 0; path < mPathCount; ++path) {
-        mLlrTree[path][stage] = xmDataPool->allocate(expandedBitCount);
-        mBitTree[path][stage] = xmDataPool->allocate(expandedBitCount);
-        mLeftBitTree[path][stage] = xmDataPool->allocate(expandedBitCount);
+        mLlrTree[index(path, stage)] = mArena->allocate(stage);
+        mBitTree[index(path, stage)] = mArena->allocate(stage);
+        mLeftBitTree[index(path, stage)] = mArena->allocate(stage);
     }
 }
 
 void PathList::clearStage(unsigned stage)
 {
     for (unsigned path = 0; path < mPathCount; ++path) {
-        xmDataPool->release(mLlrTree[path][stage]);
-        xmDataPool->release(mBitTree[path][stage]);
-        xmDataPool->release(mLeftBitTree[path][stage]);
+        mArena->release(mLlrTree[index(path, stage)]);
+        mArena->release(mBitTree[index(path, stage)]);
+        mArena->release(mLeftBitTree[index(path, stage)]);
     }
 }
 
 float* PathList::Llr(unsigned path, unsigned stage)
 {
-    return mLlrTree[path][stage]->data;
+    return mArena->data(mLlrTree[index(path, stage)]);
 }
 
 float* PathList::Bit(unsigned path, unsigned stage)
 {
-    return mBitTree[path][stage]->data;
+    return mArena->data(mBitTree[index(path, stage)]);
 }
 
 float* PathList::LeftBit(unsigned path, unsigned stage)
 {
-    return mLeftBitTree[path][stage]->data;
+    return mArena->data(mLeftBitTree[index(path, stage)]);
 }
 
 void PathList::prepareRightDecoding(unsigned stage)
 {
     for (unsigned path = 0; path < mPathCount; ++path) {
-        std::swap(mBitTree[path][stage], mLeftBitTree[path][stage]);
-        xmDataPool->prepareForWrite(mLlrTree[path][stage]);
+        std::swap(mBitTree[index(path, stage)], mLeftBitTree[index(path, stage)]);
+        mArena->prepareForWrite(mLlrTree[index(path, stage)]);
     }
 }
 
 float* PathList::NextLlr(unsigned path, unsigned stage)
 {
-    return mNextLlrTree[path][stage]->data;
+    return mArena->data(mNextLlrTree[index(path, stage)]);
 }
 
 float* PathList::NextBit(unsigned path, unsigned stage)
 {
-    return mNextBitTree[path][stage]->data;
+    return mArena->data(mNextBitTree[index(path, stage)]);
 }
 
 float& PathList::Metric(unsigned path) { return mMetric[path]; }
@@ -170,10 +179,24 @@ unsigned PathList::PathLimit() { return mPathLimit; }
 
 void PathList::setNextPathCount(unsigned pc) { mNextPathCount = pc; }
 
-Node::Node() {}
+Workspace::Workspace(size_t blockLength, size_t listSize)
+    : indices(std::max(blockLength, listSize * 8)),
+      metrics(listSize * 8),
+      bitFlipHints(listSize * 8),
+      bitFlipCount(listSize * 8),
+      results(listSize * 2)
+{
+    // Leaves shorter than a vector still load and store a whole one
+    const size_t tempBytes = std::max<size_t>(8, blockLength) * sizeof(float);
+    temp = static_cast<float*>(alignedAlloc(tempBytes, 32));
+    memset(temp, 0, tempBytes);
+}
+
+Workspace::~Workspace() { alignedFree(temp); }
 
 Node::Node(Node* other)
-    : xmDataPool(other->xmDataPool),
+    : xmMemory(other->xmMemory),
+      xmWorkspace(other->xmWorkspace),
       mBlockLength(other->mBlockLength),
       mBitCount(other->mBitCount),
       mStage(other->mStage),
@@ -182,8 +205,13 @@ Node::Node(Node* other)
 {
 }
 
-Node::Node(size_t blockLength, size_t listSize, datapool_t* pool, PathList* pathList)
-    : xmDataPool(pool),
+Node::Node(size_t blockLength,
+           size_t listSize,
+           NodeMemory* memory,
+           Workspace* workspace,
+           PathList* pathList)
+    : xmMemory(memory),
+      xmWorkspace(workspace),
       mBlockLength(blockLength),
       mBitCount(nBit2fCount(blockLength)),
       mStage(__builtin_ctz(blockLength)),
@@ -196,7 +224,7 @@ Node::~Node() {}
 
 void Node::decode() {}
 
-datapool_t* Node::pool() { return xmDataPool; }
+NodeMemory* Node::memory() { return xmMemory; }
 
 size_t Node::blockLength() { return mBlockLength; }
 
@@ -206,64 +234,71 @@ SclAvx::PathList* Node::pathList() { return xmPathList; }
  * (Short)RateRNode
  * ***********/
 
-RateRNode::RateRNode() {}
-
-RateRNode::RateRNode(const std::vector<unsigned>& frozenBits, Node* parent) : Node(parent)
+RateRNode::RateRNode(const DecoderPlan::Node* plan, Node* parent) : Node(parent)
 {
     mBlockLength /= 2;
     mStage -= 1;
 
-    std::vector<unsigned> leftFrozenBits, rightFrozenBits;
-    splitFrozenBits(frozenBits, mBlockLength, leftFrozenBits, rightFrozenBits);
-
-    mLeft = createDecoder(leftFrozenBits, this);
-    mRight = createDecoder(rightFrozenBits, this);
+    mLeft = createDecoder(plan->left, this);
+    mRight = createDecoder(plan->right, this);
 }
 
 RateRNode::~RateRNode()
 {
-    delete mLeft;
-    delete mRight;
+    // Children live in the decoder's NodeMemory, which frees them as a whole
+    mLeft->~Node();
+    mRight->~Node();
 }
 
 void RateRNode::decode()
 {
-    xmPathList->allocateStage(mStage);
+    unsigned pathCount;
 
-    unsigned pathCount = xmPathList->PathCount();
-    for (unsigned path = 0; path < pathCount; ++path) {
-        FastSscAvx::F_function(xmPathList->Llr(path, mStage + 1),
-                               xmPathList->Llr(path, mStage),
-                               mBlockLength);
+    {
+        PC_PROFILE_NODE("SclAvx::RateRNode F", mBlockLength);
+        xmPathList->allocateStage(mStage);
+
+        pathCount = xmPathList->PathCount();
+        for (unsigned path = 0; path < pathCount; ++path) {
+            FastSscAvx::F_function(xmPathList->Llr(path, mStage + 1),
+                                   xmPathList->Llr(path, mStage),
+                                   mBlockLength);
+        }
     }
 
     mLeft->decode();
 
-    xmPathList->prepareRightDecoding(mStage);
-    pathCount = xmPathList->PathCount();
-    for (unsigned path = 0; path < pathCount; ++path) {
-        FastSscAvx::G_function(xmPathList->Llr(path, mStage + 1),
-                               xmPathList->Llr(path, mStage),
-                               xmPathList->LeftBit(path, mStage),
-                               mBlockLength);
+    {
+        PC_PROFILE_NODE("SclAvx::RateRNode G", mBlockLength);
+        xmPathList->prepareRightDecoding(mStage);
+        pathCount = xmPathList->PathCount();
+        for (unsigned path = 0; path < pathCount; ++path) {
+            FastSscAvx::G_function(xmPathList->Llr(path, mStage + 1),
+                                   xmPathList->Llr(path, mStage),
+                                   xmPathList->LeftBit(path, mStage),
+                                   mBlockLength);
+        }
     }
 
     mRight->decode();
 
-    pathCount = xmPathList->PathCount();
-    for (unsigned path = 0; path < pathCount; ++path) {
-        xmPathList->getWriteAccessToBit(path, mStage + 1);
-        FastSscAvx::CombineBitsLong(xmPathList->LeftBit(path, mStage),
-                                    xmPathList->Bit(path, mStage),
-                                    xmPathList->Bit(path, mStage + 1),
-                                    mBlockLength);
-    }
+    {
+        PC_PROFILE_NODE("SclAvx::RateRNode Combine", mBlockLength);
+        pathCount = xmPathList->PathCount();
+        for (unsigned path = 0; path < pathCount; ++path) {
+            xmPathList->getWriteAccessToBit(path, mStage + 1);
+            FastSscAvx::CombineBitsLong(xmPathList->LeftBit(path, mStage),
+                                        xmPathList->Bit(path, mStage),
+                                        xmPathList->Bit(path, mStage + 1),
+                                        mBlockLength);
+        }
 
-    xmPathList->clearStage(mStage);
+        xmPathList->clearStage(mStage);
+    }
 }
 
-ShortRateRNode::ShortRateRNode(const std::vector<unsigned>& frozenBits, Node* parent)
-    : RateRNode(frozenBits, parent)
+ShortRateRNode::ShortRateRNode(const DecoderPlan::Node* plan, Node* parent)
+    : RateRNode(plan, parent)
 {
 }
 
@@ -272,38 +307,49 @@ ShortRateRNode::~ShortRateRNode() {}
 
 void ShortRateRNode::decode()
 {
-    xmPathList->allocateStage(mStage);
+    unsigned pathCount;
 
-    unsigned pathCount = xmPathList->PathCount();
-    for (unsigned path = 0; path < pathCount; ++path) {
-        FastSscAvx::F_function(xmPathList->Llr(path, mStage + 1),
-                               xmPathList->Llr(path, mStage),
-                               mBlockLength);
+    {
+        PC_PROFILE_NODE("SclAvx::ShortRateRNode F", mBlockLength);
+        xmPathList->allocateStage(mStage);
+
+        pathCount = xmPathList->PathCount();
+        for (unsigned path = 0; path < pathCount; ++path) {
+            FastSscAvx::F_function(xmPathList->Llr(path, mStage + 1),
+                                   xmPathList->Llr(path, mStage),
+                                   mBlockLength);
+        }
     }
 
     mLeft->decode();
 
-    xmPathList->prepareRightDecoding(mStage);
-    pathCount = xmPathList->PathCount();
-    for (unsigned path = 0; path < pathCount; ++path) {
-        FastSscAvx::G_function(xmPathList->Llr(path, mStage + 1),
-                               xmPathList->Llr(path, mStage),
-                               xmPathList->LeftBit(path, mStage),
-                               mBlockLength);
+    {
+        PC_PROFILE_NODE("SclAvx::ShortRateRNode G", mBlockLength);
+        xmPathList->prepareRightDecoding(mStage);
+        pathCount = xmPathList->PathCount();
+        for (unsigned path = 0; path < pathCount; ++path) {
+            FastSscAvx::G_function(xmPathList->Llr(path, mStage + 1),
+                                   xmPathList->Llr(path, mStage),
+                                   xmPathList->LeftBit(path, mStage),
+                                   mBlockLength);
+        }
     }
 
     mRight->decode();
 
-    pathCount = xmPathList->PathCount();
-    for (unsigned path = 0; path < pathCount; ++path) {
-        xmPathList->getWriteAccessToBit(path, mStage + 1);
-        FastSscAvx::CombineBitsShort(xmPathList->LeftBit(path, mStage),
-                                     xmPathList->Bit(path, mStage),
-                                     xmPathList->Bit(path, mStage + 1),
-                                     mBlockLength);
-    }
+    {
+        PC_PROFILE_NODE("SclAvx::ShortRateRNode Combine", mBlockLength);
+        pathCount = xmPathList->PathCount();
+        for (unsigned path = 0; path < pathCount; ++path) {
+            xmPathList->getWriteAccessToBit(path, mStage + 1);
+            FastSscAvx::CombineBitsShort(xmPathList->LeftBit(path, mStage),
+                                         xmPathList->Bit(path, mStage),
+                                         xmPathList->Bit(path, mStage + 1),
+                                         mBlockLength);
+        }
 
-    xmPathList->clearStage(mStage);
+        xmPathList->clearStage(mStage);
+    }
 }
 
 /*************
@@ -315,6 +361,7 @@ RateZeroDecoder::~RateZeroDecoder() {}
 
 void RateZeroDecoder::decode()
 {
+    PC_PROFILE_NODE("SclAvx::RateZeroDecoder", mBlockLength);
     const __m256 zero = _mm256_setzero_ps();
     const __m256 inf = _mm256_set1_ps(INFINITY);
     unsigned pathCount = xmPathList->PathCount();
@@ -339,19 +386,21 @@ void RateZeroDecoder::decode()
 /*************
  * RateOneDecoder
  * ***********/
-RateOneDecoder::RateOneDecoder(Node* parent) : Node(parent)
+RateOneDecoder::RateOneDecoder(Node* parent)
+    : Node(parent),
+      mIndices(xmWorkspace->indices),
+      mMetrics(xmWorkspace->metrics),
+      mBitFlipHints(xmWorkspace->bitFlipHints),
+      mBitFlipCount(xmWorkspace->bitFlipCount),
+      mTemp(xmWorkspace->temp)
 {
-    mIndices.resize(std::max(mBlockLength, mListSize * 4));
-    mMetrics.resize(mListSize * 4);
-    mBitFlipHints.resize(mListSize * 4);
-    mTempBlock = xmDataPool->allocate(mBlockLength);
-    mTemp = mTempBlock->data;
 }
 
-RateOneDecoder::~RateOneDecoder() { xmDataPool->release(mTempBlock); }
+RateOneDecoder::~RateOneDecoder() {}
 
 void RateOneDecoder::decode()
 {
+    PC_PROFILE_NODE("SclAvx::RateOneDecoder", mBlockLength);
     const __m256 sgnMask = _mm256_set1_ps(-0.0);
     unsigned pathCount = xmPathList->PathCount();
 
@@ -372,10 +421,15 @@ void RateOneDecoder::decode()
         mMetrics[path * 4 + 2] = metric - mTemp[1];
         mMetrics[path * 4 + 3] = metric - mTemp[0] - mTemp[1];
 
-        mBitFlipHints[path * 4] = {};
-        mBitFlipHints[path * 4 + 1] = { mIndices[0] };
-        mBitFlipHints[path * 4 + 2] = { mIndices[1] };
-        mBitFlipHints[path * 4 + 3] = { mIndices[0], mIndices[1] };
+        mBitFlipHints[path * 4 + 1][0] = mIndices[0];
+        mBitFlipHints[path * 4 + 2][0] = mIndices[1];
+        mBitFlipHints[path * 4 + 3][0] = mIndices[0];
+        mBitFlipHints[path * 4 + 3][1] = mIndices[1];
+
+        mBitFlipCount[path * 4] = 0;
+        mBitFlipCount[path * 4 + 1] = 1;
+        mBitFlipCount[path * 4 + 2] = 1;
+        mBitFlipCount[path * 4 + 3] = 2;
     }
 
     unsigned newPathCount = std::min(pathCount * 4, (unsigned)mListSize);
@@ -404,8 +458,8 @@ void RateOneDecoder::decode()
             _mm256_store_ps(fBitDestination + i, Llr);
         }
 
-        for (unsigned index : mBitFlipHints[mIndices[path]]) {
-            iBitDestination[index] ^= 0x80000000U;
+        for (unsigned i = 0; i < mBitFlipCount[mIndices[path]]; ++i) {
+            iBitDestination[mBitFlipHints[mIndices[path]][i]] ^= 0x80000000U;
         }
     }
 
@@ -416,17 +470,19 @@ void RateOneDecoder::decode()
 /*************
  * RepetitionDecoder
  * ***********/
-RepetitionDecoder::RepetitionDecoder(Node* parent) : Node(parent)
+RepetitionDecoder::RepetitionDecoder(Node* parent)
+    : Node(parent),
+      mIndices(xmWorkspace->indices),
+      mMetrics(xmWorkspace->metrics),
+      mResults(xmWorkspace->results)
 {
-    mIndices.resize(mListSize * 2);
-    mMetrics.resize(mListSize * 2);
-    mResults.resize(mListSize * 2);
 }
 
 RepetitionDecoder::~RepetitionDecoder() {}
 
 void RepetitionDecoder::decode()
 {
+    PC_PROFILE_NODE("SclAvx::RepetitionDecoder", mBlockLength);
     const __m256 zero = _mm256_setzero_ps();
     unsigned pathCount = xmPathList->PathCount();
 
@@ -483,20 +539,21 @@ void RepetitionDecoder::decode()
 /*************
  * SpcDecoder
  * ***********/
-SpcDecoder::SpcDecoder(Node* parent) : Node(parent)
+SpcDecoder::SpcDecoder(Node* parent)
+    : Node(parent),
+      mIndices(xmWorkspace->indices),
+      mMetrics(xmWorkspace->metrics),
+      mBitFlipHints(xmWorkspace->bitFlipHints),
+      mBitFlipCount(xmWorkspace->bitFlipCount),
+      mTemp(xmWorkspace->temp)
 {
-    mIndices.resize(std::max(mBlockLength, mListSize * 8));
-    mMetrics.resize(mListSize * 8);
-    mBitFlipHints.resize(mListSize * 8);
-    mBitFlipCount.resize(mListSize * 8);
-    mTempBlock = xmDataPool->allocate(mBlockLength);
-    mTemp = mTempBlock->data;
 }
 
-SpcDecoder::~SpcDecoder() { xmDataPool->release(mTempBlock); }
+SpcDecoder::~SpcDecoder() {}
 
 void SpcDecoder::decode()
 {
+    PC_PROFILE_NODE("SclAvx::SpcDecoder", mBlockLength);
     const __m256 sgnMask = _mm256_set1_ps(-0.0);
     unsigned pathCount = xmPathList->PathCount();
 
@@ -621,32 +678,70 @@ void SpcDecoder::decode()
 }
 
 
-Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent)
+std::pair<unsigned, bool> classifyNode(const std::vector<unsigned>& frozenBits,
+                                       size_t blockLength)
 {
-    size_t blockLength = parent->blockLength();
     size_t frozenBitCount = frozenBits.size();
 
     if (frozenBitCount == 0) {
-        return new RateOneDecoder(parent);
+        return { RATE_ONE, false };
     }
 
     if (frozenBitCount == blockLength) {
-        return new RateZeroDecoder(parent);
+        return { RATE_ZERO, false };
     }
 
     if (frozenBitCount == blockLength - 1 && blockLength < 8) {
-        return new RepetitionDecoder(parent);
+        return { REPETITION, false };
     }
 
     if (frozenBitCount == 1) {
-        return new SpcDecoder(parent);
+        return { SPC, false };
     }
 
 
     if (blockLength <= 8) {
-        return new ShortRateRNode(frozenBits, parent);
+        return { SHORT_RATE_R, true };
     } else {
-        return new RateRNode(frozenBits, parent);
+        return { RATE_R, true };
+    }
+}
+
+DecoderPlan::NodeSize nodeSize(unsigned kind, size_t)
+{
+    // Path buffers come from the PathList, leaves share the Workspace
+    switch (kind) {
+    case RATE_ZERO:
+        return { sizeof(RateZeroDecoder), 0 };
+    case RATE_ONE:
+        return { sizeof(RateOneDecoder), 0 };
+    case REPETITION:
+        return { sizeof(RepetitionDecoder), 0 };
+    case SPC:
+        return { sizeof(SpcDecoder), 0 };
+    case SHORT_RATE_R:
+        return { sizeof(ShortRateRNode), 0 };
+    default:
+        return { sizeof(RateRNode), 0 };
+    }
+}
+
+Node* createDecoder(const DecoderPlan::Node* plan, Node* parent)
+{
+    NodeMemory* memory = parent->memory();
+    switch (plan->kind) {
+    case RATE_ZERO:
+        return memory->create<RateZeroDecoder>(plan, parent);
+    case RATE_ONE:
+        return memory->create<RateOneDecoder>(plan, parent);
+    case REPETITION:
+        return memory->create<RepetitionDecoder>(plan, parent);
+    case SPC:
+        return memory->create<SpcDecoder>(plan, parent);
+    case SHORT_RATE_R:
+        return memory->create<ShortRateRNode>(plan, plan, parent);
+    default:
+        return memory->create<RateRNode>(plan, plan, parent);
     }
 }
 
@@ -665,10 +760,11 @@ SclAvxFloat::~SclAvxFloat() { clear(); }
 void SclAvxFloat::clear()
 {
     delete mEncoder;
-    delete mRootNode;
+    mRootNode->~Node();
     delete mNodeBase;
+    delete mMemory;
+    delete mWorkspace;
     delete mPathList;
-    delete mDataPool;
 }
 
 void SclAvxFloat::initialize(size_t blockLength, const std::vector<unsigned>& frozenBits)
@@ -683,18 +779,34 @@ void SclAvxFloat::initialize(size_t blockLength, const std::vector<unsigned>& fr
     mFrozenBits.assign(frozenBits.begin(), frozenBits.end());
     mEncoder = new PolarCode::Encoding::ButterflyFipPacked(mBlockLength, mFrozenBits);
     mEncoder->setSystematic(false);
-    mDataPool = new SclAvx::datapool_t();
     mPathList =
-        new SclAvx::PathList(mListSize, __builtin_ctz(mBlockLength) + 1, mDataPool);
-    mNodeBase = new SclAvx::Node(mBlockLength, mListSize, mDataPool, mPathList);
-    mRootNode = SclAvx::createDecoder(mFrozenBits, mNodeBase);
+        new SclAvx::PathList(mListSize, __builtin_ctz(mBlockLength) + 1);
+    mMemory = new NodeMemory(DecoderPlan::get("SclAvxFloat",
+                                              mBlockLength,
+                                              mFrozenBits,
+                                              SclAvx::classifyNode,
+                                              SclAvx::nodeSize));
+    mWorkspace = new SclAvx::Workspace(mBlockLength, mListSize);
+    mNodeBase = new SclAvx::Node(
+        mBlockLength, mListSize, mMemory, mWorkspace, mPathList);
+    mRootNode = SclAvx::createDecoder(mMemory->plan().root(), mNodeBase);
     mLlrContainer = new FloatContainer(mBlockLength);
     mBitContainer = new FloatContainer(mBlockLength, mFrozenBits);
-    mOutputContainer = new unsigned char[(mBlockLength - mFrozenBits.size() + 7) / 8];
+    // The packed encoder writes whole 32-bit chunks of information bits.
+    mOutputContainer =
+        new unsigned char[(mBlockLength - mFrozenBits.size() + 31) / 32 * 4];
+
+    const size_t candidateBytes = (mBlockLength - mFrozenBits.size() + 31) / 32 * 4;
+    mCandidateBits.assign(mListSize * candidateBytes, 0);
+    mCandidates.resize(mListSize);
+    for (size_t path = 0; path < mListSize; ++path) {
+        mCandidates[path] = mCandidateBits.data() + path * candidateBytes;
+    }
 }
 
 bool SclAvxFloat::decode()
 {
+    PC_PROFILE_DECODER(&mNodeProfile);
     makeInitialPathList();
 
     mRootNode->decode();
@@ -713,38 +825,33 @@ bool SclAvxFloat::extractBestPath()
     unsigned dataStage = __builtin_ctz(mBlockLength);
     unsigned byteLength = (mBlockLength - mFrozenBits.size() + 7) / 8;
     unsigned pathCount = mPathList->PathCount();
-    bool decoderSuccess = false;
-    if (mSystematic) {
-        for (unsigned path = 0; path < pathCount; ++path) {
-            mBitContainer->insertLlr(mPathList->Bit(path, dataStage));
-            mBitContainer->getPackedInformationBits(mOutputContainer);
-            if (mErrorDetector->check(mOutputContainer, byteLength)) {
-                decoderSuccess = true;
-                break;
+    int firstMatch = -1;
+
+    // The most likely path passes in most frames and is checked on its own.
+    // Otherwise, all remaining candidates are unpacked and handed to the error
+    // detector at once, which checks them side by side.
+    for (unsigned checked = 0, count = 1; firstMatch < 0 && checked < pathCount;
+         checked += count, count = pathCount - checked) {
+        for (unsigned path = checked; path < checked + count; ++path) {
+            if (mSystematic) {
+                mBitContainer->insertLlr(mPathList->Bit(path, dataStage));
+                mBitContainer->getPackedInformationBits(mCandidates[path]);
+            } else {
+                mEncoder->setFloatCodeword(mPathList->Bit(path, dataStage));
+                mEncoder->encode();
+                mEncoder->getInformation(mCandidates[path]);
             }
         }
-        // Fall back to ML path, if none of the candidates was free of errors
-        if (!decoderSuccess) {
-            mBitContainer->insertLlr(mPathList->Bit(0, dataStage));
-            mBitContainer->getPackedInformationBits(mOutputContainer);
-        }
-    } else { // non-systematic
-        for (unsigned path = 0; path < pathCount; ++path) {
-            mEncoder->setFloatCodeword(mPathList->Bit(path, dataStage));
-            mEncoder->encode();
-            mEncoder->getInformation(mOutputContainer);
-            if (mErrorDetector->check(mOutputContainer, byteLength)) {
-                decoderSuccess = true;
-                break;
-            }
-        }
-        // Fall back to ML path, if none of the candidates was free of errors
-        if (!decoderSuccess) {
-            mEncoder->setFloatCodeword(mPathList->Bit(0, dataStage));
-            mEncoder->encode();
-            mEncoder->getInformation(mOutputContainer);
+        int match = mErrorDetector->multiCheck(&mCandidates[checked], count, byteLength);
+        if (match >= 0) {
+            firstMatch = checked + match;
         }
     }
+    bool decoderSuccess = firstMatch >= 0;
+
+    // Fall back to ML path, if none of the candidates was free of errors
+    memcpy(mOutputContainer, mCandidates[decoderSuccess ? firstMatch : 0], byteLength);
+
     mPathList->clear(); // Clean up
     return decoderSuccess;
 }
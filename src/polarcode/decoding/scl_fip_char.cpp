@@ -6,45 +6,53 @@
  *
  */
 
+#include <polarcode/alignedmemory.h>
 #include <polarcode/arrayfuncs.h>
 #include <polarcode/decoding/scl_fip_char.h>
 #include <polarcode/encoding/butterfly_fip_packed.h>
 #include <polarcode/polarcode.h>
+#include <algorithm>
+#include <cstring>
 
 namespace PolarCode {
 namespace Decoding {
 
 namespace SclFip {
 
-PathList::PathList() {}
+PathList::PathList() : mPathCount(0), mArena(nullptr) {}
 
-PathList::PathList(size_t listSize, size_t stageCount, datapool_t* dataPool)
+PathList::PathList(size_t listSize, size_t stageCount)
     : mPathLimit(listSize),
       mPathCount(0),
       mNextPathCount(0),
-      mStageCount(stageCount),
-      xmDataPool(dataPool)
+      mStageCount(stageCount)
 {
-    mLlrTree.resize(listSize);
-    mBitTree.resize(listSize);
-    mLeftBitTree.resize(listSize);
+    const size_t slotCount = listSize * stageCount;
+    mLlrTree.assign(slotCount, patharena_t::noSlot);
+    mBitTree.assign(slotCount, patharena_t::noSlot);
+    mLeftBitTree.assign(slotCount, patharena_t::noSlot);
     mMetric.assign(listSize, 0);
-    mNextLlrTree.resize(listSize);
-    mNextBitTree.resize(listSize);
-    mNextLeftBitTree.resize(listSize);
+    mNextLlrTree.assign(slotCount, patharena_t::noSlot);
+    mNextBitTree.assign(slotCount, patharena_t::noSlot);
+    mNextLeftBitTree.assign(slotCount, patharena_t::noSlot);
     mNextMetric.assign(listSize, 0);
 
-    for (unsigned i = 0; i < mPathLimit; ++i) {
-        mLlrTree[i].resize(stageCount);
-        mBitTree[i].resize(stageCount);
-        mLeftBitTree[i].resize(stageCount);
-        mNextLlrTree[i].resize(stageCount);
-        mNextBitTree[i].resize(stageCount);
-        mNextLeftBitTree[i].resize(stageCount);
+    // Every path holds three slots per stage. Writing to a lazy copy swaps a
+    // shared slot for a private one, so no stage ever needs more.
+    std::vector<size_t> stageSize(stageCount);
+    for (unsigned stage = 0; stage < stageCount; ++stage) {
+        stageSize[stage] = nBit2cvecCount(1 << stage);
     }
+    mArena = new patharena_t(stageSize, 3 * listSize);
 }
 
-PathList::~PathList() { clear(); }
+PathList::~PathList()
+{
+    if (mArena != nullptr) {
+        clear();
+        delete mArena;
+    }
+}
 
 void PathList::clear()
 {
@@ -55,35 +63,35 @@ void PathList::clear()
 void PathList::duplicatePath(unsigned destination, unsigned source, unsigned stage)
 {
     for (unsigned i = stage; i < mStageCount; ++i) {
-        mNextLlrTree[destination][i] = xmDataPool->lazyDuplicate(mLlrTree[source][i]);
-        mNextBitTree[destination][i] = xmDataPool->lazyDuplicate(mBitTree[source][i]);
-        mNextLeftBitTree[destination][i] =
-            xmDataPool->lazyDuplicate(mLeftBitTree[source][i]);
+        const unsigned from = index(source, i), to = index(destination, i);
+        mNextLlrTree[to] = mArena->lazyDuplicate(mLlrTree[from]);
+        mNextBitTree[to] = mArena->lazyDuplicate(mBitTree[from]);
+        mNextLeftBitTree[to] = mArena->lazyDuplicate(mLeftBitTree[from]);
     }
 }
 
 void PathList::getWriteAccessToLlr(unsigned path, unsigned stage)
 {
-    xmDataPool->prepareForWrite(mLlrTree[path][stage]);
+    mArena->prepareForWrite(mLlrTree[index(path, stage)]);
 }
 
 void PathList::getWriteAccessToBit(unsigned path, unsigned stage)
 {
-    xmDataPool->prepareForWrite(mBitTree[path][stage]);
+    mArena->prepareForWrite(mBitTree[index(path, stage)]);
 }
 
 void PathList::getWriteAccessToNextBit(unsigned path, unsigned stage)
 {
-    xmDataPool->prepareForWrite(mNextBitTree[path][stage]);
+    mArena->prepareForWrite(mNextBitTree[index(path, stage)]);
 }
 
 void PathList::clearOldPaths(unsigned stage)
 {
     for (unsigned path = 0; path < mPathCount; ++path) {
         for (unsigned i = stage; i < mStageCount; ++i) {
-            xmDataPool->release(mLlrTree[path][i]);
-            xmDataPool->release(mBitTree[path][i]);
-            xmDataPool->release(mLeftBitTree[path][i]);
+            mArena->release(mLlrTree[index(path, i)]);
+            mArena->release(mBitTree[index(path, i)]);
+            mArena->release(mLeftBitTree[index(path, i)]);
         }
     }
 }
@@ -100,6 +108,7 @@ void PathList::switchToNext()
 void PathList::setFirstPath(void* pLlr)
 {
     mPathCount = 1;
+    mMetric[0] = 0; // Metrics must not carry over from the previous frame
     unsigned stage = mStageCount - 1;
     allocateStage(stage);
 
@@ -108,48 +117,53 @@ void PathList::setFirstPath(void* pLlr)
 
 void PathList::allocateStage(unsigned stage)
 {
-    unsigned vecCount = nBit2cvecCount(1 << stage);
     for (unsigned path = 0; path < mPathCount; ++path) {
-        mLlrTree[path][stage] = xmDataPool->allocate(vecCount);
-        mBitTree[path][stage] = xmDataPool->allocate(vecCount);
-        mLeftBitTree[path][stage] = xmDataPool->allocate(vecCount);
+        mLlrTree[index(path, stage)] = mArena->allocate(stage);
+        mBitTree[index(path, stage)] = mArena->allocate(stage);
+        mLeftBitTree[index(path, stage)] = mArena->allocate(stage);
     }
 }
 
 void PathList::clearStage(unsigned stage)
 {
     for (unsigned path = 0; path < mPathCount; ++path) {
-        xmDataPool->release(mLlrTree[path][stage]);
-        xmDataPool->release(mBitTree[path][stage]);
-        xmDataPool->release(mLeftBitTree[path][stage]);
+        mArena->release(mLlrTree[index(path, stage)]);
+        mArena->release(mBitTree[index(path, stage)]);
+        mArena->release(mLeftBitTree[index(path, stage)]);
     }
 }
 
-fipv* PathList::Llr(unsigned path, unsigned stage) { return mLlrTree[path][stage]->data; }
+fipv* PathList::Llr(unsigned path, unsigned stage)
+{
+    return mArena->data(mLlrTree[index(path, stage)]);
+}
 
-fipv* PathList::Bit(unsigned path, unsigned stage) { return mBitTree[path][stage]->data; }
+fipv* PathList::Bit(unsigned path, unsigned stage)
+{
+    return mArena->data(mBitTree[index(path, stage)]);
+}
 
 fipv* PathList::LeftBit(unsigned path, unsigned stage)
 {
-    return mLeftBitTree[path][stage]->data;
+    return mArena->data(mLeftBitTree[index(path, stage)]);
 }
 
 void PathList::prepareRightDecoding(unsigned stage)
 {
     for (unsigned path = 0; path < mPathCount; ++path) {
-        std::swap(mBitTree[path][stage], mLeftBitTree[path][stage]);
-        xmDataPool->prepareForWrite(mLlrTree[path][stage]);
+        std::swap(mBitTree[index(path, stage)], mLeftBitTree[index(path, stage)]);
+        mArena->prepareForWrite(mLlrTree[index(path, stage)]);
     }
 }
 
 fipv* PathList::NextLlr(unsigned path, unsigned stage)
 {
-    return mNextLlrTree[path][stage]->data;
+    return mArena->data(mNextLlrTree[index(path, stage)]);
 }
 
 fipv* PathList::NextBit(unsigned path, unsigned stage)
 {
-    return mNextBitTree[path][stage]->data;
+    return mArena->data(mNextBitTree[index(path, stage)]);
 }
 
 long& PathList::Metric(unsigned path) { return mMetric[path]; }
@@ -162,10 +176,24 @@ unsigned PathList::PathLimit() { return mPathLimit; }
 
 void PathList::setNextPathCount(unsigned pc) { mNextPathCount = pc; }
 
-Node::Node() {}
+Workspace::Workspace(size_t blockLength, size_t listSize)
+    : indices(std::max(std::max(blockLength, listSize * 8), size_t(32))),
+      metrics(listSize * 8),
+      bitFlipHints(listSize * 8),
+      bitFlipCount(listSize * 8),
+      results(listSize * 2)
+{
+    const size_t tempBytes =
+        std::max<size_t>(2, nBit2cvecCount(blockLength)) * BYTESPERVECTOR;
+    temp = static_cast<fipv*>(alignedAlloc(tempBytes, BYTESPERVECTOR));
+    memset(temp, 0, tempBytes);
+}
+
+Workspace::~Workspace() { alignedFree(temp); }
 
 Node::Node(Node* other)
-    : xmDataPool(other->xmDataPool),
+    : xmMemory(other->xmMemory),
+      xmWorkspace(other->xmWorkspace),
       mBlockLength(other->mBlockLength),
       mVecCount(other->mVecCount),
       mStage(other->mStage),
@@ -174,8 +202,13 @@ Node::Node(Node* other)
 {
 }
 
-Node::Node(size_t blockLength, size_t listSize, datapool_t* pool, PathList* pathList)
-    : xmDataPool(pool),
+Node::Node(size_t blockLength,
+           size_t listSize,
+           NodeMemory* memory,
+           Workspace* workspace,
+           PathList* pathList)
+    : xmMemory(memory),
+      xmWorkspace(workspace),
       mBlockLength(blockLength),
       mVecCount(nBit2cvecCount(blockLength)),
       mStage(__builtin_ctz(mBlockLength)),
@@ -188,7 +221,7 @@ Node::~Node() {}
 
 void Node::decode() {}
 
-datapool_t* Node::pool() { return xmDataPool; }
+NodeMemory* Node::memory() { return xmMemory; }
 
 unsigned Node::blockLength() { return mBlockLength; }
 
@@ -199,61 +232,58 @@ SclFip::PathList* Node::pathList() { return xmPathList; }
 
 // Constructors
 
-RateRNode::RateRNode(const std::vector<unsigned>& frozenBits, Node* parent) : Node(parent)
+RateRNode::RateRNode(const DecoderPlan::Node* plan, Node* parent) : Node(parent)
 {
     mBlockLength /= 2;
     mStage -= 1;
     mVecCount = nBit2cvecCount(mBlockLength);
 
-    std::vector<unsigned> leftFrozenBits, rightFrozenBits;
-    splitFrozenBits(frozenBits, mBlockLength, leftFrozenBits, rightFrozenBits);
-
-    mLeft = createDecoder(leftFrozenBits, this);
-    mRight = createDecoder(rightFrozenBits, this);
+    mLeft = createDecoder(plan->left, this);
+    mRight = createDecoder(plan->right, this);
 }
 
-ShortRateRNode::ShortRateRNode(const std::vector<unsigned>& frozenBits, Node* parent)
-    : RateRNode(frozenBits, parent)
+ShortRateRNode::ShortRateRNode(const DecoderPlan::Node* plan, Node* parent)
+    : RateRNode(plan, parent)
 {
 }
 
-RateZeroDecoder::RateZeroDecoder(Node* parent) : Node(parent)
-{
-    mIndices.resize(mListSize);
-    mMetrics.resize(mListSize);
-}
+RateZeroDecoder::RateZeroDecoder(Node* parent) : Node(parent) {}
 
-RateOneDecoder::RateOneDecoder(Node* parent) : Node(parent)
+RateOneDecoder::RateOneDecoder(Node* parent)
+    : Node(parent),
+      mIndices(xmWorkspace->indices),
+      mMetrics(xmWorkspace->metrics),
+      mBitFlipHints(xmWorkspace->bitFlipHints),
+      mBitFlipCount(xmWorkspace->bitFlipCount),
+      mTemp(xmWorkspace->temp)
 {
-    mIndices.resize(std::max(mBlockLength, mListSize * 4));
-    mMetrics.resize(mListSize * 4);
-    mBitFlipHints.resize(mListSize * 4);
-    mBitFlipCount.resize(mListSize * 4);
 }
 
-RepetitionDecoder::RepetitionDecoder(Node* parent) : Node(parent)
+RepetitionDecoder::RepetitionDecoder(Node* parent)
+    : Node(parent),
+      mIndices(xmWorkspace->indices),
+      mMetrics(xmWorkspace->metrics),
+      mResults(xmWorkspace->results)
 {
-    mIndices.resize(mListSize * 2);
-    mMetrics.resize(mListSize * 2);
-    mResults.resize(mListSize * 2);
 }
 
-SpcDecoder::SpcDecoder(Node* parent) : Node(parent)
+SpcDecoder::SpcDecoder(Node* parent)
+    : Node(parent),
+      mIndices(xmWorkspace->indices),
+      mMetrics(xmWorkspace->metrics),
+      mBitFlipHints(xmWorkspace->bitFlipHints),
+      mBitFlipCount(xmWorkspace->bitFlipCount),
+      mTemp(xmWorkspace->temp)
 {
-    mIndices.resize(std::max(std::max(mBlockLength, mListSize * 8), 32u));
-    mMetrics.resize(mListSize * 8);
-    mBitFlipHints.resize(mListSize * 8);
-    mBitFlipCount.resize(mListSize * 8);
 }
 
 // Destructors
 
 RateRNode::~RateRNode()
 {
-    if (mLeft)
-        delete mLeft;
-    if (mRight)
-        delete mRight;
+    // Children live in the decoder's NodeMemory, which frees them as a whole
+    mLeft->~Node();
+    mRight->~Node();
 }
 
 ShortRateRNode::~ShortRateRNode() {}
@@ -267,7 +297,19 @@ RepetitionDecoder::~RepetitionDecoder() {}
 SpcDecoder::~SpcDecoder() {}
 
 // Decoders
-#ifndef __AVX2__
+#ifdef POLARCODE_AVX512
+const unsigned LLRS_PER_GROUP = 8; ///< LLRs per llrExpandToLong() group
+
+inline __m512i llrExpandToLong(fipv vec, const unsigned i)
+{
+    // Move the i-th group of eight LLRs to the front, zero the rest
+    const __m512i group = _mm512_maskz_permutexvar_epi64(1, _mm512_set1_epi64(i), vec);
+    return _mm512_cvtepi8_epi64(_mm512_castsi512_si128(group));
+}
+
+#elif !defined(__AVX2__)
+const unsigned LLRS_PER_GROUP = 4; ///< LLRs per llrExpandToLong() group
+
 inline __m128i llrExpandToLong(__m128i vec, const unsigned i)
 {
     switch (i) {
@@ -288,6 +330,8 @@ inline __m128i llrExpandToLong(__m128i vec, const unsigned i)
 }
 
 #else
+const unsigned LLRS_PER_GROUP = 4; ///< LLRs per llrExpandToLong() group
+
 inline __m256i llrExpandToLong(fipv vec, const unsigned i)
 {
     switch (i % 4) {
@@ -411,7 +455,7 @@ void RateZeroDecoder::decode()
             fipv LlrIn = fi_load(vLlrSource + vector);
             LlrIn = fi_min_epi8(LlrIn, zero);
 
-            for (unsigned group = 0; group < BYTESPERVECTOR / 4; ++group) {
+            for (unsigned group = 0; group < BYTESPERVECTOR / LLRS_PER_GROUP; ++group) {
                 expanded = llrExpandToLong(LlrIn, group);
                 punishment = fi_add_epi64(punishment, expanded);
             }
@@ -424,7 +468,6 @@ void RateOneDecoder::decode()
 {
     const fipv absCorrector = fi_set1_epi8(-127);
     unsigned pathCount = xmPathList->PathCount();
-    Block<fipv>* block = xmDataPool->allocate(mVecCount);
     union {
         fipv* vTempBlock;
         char* cTempBlock;
@@ -434,7 +477,7 @@ void RateOneDecoder::decode()
         char* cLlrSource;
     };
 
-    vTempBlock = block->data;
+    vTempBlock = mTemp;
 
     for (unsigned path = 0; path < pathCount; ++path) {
         long metric = xmPathList->Metric(path);
@@ -470,7 +513,6 @@ void RateOneDecoder::decode()
         mBitFlipCount[path * 4 + 2] = 1;
         mBitFlipCount[path * 4 + 3] = 2;
     }
-    xmDataPool->release(block);
 
     unsigned newPathCount = std::min(pathCount * 4, xmPathList->PathLimit());
     xmPathList->setNextPathCount(newPathCount);
@@ -535,7 +577,7 @@ void RepetitionDecoder::decode()
             vPos = fi_max_epi8(llr, zero);
             vNeg = fi_min_epi8(llr, zero);
 
-            for (unsigned group = 0; group < BYTESPERVECTOR / 4; ++group) {
+            for (unsigned group = 0; group < BYTESPERVECTOR / LLRS_PER_GROUP; ++group) {
                 expanded = llrExpandToLong(vNeg, group);
                 vZero = fi_add_epi64(vZero, expanded);
 
@@ -584,14 +626,9 @@ void SpcDecoder::decode()
 {
     const fipv absCorrector = fi_set1_epi8(-127);
     unsigned pathCount = xmPathList->PathCount();
-    Block<fipv>* block = xmDataPool->allocate(std::max(mVecCount, 2U));
     union {
-#ifdef __AVX2__
-        __m256i* vTempBlock;
+        fipv* vTempBlock;
         __m128i* wTempBlock;
-#else
-        __m128i* vTempBlock;
-#endif
         char* cTempBlock;
         long* lTempBlock;
     };
@@ -601,7 +638,7 @@ void SpcDecoder::decode()
     };
     fipv vParity;
 
-    vTempBlock = block->data;
+    vTempBlock = mTemp;
 
     for (unsigned path = 0; path < pathCount; ++path) {
         vParity = fi_setzero();
@@ -620,10 +657,11 @@ void SpcDecoder::decode()
         }
         findWeakLlrs(mIndices, cTempBlock, mBlockLength, 4);
 
-        unsigned char cParity = reduce_xor(vParity) & 0x80U;
+        bool cParity = sign_parity_epi8(vParity);
         long weakest = 0;
 #ifdef __AVX2__
-        _mm256_store_si256(vTempBlock, _mm256_cvtepi8_epi64(_mm_load_si128(wTempBlock)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(wTempBlock),
+                           _mm256_cvtepi8_epi64(_mm_load_si128(wTempBlock)));
 #else
         { // To be optimized
             char t0 = cTempBlock[0];
@@ -691,7 +729,6 @@ void SpcDecoder::decode()
         mBitFlipHints[path * 8 + 7][mBitFlipCount[path * 8 + 7]++] = mIndices[2];
         mBitFlipHints[path * 8 + 7][mBitFlipCount[path * 8 + 7]++] = mIndices[3];
     }
-    xmDataPool->release(block);
 
     unsigned newPathCount = std::min(pathCount * 8, xmPathList->PathLimit());
     xmPathList->setNextPathCount(newPathCount);
@@ -726,31 +763,69 @@ void SpcDecoder::decode()
 }
 
 
-Node* createDecoder(const std::vector<unsigned>& frozenBits, Node* parent)
+std::pair<unsigned, bool> classifyNode(const std::vector<unsigned>& frozenBits,
+                                       size_t blockLength)
 {
-    size_t blockLength = parent->blockLength();
     size_t frozenBitCount = frozenBits.size();
 
     if (frozenBitCount == blockLength) {
-        return new RateZeroDecoder(parent);
+        return { RATE_ZERO, false };
     }
 
     if (frozenBitCount == 0) {
-        return new RateOneDecoder(parent);
+        return { RATE_ONE, false };
     }
 
     if (frozenBitCount == blockLength - 1) {
-        return new RepetitionDecoder(parent);
+        return { REPETITION, false };
     }
 
     if (frozenBitCount == 1) {
-        return new SpcDecoder(parent);
+        return { SPC, false };
     }
 
     if (blockLength <= BYTESPERVECTOR) {
-        return new ShortRateRNode(frozenBits, parent);
+        return { SHORT_RATE_R, true };
     } else {
-        return new RateRNode(frozenBits, parent);
+        return { RATE_R, true };
+    }
+}
+
+DecoderPlan::NodeSize nodeSize(unsigned kind, size_t)
+{
+    // Path buffers come from the PathList, leaves share the Workspace
+    switch (kind) {
+    case RATE_ZERO:
+        return { sizeof(RateZeroDecoder), 0 };
+    case RATE_ONE:
+        return { sizeof(RateOneDecoder), 0 };
+    case REPETITION:
+        return { sizeof(RepetitionDecoder), 0 };
+    case SPC:
+        return { sizeof(SpcDecoder), 0 };
+    case SHORT_RATE_R:
+        return { sizeof(ShortRateRNode), 0 };
+    default:
+        return { sizeof(RateRNode), 0 };
+    }
+}
+
+Node* createDecoder(const DecoderPlan::Node* plan, Node* parent)
+{
+    NodeMemory* memory = parent->memory();
+    switch (plan->kind) {
+    case RATE_ZERO:
+        return memory->create<RateZeroDecoder>(plan, parent);
+    case RATE_ONE:
+        return memory->create<RateOneDecoder>(plan, parent);
+    case REPETITION:
+        return memory->create<RepetitionDecoder>(plan, parent);
+    case SPC:
+        return memory->create<SpcDecoder>(plan, parent);
+    case SHORT_RATE_R:
+        return memory->create<ShortRateRNode>(plan, plan, parent);
+    default:
+        return memory->create<RateRNode>(plan, plan, parent);
     }
 }
 
@@ -769,10 +844,11 @@ SclFipChar::~SclFipChar() { clear(); }
 void SclFipChar::clear()
 {
     delete mEncoder;
-    delete mRootNode;
+    mRootNode->~Node();
     delete mNodeBase;
+    delete mMemory;
+    delete mWorkspace;
     delete mPathList;
-    delete mDataPool;
 }
 
 void SclFipChar::initialize(size_t blockLength, const std::vector<unsigned>& frozenBits)
@@ -788,14 +864,29 @@ void SclFipChar::initialize(size_t blockLength, const std::vector<unsigned>& fro
     mFrozenBits.assign(frozenBits.begin(), frozenBits.end());
     mEncoder = new PolarCode::Encoding::ButterflyFipPacked(mBlockLength, mFrozenBits);
     mEncoder->setSystematic(false);
-    mDataPool = new SclFip::datapool_t();
     mPathList =
-        new SclFip::PathList(mListSize, __builtin_ctz(mBlockLength) + 1, mDataPool);
-    mNodeBase = new SclFip::Node(mBlockLength, mListSize, mDataPool, mPathList);
-    mRootNode = SclFip::createDecoder(frozenBits, mNodeBase);
+        new SclFip::PathList(mListSize, __builtin_ctz(mBlockLength) + 1);
+    mMemory = new NodeMemory(DecoderPlan::get("SclFipChar",
+                                              mBlockLength,
+                                              mFrozenBits,
+                                              SclFip::classifyNode,
+                                              SclFip::nodeSize));
+    mWorkspace = new SclFip::Workspace(mBlockLength, mListSize);
+    mNodeBase = new SclFip::Node(
+        mBlockLength, mListSize, mMemory, mWorkspace, mPathList);
+    mRootNode = SclFip::createDecoder(mMemory->plan().root(), mNodeBase);
     mLlrContainer = new CharContainer(mBlockLength);
     mBitContainer = new CharContainer(mBlockLength, frozenBits);
-    mOutputContainer = new unsigned char[(mBlockLength - frozenBits.size() + 7) / 8];
+    // The packed encoder writes whole 32-bit chunks of information bits.
+    mOutputContainer =
+        new unsigned char[(mBlockLength - frozenBits.size() + 31) / 32 * 4];
+
+    const size_t candidateBytes = (mBlockLength - mFrozenBits.size() + 31) / 32 * 4;
+    mCandidateBits.assign(mListSize * candidateBytes, 0);
+    mCandidates.resize(mListSize);
+    for (size_t path = 0; path < mListSize; ++path) {
+        mCandidates[path] = mCandidateBits.data() + path * candidateBytes;
+    }
 }
 
 bool SclFipChar::decode()
@@ -818,38 +909,33 @@ bool SclFipChar::extractBestPath()
     unsigned dataStage = __builtin_ctz(mBlockLength);
     unsigned byteLength = (mBlockLength - mFrozenBits.size() + 7) / 8;
     unsigned pathCount = mPathList->PathCount();
-    bool decoderSuccess = false;
-    if (mSystematic) {
-        for (unsigned path = 0; path < pathCount; ++path) {
-            mBitContainer->insertCharBits(mPathList->Bit(path, dataStage));
-            mBitContainer->getPackedInformationBits(mOutputContainer);
-            if (mErrorDetector->check(mOutputContainer, byteLength)) {
-                decoderSuccess = true;
-                break;
-            }
-        }
-        // Fall back to ML path, if none of the candidates was free of errors
-        if (!decoderSuccess) {
-            mBitContainer->insertCharBits(mPathList->Bit(0, dataStage));
-            mBitContainer->getPackedInformationBits(mOutputContainer);
-        }
-    } else {
-        for (unsigned path = 0; path < pathCount; ++path) {
-            mEncoder->setCharCodeword(mPathList->Bit(path, dataStage));
-            mEncoder->encode();
-            mEncoder->getInformation(mOutputContainer);
-            if (mErrorDetector->check(mOutputContainer, byteLength)) {
-                decoderSuccess = true;
-                break;
+    int firstMatch = -1;
+
+    // The most likely path passes in most frames and is checked on its own.
+    // Otherwise, all remaining candidates are unpacked and handed to the error
+    // detector at once, which checks them side by side.
+    for (unsigned checked = 0, count = 1; firstMatch < 0 && checked < pathCount;
+         checked += count, count = pathCount - checked) {
+        for (unsigned path = checked; path < checked + count; ++path) {
+            if (mSystematic) {
+                mBitContainer->insertCharBits(mPathList->Bit(path, dataStage));
+                mBitContainer->getPackedInformationBits(mCandidates[path]);
+            } else {
+                mEncoder->setCharCodeword(mPathList->Bit(path, dataStage));
+                mEncoder->encode();
+                mEncoder->getInformation(mCandidates[path]);
             }
         }
-        // Fall back to ML path, if none of the candidates was free of errors
-        if (!decoderSuccess) {
-            mEncoder->setCharCodeword(mPathList->Bit(0, dataStage));
-            mEncoder->encode();
-            mEncoder->getInformation(mOutputContainer);
+        int match = mErrorDetector->multiCheck(&mCandidates[checked], count, byteLength);
+        if (match >= 0) {
+            firstMatch = checked + match;
         }
     }
+    bool decoderSuccess = firstMatch >= 0;
+
+    // Fall back to ML path, if none of the candidates was free of errors
+    memcpy(mOutputContainer, mCandidates[decoderSuccess ? firstMatch : 0], byteLength);
+
     mPathList->clear(); // Clean up
     return decoderSuccess;
 }
@@ -6,8 +6,10 @@
  *
  */
 
+#include <polarcode/encoding/butterfly_fip_packed.h>
 #include <polarcode/encoding/encoder.h>
 #include <polarcode/errordetection/dummy.h>
+#include <polarcode/isadispatch.h>
 #include <chrono>
 #include <iostream>
 
@@ -100,5 +102,13 @@ void UndefinedEncoder::encode()
     std::cerr << "Call to UndefinedEncoder::encode()!" << std::endl;
 }
 
+Encoder* create(size_t blockLength, const std::vector<unsigned>& frozenBits)
+{
+    if (const Dispatch::KernelTable* kernels = Dispatch::moduleKernels()) {
+        return kernels->createEncoder(blockLength, frozenBits);
+    }
+    return new ButterflyFipPacked(blockLength, frozenBits);
+}
+
 } // namespace Encoding
 } // namespace PolarCode
@@ -7,65 +7,27 @@
  */
 
 #include <polarcode/errordetection/crc24nrc.h>
-#define CRCPP_USE_CPP11
-#define CRCPP_INCLUDE_ESOTERIC_CRC_DEFINITIONS
-#include "CRC.h"
-
 
 namespace PolarCode {
 namespace ErrorDetection {
 
 
-CRC24NRC::CRC24NRC() {}
+CRC24NRC::CRC24NRC() : mEngine(24, 0xb2b117) {}
 
 CRC24NRC::~CRC24NRC() {}
 
 uint64_t CRC24NRC::calculate(void* data, size_t bits)
 {
-    uint32_t* tData = reinterpret_cast<uint32_t*>(data);
-    return gen(tData, bits);
-}
-
-uint32_t CRC24NRC::gen(uint32_t* data, size_t bitSize)
-{
-    return CRC::CalculateBits(data, bitSize, CRC::CRC_24_NRC());
-}
-
-bool CRC24NRC::check(void* pData, int bytes)
-{
-    uint32_t* data = reinterpret_cast<uint32_t*>(pData);
-    uint8_t* p = reinterpret_cast<uint8_t*>(pData);
-    const uint32_t rx_checksum = (uint32_t(p[bytes - 3] << 16) |
-                                  uint32_t(p[bytes - 2] << 8) | uint32_t(p[bytes - 1]));
-    const auto checksum = gen(data, 8 * (bytes - 3));
-    return checksum == rx_checksum;
+    return mEngine.calculateBits(data, bits);
 }
 
-void CRC24NRC::generate(void* pData, int bytes)
-{
-    uint32_t* data = reinterpret_cast<uint32_t*>(pData);
-    auto checksum = gen(data, 8 * (bytes - 3));
-
-    uint8_t* p = reinterpret_cast<uint8_t*>(pData);
-    p[bytes - 3] = (checksum >> 16) & 0xFF;
-    p[bytes - 2] = (checksum >> 8) & 0xFF;
-    p[bytes - 1] = checksum & 0xFF;
-}
+bool CRC24NRC::check(void* pData, int bytes) { return mEngine.check(pData, bytes); }
 
+void CRC24NRC::generate(void* pData, int bytes) { mEngine.generate(pData, bytes); }
 
 int CRC24NRC::multiCheck(void** pData, int nArrays, int nBytes)
 {
-    uint16_t** data = reinterpret_cast<uint16_t**>(pData);
-
-    int firstMatch = -1;
-    for (int array = 0; array < nArrays; ++array) {
-        if (check(data[array], nBytes)) {
-            firstMatch = array;
-            break;
-        }
-    }
-
-    return firstMatch;
+    return mEngine.multiCheck(pData, nArrays, nBytes);
 }
 
 } // namespace ErrorDetection
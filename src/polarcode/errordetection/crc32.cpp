@@ -9,6 +9,7 @@
 #include <polarcode/errordetection/crc32.h>
 
 #include "nmmintrin.h"
+#include <algorithm>
 
 namespace PolarCode {
 namespace ErrorDetection {
@@ -73,29 +74,30 @@ void CRC32::generate(void* pData, int bytes)
 int CRC32::multiCheck(void** pData, int nArrays, int nBytes)
 {
     unsigned int** data = reinterpret_cast<unsigned int**>(pData);
-    unsigned int* checksums = new unsigned int[nArrays]();
+    const int laneCount = 32; // Independent checksums interleaved per block
 
     int nCheckBlocks = (nBytes - 4) / 4;
 
     checkBlockSizeRestriction(nCheckBlocks, nBytes - 4);
 
-    for (int block = 0; block < nCheckBlocks; ++block) {
-        for (int array = 0; array < nArrays; ++array) {
-            checksums[array] = _mm_crc32_u32(checksums[array], data[array][block]);
+    for (int first = 0; first < nArrays; first += laneCount) {
+        const int lanes = std::min(laneCount, nArrays - first);
+        unsigned int** lane = data + first;
+        unsigned int checksums[laneCount] = {};
+
+        for (int block = 0; block < nCheckBlocks; ++block) {
+            for (int array = 0; array < lanes; ++array) {
+                checksums[array] = _mm_crc32_u32(checksums[array], lane[array][block]);
+            }
         }
-    }
 
-    int firstMatch = -1;
-    for (int array = 0; array < nArrays; ++array) {
-        if (checksums[array] == data[array][nCheckBlocks]) {
-            firstMatch = array;
-            break;
+        for (int array = 0; array < lanes; ++array) {
+            if (checksums[array] == lane[array][nCheckBlocks]) {
+                return first + array;
+            }
         }
     }
-
-
-    delete[] checksums;
-    return firstMatch;
+    return -1;
 }
 
 
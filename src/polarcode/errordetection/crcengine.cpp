@@ -0,0 +1,253 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <polarcode/errordetection/crcengine.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __PCLMUL__
+#include <immintrin.h>
+#endif
+
+namespace PolarCode {
+namespace ErrorDetection {
+
+namespace {
+
+inline uint32_t loadBigEndian(const uint8_t* data)
+{
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) |
+           (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+}
+
+/*!
+ * \brief x^n mod P for the left-aligned generator _poly_.
+ */
+uint64_t xPowMod(unsigned n, uint32_t poly)
+{
+    uint32_t reg = 1;
+    for (unsigned i = 0; i < n; ++i) {
+        reg = (reg & 0x80000000) ? (reg << 1) ^ poly : reg << 1;
+    }
+    return reg;
+}
+
+/*!
+ * \brief floor(x^64 / P), including the x^32 term of the 33-bit quotient.
+ */
+uint64_t barrettConstant(uint32_t poly)
+{
+    const unsigned __int128 divisor = (unsigned __int128)((1ULL << 32) | poly);
+    unsigned __int128 remainder = (unsigned __int128)1 << 64;
+    uint64_t quotient = 0;
+    for (int bit = 64; bit >= 32; --bit) {
+        if ((remainder >> bit) & 1) {
+            quotient |= 1ULL << (bit - 32);
+            remainder ^= divisor << (bit - 32);
+        }
+    }
+    return quotient;
+}
+
+#ifdef __PCLMUL__
+inline __m128i clmul(uint64_t a, uint64_t b)
+{
+    return _mm_clmulepi64_si128(_mm_cvtsi64_si128(a), _mm_cvtsi64_si128(b), 0x00);
+}
+
+/*!
+ * \brief Load 16 bytes such that the first message bit is bit 127.
+ */
+inline __m128i loadBlock(const uint8_t* data)
+{
+    const __m128i reverse =
+        _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)),
+                            reverse);
+}
+#endif
+
+} // namespace
+
+CrcEngine::CrcEngine(unsigned width, uint32_t polynomial, uint32_t init)
+    : mWidth(width)
+{
+    if (width == 0 || width > 32) {
+        throw std::invalid_argument("CrcEngine: width must be 1 to 32 bits");
+    }
+    mPolynomial = polynomial << (32 - width);
+    mInit = init << (32 - width);
+
+    for (unsigned byte = 0; byte < 256; ++byte) {
+        uint32_t reg = byte << 24;
+        for (int bit = 0; bit < 8; ++bit) {
+            reg = (reg & 0x80000000) ? (reg << 1) ^ mPolynomial : reg << 1;
+        }
+        mTable[0][byte] = reg;
+    }
+    for (unsigned slice = 1; slice < 8; ++slice) {
+        for (unsigned byte = 0; byte < 256; ++byte) {
+            uint32_t reg = mTable[slice - 1][byte];
+            mTable[slice][byte] = (reg << 8) ^ mTable[0][reg >> 24];
+        }
+    }
+
+    mFoldHigh = xPowMod(192, mPolynomial);
+    mFoldLow = xPowMod(128, mPolynomial);
+    mReduce96 = xPowMod(96, mPolynomial);
+    mReduce64 = xPowMod(64, mPolynomial);
+    mBarrett = barrettConstant(mPolynomial);
+}
+
+uint32_t CrcEngine::update(uint32_t reg, const uint8_t* data, size_t bytes) const
+{
+    for (; bytes >= 8; bytes -= 8, data += 8) {
+        uint32_t high = reg ^ loadBigEndian(data);
+        uint32_t low = loadBigEndian(data + 4);
+        reg = mTable[7][high >> 24] ^ mTable[6][(high >> 16) & 0xFF] ^
+              mTable[5][(high >> 8) & 0xFF] ^ mTable[4][high & 0xFF] ^
+              mTable[3][low >> 24] ^ mTable[2][(low >> 16) & 0xFF] ^
+              mTable[1][(low >> 8) & 0xFF] ^ mTable[0][low & 0xFF];
+    }
+    for (; bytes > 0; --bytes, ++data) {
+        reg = (reg << 8) ^ mTable[0][(reg >> 24) ^ *data];
+    }
+    return reg;
+}
+
+void CrcEngine::updateLanes(uint32_t* reg,
+                            const uint8_t* const* data,
+                            unsigned lanes,
+                            size_t bytes) const
+{
+    size_t offset = 0;
+
+#ifdef __PCLMUL__
+    if (bytes >= 16) {
+        const __m128i fold = _mm_set_epi64x(mFoldHigh, mFoldLow);
+        __m128i acc[laneCount];
+
+        // The register is added to the first 32 message bits
+        for (unsigned lane = 0; lane < lanes; ++lane) {
+            acc[lane] = _mm_xor_si128(loadBlock(data[lane]),
+                                      _mm_set_epi32(reg[lane], 0, 0, 0));
+        }
+        for (offset = 16; offset + 16 <= bytes; offset += 16) {
+            for (unsigned lane = 0; lane < lanes; ++lane) {
+                __m128i high = _mm_clmulepi64_si128(acc[lane], fold, 0x11);
+                __m128i low = _mm_clmulepi64_si128(acc[lane], fold, 0x00);
+                acc[lane] = _mm_xor_si128(_mm_xor_si128(high, low),
+                                          loadBlock(data[lane] + offset));
+            }
+        }
+
+        // Reduce acc * x^32 to 32 bits: fold to 96 and 64 bits, then Barrett
+        const uint64_t poly = (1ULL << 32) | mPolynomial;
+        for (unsigned lane = 0; lane < lanes; ++lane) {
+            uint64_t high = _mm_extract_epi64(acc[lane], 1);
+            uint64_t low = _mm_cvtsi128_si64(acc[lane]);
+            __m128i v96 = _mm_xor_si128(clmul(high, mReduce96),
+                                        _mm_slli_si128(_mm_cvtsi64_si128(low), 4));
+            uint64_t v64 = _mm_cvtsi128_si64(v96) ^
+                           _mm_cvtsi128_si64(clmul(_mm_extract_epi64(v96, 1), mReduce64));
+            uint64_t quotient = _mm_cvtsi128_si64(clmul(v64 >> 32, mBarrett)) >> 32;
+            reg[lane] = uint32_t(v64 ^ _mm_cvtsi128_si64(clmul(quotient, poly)));
+        }
+    }
+#endif
+
+    for (unsigned lane = 0; lane < lanes; ++lane) {
+        reg[lane] = update(reg[lane], data[lane] + offset, bytes - offset);
+    }
+}
+
+uint32_t CrcEngine::calculate(const void* data, size_t bytes) const
+{
+    const uint8_t* bytePtr = static_cast<const uint8_t*>(data);
+    uint32_t reg = mInit;
+    updateLanes(&reg, &bytePtr, 1, bytes);
+    return reg >> (32 - mWidth);
+}
+
+uint32_t CrcEngine::calculateBits(const void* data, size_t bits) const
+{
+    const uint8_t* bytePtr = static_cast<const uint8_t*>(data);
+    uint32_t reg = mInit;
+    updateLanes(&reg, &bytePtr, 1, bits / 8);
+
+    // A partial last byte enters the register as a whole, but is only shifted
+    // by the remaining bit count, like in the CRC++ CalculateBits().
+    if (bits % 8) {
+        reg ^= uint32_t(bytePtr[bits / 8]) << 24;
+        for (unsigned bit = 0; bit < bits % 8; ++bit) {
+            reg = (reg & 0x80000000) ? (reg << 1) ^ mPolynomial : reg << 1;
+        }
+    }
+    return reg >> (32 - mWidth);
+}
+
+void CrcEngine::calculate(const void* const* data,
+                          size_t nArrays,
+                          size_t bytes,
+                          uint32_t* checksums) const
+{
+    const uint8_t* const* bytePtrs = reinterpret_cast<const uint8_t* const*>(data);
+    for (size_t first = 0; first < nArrays; first += laneCount) {
+        const unsigned lanes = std::min<size_t>(laneCount, nArrays - first);
+        std::fill(checksums + first, checksums + first + lanes, mInit);
+        updateLanes(checksums + first, bytePtrs + first, lanes, bytes);
+        for (unsigned lane = 0; lane < lanes; ++lane) {
+            checksums[first + lane] >>= 32 - mWidth;
+        }
+    }
+}
+
+uint32_t CrcEngine::storedChecksum(const uint8_t* data, size_t bytes) const
+{
+    uint32_t checksum = 0;
+    for (size_t i = bytes - checkBytes(); i < bytes; ++i) {
+        checksum = (checksum << 8) | data[i];
+    }
+    return checksum;
+}
+
+void CrcEngine::generate(void* data, size_t bytes) const
+{
+    uint8_t* bytePtr = static_cast<uint8_t*>(data);
+    uint32_t checksum = calculate(data, bytes - checkBytes());
+    for (size_t i = bytes; i > bytes - checkBytes(); --i) {
+        bytePtr[i - 1] = checksum & 0xFF;
+        checksum >>= 8;
+    }
+}
+
+bool CrcEngine::check(const void* data, size_t bytes) const
+{
+    const uint8_t* bytePtr = static_cast<const uint8_t*>(data);
+    return calculate(data, bytes - checkBytes()) == storedChecksum(bytePtr, bytes);
+}
+
+int CrcEngine::multiCheck(const void* const* data, size_t nArrays, size_t bytes) const
+{
+    uint32_t checksums[laneCount];
+    for (size_t first = 0; first < nArrays; first += laneCount) {
+        const size_t lanes = std::min<size_t>(laneCount, nArrays - first);
+        calculate(data + first, lanes, bytes - checkBytes(), checksums);
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            const uint8_t* bytePtr = static_cast<const uint8_t*>(data[first + lane]);
+            if (checksums[lane] == storedChecksum(bytePtr, bytes)) {
+                return first + lane;
+            }
+        }
+    }
+    return -1;
+}
+
+} // namespace ErrorDetection
+} // namespace PolarCode
@@ -16,6 +16,7 @@
 #include <polarcode/errordetection/crc8.h>
 #include <polarcode/errordetection/dummy.h>
 #include <polarcode/errordetection/errordetector.h>
+#include <polarcode/isadispatch.h>
 
 #include <algorithm>
 #include <stdexcept>
@@ -26,6 +27,10 @@ namespace ErrorDetection {
 
 Detector* create(unsigned size, std::string type)
 {
+    if (const Dispatch::KernelTable* kernels = Dispatch::moduleKernels()) {
+        return kernels->createDetector(size, type);
+    }
+
     std::transform(type.begin(), type.end(), type.begin(), [](unsigned char c) {
         return std::tolower(c);
     });
@@ -0,0 +1,147 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <polarcode/decoding/decoder.h>
+#include <polarcode/encoding/encoder.h>
+#include <polarcode/errordetection/errordetector.h>
+#include <polarcode/isadispatch.h>
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(POLARCODE_ISA_DISPATCH) && !defined(POLARCODE_KERNEL_MODULE)
+#include <dlfcn.h>
+#endif
+
+namespace PolarCode {
+namespace Dispatch {
+
+namespace {
+
+const char* const ISA_NAMES[] = { "avx", "avx2", "avx512" };
+
+} // namespace
+
+IsaLevel compiledIsa()
+{
+#if defined(POLARCODE_AVX512)
+    return IsaAvx512;
+#elif defined(__AVX2__)
+    return IsaAvx2;
+#else
+    return IsaAvx;
+#endif
+}
+
+IsaLevel cpuIsa()
+{
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("fma") ||
+        !__builtin_cpu_supports("bmi2") || !__builtin_cpu_supports("rdrnd")) {
+        return IsaAvx;
+    }
+    if (!__builtin_cpu_supports("avx512bw") || !__builtin_cpu_supports("avx512vl")) {
+        return IsaAvx2;
+    }
+    return IsaAvx512;
+}
+
+IsaLevel selectedIsa()
+{
+    IsaLevel level = cpuIsa();
+    IsaLevel forced;
+    const char* env = getenv("POLARCODE_ISA");
+    if (env != nullptr && parseIsa(env, &forced)) {
+        level = std::min(level, forced);
+    }
+    return std::max(level, compiledIsa());
+}
+
+IsaLevel activeIsa()
+{
+    const KernelTable* table = moduleKernels();
+    return table ? table->isa : compiledIsa();
+}
+
+const char* isaName(IsaLevel level) { return ISA_NAMES[level]; }
+
+bool parseIsa(const std::string& name, IsaLevel* level)
+{
+    for (int i = IsaAvx; i <= IsaAvx512; ++i) {
+        if (name == ISA_NAMES[i]) {
+            *level = static_cast<IsaLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const KernelTable* loadModule(IsaLevel level)
+{
+#if defined(POLARCODE_ISA_DISPATCH) && !defined(POLARCODE_KERNEL_MODULE)
+    std::string fileName = std::string("libPolarCodeKernels_") + isaName(level) + ".so";
+    std::string path = fileName;
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(&loadModule), &info) && info.dli_fname) {
+        std::string library(info.dli_fname);
+        size_t slash = library.rfind('/');
+        if (slash != std::string::npos) {
+            path = library.substr(0, slash + 1) + fileName;
+        }
+    }
+
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr) {
+        handle = dlopen(fileName.c_str(), RTLD_NOW | RTLD_LOCAL);
+    }
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    auto entry = reinterpret_cast<const KernelTable* (*)()>(
+        dlsym(handle, "polarcode_kernel_table"));
+    const KernelTable* table = entry ? entry() : nullptr;
+    if (table == nullptr || table->isa != level) {
+        dlclose(handle);
+        return nullptr;
+    }
+    return table; // Stays loaded until the process exits
+#else
+    return nullptr;
+#endif
+}
+
+const KernelTable* moduleKernels()
+{
+#if defined(POLARCODE_ISA_DISPATCH) && !defined(POLARCODE_KERNEL_MODULE)
+    static const KernelTable* table =
+        selectedIsa() > compiledIsa() ? loadModule(selectedIsa()) : nullptr;
+    return table;
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace Dispatch
+} // namespace PolarCode
+
+#ifdef POLARCODE_KERNEL_MODULE
+
+/*!
+ * \brief Entry point of a kernel module, the only symbol it exports.
+ */
+extern "C" __attribute__((visibility("default"))) const PolarCode::Dispatch::KernelTable*
+polarcode_kernel_table()
+{
+    using namespace PolarCode;
+    static const Dispatch::KernelTable table = { Dispatch::compiledIsa(),
+                                                 Decoding::create,
+                                                 Encoding::create,
+                                                 ErrorDetection::create };
+    return &table;
+}
+
+#endif
@@ -0,0 +1,238 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <signalprocessing/avx_mathfun.h>
+#include <signalprocessing/philox.h>
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace SignalProcessing {
+namespace Random {
+
+namespace {
+
+const uint32_t PHILOX_M0 = 0xD2511F53;
+const uint32_t PHILOX_M1 = 0xCD9E8D57;
+const uint32_t PHILOX_W0 = 0x9E3779B9;
+const uint32_t PHILOX_W1 = 0xBB67AE85;
+const unsigned PHILOX_ROUNDS = 10;
+
+#ifdef __AVX2__
+/*!
+ * \brief Full 32x32-bit products of all eight lanes.
+ */
+inline void mulhilo(__m256i a, __m256i b, __m256i* hi, __m256i* lo)
+{
+    const __m256i even = _mm256_mul_epu32(a, b);
+    const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+    *lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    *hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+inline __m256i addWords(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+inline __m256i xorWords(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+inline __m256i orWords(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+inline __m256i shiftWords(__m256i a, int n) { return _mm256_srli_epi32(a, n); }
+#else
+// AVX lacks 256-bit integer arithmetic, so do it on both halves with SSE4.1
+inline __m256i combine(__m128i lo, __m128i hi)
+{
+    return _mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+inline void mulhilo(__m128i a, __m128i b, __m128i* hi, __m128i* lo)
+{
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), b);
+    *lo = _mm_blend_epi16(even, _mm_slli_epi64(odd, 32), 0xCC);
+    *hi = _mm_blend_epi16(_mm_srli_epi64(even, 32), odd, 0xCC);
+}
+
+/*!
+ * \brief Full 32x32-bit products of all eight lanes.
+ */
+inline void mulhilo(__m256i a, __m256i b, __m256i* hi, __m256i* lo)
+{
+    __m128i hiLow, loLow, hiHigh, loHigh;
+    mulhilo(_mm256_castsi256_si128(a), _mm256_castsi256_si128(b), &hiLow, &loLow);
+    mulhilo(_mm256_extractf128_si256(a, 1), _mm256_extractf128_si256(b, 1), &hiHigh,
+            &loHigh);
+    *hi = combine(hiLow, hiHigh);
+    *lo = combine(loLow, loHigh);
+}
+
+inline __m256i addWords(__m256i a, __m256i b)
+{
+    return combine(
+        _mm_add_epi32(_mm256_castsi256_si128(a), _mm256_castsi256_si128(b)),
+        _mm_add_epi32(_mm256_extractf128_si256(a, 1), _mm256_extractf128_si256(b, 1)));
+}
+
+inline __m256i xorWords(__m256i a, __m256i b)
+{
+    return _mm256_castps_si256(
+        _mm256_xor_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b)));
+}
+
+inline __m256i orWords(__m256i a, __m256i b)
+{
+    return _mm256_castps_si256(
+        _mm256_or_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b)));
+}
+
+inline __m256i shiftWords(__m256i a, int n)
+{
+    return combine(_mm_srli_epi32(_mm256_castsi256_si128(a), n),
+                   _mm_srli_epi32(_mm256_extractf128_si256(a, 1), n));
+}
+#endif
+
+} // namespace
+
+Philox::Philox()
+{
+    std::random_device device;
+    seed((uint64_t(device()) << 32) | device());
+}
+
+Philox::Philox(uint64_t seed, uint32_t stream) { this->seed(seed, stream); }
+
+Philox::~Philox() {}
+
+void Philox::seed(uint64_t seed, uint32_t stream)
+{
+    mKey[0] = static_cast<uint32_t>(seed);
+    mKey[1] = static_cast<uint32_t>(seed >> 32);
+    mStream = stream;
+    setBlock(0);
+}
+
+void Philox::setBlock(uint64_t block)
+{
+    mBlock = block;
+    mCounter = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    mHasNormal = false;
+}
+
+void Philox::generate(__m256i* out)
+{
+    const __m256i m0 = _mm256_set1_epi32(PHILOX_M0);
+    const __m256i m1 = _mm256_set1_epi32(PHILOX_M1);
+    __m256i c0 = mCounter;
+    __m256i c1 = _mm256_set1_epi32(static_cast<uint32_t>(mBlock));
+    __m256i c2 = _mm256_set1_epi32(static_cast<uint32_t>(mBlock >> 32));
+    __m256i c3 = _mm256_set1_epi32(mStream);
+    uint32_t k0 = mKey[0], k1 = mKey[1];
+
+    for (unsigned round = 0; round < PHILOX_ROUNDS; ++round) {
+        __m256i hi0, lo0, hi1, lo1;
+        mulhilo(c0, m0, &hi0, &lo0);
+        mulhilo(c2, m1, &hi1, &lo1);
+        c0 = xorWords(xorWords(hi1, c1), _mm256_set1_epi32(k0));
+        c1 = lo1;
+        c2 = xorWords(xorWords(hi0, c3), _mm256_set1_epi32(k1));
+        c3 = lo0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+    mCounter = addWords(mCounter, _mm256_set1_epi32(8));
+}
+
+void Philox::hash(uint32_t* counter, const uint32_t* key)
+{
+    uint32_t k0 = key[0], k1 = key[1];
+    for (unsigned round = 0; round < PHILOX_ROUNDS; ++round) {
+        const uint64_t p0 = uint64_t(PHILOX_M0) * counter[0];
+        const uint64_t p1 = uint64_t(PHILOX_M1) * counter[2];
+        const uint32_t c1 = counter[1];
+        counter[0] = uint32_t(p1 >> 32) ^ c1 ^ k0;
+        counter[1] = uint32_t(p1);
+        counter[2] = uint32_t(p0 >> 32) ^ counter[3] ^ k1;
+        counter[3] = uint32_t(p0);
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+void Philox::fill(void* data, size_t bytes)
+{
+    unsigned char* dst = static_cast<unsigned char*>(data);
+    __m256i words[4];
+    while (bytes > 0) {
+        generate(words);
+        const size_t count = std::min(bytes, sizeof(words));
+        memcpy(dst, words, count);
+        dst += count;
+        bytes -= count;
+    }
+}
+
+void Philox::getNormDist(__m256* a, __m256* b)
+{
+    if (mHasNormal) {
+        *a = mNormal[0];
+        *b = mNormal[1];
+        mHasNormal = false;
+        return;
+    }
+
+    const __m256 twopi = _mm256_set1_ps(2.0f * 3.14159265358979323846f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 minustwo = _mm256_set1_ps(-2.0f);
+    const __m256i exponent = _mm256_set1_epi32(0x3F800000);
+
+    __m256i words[4];
+    generate(words);
+
+    // Box-Muller transform of two independent pairs of uniform vectors
+    __m256 normal[4];
+    for (unsigned i = 0; i < 4; i += 2) {
+        // Mantissa bits in [1, 2), shifted to (0, 1] and [0, 1)
+        const __m256 f1 =
+            _mm256_castsi256_ps(orWords(shiftWords(words[i], 9), exponent));
+        const __m256 f2 =
+            _mm256_castsi256_ps(orWords(shiftWords(words[i + 1], 9), exponent));
+        const __m256 u1 = _mm256_sub_ps(_mm256_set1_ps(2.0f), f1);
+        const __m256 u2 = _mm256_sub_ps(f2, one);
+
+        const __m256 radius = _mm256_sqrt_ps(_mm256_mul_ps(minustwo, log256_ps(u1)));
+        __m256 sintheta, costheta;
+        sincos256_ps(_mm256_mul_ps(twopi, u2), &sintheta, &costheta);
+        normal[i] = _mm256_mul_ps(radius, costheta);
+        normal[i + 1] = _mm256_mul_ps(radius, sintheta);
+    }
+
+    *a = normal[0];
+    *b = normal[1];
+    mNormal[0] = normal[2];
+    mNormal[1] = normal[3];
+    mHasNormal = true;
+}
+
+void Philox::getRayleighDist(__m256* a, __m256* b)
+{
+    __m256 norm[4];
+    getNormDist(norm, norm + 1);
+    getNormDist(norm + 2, norm + 3);
+
+    for (int i = 0; i < 4; ++i)
+        norm[i] = _mm256_mul_ps(norm[i], norm[i]);
+
+    // return square root of (R²+I²)
+    *a = _mm256_sqrt_ps(_mm256_add_ps(norm[0], norm[2]));
+    *b = _mm256_sqrt_ps(_mm256_add_ps(norm[1], norm[3]));
+}
+
+} // namespace Random
+} // namespace SignalProcessing
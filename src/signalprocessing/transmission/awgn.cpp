@@ -8,9 +8,9 @@
 
 #include <immintrin.h>
 #include <signalprocessing/transmission/awgn.h>
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
-#include <random>
 
 namespace SignalProcessing {
 namespace Transmission {
@@ -19,14 +19,18 @@ Awgn::Awgn() : Awgn(10.0) {}
 
 Awgn::Awgn(float EsN0_dB)
 {
-    // Create 256-bit pseudo-random generator
-    mRandGen = new Random::Generator();
+    // Create counter-based pseudo-random generator, randomly seeded
+    mRandGen = new Random::Philox();
 
     setEsN0(EsN0_dB);
 }
 
 Awgn::~Awgn() { delete mRandGen; }
 
+void Awgn::seed(uint64_t seed, uint32_t stream) { mRandGen->seed(seed, stream); }
+
+void Awgn::setBlock(uint64_t block) { mRandGen->setBlock(block); }
+
 void Awgn::setEsN0(float EsNo)
 {
     mEsNoLog = EsNo;
@@ -46,49 +50,39 @@ float Awgn::EsNo() { return mEsNoLog; }
 
 float Awgn::EsNoLin() { return mEsNoLin; }
 
-void Awgn::transmit()
-{
-    size_t size = mSignal->size();
+void Awgn::transmit() { addNoise(mSignal->data(), mSignal->size()); }
 
-    transmit_vectorized();
-    if (size % 16 != 0) {
-        return transmit_simple();
-    } else {
-        return;
+void Awgn::transmit_batch(float* signal,
+                          size_t frameLength,
+                          size_t nFrames,
+                          uint64_t firstBlock)
+{
+    for (size_t frame = 0; frame < nFrames; ++frame) {
+        mRandGen->setBlock(firstBlock + frame);
+        addNoise(signal + frame * frameLength, frameLength);
     }
+    mRandGen->setBlock(firstBlock + nFrames);
 }
 
-void Awgn::transmit_simple()
+void Awgn::getNoise(float* noise, size_t frameLength, size_t nFrames, uint64_t firstBlock)
 {
-    std::mt19937_64 generator;
-    std::normal_distribution<float> distribution(0, mNoiseMagnitude);
-
-    float* fSignal = mSignal->data();
-    const size_t size = mSignal->size();
-    const size_t begin =
-        size & ~15U; // All symbols not covered by vectorized transmission
-
-    for (size_t i = begin; i < size; ++i) {
-        fSignal[i] += distribution(generator);
-    }
+    std::fill(noise, noise + frameLength * nFrames, 0.0f);
+    transmit_batch(noise, frameLength, nFrames, firstBlock);
 }
 
-void Awgn::transmit_vectorized()
+void Awgn::addNoise(float* signal, size_t size)
 {
+    const __m256 noiseMagnitude = _mm256_set1_ps(mNoiseMagnitude);
+    size_t i = 0;
 
-    float* fSignal = mSignal->data();
-    const int size = mSignal->size() - 15; // Limit for full vectors
-
-    __m256 noiseMagnitude = _mm256_set1_ps(mNoiseMagnitude);
-
-    for (int i = 0; i < size; i += 16) {
+    for (; i + 16 <= size; i += 16) {
         // Generate Gaussian noise
         __m256 a, b;
         mRandGen->getNormDist(&a, &b);
 
         // Load signal
-        __m256 siga = _mm256_loadu_ps(fSignal + i);
-        __m256 sigb = _mm256_loadu_ps(fSignal + i + 8);
+        __m256 siga = _mm256_loadu_ps(signal + i);
+        __m256 sigb = _mm256_loadu_ps(signal + i + 8);
 
         // Add noise to signal
 #ifdef __FMA__
@@ -99,8 +93,30 @@ void Awgn::transmit_vectorized()
         sigb = _mm256_add_ps(_mm256_mul_ps(noiseMagnitude, b), sigb);
 #endif
         // Store signal
-        _mm256_storeu_ps(fSignal + i, siga);
-        _mm256_storeu_ps(fSignal + i + 8, sigb);
+        _mm256_storeu_ps(signal + i, siga);
+        _mm256_storeu_ps(signal + i + 8, sigb);
+    }
+
+    if (i < size) {
+        // Masked access to the last symbols, e.g. of rate-matched frames
+        const int remaining = size - i;
+        const __m256i maska = laneMask(remaining);
+        const __m256i maskb = laneMask(remaining - 8);
+
+        __m256 a, b;
+        mRandGen->getNormDist(&a, &b);
+
+        __m256 siga = _mm256_maskload_ps(signal + i, maska);
+        __m256 sigb = _mm256_maskload_ps(signal + i + 8, maskb);
+#ifdef __FMA__
+        siga = _mm256_fmadd_ps(noiseMagnitude, a, siga);
+        sigb = _mm256_fmadd_ps(noiseMagnitude, b, sigb);
+#else
+        siga = _mm256_add_ps(_mm256_mul_ps(noiseMagnitude, a), siga);
+        sigb = _mm256_add_ps(_mm256_mul_ps(noiseMagnitude, b), sigb);
+#endif
+        _mm256_maskstore_ps(signal + i, maska, siga);
+        _mm256_maskstore_ps(signal + i + 8, maskb, sigb);
     }
 }
 
@@ -0,0 +1,226 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include <signalprocessing/transmission/fusedchannel.h>
+#include <signalprocessing/transmission/transmitter.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace SignalProcessing {
+namespace Transmission {
+
+namespace {
+
+/*!
+ * \brief Map eight packed bits to BPSK symbols, bit zero to +1, bit one to -1.
+ */
+inline __m256 bpskSymbols(unsigned char byte)
+{
+#ifdef __AVX2__
+    const __m256i select = _mm256_setr_epi32(0x80, 0x40, 0x20, 0x10, 8, 4, 2, 1);
+    const __m256i isZero = _mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(byte), select), _mm256_setzero_si256());
+#else
+    const __m128i value = _mm_set1_epi32(byte);
+    const __m128i zero = _mm_setzero_si128();
+    const __m256i isZero = _mm256_insertf128_si256(
+        _mm256_castsi128_si256(_mm_cmpeq_epi32(
+            _mm_and_si128(value, _mm_setr_epi32(0x80, 0x40, 0x20, 0x10)), zero)),
+        _mm_cmpeq_epi32(_mm_and_si128(value, _mm_setr_epi32(8, 4, 2, 1)), zero),
+        1);
+#endif
+    const __m256 sign =
+        _mm256_andnot_ps(_mm256_castsi256_ps(isZero), _mm256_set1_ps(-0.0f));
+    return _mm256_or_ps(sign, _mm256_set1_ps(1.0f));
+}
+
+inline void storeLlr(__m256 a, __m256 b, int count, float* llr)
+{
+    _mm256_maskstore_ps(llr, laneMask(count), a);
+    _mm256_maskstore_ps(llr + 8, laneMask(count - 8), b);
+}
+
+/*!
+ * \brief Round and saturate 16 LLRs to 8 bits, as CharContainer::insertLlr().
+ */
+inline void storeLlr(__m256 a, __m256 b, int count, char* llr)
+{
+    const __m256 maximum = _mm256_set1_ps(127.0f);
+    const __m256 minimum = _mm256_set1_ps(-128.0f);
+    a = _mm256_min_ps(_mm256_max_ps(a, minimum), maximum);
+    b = _mm256_min_ps(_mm256_max_ps(b, minimum), maximum);
+
+#ifdef __AVX2__
+    __m256i words = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+    words = _mm256_permute4x64_epi64(words, 0b11011000);
+    const __m128i bytes = _mm_packs_epi16(_mm256_castsi256_si128(words),
+                                          _mm256_extracti128_si256(words, 1));
+#else
+    const __m256i wordsA = _mm256_cvtps_epi32(a);
+    const __m256i wordsB = _mm256_cvtps_epi32(b);
+    const __m128i bytes = _mm_packs_epi16(
+        _mm_packs_epi32(_mm256_castsi256_si128(wordsA),
+                        _mm256_extractf128_si256(wordsA, 1)),
+        _mm_packs_epi32(_mm256_castsi256_si128(wordsB),
+                        _mm256_extractf128_si256(wordsB, 1)));
+#endif
+    if (count >= 16) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(llr), bytes);
+    } else {
+        alignas(16) char buffer[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(buffer), bytes);
+        memcpy(llr, buffer, count);
+    }
+}
+
+} // namespace
+
+FusedChannel::FusedChannel(unsigned bitsPerSymbol)
+    : mRandGen(new Random::Philox()), mAmplification(1.0f)
+{
+    setBitsPerSymbol(bitsPerSymbol);
+    setEsN0(10.0);
+}
+
+FusedChannel::~FusedChannel() { delete mRandGen; }
+
+void FusedChannel::setBitsPerSymbol(unsigned bps, bool normalizeOutput)
+{
+    mBitsPerSymbol = bps;
+    mAskLlr.resize(16 * bps);
+
+    // Same constellation power as Ask
+    if (normalizeOutput && bps > 1) {
+        float power = 0.0;
+        float limit = 1 << mBitsPerSymbol;
+        for (float symbol = 1.0; symbol < limit; symbol += 2.0) {
+            power += symbol * symbol;
+        }
+        mNormalMagnitude = sqrt(2.0 * power / limit);
+        mPowerNormalizer = 1.0 / mNormalMagnitude;
+    } else {
+        mNormalMagnitude = 1.0;
+        mPowerNormalizer = 1.0;
+    }
+}
+
+void FusedChannel::setEsN0(float EsNo)
+{
+    mEsNoLog = EsNo;
+    mEsNoLin = pow(10.0, mEsNoLog / 10.0);
+    mNoiseMagnitude = 1.0 / sqrt(mEsNoLin * 2.0);
+}
+
+void FusedChannel::setEsN0Linear(float EsNo)
+{
+    mEsNoLin = EsNo;
+    mEsNoLog = 10.0 * log10(EsNo);
+    mNoiseMagnitude = 1.0 / sqrt(mEsNoLin * 2.0);
+}
+
+void FusedChannel::setAmplification(float factor) { mAmplification = factor; }
+
+void FusedChannel::seed(uint64_t seed, uint32_t stream) { mRandGen->seed(seed, stream); }
+
+void FusedChannel::setBlock(uint64_t block) { mRandGen->setBlock(block); }
+
+void FusedChannel::transmit(const unsigned char* bits, size_t bitCount, float* llr)
+{
+    transmitFrame(bits, bitCount, llr);
+}
+
+void FusedChannel::transmit(const unsigned char* bits, size_t bitCount, char* llr)
+{
+    transmitFrame(bits, bitCount, llr);
+}
+
+template <typename LlrType>
+void FusedChannel::transmitFrame(const unsigned char* bits,
+                                 size_t bitCount,
+                                 LlrType* llr)
+{
+    const __m256 noiseMagnitude = _mm256_set1_ps(mNoiseMagnitude);
+    const __m256 amplification = _mm256_set1_ps(mAmplification);
+    const size_t symbolCount = (bitCount + mBitsPerSymbol - 1) / mBitsPerSymbol;
+
+    // Noise is drawn per 16 symbols, like Awgn does
+    for (size_t symbol = 0; symbol < symbolCount; symbol += 16) {
+        const int count = std::min<size_t>(symbolCount - symbol, 16);
+        __m256 siga, sigb;
+
+        // Modulate
+        if (mBitsPerSymbol == 1) {
+            siga = bpskSymbols(bits[symbol / 8]);
+            sigb = count > 8 ? bpskSymbols(bits[symbol / 8 + 1]) : siga;
+        } else {
+            // Gray-mapped ASK, padded with zero-bits as in Ask::modulate()
+            alignas(32) float symbols[16] = {};
+            size_t bit = symbol * mBitsPerSymbol;
+            for (int i = 0; i < count; ++i) {
+                float value = 0.0;
+                float memory = 1.0;
+                for (unsigned j = 0; j < mBitsPerSymbol; ++j, ++bit) {
+                    if (bit < bitCount && (bits[bit / 8] << (bit % 8)) & 0x80) {
+                        memory = -memory;
+                    }
+                    value = 2 * value + memory;
+                }
+                symbols[i] = value * mPowerNormalizer;
+            }
+            siga = _mm256_load_ps(symbols);
+            sigb = _mm256_load_ps(symbols + 8);
+        }
+
+        // Add noise
+        __m256 a, b;
+        mRandGen->getNormDist(&a, &b);
+#ifdef __FMA__
+        siga = _mm256_fmadd_ps(noiseMagnitude, a, siga);
+        sigb = _mm256_fmadd_ps(noiseMagnitude, b, sigb);
+#else
+        siga = _mm256_add_ps(_mm256_mul_ps(noiseMagnitude, a), siga);
+        sigb = _mm256_add_ps(_mm256_mul_ps(noiseMagnitude, b), sigb);
+#endif
+
+        // Demodulate and scale
+        if (mBitsPerSymbol == 1) {
+            siga = _mm256_mul_ps(siga, amplification);
+            sigb = _mm256_mul_ps(sigb, amplification);
+            storeLlr(siga, sigb, count, llr + symbol);
+        } else {
+            alignas(32) float received[16];
+            _mm256_store_ps(received, siga);
+            _mm256_store_ps(received + 8, sigb);
+
+            float* out = mAskLlr.data();
+            for (int i = 0; i < count; ++i) {
+                float amplitude = received[i] * mNormalMagnitude;
+                float shift = 1 << (mBitsPerSymbol - 1);
+                for (unsigned j = 0; j < mBitsPerSymbol; ++j) {
+                    *out++ = amplitude * mAmplification;
+                    amplitude = fabs(amplitude) - shift;
+                    shift /= 2;
+                }
+            }
+
+            const size_t firstBit = symbol * mBitsPerSymbol;
+            const size_t llrCount = std::min<size_t>(count * mBitsPerSymbol,
+                                                     bitCount - firstBit);
+            for (size_t i = 0; i < llrCount; i += 16) {
+                storeLlr(_mm256_loadu_ps(mAskLlr.data() + i),
+                         _mm256_loadu_ps(mAskLlr.data() + i + 8),
+                         std::min<size_t>(llrCount - i, 16),
+                         llr + firstBit + i);
+            }
+        }
+    }
+}
+
+} // namespace Transmission
+} // namespace SignalProcessing
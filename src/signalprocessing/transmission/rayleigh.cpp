@@ -8,9 +8,9 @@
 
 #include <immintrin.h>
 #include <signalprocessing/transmission/rayleigh.h>
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
-#include <random>
 
 namespace SignalProcessing {
 namespace Transmission {
@@ -19,14 +19,18 @@ Rayleigh::Rayleigh() : Rayleigh(10.0) {}
 
 Rayleigh::Rayleigh(float EsN0_dB)
 {
-    // Create 256-bit pseudo-random generator
-    mRandGen = new Random::Generator();
+    // Create counter-based pseudo-random generator, randomly seeded
+    mRandGen = new Random::Philox();
 
     setEsN0(EsN0_dB);
 }
 
 Rayleigh::~Rayleigh() { delete mRandGen; }
 
+void Rayleigh::seed(uint64_t seed, uint32_t stream) { mRandGen->seed(seed, stream); }
+
+void Rayleigh::setBlock(uint64_t block) { mRandGen->setBlock(block); }
+
 void Rayleigh::setEsN0(float EsNo)
 {
     mEsNoLog = EsNo;
@@ -43,35 +47,7 @@ void Rayleigh::setEsN0Linear(float EsNo)
 
 float Rayleigh::EsNo() { return mEsNoLog; }
 
-void Rayleigh::transmit()
-{
-    size_t size = mSignal->size();
-
-    if (size % 16 == 0) {
-        return transmit_vectorized();
-    } else {
-        return transmit_simple();
-    }
-}
-
-void Rayleigh::transmit_simple()
-{
-    std::mt19937_64 generator;
-    std::normal_distribution<float> noiseDist(0.0, mNoiseMagnitude);
-    std::normal_distribution<float> raylDist(0.0, 1.0);
-
-    float* fSignal = mSignal->data();
-    const size_t size = mSignal->size();
-    float real, imag, rayleighFactor;
-
-    for (size_t i = 0; i < size; ++i) {
-        real = raylDist(generator);
-        imag = raylDist(generator);
-        rayleighFactor = sqrt(real * real + imag * imag);
-
-        fSignal[i] = fSignal[i] * rayleighFactor + noiseDist(generator);
-    }
-}
+void Rayleigh::transmit() { transmit_vectorized(); }
 
 void Rayleigh::transmit_vectorized()
 {
@@ -87,11 +63,13 @@ void Rayleigh::transmit_vectorized()
         __m256 raylA, raylB;
         mRandGen->getNormDist(&noiseA, &noiseB);
         mRandGen->getRayleighDist(&raylA, &raylB);
-        // mRandGen->getNormDist(&raylA, &raylB);
 
-        // Load signal
-        __m256 sigA = _mm256_loadu_ps(fSignal + i);
-        __m256 sigB = _mm256_loadu_ps(fSignal + i + 8);
+        // Load signal, masking the symbols beyond a partial last vector
+        const int remaining = std::min<size_t>(size - i, 16);
+        const __m256i maskA = laneMask(remaining);
+        const __m256i maskB = laneMask(remaining - 8);
+        __m256 sigA = _mm256_maskload_ps(fSignal + i, maskA);
+        __m256 sigB = _mm256_maskload_ps(fSignal + i + 8, maskB);
 
         // Deform signal
         sigA = _mm256_mul_ps(sigA, raylA);
@@ -106,8 +84,8 @@ void Rayleigh::transmit_vectorized()
         sigB = _mm256_add_ps(_mm256_mul_ps(noiseMagnitude, noiseB), sigB);
 #endif
         // Store signal
-        _mm256_storeu_ps(fSignal + i, sigA);
-        _mm256_storeu_ps(fSignal + i + 8, sigB);
+        _mm256_maskstore_ps(fSignal + i, maskA, sigA);
+        _mm256_maskstore_ps(fSignal + i + 8, maskB, sigB);
     }
 }
 
@@ -0,0 +1,123 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include "remote.h"
+
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Simulation {
+namespace Remote {
+
+namespace {
+
+bool sockaddrFromPath(const std::string& path, sockaddr_un* address)
+{
+    if (path.size() >= sizeof(address->sun_path)) {
+        return false;
+    }
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, path.c_str());
+    return true;
+}
+
+bool writeAll(int socket, const void* data, size_t size)
+{
+    const char* ptr = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::send(socket, ptr, size, MSG_NOSIGNAL);
+        if (written <= 0) {
+            return false;
+        }
+        ptr += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool readAll(int socket, void* data, size_t size)
+{
+    char* ptr = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = ::recv(socket, ptr, size, 0);
+        if (received <= 0) {
+            return false;
+        }
+        ptr += received;
+        size -= received;
+    }
+    return true;
+}
+
+} // namespace
+
+Connection::Connection(int socket) : mSocket(socket) {}
+
+Connection::~Connection() { close(mSocket); }
+
+Connection* Connection::connect(const std::string& path)
+{
+    sockaddr_un address;
+    if (!sockaddrFromPath(path, &address)) {
+        return nullptr;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    return new Connection(fd);
+}
+
+bool Connection::send(const Message& message, const std::vector<uint64_t>& times)
+{
+    return writeAll(mSocket, &message, sizeof(message)) &&
+           writeAll(mSocket, times.data(), sizeof(uint64_t) * times.size());
+}
+
+bool Connection::receive(Message* message, std::vector<uint64_t>* times)
+{
+    if (!readAll(mSocket, message, sizeof(*message))) {
+        return false;
+    }
+    std::vector<uint64_t> discard;
+    if (times == nullptr) {
+        times = &discard;
+    }
+    times->resize(message->type == RESULT ? message->wordCount : 0);
+    return readAll(mSocket, times->data(), sizeof(uint64_t) * times->size());
+}
+
+int listen(const std::string& path)
+{
+    sockaddr_un address;
+    if (!sockaddrFromPath(path, &address)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace Remote
+} // namespace Simulation
@@ -0,0 +1,90 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PCSIM_REMOTE_H
+#define PCSIM_REMOTE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Simulation {
+
+/*!
+ * \brief Transport between a coordinating pcsim process and its workers.
+ *
+ * Every worker thread holds one Unix stream socket connection to the
+ * coordinator. It sends REQUEST and RESULT messages and receives WORK or
+ * STOP. On connection, the coordinator sends HELLO with the seed of the
+ * simulation and its number of jobs.
+ */
+namespace Remote {
+
+enum MessageType : uint32_t { HELLO, REQUEST, WORK, RESULT, STOP };
+
+/*!
+ * \brief Fixed-size message, the fields in use depend on the type.
+ */
+struct Message {
+    uint32_t type;
+    uint32_t job; ///< Job index, or the number of jobs for HELLO
+    uint64_t seed;
+    uint64_t batch;
+    uint64_t firstBlock;
+    uint64_t blockCount;
+    int64_t runs;
+    int64_t errors;
+    int64_t reportedErrors;
+    int64_t biterrors;
+    float encTime;
+    uint32_t wordCount; ///< Length of the serialized timings following a RESULT
+};
+
+/*!
+ * \brief A connected stream socket, transferring whole messages.
+ */
+class Connection
+{
+    int mSocket;
+
+public:
+    /*!
+     * \brief Take ownership of a connected socket.
+     */
+    explicit Connection(int socket);
+    ~Connection();
+
+    /*!
+     * \brief Connect to a coordinator.
+     * \return The connection, or nullptr on failure.
+     */
+    static Connection* connect(const std::string& path);
+
+    /*!
+     * \brief Send a message, followed by _wordCount_ words of block timings.
+     * \return False, if the peer is gone.
+     */
+    bool send(const Message& message, const std::vector<uint64_t>& times = {});
+
+    /*!
+     * \brief Receive a message and its block timings.
+     * \return False, if the peer is gone.
+     */
+    bool receive(Message* message, std::vector<uint64_t>* times = nullptr);
+};
+
+/*!
+ * \brief Create a listening Unix socket, replacing a stale socket file.
+ * \return The socket descriptor, or -1 on failure.
+ */
+int listen(const std::string& path);
+
+} // namespace Remote
+} // namespace Simulation
+
+#endif // PCSIM_REMOTE_H
@@ -63,6 +63,18 @@ void Configurator::setupArgumentDefaults()
     defaultStrings.insert({ "outputFile", "simulation" });
 
     defaultInts.insert({ "threads", 1 });
+
+    defaultStrings.insert({ "constructionCache", "" });
+
+    defaultLongInts.insert({ "seed", 0 });
+
+    defaultInts.insert({ "target-errors", 0 });
+
+    defaultStrings.insert({ "checkpoint", "" });
+
+    defaultInts.insert({ "processes", 0 });
+    defaultStrings.insert({ "listen", "" });
+    defaultStrings.insert({ "connect", "" });
 }
 
 
@@ -317,6 +329,90 @@ void Configurator::setupArgumentThreadCount()
     insertArgument(ThreadCount);
 }
 
+void Configurator::setupArgumentConstructionCache()
+{
+    auto CacheFile = new ValueArg<string>(
+        "",
+        "construction-cache",
+        "File to load constructed codes from and to store new constructions in.",
+        false,
+        defaultStrings["constructionCache"],
+        "filename");
+    insertArgument(CacheFile);
+}
+
+void Configurator::setupArgumentSeed()
+{
+    auto Seed = new ValueArg<long>("",
+                                   "seed",
+                                   "Seed of the data and noise generators. Equal seeds "
+                                   "reproduce a run. 0 selects a random seed.",
+                                   false,
+                                   defaultLongInts["seed"],
+                                   "integer");
+    insertArgument(Seed);
+}
+
+void Configurator::setupArgumentTargetErrors()
+{
+    auto TargetErrors =
+        new ValueArg<int>("",
+                          "target-errors",
+                          "Stop an SNR point after this many block errors, for a "
+                          "relative 95%-confidence interval of about 2/sqrt(target), "
+                          "for example 100. The default 0 always simulates the "
+                          "workload.",
+                          false,
+                          defaultInts["target-errors"],
+                          "int");
+    insertArgument(TargetErrors);
+}
+
+void Configurator::setupArgumentCheckpoint()
+{
+    auto Checkpoint = new ValueArg<string>(
+        "",
+        "checkpoint",
+        "File to log finished batches to. An interrupted run resumes from it.",
+        false,
+        defaultStrings["checkpoint"],
+        "filename");
+    insertArgument(Checkpoint);
+}
+
+void Configurator::setupArgumentDistribution()
+{
+    auto Processes = new ValueArg<int>("",
+                                       "processes",
+                                       "Number of local worker processes to start, each "
+                                       "running --threads threads. The calling process "
+                                       "coordinates them.",
+                                       false,
+                                       defaultInts["processes"],
+                                       "int");
+    insertArgument(Processes);
+
+    auto Listen = new ValueArg<string>(
+        "",
+        "listen",
+        "Coordinate workers connecting to this Unix socket, in addition to "
+        "--processes.",
+        false,
+        defaultStrings["listen"],
+        "path");
+    insertArgument(Listen);
+
+    auto Connect = new ValueArg<string>(
+        "",
+        "connect",
+        "Work for the coordinator at this Unix socket. All other arguments must "
+        "match the coordinator's.",
+        false,
+        defaultStrings["connect"],
+        "path");
+    insertArgument(Connect);
+}
+
 void Configurator::setupCommandlineArguments(CmdLine* cmd)
 {
     setupArgumentDefaults();
@@ -333,6 +429,11 @@ void Configurator::setupCommandlineArguments(CmdLine* cmd)
     setupArgumentAmplification();
     setupArgumentOutputFile();
     setupArgumentThreadCount();
+    setupArgumentConstructionCache();
+    setupArgumentSeed();
+    setupArgumentTargetErrors();
+    setupArgumentCheckpoint();
+    setupArgumentDistribution();
 
     for (auto arg : argumentList) {
         cmd->add(arg.second);
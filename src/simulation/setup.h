@@ -56,6 +56,11 @@ class Configurator
     void setupArgumentAmplification();
     void setupArgumentOutputFile();
     void setupArgumentThreadCount();
+    void setupArgumentConstructionCache();
+    void setupArgumentSeed();
+    void setupArgumentTargetErrors();
+    void setupArgumentCheckpoint();
+    void setupArgumentDistribution();
 
 public:
     /*!
@@ -8,12 +8,23 @@
 
 #include "simulator.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <random>
+#include <sstream>
 #include <thread>
 
-#include <signalprocessing/modulation/ask.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+#include <polarcode/construction/constructioncache.h>
 
 #include <polarcode/encoding/butterfly_fip_packed.h>
 
@@ -38,8 +49,26 @@
 
 namespace Simulation {
 
-Simulator::Simulator(Setup::Configurator* config) : mConfiguration(config), mNextJob(0)
+namespace {
+
+/*!
+ * \brief Blocks per WorkUnit, small enough to stop shortly after the error target.
+ */
+const unsigned long BATCH_BLOCKS = 256;
+
+/*!
+ * \brief Interval of rewriting the result file with partial results.
+ */
+const std::chrono::seconds SAVE_INTERVAL(30);
+
+} // namespace
+
+Simulator::Simulator(Setup::Configurator* config) : mConfiguration(config)
 {
+    std::string cacheFile = mConfiguration->getString("construction-cache");
+    if (!cacheFile.empty()) {
+        PolarCode::Construction::ConstructionCache::global().attachFile(cacheFile);
+    }
 
     std::string simType = mConfiguration->getString("simtype");
 
@@ -67,14 +96,53 @@ Simulator::Simulator(Setup::Configurator* config) : mConfiguration(config), mNex
         configureAskSim();
     } else if (simType == "compareall") {
         configureComparisonSim();
-        return; // No SNR inflation
     } else if (simType == "getcode") {
         printCode();
     } else {
         // Unknown simulation type, should be caught by cmd-parser
         exit(EXIT_FAILURE);
     }
-    snrInflateJobList();
+    if (simType != "compareall") { // No SNR inflation for comparisons
+        snrInflateJobList();
+    }
+
+    // Every job gets its own random streams and scheduling state. Jobs are
+    // read-only once workers run them, so they are normalised here.
+    for (unsigned id = 0; id < mJobList.size(); ++id) {
+        DataPoint* job = mJobList[id];
+        job->id = id;
+        if (job->errorDetection >= job->K) {
+            // No room for check bits
+            job->errorDetection = 0;
+            job->errorDetectionType = "none";
+        }
+    }
+    mProgress.resize(mJobList.size());
+    mOpenJobs = mJobList.size();
+    mTargetErrors = mConfiguration->getInt("target-errors");
+    mProcesses = mConfiguration->getInt("processes");
+    mListenPath = mConfiguration->getString("listen");
+    mConnectPath = mConfiguration->getString("connect");
+    if (!mConnectPath.empty()) {
+        return; // The coordinator keeps seed, checkpoint and results
+    }
+
+    // Continue an interrupted run with its seed
+    mSeed = mConfiguration->getLongInt("seed");
+    mCheckpointFile = mConfiguration->getString("checkpoint");
+    if (!mCheckpointFile.empty()) {
+        resumeCheckpoint();
+    }
+    if (mSeed == 0) {
+        std::random_device device;
+        // 63 bits, to be given back as --seed
+        mSeed = ((uint64_t(device()) << 32) | device()) >> 1;
+        std::cout << "[0] Random seed: " << mSeed << std::endl;
+    }
+    if (!mCheckpointFile.empty()) {
+        openCheckpoint();
+    }
+    mLastSave = std::chrono::steady_clock::now();
 }
 
 Simulator::~Simulator()
@@ -85,6 +153,23 @@ Simulator::~Simulator()
 }
 
 void Simulator::run()
+{
+    if (!mConnectPath.empty()) {
+        runThreads();
+        return;
+    }
+
+    if (mProcesses > 0 || !mListenPath.empty()) {
+        coordinate();
+    } else {
+        runThreads();
+    }
+
+    // Write results into file
+    writeResults(mJobList);
+}
+
+void Simulator::runThreads()
 {
     // Get number of concurrently active simulation threads
     unsigned threadCount = mConfiguration->getInt("threads");
@@ -105,30 +190,428 @@ void Simulator::run()
         std::cout << "what(): " << e.what() << std::endl;
         SimThread(this, 1);
     }
+}
+
+void Simulator::coordinate()
+{
+    std::string path = mListenPath;
+    if (path.empty()) {
+        path = "/tmp/pcsim-" + std::to_string(getpid()) + ".socket";
+    }
+    int socket = Remote::listen(path);
+    if (socket < 0) {
+        std::cout << "Cannot listen on " << path << ", simulating locally." << std::endl;
+        runThreads();
+        return;
+    }
+    std::cout << "[0] Coordinating workers on " << path << std::endl;
+
+    // Local worker processes, connecting like external ones
+    std::vector<pid_t> children;
+    std::cout.flush();
+    for (int i = 0; i < mProcesses; ++i) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(socket);
+            mConnectPath = path;
+            runThreads();
+            _exit(EXIT_SUCCESS);
+        } else if (pid > 0) {
+            children.push_back(pid);
+        }
+    }
 
+    std::vector<std::thread> handlers;
+    pollfd listener = {socket, POLLIN, 0};
+    while (!finished()) {
+        if (poll(&listener, 1, 100) > 0) {
+            int connection = accept(socket, nullptr, nullptr);
+            if (connection >= 0) {
+                handlers.push_back(std::thread(&Simulator::serve, this, connection));
+            }
+        }
 
-    // Write results into file
-    if (mConfiguration->getString("simtype") == "compareall") {
-        saveComparisonResults();
-    } else {
-        saveResults();
+        // Without external workers, nobody is left once all children are gone
+        children.erase(std::remove_if(children.begin(),
+                                      children.end(),
+                                      [](pid_t pid) {
+                                          return waitpid(pid, nullptr, WNOHANG) == pid;
+                                      }),
+                       children.end());
+        if (children.empty() && mListenPath.empty()) {
+            break;
+        }
+    }
+
+    for (auto& handler : handlers) {
+        handler.join();
+    }
+    for (pid_t pid : children) {
+        waitpid(pid, nullptr, 0);
+    }
+    close(socket);
+    unlink(path.c_str());
+
+    // Batches of lost workers
+    if (!finished()) {
+        runThreads();
     }
 }
 
-DataPoint* Simulator::getJob()
+void Simulator::serve(int socket)
 {
-    unsigned jobId = mNextJob.fetch_add(1);
+    Remote::Connection connection(socket);
+    Remote::Message message = {};
+    message.type = Remote::HELLO;
+    message.job = mJobList.size();
+    message.seed = mSeed;
+    if (!connection.send(message)) {
+        return;
+    }
 
-    if (jobId < mJobList.size()) {
-        std::string message = "[0] Jobs in queue: ";
-        message += std::to_string(mJobList.size() - jobId - 1);
-        message += "\n";
-        std::cout << message;
+    WorkUnit unit;
+    DataPoint* current = nullptr;
+    bool outstanding = false;
+    std::vector<uint64_t> times;
+    while (connection.receive(&message, &times)) {
+        if (message.type == Remote::REQUEST) {
+            if (!getWork(&unit, current)) {
+                current = nullptr;
+                message.type = Remote::STOP;
+                connection.send(message);
+                return;
+            }
+            current = unit.job;
+            outstanding = true;
+            message.type = Remote::WORK;
+            message.job = unit.job->id;
+            message.batch = unit.batch;
+            message.firstBlock = unit.firstBlock;
+            message.blockCount = unit.blockCount;
+            if (!connection.send(message)) {
+                break;
+            }
+        } else if (message.type == Remote::RESULT && outstanding) {
+            BatchResult result;
+            result.runs = message.runs;
+            result.errors = message.errors;
+            result.reportedErrors = message.reportedErrors;
+            result.biterrors = message.biterrors;
+            result.encTime = message.encTime;
+            if (!result.timeStat.deserialize(times)) {
+                break; // Broken worker, the batch is simulated again
+            }
+            outstanding = false;
+            if (submitWork(unit, &result)) {
+                printJobResults(0, unit.job);
+            }
+        }
+    }
+
+    // The worker is gone, its batch goes to someone else
+    returnWork(outstanding ? &unit : nullptr, current);
+}
+
+bool Simulator::finished()
+{
+    std::lock_guard<std::mutex> lock(mScheduleMutex);
+    return mOpenJobs == 0;
+}
+
+void Simulator::returnWork(const WorkUnit* unit, DataPoint* current)
+{
+    std::lock_guard<std::mutex> lock(mScheduleMutex);
+    if (unit != nullptr) {
+        JobProgress& progress = mProgress[unit->job->id];
+        if (!progress.done) {
+            progress.requeued.push_back(unit->batch);
+        }
+    }
+    if (current != nullptr) {
+        mProgress[current->id].workers--;
+    }
+}
 
-        return mJobList[jobId];
+bool Simulator::batchesLeft(const DataPoint* job)
+{
+    const JobProgress& progress = mProgress[job->id];
+    return !progress.done &&
+           (!progress.requeued.empty() ||
+            progress.issuedBatches * BATCH_BLOCKS < (unsigned long)job->BlocksToSimulate);
+}
+
+bool Simulator::getWork(WorkUnit* unit, DataPoint* current)
+{
+    std::lock_guard<std::mutex> lock(mScheduleMutex);
+    DataPoint* job = current;
+
+    if (job == nullptr || !batchesLeft(job)) {
+        if (job != nullptr) {
+            mProgress[job->id].workers--;
+        }
+
+        // Join the open job with the fewest threads, the first one on ties
+        job = nullptr;
+        for (DataPoint* candidate : mJobList) {
+            if (batchesLeft(candidate) &&
+                (job == nullptr ||
+                 mProgress[candidate->id].workers < mProgress[job->id].workers)) {
+                job = candidate;
+            }
+        }
+        if (job == nullptr) {
+            return false;
+        }
+        mProgress[job->id].workers++;
+    }
+
+    JobProgress& progress = mProgress[job->id];
+    unit->job = job;
+    if (!progress.requeued.empty()) {
+        unit->batch = progress.requeued.back();
+        progress.requeued.pop_back();
     } else {
-        return nullptr;
+        unit->batch = progress.issuedBatches++;
     }
+    unit->firstBlock = unit->batch * BATCH_BLOCKS;
+    unit->blockCount =
+        std::min(BATCH_BLOCKS, (unsigned long)job->BlocksToSimulate - unit->firstBlock);
+    return true;
+}
+
+bool Simulator::mergeBatch(DataPoint* job, const BatchResult& result)
+{
+    JobProgress& progress = mProgress[job->id];
+
+    job->runs += result.runs;
+    job->errors += result.errors;
+    job->reportedErrors += result.reportedErrors;
+    job->biterrors += result.biterrors;
+    job->encTime += result.encTime;
+    job->timeStat.merge(result.timeStat);
+
+    progress.mergedBatches++;
+    progress.done = (mTargetErrors > 0 && job->errors >= mTargetErrors) ||
+                    progress.mergedBatches * BATCH_BLOCKS >=
+                        (unsigned long)job->BlocksToSimulate;
+    return progress.done;
+}
+
+bool Simulator::submitWork(const WorkUnit& unit, BatchResult* result)
+{
+    bool done;
+    {
+        std::lock_guard<std::mutex> lock(mScheduleMutex);
+        DataPoint* job = unit.job;
+        JobProgress& progress = mProgress[job->id];
+
+        if (progress.done) {
+            return false; // Beyond the stopping point, discarded
+        }
+        progress.pending[unit.batch] = std::move(*result);
+
+        auto it = progress.pending.begin();
+        while (!progress.done && it != progress.pending.end() &&
+               it->first == progress.mergedBatches) {
+            mergeBatch(job, it->second);
+            if (mCheckpoint.is_open()) {
+                mCheckpointQueue.push_back(
+                    { job->id, it->first, std::move(it->second) });
+            }
+            it = progress.pending.erase(it);
+        }
+
+        if (progress.done) {
+            progress.pending.clear();
+            calculateStatistics(job);
+            mOpenJobs--;
+            std::string message = "[0] Jobs in queue: ";
+            message += std::to_string(mOpenJobs);
+            message += "\n";
+            std::cout << message;
+        }
+        if (progress.done ||
+            std::chrono::steady_clock::now() - mLastSave >= SAVE_INTERVAL) {
+            saveProgress();
+        }
+        done = progress.done;
+    }
+
+    writeFiles();
+    return done;
+}
+
+uint64_t Simulator::fingerprint() const
+{
+    std::ostringstream parameters;
+    parameters << std::setprecision(9) << BATCH_BLOCKS << ' ' << mTargetErrors;
+    for (const DataPoint* job : mJobList) {
+        parameters << '\n'
+                   << job->name << ' ' << job->designSNR << ' ' << job->N << ' ' << job->K
+                   << ' ' << job->L << ' ' << job->errorDetection << ' '
+                   << job->errorDetectionType << ' ' << job->systematic << ' '
+                   << static_cast<int>(job->decoderType) << ' ' << job->codingScheme
+                   << ' ' << job->EbN0 << ' ' << job->BlocksToSimulate << ' '
+                   << job->precision << ' ' << job->amplification << ' '
+                   << job->bitsPerSymbol;
+        for (unsigned bit : job->scfNodeRanking) {
+            parameters << ' ' << bit;
+        }
+    }
+
+    // 64-bit FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : parameters.str()) {
+        hash = (hash ^ c) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+void Simulator::resumeCheckpoint()
+{
+    std::ifstream file(mCheckpointFile);
+    std::string line, tag;
+    uint64_t seed, hash;
+    size_t jobCount;
+
+    if (!std::getline(file, line)) {
+        return; // New checkpoint
+    }
+    std::istringstream header(line);
+    if (!(header >> tag >> seed >> jobCount >> std::hex >> hash) || tag != "seed" ||
+        jobCount != mJobList.size() || hash != fingerprint() ||
+        (mSeed != 0 && mSeed != seed)) {
+        std::cerr << "Checkpoint \"" << mCheckpointFile
+                  << "\" belongs to another simulation." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    mSeed = seed;
+
+    // Accept batches in order only, a truncated last line is dropped
+    unsigned long resumed = 0;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        unsigned id;
+        unsigned long batch;
+        BatchResult result = BatchResult();
+        if (!(fields >> tag >> id >> batch >> result.runs >> result.errors >>
+              result.reportedErrors >> result.biterrors >> result.encTime) ||
+            tag != "batch" || id >= mJobList.size() || mProgress[id].done ||
+            batch != mProgress[id].mergedBatches) {
+            continue;
+        }
+        std::vector<uint64_t> times;
+        uint64_t word;
+        while (fields >> word) {
+            times.push_back(word);
+        }
+        if (!result.timeStat.deserialize(times) ||
+            result.timeStat.count() != (uint64_t)result.runs) {
+            continue;
+        }
+        mergeBatch(mJobList[id], result);
+        ++resumed;
+    }
+
+    for (DataPoint* job : mJobList) {
+        JobProgress& progress = mProgress[job->id];
+        progress.issuedBatches = progress.mergedBatches;
+        if (progress.done) {
+            calculateStatistics(job);
+            mOpenJobs--;
+        }
+    }
+    std::cout << "[0] Resumed " << resumed << " batches, " << mOpenJobs
+              << " jobs left." << std::endl;
+}
+
+void Simulator::openCheckpoint()
+{
+    // Terminate a truncated last line before appending
+    bool newFile = true, newLine = true;
+    std::ifstream input(mCheckpointFile, std::ios::binary | std::ios::ate);
+    if (input && input.tellg() > 0) {
+        newFile = false;
+        input.seekg(-1, std::ios::end);
+        newLine = input.get() != '\n';
+    }
+
+    mCheckpoint.open(mCheckpointFile, std::ios::app);
+    if (newFile) {
+        mCheckpoint << "seed " << mSeed << ' ' << mJobList.size() << ' ' << std::hex
+                    << fingerprint() << std::dec << '\n';
+    } else if (newLine) {
+        mCheckpoint << '\n';
+    }
+    mCheckpoint << std::setprecision(9) << std::flush;
+}
+
+void Simulator::appendCheckpoint(const CheckpointEntry& entry)
+{
+    const BatchResult& result = entry.result;
+    mCheckpoint << "batch " << entry.job << ' ' << entry.batch << ' ' << result.runs
+                << ' ' << result.errors << ' ' << result.reportedErrors << ' '
+                << result.biterrors << ' ' << result.encTime;
+    for (uint64_t word : result.timeStat.serialize()) {
+        mCheckpoint << ' ' << word;
+    }
+    mCheckpoint << std::endl;
+}
+
+void Simulator::saveProgress()
+{
+    // Finished jobs were evaluated already
+    for (DataPoint* job : mJobList) {
+        if (job->runs > 0 && !mProgress[job->id].done) {
+            calculateStatistics(job);
+        }
+    }
+    mSnapshot.clear();
+    for (const DataPoint* job : mJobList) {
+        mSnapshot.push_back(*job);
+    }
+    mLastSave = std::chrono::steady_clock::now();
+}
+
+void Simulator::writeFiles()
+{
+    // Whoever holds the file mutex writes everything queued until then, so
+    // the checkpoint lines keep their merge order and no older snapshot
+    // overwrites a newer one.
+    std::lock_guard<std::mutex> fileLock(mFileMutex);
+    std::vector<CheckpointEntry> entries;
+    std::vector<DataPoint> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mScheduleMutex);
+        entries.swap(mCheckpointQueue);
+        snapshot.swap(mSnapshot);
+    }
+
+    for (const CheckpointEntry& entry : entries) {
+        appendCheckpoint(entry);
+    }
+    if (!snapshot.empty()) {
+        std::vector<DataPoint*> jobs;
+        for (DataPoint& job : snapshot) {
+            jobs.push_back(&job);
+        }
+        writeResults(jobs);
+    }
+}
+
+uint64_t Simulator::seed() const { return mSeed; }
+
+DataPoint* Simulator::job(unsigned id) { return mJobList[id]; }
+
+unsigned Simulator::jobCount() const { return mJobList.size(); }
+
+const std::string& Simulator::connectPath() const { return mConnectPath; }
+
+void Simulator::addNodeProfile(DataPoint* job,
+                               const PolarCode::Decoding::NodeProfile& profile)
+{
+    std::lock_guard<std::mutex> lock(mScheduleMutex);
+    job->nodeProfile.merge(profile);
 }
 
 DataPoint* Simulator::getDefaultDataPoint()
@@ -493,9 +976,8 @@ void Simulator::configureComparisonSim()
 void Simulator::printCode()
 {
     DataPoint* config = getDefaultDataPoint();
-    auto constructor = new PolarCode::Construction::Bhattacharrya(
-        config->N, config->K, config->designSNR);
-    auto frozenBits = constructor->construct();
+    auto frozenBits =
+        PolarCode::Construction::frozen_bits(config->N, config->K, config->designSNR);
 
     unsigned counter = 0;
     for (unsigned i = 0; i < (unsigned)config->N; ++i) {
@@ -516,24 +998,66 @@ void Simulator::printCode()
 }
 
 
-void Simulator::saveResults()
+void Simulator::writeResults(const std::vector<DataPoint*>& jobs)
+{
+    if (mConfiguration->getString("simtype") == "compareall") {
+        saveComparisonResults(jobs);
+    } else {
+        saveResults(jobs);
+    }
+    saveLatencies(jobs);
+    saveNodeProfiles(jobs);
+}
+
+void Simulator::saveLatencies(const std::vector<DataPoint*>& jobs)
+{
+    std::string fileName = mConfiguration->getString("output");
+    fileName += "_";
+    fileName += mConfiguration->getString("simtype");
+    fileName += "_latency.json";
+    std::ofstream file(fileName + ".part");
+
+    // Decoding time histograms in seconds, one object per simulated job
+    file << "[\n";
+    bool first = true;
+    for (auto job : jobs) {
+        if (job->runs == 0) {
+            continue;
+        }
+        file << (first ? "" : ",\n") << "{\"N\": " << job->N << ", \"K\": " << job->K
+             << ", \"L\": " << job->L << ", \"Eb/N0\": " << job->EbN0
+             << ", \"time\": ";
+        job->timeStat.writeJson(file);
+        file << '}';
+        first = false;
+    }
+    file << "\n]\n";
+    file.close();
+
+    std::rename((fileName + ".part").c_str(), fileName.c_str());
+}
+
+void Simulator::saveResults(const std::vector<DataPoint*>& jobs)
 {
     std::string fileName = mConfiguration->getString("output");
     fileName += "_";
     fileName += mConfiguration->getString("simtype");
     fileName += ".csv";
-    std::ofstream file(fileName);
+    std::ofstream file(fileName + ".part");
 
 
     file << "\"N\",\"K\",\"dSNR\",\"C\",\"L\",\"Eb/"
             "N0\",\"BPS\",\"BLER\",\"BER\",\"RER\",\"Runs\",\"Errors\",\"Time\","
             "\"Blockspeed\",\"Coded Bitrate\",\"Payload Bitrate\",\"Effective Payload "
             "Bitrate\",\"Encoder Bitrate\",\"Amplification\",\"time min\",\"time "
-            "max\",\"time mean\",\"time deviation\""
+            "max\",\"time mean\",\"time deviation\",\"time p50\",\"time p99\",\"time "
+            "p99.9\",\"time p99.99\""
          << std::endl;
 
-    for (auto job : mJobList) {
-        std::vector<float> timeValues = job->timeStat.valueList();
+    for (auto job : jobs) {
+        if (job->runs == 0) {
+            continue; // Not simulated yet
+        }
         file << job->N << ',' << job->K << ',' << job->designSNR << ','
              << job->errorDetection << ',' << job->L << ',' << job->EbN0 << ','
              << job->bitsPerSymbol << ',';
@@ -553,32 +1077,67 @@ void Simulator::saveResults()
              << job->blps << ',' << job->cbps << ',' << job->pbps << ','
              << job->effectiveRate << ',' << job->ebps << ',' << job->amplification << ','
              << int(job->time.min * 1e9) << ',' << int(job->time.max * 1e9) << ','
-             << int(job->time.mean * 1e9) << ',' << int(job->time.dev * 1e9);
-        //      for(auto& tp : timeValues){
-        //        file << ',' << int(tp * 1e9);
-        //      }
+             << int(job->time.mean * 1e9) << ',' << int(job->time.dev * 1e9) << ','
+             << int(job->time.p50 * 1e9) << ',' << int(job->time.p99 * 1e9) << ','
+             << int(job->time.p999 * 1e9) << ',' << int(job->time.p9999 * 1e9);
         file << std::endl;
     }
     file.close();
+
+    // Replace partial results of a running simulation at once
+    std::rename((fileName + ".part").c_str(), fileName.c_str());
 }
 
-void Simulator::saveComparisonResults()
+void Simulator::saveNodeProfiles(const std::vector<DataPoint*>& jobs)
+{
+    // Snapshots from writeFiles() or the jobs after all workers are done
+    bool profiled = false;
+    for (auto job : jobs) {
+        profiled |= !job->nodeProfile.empty();
+    }
+    if (!profiled) {
+        return; // Library built without node profiling
+    }
+
+    std::string fileName = mConfiguration->getString("output");
+    fileName += "_";
+    fileName += mConfiguration->getString("simtype");
+    fileName += "_nodes.csv";
+    std::ofstream file(fileName + ".part");
+
+    PolarCode::Decoding::NodeProfile::writeCsvHeader(file,
+                                                     "\"N\",\"K\",\"L\",\"Eb/N0\",");
+    for (auto job : jobs) {
+        std::ostringstream columns;
+        columns << job->N << ',' << job->K << ',' << job->L << ',' << job->EbN0 << ',';
+        job->nodeProfile.writeCsvRows(file, columns.str());
+    }
+    file.close();
+
+    std::rename((fileName + ".part").c_str(), fileName.c_str());
+}
+
+void Simulator::saveComparisonResults(const std::vector<DataPoint*>& jobs)
 {
     std::string fileName = mConfiguration->getString("output");
     fileName += "_";
     fileName += mConfiguration->getString("simtype");
     fileName += ".csv";
-    std::ofstream file(fileName);
+    std::ofstream file(fileName + ".part");
 
 
     file << "\"Name\",\"N\",\"K\",\"dSNR\",\"C\",\"L\",\"Eb/"
             "N0\",\"BPS\",\"BLER\",\"BER\",\"RER\",\"Runs\",\"Errors\",\"Time\","
             "\"Blockspeed\",\"Coded Bitrate\",\"Payload Bitrate\",\"Effective Payload "
             "Bitrate\",\"Encoder Bitrate\",\"Amplification\",\"time min\",\"time "
-            "max\",\"time mean\",\"time deviation\""
+            "max\",\"time mean\",\"time deviation\",\"time p50\",\"time p99\",\"time "
+            "p99.9\",\"time p99.99\""
          << std::endl;
 
-    for (auto job : mJobList) {
+    for (auto job : jobs) {
+        if (job->runs == 0) {
+            continue; // Not simulated yet
+        }
         file << '"' << job->name << "\"," << job->N << ',' << job->K << ','
              << job->designSNR << ',' << job->errorDetection << ',' << job->L << ','
              << job->EbN0 << ',' << job->bitsPerSymbol << ',';
@@ -598,10 +1157,55 @@ void Simulator::saveComparisonResults()
              << job->blps << ',' << job->cbps << ',' << job->pbps << ','
              << job->effectiveRate << ',' << job->ebps << ',' << job->amplification << ','
              << int(job->time.min * 1e9) << ',' << int(job->time.max * 1e9) << ','
-             << int(job->time.mean * 1e9) << ',' << int(job->time.dev * 1e9);
+             << int(job->time.mean * 1e9) << ',' << int(job->time.dev * 1e9) << ','
+             << int(job->time.p50 * 1e9) << ',' << int(job->time.p99 * 1e9) << ','
+             << int(job->time.p999 * 1e9) << ',' << int(job->time.p9999 * 1e9);
         file << std::endl;
     }
     file.close();
+
+    // Replace partial results of a running simulation at once
+    std::rename((fileName + ".part").c_str(), fileName.c_str());
+}
+
+void calculateStatistics(DataPoint* job)
+{
+    job->time = job->timeStat.evaluate();
+    // job->timeStat.printContents();
+    job->bits = job->runs * (job->K - job->errorDetection);
+    job->BLER = (float)job->errors / job->runs;
+    job->BER = (double)job->biterrors / ((double)job->runs * (double)job->K);
+    job->RER = (float)job->reportedErrors / job->runs;
+    job->blps = job->runs;
+    job->cbps = job->runs * job->N;
+    job->pbps = job->bits;
+    job->ebps = job->cbps;
+    job->blps /= job->time.sum;
+    job->cbps /= job->time.sum;
+    job->pbps /= job->time.sum;
+    job->ebps /= job->encTime;
+    job->effectiveRate = (job->runs - job->errors + 0.0f) *
+                         (job->K - job->errorDetection) / job->time.sum;
+}
+
+void printJobResults(int workerId, const DataPoint* job)
+{
+    std::string output;
+    output.clear();
+
+    output += "[";
+    output += std::to_string(workerId);
+    output += "] BLER=" + std::to_string(job->BLER);
+    output += ", BER=" + std::to_string(job->BER);
+    output += ", RER=" + std::to_string(job->RER);
+    output += ", throughput:" + std::to_string(job->cbps * 1e-6);
+    output += "Mbps, delay[µs]=[" + std::to_string(job->time.min * 1e6);
+    output += ";" + std::to_string(job->time.max * 1e6);
+    output += "](" + std::to_string(job->time.mean * 1e6);
+    output += "," + std::to_string(job->time.dev * 1e6);
+    output += ") [min;max](mean,dev)\n";
+
+    std::cout << output;
 }
 
 void SimThread(Simulator* Sim, int workerId)
@@ -613,61 +1217,166 @@ void SimThread(Simulator* Sim, int workerId)
 
 SimulationWorker::SimulationWorker(Simulator* Sim, int workerId)
     : mSim(Sim),
-      mModulator(new SignalProcessing::Modulation::Bpsk()),
-      mDemodulator(new SignalProcessing::Modulation::Bpsk()),
-      mTransmitter(new SignalProcessing::Transmission::Awgn()),
-      mAmplifier(new SignalProcessing::Transmission::Scale()),
+      mChannel(new SignalProcessing::Transmission::FusedChannel()),
+      mDataGenerator(new SignalProcessing::Random::Philox()),
+      mConnection(nullptr),
+      mSeed(Sim->seed()),
       mWorkerId(workerId)
 {
 }
 
 SimulationWorker::~SimulationWorker()
 {
-    delete mTransmitter;
-    delete mModulator;
-    delete mDemodulator;
-    delete mAmplifier;
+    delete mChannel;
+    delete mDataGenerator;
+    delete mConnection;
+}
+
+bool SimulationWorker::connect()
+{
+    mConnection = Remote::Connection::connect(mSim->connectPath());
+    Remote::Message hello;
+    if (mConnection == nullptr || !mConnection->receive(&hello) ||
+        hello.type != Remote::HELLO) {
+        std::cout << "[" << mWorkerId << "] Cannot connect to "
+                  << mSim->connectPath() << std::endl;
+        return false;
+    }
+    if (hello.job != mSim->jobCount()) {
+        std::cout << "[" << mWorkerId
+                  << "] Job list differs from the coordinator, check the arguments."
+                  << std::endl;
+        return false;
+    }
+    mSeed = hello.seed;
+    return true;
+}
+
+bool SimulationWorker::requestWork(WorkUnit* unit)
+{
+    if (mConnection == nullptr) {
+        return mSim->getWork(unit, mJob);
+    }
+
+    Remote::Message message = {};
+    message.type = Remote::REQUEST;
+    if (!mConnection->send(message) || !mConnection->receive(&message) ||
+        message.type != Remote::WORK) {
+        return false;
+    }
+    unit->job = mSim->job(message.job);
+    unit->batch = message.batch;
+    unit->firstBlock = message.firstBlock;
+    unit->blockCount = message.blockCount;
+    return true;
+}
+
+bool SimulationWorker::submitBatch(const WorkUnit& unit)
+{
+    if (mConnection == nullptr) {
+        return mSim->submitWork(unit, &mBatch);
+    }
+
+    // The coordinator merges and reports
+    Remote::Message message = {};
+    message.type = Remote::RESULT;
+    message.job = unit.job->id;
+    message.batch = unit.batch;
+    message.runs = mBatch.runs;
+    message.errors = mBatch.errors;
+    message.reportedErrors = mBatch.reportedErrors;
+    message.biterrors = mBatch.biterrors;
+    message.encTime = mBatch.encTime;
+    std::vector<uint64_t> times = mBatch.timeStat.serialize();
+    message.wordCount = times.size();
+    mConnection->send(message, times);
+    return false;
 }
 
 void SimulationWorker::run()
 {
-    while ((mJob = mSim->getJob()) != nullptr) {
-        jobStartingOutput();
-        selectFrozenBits();
-        setCoders();
-        setErrorDetector();
-        setChannel();
-        allocateMemory();
-
-        unsigned long blocksToSimulate = mJob->BlocksToSimulate;
-        unsigned long warmUpBlocks = std::min(blocksToSimulate / 8, 1000UL);
-
-        // Warmup
-        warmup = true;
-        for (unsigned block = 0; block < warmUpBlocks; ++block) {
-            generateData();
-            encode();
-            modulate();
-            transmit();
-            demodulate();
-            decode();
-            countErrors();
+    WorkUnit unit;
+    mJob = nullptr;
+
+    if (!mSim->connectPath().empty() && !connect()) {
+        return;
+    }
+
+    while (requestWork(&unit)) {
+        if (unit.job != mJob) {
+            if (mJob != nullptr) {
+                cleanup();
+            }
+            mJob = unit.job;
+            startJob();
         }
 
-        // Actual simulation
-        warmup = false;
-        for (unsigned block = 0; block < blocksToSimulate; ++block) {
-            generateData();
-            encode();
-            modulate();
-            transmit();
-            demodulate();
-            decode();
-            countErrors();
+        simulateBatch(unit);
+        if (submitBatch(unit)) {
+            jobEndingOutput();
         }
-        calculateStatistics();
+    }
+
+    if (mJob != nullptr) {
         cleanup();
-        jobEndingOutput();
+    }
+}
+
+void SimulationWorker::startJob()
+{
+    jobStartingOutput();
+    selectFrozenBits();
+    setCoders();
+    setErrorDetector();
+    setChannel();
+    allocateMemory();
+
+    // Every job draws from its own streams, independent of the worker running it
+    mDataGenerator->seed(mSeed, 2 * mJob->id);
+    mChannel->seed(mSeed, 2 * mJob->id + 1);
+
+    // Warmup, on blocks beyond the workload. Only once per code and worker, as
+    // workers switch between the SNR points of a code all the time.
+    const codekey_t code(mJob->N,
+                         mJob->K,
+                         mJob->L,
+                         mJob->designSNR,
+                         mJob->precision,
+                         int(mJob->decoderType),
+                         mJob->codingScheme,
+                         mJob->errorDetection,
+                         mJob->errorDetectionType,
+                         mJob->systematic);
+    if (!mWarmCodes.insert(code).second) {
+        return;
+    }
+    warmup = true;
+    unsigned long blocksToSimulate = mJob->BlocksToSimulate;
+    unsigned long warmUpBlocks = std::min(blocksToSimulate / 8, BATCH_BLOCKS);
+    for (unsigned long block = 0; block < warmUpBlocks; ++block) {
+        seekBlock(blocksToSimulate + block);
+        generateData();
+        encode();
+        transmit();
+        decode();
+        countErrors();
+    }
+}
+
+void SimulationWorker::simulateBatch(const WorkUnit& unit)
+{
+    mBatch = BatchResult();
+    warmup = false;
+
+    for (unsigned long block = unit.firstBlock;
+         block < unit.firstBlock + unit.blockCount;
+         ++block) {
+        seekBlock(block);
+        generateData();
+        encode();
+        transmit();
+        decode();
+        countErrors();
     }
 }
 
@@ -686,11 +1395,9 @@ void SimulationWorker::stopTiming()
 void SimulationWorker::selectFrozenBits()
 {
     if (mJob->decoderType != PolarCode::Decoding::DecoderType::tFixed) {
-        mConstructor =
-            new PolarCode::Construction::Bhattacharrya(mJob->N, mJob->K, mJob->designSNR);
-        mFrozenBits = mConstructor->construct();
+        mFrozenBits =
+            PolarCode::Construction::frozen_bits(mJob->N, mJob->K, mJob->designSNR);
     } else {
-        mConstructor = nullptr;
         //		std::vector<PolarCode::Decoding::CodingScheme> &registry =
         // PolarCode::Decoding::codeRegistry; 		std::vector<unsigned> &frozenBits
         // = registry[mJob->codingScheme].frozenBits;
@@ -703,9 +1410,11 @@ void SimulationWorker::selectFrozenBits()
 void SimulationWorker::setCoders()
 {
     mEncoder = new PolarCode::Encoding::ButterflyFipPacked(mJob->N, mFrozenBits);
+    mCharInput = false;
 #if __GNUC__ < 6
     if (mJob->decoderType == PolarCode::Decoding::DecoderType::tFixed) {
         mDecoder = new PolarCode::Decoding::FastSscFipChar(mJob->N, mFrozenBits);
+        mCharInput = true;
 #else
     if (mJob->decoderType == PolarCode::Decoding::DecoderType::tFixed) {
         // mDecoder = new PolarCode::Decoding::FixedChar(mJob->codingScheme);
@@ -745,6 +1454,7 @@ void SimulationWorker::setCoders()
             case 8:
             case 832:
                 mDecoder = new PolarCode::Decoding::FastSscFipChar(mJob->N, mFrozenBits);
+                mCharInput = true;
                 break;
             case 32:
                 mDecoder = new PolarCode::Decoding::FastSscAvxFloat(mJob->N, mFrozenBits);
@@ -765,10 +1475,6 @@ void SimulationWorker::setCoders()
 
 void SimulationWorker::setErrorDetector()
 {
-    if (mJob->errorDetection >= mJob->K) {
-        mJob->errorDetection = 0;
-        mJob->errorDetectionType = "none";
-    }
     if (mJob->errorDetectionType == "crc") {
         switch (mJob->errorDetection) {
         case 8:
@@ -820,12 +1526,7 @@ void SimulationWorker::setErrorDetector()
 
 void SimulationWorker::setChannel()
 {
-    if (mJob->bitsPerSymbol > 1) {
-        delete mModulator;
-        delete mDemodulator;
-        mModulator = new SignalProcessing::Modulation::Ask(mJob->bitsPerSymbol);
-        mDemodulator = new SignalProcessing::Modulation::Ask(mJob->bitsPerSymbol);
-    }
+    mChannel->setBitsPerSymbol(mJob->bitsPerSymbol);
     // Set channel SNR to energy per bit over noise energy for
     // AWGN channels.
     // Source: Chapter 11.4. in Nachrichtenübertragung by K.-D. Kammeyer, 2011
@@ -835,35 +1536,34 @@ void SimulationWorker::setChannel()
     float EsN0_linear = EbN0_linear * mJob->bitsPerSymbol /* * 2.0*/;
     EsN0_linear *= mJob->K;
     EsN0_linear /= mJob->N;
-    mTransmitter->setEsN0Linear(EsN0_linear);
+    mChannel->setEsN0Linear(EsN0_linear);
 
-    mAmplifier->setFactor(mJob->amplification);
+    mChannel->setAmplification(mJob->amplification);
 }
 
 void SimulationWorker::allocateMemory()
 {
     mInputData = new unsigned char[mJob->K / 8];
     mEncodedData = new PolarCode::PackedContainer(mJob->N);
+    if (mCharInput) {
+        mCharLlr.resize(mJob->N);
+    } else {
+        mLlr.resize(mJob->N);
+    }
     mDecodedData = nullptr;
 }
 
+void SimulationWorker::seekBlock(uint64_t block)
+{
+    // Block n of a job always sees the same data and noise
+    mDataGenerator->setBlock(block);
+    mChannel->setBlock(block);
+}
+
 void SimulationWorker::generateData()
 {
-    SignalProcessing::Random::Generator generator;
-    unsigned long* lData = reinterpret_cast<unsigned long*>(mInputData);
     unsigned nBits = mJob->K - mJob->errorDetection;
-    unsigned nLongs = nBits / 64;
-    unsigned nBytes = (nBits - nLongs * 64) / 8;
-
-
-    for (unsigned i = 0; i < nLongs; ++i) {
-        generator.get64(lData + i);
-    }
-    if (nBytes) {
-        unsigned long rem;
-        generator.get64(&rem);
-        memcpy(lData + nLongs, &rem, nBytes);
-    }
+    mDataGenerator->fill(mInputData, nBits / 8);
 }
 
 void SimulationWorker::encode()
@@ -874,66 +1574,38 @@ void SimulationWorker::encode()
     mEncoder->getEncodedData(mEncodedData->data());
     stopTiming();
     if (!warmup)
-        mJob->encTime += mTimeUsed.count();
-}
-
-void SimulationWorker::modulate()
-{
-    mModulator->setInputData(mEncodedData);
-    mModulator->modulate();
-    mSignal = mModulator->outputSignal();
+        mBatch.encTime += mTimeUsed.count();
 }
 
 void SimulationWorker::transmit()
 {
-    /*	float sum = 0.0f;
-            for(float f : *mSignal) {
-                    sum += f * f;
-            }
-            sum /= mSignal->size();
-            std::cout << "Pre-transmit energy: " << sum << std::endl
-                              << "Expected energy: " << 1.0f << std::endl
-                              << std::endl;
-    */
-    mTransmitter->setSignal(mSignal);
-    mTransmitter->transmit();
-    /*
-            sum = 0.0f;
-            for(float f : *mSignal) {
-                    sum += f * f;
-            }
-            sum /= mSignal->size();
-            std::cout << "Post-transmit energy: " << sum << std::endl
-                              << "Expected energy: " << (1.0f + 0.5f /
-       mTransmitter->EsNoLin()) << std::endl
-                              << std::endl;
-    */
-}
-
-void SimulationWorker::demodulate()
-{
-    mDemodulator->setInputSignal(mSignal);
-    mDemodulator->demodulate();
-    mSignal = mDemodulator->outputSignal();
+    // Modulation, noise, demodulation and amplification in one pass
+    const unsigned char* bits = reinterpret_cast<unsigned char*>(mEncodedData->data());
+    if (mCharInput) {
+        mChannel->transmit(bits, mJob->N, mCharLlr.data());
+    } else {
+        mChannel->transmit(bits, mJob->N, mLlr.data());
+    }
 }
 
 void SimulationWorker::decode()
 {
     bool success;
 
-    mAmplifier->setSignal(mSignal);
-    mAmplifier->transmit();
-
     startTiming();
-    mDecoder->setSignal(mSignal->data());
+    if (mCharInput) {
+        mDecoder->setSignal(mCharLlr.data());
+    } else {
+        mDecoder->setSignal(mLlr.data());
+    }
     success = mDecoder->decode();
     mDecodedData = mDecoder->packedOutput();
     stopTiming();
 
     if (!success && !warmup)
-        mJob->reportedErrors++;
+        mBatch.reportedErrors++;
     if (!warmup)
-        mJob->timeStat.insert(mTimeUsed.count());
+        mBatch.timeStat.insert(mTimeUsed.count());
 }
 
 void SimulationWorker::countErrors()
@@ -956,34 +1628,14 @@ void SimulationWorker::countErrors()
         biterrors += _mm_popcnt_u64(remIn ^ remOut);
     }
     if (!warmup) {
-        mJob->biterrors += biterrors;
+        mBatch.biterrors += biterrors;
         if (biterrors) {
-            mJob->errors++;
+            mBatch.errors++;
         }
-        mJob->runs++;
+        mBatch.runs++;
     }
 }
 
-void SimulationWorker::calculateStatistics()
-{
-    mJob->time = mJob->timeStat.evaluate();
-    // mJob->timeStat.printContents();
-    mJob->bits = mJob->runs * (mJob->K - mJob->errorDetection);
-    mJob->BLER = (float)mJob->errors / mJob->runs;
-    mJob->BER = (double)mJob->biterrors / ((double)mJob->runs * (double)mJob->K);
-    mJob->RER = (float)mJob->reportedErrors / mJob->runs;
-    mJob->blps = mJob->runs;
-    mJob->cbps = mJob->runs * mJob->N;
-    mJob->pbps = mJob->bits;
-    mJob->ebps = mJob->cbps;
-    mJob->blps /= mJob->time.sum;
-    mJob->cbps /= mJob->time.sum;
-    mJob->pbps /= mJob->time.sum;
-    mJob->ebps /= mJob->encTime;
-    mJob->effectiveRate = (mJob->runs - mJob->errors + 0.0f) *
-                          (mJob->K - mJob->errorDetection) / mJob->time.sum;
-}
-
 void SimulationWorker::jobStartingOutput()
 {
     std::string output;
@@ -1003,36 +1655,18 @@ void SimulationWorker::jobStartingOutput()
     std::cout << output;
 }
 
-void SimulationWorker::jobEndingOutput()
-{
-    std::string output;
-    output.clear();
-
-    output += "[";
-    output += std::to_string(mWorkerId);
-    output += "] BLER=" + std::to_string(mJob->BLER);
-    output += ", BER=" + std::to_string(mJob->BER);
-    output += ", RER=" + std::to_string(mJob->RER);
-    output += ", throughput:" + std::to_string(mJob->cbps * 1e-6);
-    output += "Mbps, delay[µs]=[" + std::to_string(mJob->time.min * 1e6);
-    output += ";" + std::to_string(mJob->time.max * 1e6);
-    output += "](" + std::to_string(mJob->time.mean * 1e6);
-    output += "," + std::to_string(mJob->time.dev * 1e6);
-    output += ") [min;max](mean,dev)\n";
-
-    std::cout << output;
-}
+void SimulationWorker::jobEndingOutput() { printJobResults(mWorkerId, mJob); }
 
 void SimulationWorker::cleanup()
 {
+    mSim->addNodeProfile(mJob, mDecoder->nodeProfile());
+
     delete[] mInputData;
     delete mEncodedData;
 
     delete mDecoder;
     delete mEncoder;
     delete mErrorDetector;
-    if (mConstructor)
-        delete mConstructor;
 }
 
 } // namespace Simulation
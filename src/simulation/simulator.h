@@ -9,22 +9,26 @@
 #ifndef PCSIM_SIMULATOR_H
 #define PCSIM_SIMULATOR_H
 
-#include <atomic>
 #include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
 #include <queue>
+#include <set>
+#include <tuple>
 
 
-#include <polarcode/construction/bhattacharrya.h>
+#include <polarcode/construction/constructor.h>
 #include <polarcode/decoding/decoder.h>
 #include <polarcode/encoding/encoder.h>
 #include <polarcode/errordetection/errordetector.h>
 
-#include <signalprocessing/modulation/bpsk.h>
+#include <signalprocessing/philox.h>
 #include <signalprocessing/random.h>
 
-#include <signalprocessing/transmission/awgn.h>
-#include <signalprocessing/transmission/scale.h>
+#include <signalprocessing/transmission/fusedchannel.h>
 
+#include "remote.h"
 #include "setup.h"
 #include "statistics.h"
 
@@ -74,6 +78,7 @@ inline std::string errorDetectionStringToType(std::string errDetStr)
  */
 struct DataPoint {
     std::string name;
+    unsigned id; ///< Position in the job list, selects the random streams and progress
 
     // Codec-Parameters
     float designSNR;    ///< Design-SNR for code construction
@@ -91,7 +96,7 @@ struct DataPoint {
 
     // Simulation-Parameters
     float EbN0;            ///< Bit-energy to noise-energy ratio for AWGN-channel
-    long BlocksToSimulate; ///< Determines the BLER-precision
+    long BlocksToSimulate; ///< Upper limit of blocks, if the error target is not met
     int precision;         ///< Quantization bits per symbol (32-bit float or 8-bit int)
     float amplification;   ///< Amplification factor to optimize 8-bit quantization
     int bitsPerSymbol;
@@ -118,17 +123,142 @@ struct DataPoint {
     float effectiveRate; ///< Successfully transmitted payload bits per second
     float encTime;       ///< Encoding time in seconds
     float ebps;          ///< Encoder speed in bits per second
+
+    PolarCode::Decoding::NodeProfile nodeProfile; ///< Empty without profiling build
+};
+
+/*!
+ * \brief Derive rates and timing figures from the counters of a job.
+ */
+void calculateStatistics(DataPoint* job);
+
+/*!
+ * \brief Print the results of a finished job.
+ */
+void printJobResults(int workerId, const DataPoint* job);
+
+/*!
+ * \brief A batch of consecutive blocks of one job, the unit of work of a thread.
+ */
+struct WorkUnit {
+    DataPoint* job;
+    unsigned long batch;      ///< Index of this batch within the job
+    unsigned long firstBlock; ///< Block index, selecting data and noise
+    unsigned long blockCount;
+};
+
+/*!
+ * \brief Counters of a finished WorkUnit.
+ */
+struct BatchResult {
+    long runs;
+    long errors;
+    long reportedErrors;
+    long biterrors;
+    float encTime;
+    Statistics timeStat;
+};
+
+/*!
+ * \brief A merged batch, waiting to be logged to the checkpoint file.
+ */
+struct CheckpointEntry {
+    unsigned job;
+    unsigned long batch;
+    BatchResult result;
+};
+
+/*!
+ * \brief Scheduling state of a job.
+ *
+ * Batches can finish in any order. They are merged into the DataPoint in
+ * batch order only, and the job stops at the first batch that reaches the
+ * error target. This makes results independent of the thread count.
+ */
+struct JobProgress {
+    unsigned long issuedBatches;
+    unsigned long mergedBatches;
+    unsigned workers; ///< Threads currently assigned to this job
+    bool started;
+    bool done;
+    std::map<unsigned long, BatchResult> pending; ///< Finished, but not merged
+    std::vector<unsigned long> requeued; ///< Batches of lost remote workers
 };
 
 /*!
  * \brief The Simulator class
+ *
+ * Every job (SNR point) is split into batches of blocks, which are handed
+ * out to all threads. A thread keeps working on its job while there are
+ * batches left and then joins the job with the fewest threads, so idle
+ * threads move to the slowest points. A job stops early once it reached
+ * the target number of block errors.
  */
 class Simulator
 {
     Setup::Configurator* mConfiguration;
 
     std::vector<DataPoint*> mJobList;
-    std::atomic<unsigned> mNextJob;
+    std::vector<JobProgress> mProgress;
+    std::mutex mScheduleMutex;
+    unsigned mOpenJobs;
+    long mTargetErrors;
+    uint64_t mSeed;
+
+    std::string mCheckpointFile;
+    std::ofstream mCheckpoint; ///< Append-only log of merged batches
+    std::chrono::steady_clock::time_point mLastSave;
+
+    // Files are written outside of mScheduleMutex. Merges queue their output
+    // under it, and writeFiles() takes the queue under mFileMutex.
+    std::mutex mFileMutex;
+    std::vector<CheckpointEntry> mCheckpointQueue; ///< Merged, not yet logged
+    std::vector<DataPoint> mSnapshot;              ///< Results not yet written
+
+    int mProcesses;
+    std::string mListenPath;  ///< Coordinator socket, if any
+    std::string mConnectPath; ///< Coordinator to work for, if any
+
+    bool batchesLeft(const DataPoint* job);
+    void runThreads();
+    void coordinate();
+    void serve(int socket);
+    bool finished();
+
+    /*!
+     * \brief Hand back the work of a lost remote worker.
+     * \param unit The unfinished batch, or nullptr.
+     * \param current The job the worker was assigned to, or nullptr.
+     */
+    void returnWork(const WorkUnit* unit, DataPoint* current);
+
+    /*!
+     * \brief Merge the next batch of a job in order.
+     * \return True, if the job is done afterwards.
+     */
+    bool mergeBatch(DataPoint* job, const BatchResult& result);
+
+    /*!
+     * \brief Hash of all job parameters, the error target and the batch size.
+     *        A checkpoint is only resumed by a run with the same fingerprint.
+     */
+    uint64_t fingerprint() const;
+
+    void resumeCheckpoint();
+    void openCheckpoint();
+    void appendCheckpoint(const CheckpointEntry& entry);
+
+    /*!
+     * \brief Take a snapshot of all jobs for the result files.
+     *        The caller holds mScheduleMutex.
+     */
+    void saveProgress();
+
+    /*!
+     * \brief Log the queued batches and write the latest snapshot, in the
+     *        order they were queued. The caller must not hold mScheduleMutex.
+     */
+    void writeFiles();
 
     DataPoint* getDefaultDataPoint();
     void configureSingleRun();
@@ -145,8 +275,11 @@ class Simulator
     void configureComparisonSim();
     void printCode();
 
-    void saveResults();
-    void saveComparisonResults();
+    void writeResults(const std::vector<DataPoint*>& jobs);
+    void saveResults(const std::vector<DataPoint*>& jobs);
+    void saveLatencies(const std::vector<DataPoint*>& jobs);
+    void saveNodeProfiles(const std::vector<DataPoint*>& jobs);
+    void saveComparisonResults(const std::vector<DataPoint*>& jobs);
 
 public:
     /*!
@@ -161,19 +294,54 @@ public:
     void run();
 
     /*!
-     * \brief Worker threads can poll for jobs by getJob().
+     * \brief Worker threads poll for batches of blocks by getWork().
      *
-     * This function returns a pointer to a DataPoint structure, which contains
-     * simulation parameters and return values.
+     * \param unit Receives the job and block range to simulate.
+     * \param current The job the calling thread is set up for, or nullptr.
+     * \return False, if all work is handed out.
+     */
+    bool getWork(WorkUnit* unit, DataPoint* current);
+
+    /*!
+     * \brief Report the counters of a finished batch.
+     *
+     * Merged batches are logged to the checkpoint file, and the result file
+     * is rewritten when a job finishes, or every 30 seconds.
      *
-     * \return Pointer to a previously unassigned job or nullptr, if all work is done.
+     * \return True, if this batch completed its job.
+     */
+    bool submitWork(const WorkUnit& unit, BatchResult* result);
+
+    /*!
+     * \brief Get the seed of all random number generators of this simulation.
+     */
+    uint64_t seed() const;
+
+    /*!
+     * \brief Get a job by its index.
+     */
+    DataPoint* job(unsigned id);
+
+    /*!
+     * \brief Get the number of jobs.
+     */
+    unsigned jobCount() const;
+
+    /*!
+     * \brief Get the coordinator socket of a worker process, or an empty string.
      */
-    DataPoint* getJob();
+    const std::string& connectPath() const;
+
+    /*!
+     * \brief Add the node profile of a worker's decoder to a job.
+     */
+    void addNodeProfile(DataPoint* job, const PolarCode::Decoding::NodeProfile& profile);
 };
 
 /*!
- * SimThread is a function which pulls and executes a row of jobs from
- * the given Simulator object until Simulator::getJob() returns nullptr.
+ * SimThread is a function which pulls and executes batches of blocks from
+ * the given Simulator object until Simulator::getWork() returns false.
+ * In a worker process, the batches come from the coordinator instead.
  */
 void SimThread(Simulator*, int workerId);
 
@@ -187,20 +355,23 @@ class SimulationWorker
 {
     Simulator* mSim;
     DataPoint* mJob;
-    PolarCode::Construction::Bhattacharrya* mConstructor;
+    BatchResult mBatch; ///< Counters of the current batch
     PolarCode::Encoding::Encoder* mEncoder;
     PolarCode::Decoding::Decoder* mDecoder;
     PolarCode::ErrorDetection::Detector* mErrorDetector;
 
-    SignalProcessing::Modulation::Modem *mModulator, *mDemodulator;
-    SignalProcessing::Transmission::Awgn* mTransmitter;
-    SignalProcessing::Transmission::Scale* mAmplifier;
+    SignalProcessing::Transmission::FusedChannel* mChannel;
+    SignalProcessing::Random::Philox* mDataGenerator;
+    Remote::Connection* mConnection; ///< Link to a coordinator process, if any
+    uint64_t mSeed;
 
     std::vector<unsigned> mFrozenBits;
 
     unsigned char* mInputData;
     PolarCode::PackedContainer* mEncodedData;
-    std::vector<float>* mSignal;
+    std::vector<float> mLlr;
+    std::vector<char> mCharLlr;
+    bool mCharInput; ///< Pass 8-bit LLRs to the decoder
     unsigned char* mDecodedData;
 
     std::chrono::high_resolution_clock::time_point mTimeStart, mTimeEnd;
@@ -209,6 +380,20 @@ class SimulationWorker
     int mWorkerId;
     bool warmup;
 
+    /*!
+     * \brief Parameters that select the code and its coders, same for all SNR
+     *        points of a code.
+     */
+    typedef std::tuple<int, int, int, float, int, int, int, int, std::string, bool>
+        codekey_t;
+    std::set<codekey_t> mWarmCodes; ///< Codes this worker has warmed up for
+
+    bool connect();
+    bool requestWork(WorkUnit* unit);
+    bool submitBatch(const WorkUnit& unit);
+    void startJob();
+    void simulateBatch(const WorkUnit& unit);
+
     void startTiming();
     void stopTiming();
 
@@ -218,16 +403,13 @@ class SimulationWorker
     void setChannel();
     void allocateMemory();
 
+    void seekBlock(uint64_t block);
     void generateData();
     void encode();
-    void modulate();
     void transmit();
-    void demodulate();
     void decode();
     void countErrors();
 
-    void calculateStatistics();
-
     void jobStartingOutput();
     void jobEndingOutput();
 
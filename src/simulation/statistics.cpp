@@ -8,63 +8,251 @@
 
 #include "statistics.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
 
 namespace Simulation {
 
-Statistics::Statistics() {}
+namespace {
+
+/*!
+ * \brief Bucketed range of 2^-30 to 2^10, about a nanosecond to 17 minutes.
+ */
+const int MIN_EXPONENT = -30;
+const int MAX_EXPONENT = 10;
+
+const unsigned MANTISSA_SHIFT = 23 - Statistics::SUB_BUCKET_BITS;
+const uint32_t FIRST_BUCKET = uint32_t(127 + MIN_EXPONENT) << Statistics::SUB_BUCKET_BITS;
+const size_t BUCKET_COUNT = size_t(MAX_EXPONENT - MIN_EXPONENT)
+                            << Statistics::SUB_BUCKET_BITS;
+
+uint32_t floatBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsFloat(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint64_t doubleBits(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/*!
+ * \brief The exponent and the upper mantissa bits of a float form a log-linear
+ *        bucket index, values out of range go to the first or last bucket.
+ */
+size_t bucketIndex(float value)
+{
+    const float lowest = ldexpf(1.0f, MIN_EXPONENT);
+    if (!(value > lowest)) {
+        return 0;
+    }
+    size_t index = (floatBits(value) >> MANTISSA_SHIFT) - FIRST_BUCKET;
+    return std::min(index, BUCKET_COUNT - 1);
+}
+
+float bucketLowerBound(size_t index)
+{
+    return bitsFloat(uint32_t(index + FIRST_BUCKET) << MANTISSA_SHIFT);
+}
+
+} // namespace
+
+Statistics::Statistics() { clear(); }
 
 Statistics::~Statistics() {}
 
-void Statistics::insert(float value) { mContainer.push_back(value); }
+void Statistics::insert(float value)
+{
+    if (mBuckets.empty()) {
+        mBuckets.resize(BUCKET_COUNT);
+    }
+    mBuckets[bucketIndex(value)]++;
+    const double oldMean = mCount > 0 ? mSum / mCount : 0.0;
+    mCount++;
+    mSum += value;
+    mSquareDeviation += (value - oldMean) * (value - mSum / mCount);
+    mMin = std::min(mMin, value);
+    mMax = std::max(mMax, value);
+}
+
+void Statistics::clear()
+{
+    mBuckets.clear();
+    mCount = 0;
+    mSum = 0.0;
+    mSquareDeviation = 0.0;
+    mMin = std::numeric_limits<float>::infinity();
+    mMax = -std::numeric_limits<float>::infinity();
+}
 
-void Statistics::clear() { mContainer.clear(); }
+void Statistics::merge(const Statistics& other)
+{
+    if (other.mCount == 0) {
+        return;
+    }
+    if (mBuckets.empty()) {
+        mBuckets.resize(BUCKET_COUNT);
+    }
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        mBuckets[i] += other.mBuckets[i];
+    }
+    if (mCount > 0) {
+        const double delta = other.mSum / other.mCount - mSum / mCount;
+        mSquareDeviation += delta * delta * mCount / (mCount + other.mCount) *
+                            other.mCount;
+    }
+    mSquareDeviation += other.mSquareDeviation;
+    mCount += other.mCount;
+    mSum += other.mSum;
+    mMin = std::min(mMin, other.mMin);
+    mMax = std::max(mMax, other.mMax);
+}
 
-StatisticsOutput Statistics::evaluate()
+StatisticsOutput Statistics::evaluate() const
 {
     StatisticsOutput ret;
 
-    if (mContainer.empty()) {
+    if (mCount == 0) {
         return { 0 };
     }
 
-    unsigned size = mContainer.size();
-    unsigned minIdx = 0, maxIdx = 0;
-    float sum = 0.0, mean;
+    double mean = mSum / mCount;
+    ret.min = mMin;
+    ret.max = mMax;
+    ret.mean = mean;
+    ret.sum = mSum;
 
-    // Find minimum, maximum and calculate mean
-    for (unsigned i = 0; i < size; ++i) {
-        sum += mContainer[i];
-        if (mContainer[i] < mContainer[minIdx]) {
-            minIdx = i;
-        } else if (mContainer[i] > mContainer[maxIdx]) {
-            maxIdx = i;
-        }
+    double variance = 0.0;
+    if (mCount > 1) {
+        variance = mSquareDeviation / (mCount - 1);
     }
-    mean = sum / size;
+    ret.dev = sqrt(variance);
 
-    ret.min = mContainer[minIdx];
-    ret.max = mContainer[maxIdx];
-    ret.mean = mean;
-    ret.sum = sum;
+    ret.p50 = percentile(0.5);
+    ret.p99 = percentile(0.99);
+    ret.p999 = percentile(0.999);
+    ret.p9999 = percentile(0.9999);
+    return ret;
+}
 
-    // Calculate deviation
-    sum = 0.0;
-    for (unsigned i = 0; i < size; ++i) {
-        float tmp = mContainer[i] - mean;
-        sum += tmp * tmp;
+float Statistics::percentile(double fraction) const
+{
+    if (mCount == 0) {
+        return 0.0f;
     }
-    ret.dev = sqrt(sum / (size - 1));
 
-    return ret;
+    uint64_t rank = std::max<uint64_t>(1, ceil(fraction * mCount));
+    uint64_t seen = 0;
+    size_t index = 0;
+    while (index < BUCKET_COUNT - 1 && (seen += mBuckets[index]) < rank) {
+        ++index;
+    }
+
+    float center = (bucketLowerBound(index) + bucketLowerBound(index + 1)) / 2;
+    return std::min(std::max(center, mMin), mMax);
+}
+
+void Statistics::printContents() { writeCsv(std::cout); }
+
+void Statistics::writeJson(std::ostream& stream) const
+{
+    StatisticsOutput out = evaluate();
+    stream << "{\"count\": " << mCount << ", \"min\": " << out.min
+           << ", \"max\": " << out.max << ", \"mean\": " << out.mean
+           << ", \"dev\": " << out.dev << ", \"p50\": " << out.p50
+           << ", \"p99\": " << out.p99 << ", \"p99.9\": " << out.p999
+           << ", \"p99.99\": " << out.p9999 << ", \"buckets\": [";
+    bool first = true;
+    for (size_t i = 0; i < mBuckets.size(); ++i) {
+        if (mBuckets[i] == 0) {
+            continue;
+        }
+        stream << (first ? "" : ", ") << '[' << bucketLowerBound(i) << ", "
+               << bucketLowerBound(i + 1) << ", " << mBuckets[i] << ']';
+        first = false;
+    }
+    stream << "]}";
 }
 
-void Statistics::printContents()
+void Statistics::writeCsv(std::ostream& stream) const
 {
-    for (float f : mContainer) {
-        std::cout << f << std::endl;
+    for (size_t i = 0; i < mBuckets.size(); ++i) {
+        if (mBuckets[i] != 0) {
+            stream << bucketLowerBound(i) << ',' << bucketLowerBound(i + 1) << ','
+                   << mBuckets[i] << std::endl;
+        }
+    }
+}
+
+std::vector<uint64_t> Statistics::serialize() const
+{
+    // Count, sum, squared deviation and limits, then pairs of bucket index and count
+    std::vector<uint64_t> words = { mCount,
+                                     doubleBits(mSum),
+                                     doubleBits(mSquareDeviation),
+                                     uint64_t(floatBits(mMin)) << 32 | floatBits(mMax) };
+    for (size_t i = 0; i < mBuckets.size(); ++i) {
+        if (mBuckets[i] != 0) {
+            words.push_back(i);
+            words.push_back(mBuckets[i]);
+        }
+    }
+    return words;
+}
+
+bool Statistics::deserialize(const std::vector<uint64_t>& words)
+{
+    clear();
+    if (words.size() < 4 || words.size() % 2 != 0) {
+        return false;
+    }
+
+    uint64_t count = 0;
+    mBuckets.resize(BUCKET_COUNT);
+    for (size_t i = 4; i < words.size(); i += 2) {
+        if (words[i] >= BUCKET_COUNT) {
+            clear();
+            return false;
+        }
+        mBuckets[words[i]] += words[i + 1];
+        count += words[i + 1];
+    }
+    if (count != words[0]) {
+        clear();
+        return false;
+    }
+
+    mCount = words[0];
+    mSum = bitsDouble(words[1]);
+    mSquareDeviation = bitsDouble(words[2]);
+    mMin = bitsFloat(words[3] >> 32);
+    mMax = bitsFloat(uint32_t(words[3]));
+    if (!(mSquareDeviation >= 0.0) || (mCount > 0 && !(mMin <= mMax))) {
+        clear();
+        return false;
     }
+    return true;
 }
 
 } // namespace Simulation
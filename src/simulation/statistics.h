@@ -9,6 +9,8 @@
 #ifndef PCSIM_STATISTICS_H
 #define PCSIM_STATISTICS_H
 
+#include <cstdint>
+#include <ostream>
 #include <vector>
 
 namespace Simulation {
@@ -17,24 +19,79 @@ struct StatisticsOutput {
     float min, max;
     float mean, dev;
     float sum;
+    float p50, p99, p999, p9999; ///< Percentiles, see Statistics::percentile()
 };
 
+/*!
+ * \brief Streaming histogram of positive values, such as decoding times.
+ *
+ * Values are counted in log-linear buckets, as in HdrHistogram: every power of
+ * two is split into 2^SUB_BUCKET_BITS equal buckets. Memory stays constant for
+ * any number of values, and histograms of several threads or processes merge
+ * without loss. Count, sum, minimum and maximum are exact. The deviation is
+ * accumulated with Welford's algorithm and merged with the pairwise update of
+ * Chan et al., so it does not suffer from cancellation like a sum of squares.
+ */
 class Statistics
 {
-    std::vector<float> mContainer;
+    std::vector<uint64_t> mBuckets; ///< Allocated on first use
+    uint64_t mCount;
+    double mSum;
+    double mSquareDeviation; ///< Sum of squared differences from the mean
+    float mMin, mMax;
 
 public:
+    /*!
+     * \brief Percentiles are off by at most half a bucket, 1/256 of the value.
+     */
+    static const unsigned SUB_BUCKET_BITS = 7;
+
     Statistics();
     ~Statistics();
 
     void insert(float value);
     void clear();
 
-    StatisticsOutput evaluate();
+    /*!
+     * \brief Add all values of another histogram.
+     */
+    void merge(const Statistics& other);
+
+    StatisticsOutput evaluate() const;
+
+    /*!
+     * \brief Get the value below or at which the given fraction of values lies.
+     * \param fraction Between 0 and 1, e.g. 0.999 for p99.9.
+     * \return The center of the matching bucket, limited to minimum and maximum.
+     */
+    float percentile(double fraction) const;
+
+    uint64_t count() const { return mCount; }
 
     void printContents();
 
-    std::vector<float> valueList() { return mContainer; };
+    /*!
+     * \brief Write count, summary, percentiles and all non-empty buckets as JSON.
+     */
+    void writeJson(std::ostream& stream) const;
+
+    /*!
+     * \brief Write the non-empty buckets as CSV rows of lower bound, upper bound
+     *        and count.
+     */
+    void writeCsv(std::ostream& stream) const;
+
+    /*!
+     * \brief Get the histogram as a compact list of words, for checkpoints and
+     *        worker processes.
+     */
+    std::vector<uint64_t> serialize() const;
+
+    /*!
+     * \brief Restore a histogram from serialize().
+     * \return False, if the words are not a valid histogram.
+     */
+    bool deserialize(const std::vector<uint64_t>& words);
 };
 
 } // namespace Simulation
@@ -11,6 +11,10 @@
 #include <fmt/ranges.h>
 #include <polarcode/construction/betaexpansion.h>
 #include <polarcode/construction/bhattacharrya.h>
+#include <polarcode/construction/constructioncache.h>
+#include <polarcode/construction/gaussianapproximation.h>
+#include <cstdio>
+#include <fstream>
 #include <stdexcept>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ConstructionTest);
@@ -77,3 +81,81 @@ void ConstructionTest::testBetaExpansion()
     output = mConstructor->construct();
     CPPUNIT_ASSERT(output == expectedOutput256);
 }
+
+void ConstructionTest::testGaussianApproximation()
+{
+    using PolarCode::Construction::GaussianApproximation;
+    std::vector<unsigned> output;
+
+    mConstructor = std::make_unique<GaussianApproximation>(4, 8);
+    CPPUNIT_ASSERT_THROW(output = mConstructor->construct(), std::invalid_argument);
+
+    mConstructor = std::make_unique<GaussianApproximation>(8, 4);
+    std::vector<unsigned> expectedOutput({ 0, 1, 2, 4 });
+    output = mConstructor->construct();
+    CPPUNIT_ASSERT(output == expectedOutput);
+
+    // Reference values from python/channel_construction.py
+    mConstructor = std::make_unique<GaussianApproximation>(64, 32, 1.0);
+    std::vector<unsigned> expectedOutput64({ 0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10,
+                                             11, 12, 13, 14, 16, 17, 18, 19, 20, 21, 22,
+                                             24, 25, 32, 33, 34, 35, 36, 37, 40, 48 });
+    output = mConstructor->construct();
+    CPPUNIT_ASSERT(output == expectedOutput64);
+    CPPUNIT_ASSERT(PolarCode::Construction::frozen_bits(64, 32, 1.0, "GA") == output);
+
+    // The reliability order is computed once per (N, designSNR)
+    CPPUNIT_ASSERT(GaussianApproximation::reliabilityOrder(1024, 0.5) ==
+                   GaussianApproximation::reliabilityOrder(1024, 0.5));
+    CPPUNIT_ASSERT(GaussianApproximation::reliabilityOrder(1024, 0.5) !=
+                   GaussianApproximation::reliabilityOrder(1024, 1.5));
+}
+
+void ConstructionTest::testConstructionCache()
+{
+    using PolarCode::Construction::ConstructionCache;
+    const std::string fileName("constructiontest_cache.txt");
+    std::remove(fileName.c_str());
+
+    {
+        ConstructionCache cache;
+        CPPUNIT_ASSERT_EQUAL(size_t(0), cache.attachFile(fileName));
+
+        auto frozen = cache.frozenBits(128, 64, 0.0, "BB");
+        mConstructor = std::make_unique<PolarCode::Construction::Bhattacharrya>(128, 64);
+        CPPUNIT_ASSERT(*frozen == mConstructor->construct());
+
+        // Repeated lookups share the entry, the type string is canonicalized
+        CPPUNIT_ASSERT(frozen == cache.frozenBits(128, 64, 0.0, "bb"));
+        CPPUNIT_ASSERT(frozen != cache.frozenBits(128, 32, 0.0, "BB"));
+        cache.frozenBits(256, 128, 1.5, "GA");
+        cache.frozenBits(64, 32, 0.0, "BE");
+        CPPUNIT_ASSERT_EQUAL(size_t(4), cache.size());
+    }
+
+    // A second process would start with all entries from the file
+    ConstructionCache cache;
+    CPPUNIT_ASSERT_EQUAL(size_t(4), cache.attachFile(fileName));
+    CPPUNIT_ASSERT_EQUAL(size_t(4), cache.size());
+    PolarCode::Construction::GaussianApproximation constructor(256, 128, 1.5);
+    CPPUNIT_ASSERT(*cache.frozenBits(256, 128, 1.5, "ga") == constructor.construct());
+    CPPUNIT_ASSERT_EQUAL(size_t(4), cache.size());
+
+    cache.clear();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), cache.size());
+
+    // Invalid frozen bit sets are rejected: too few, out of range, duplicate
+    // and trailing garbage
+    {
+        std::ofstream file(fileName, std::ios::app);
+        file << "BB 8 4 0 0 1 2\n"
+             << "BB 8 4 0 0 1 2 8\n"
+             << "BB 8 4 0 0 1 2 2\n"
+             << "BB 8 4 0 0 1 2 4 x\n"
+             << "BB 8 5 0 3 1 2\n";
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(5), cache.attachFile(fileName));
+    const std::vector<unsigned> expected{ 1, 2, 3 };
+    CPPUNIT_ASSERT(*cache.frozenBits(8, 5, 0.0, "BB") == expected);
+    std::remove(fileName.c_str());
+}
@@ -18,6 +18,8 @@ class ConstructionTest : public CppUnit::TestFixture
     CPPUNIT_TEST_SUITE(ConstructionTest);
     CPPUNIT_TEST(testBhattacharrya);
     CPPUNIT_TEST(testBetaExpansion);
+    CPPUNIT_TEST(testGaussianApproximation);
+    CPPUNIT_TEST(testConstructionCache);
     CPPUNIT_TEST_SUITE_END();
 
     std::unique_ptr<PolarCode::Construction::Constructor> mConstructor;
@@ -28,6 +30,8 @@ public:
 
     void testBhattacharrya();
     void testBetaExpansion();
+    void testGaussianApproximation();
+    void testConstructionCache();
 };
 
 #endif // PC_TEST_CONSTRUCTION_H
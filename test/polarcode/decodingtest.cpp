@@ -11,18 +11,120 @@
 
 #include <fmt/core.h>
 #include <fmt/ranges.h>
+#include <polarcode/alignedmemory.h>
 #include <polarcode/construction/bhattacharrya.h>
+#include <polarcode/construction/constructor.h>
+#include <polarcode/decoding/decoderplan.h>
+#include <polarcode/decoding/decoderpool.h>
+#include <polarcode/decoding/depth_first.h>
 #include <polarcode/decoding/fastssc_avx_float.h>
+#include <polarcode/decoding/fastssc_flat.h>
 #include <polarcode/decoding/fastssc_fip_char.h>
 #include <polarcode/decoding/fastsscan_float.h>
 #include <polarcode/decoding/fip_templates.txx>
+#include <polarcode/decoding/fixed_fip_char.h>
 #include <polarcode/decoding/scan.h>
 #include <polarcode/decoding/scl_avx_float.h>
 #include <polarcode/decoding/scl_fip_char.h>
 #include <polarcode/decoding/templatized_float.h>
+#include <polarcode/encoding/butterfly_fip_packed.h>
+#include <polarcode/errordetection/errordetector.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
+#include <numeric>
 #include <random>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+// Heap allocations of the calling thread while a HeapCount is alive. The
+// counters are thread-local, so other threads and tests are not counted.
+thread_local bool countHeap = false;
+thread_local size_t heapAllocations = 0;
+
+inline void countAllocation()
+{
+    if (countHeap) {
+        ++heapAllocations;
+    }
+}
+
+/*!
+ * \brief Counts every heap allocation of this thread within its scope
+ *
+ * The malloc family is replaced below, which covers operator new and
+ * _mm_malloc as well. Under AddressSanitizer the allocator belongs to
+ * the sanitizer, so nothing is counted there.
+ */
+class HeapCount
+{
+public:
+    HeapCount()
+    {
+        heapAllocations = 0;
+        countHeap = true;
+    }
+    ~HeapCount() { countHeap = false; }
+    size_t allocations() const { return heapAllocations; }
+};
+} // namespace
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size)
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    countAllocation();
+    void* memory = __libc_memalign(alignment, size);
+    if (memory == nullptr) {
+        return ENOMEM;
+    }
+    *ptr = memory;
+    return 0;
+}
+}
+#endif
 
 CPPUNIT_TEST_SUITE_REGISTRATION(DecodingTest);
 
@@ -281,10 +383,11 @@ void DecodingTest::testSPCCodeFloat()
     runSPCCodeFloat(block_length * 64);
 }
 
-void DecodingTest::fillRandom(float* vec, const unsigned length)
+void DecodingTest::fillRandom(
+    float* vec, const unsigned length, float mean, float deviation, unsigned seed)
 {
-    std::mt19937_64 generator;
-    std::normal_distribution<float> dist(10, 20);
+    std::mt19937_64 generator(seed);
+    std::normal_distribution<float> dist(mean, deviation);
     for (unsigned i = 0; i < length; ++i) {
         auto value = dist(generator);
         while (!std::isfinite(value)) {
@@ -297,6 +400,41 @@ void DecodingTest::fillRandom(float* vec, const unsigned length)
     }
 }
 
+std::pair<std::vector<unsigned char>, std::vector<float>>
+DecodingTest::noisyFrame(std::mt19937_64& generator,
+                         size_t blockLength,
+                         const std::vector<unsigned>& frozenBits,
+                         float sigma,
+                         bool systematic)
+{
+    using namespace PolarCode;
+
+    const size_t infoBytes = (blockLength - frozenBits.size()) / 8;
+    CPPUNIT_ASSERT(infoBytes > 4);
+    Encoding::ButterflyFipPacked encoder(blockLength, frozenBits);
+    encoder.setSystematic(systematic);
+    encoder.setErrorDetection(ErrorDetection::create(32, "crc"));
+
+    // The CRC goes into the last four bytes, plus padding for the packed encoder
+    std::uniform_int_distribution<unsigned> byteDist(0, 255);
+    std::vector<unsigned char> info(infoBytes + 4), codeword(blockLength / 8 + 4);
+    for (size_t i = 0; i < infoBytes - 4; ++i) {
+        info[i] = byteDist(generator);
+    }
+    encoder.setInformation(info.data());
+    encoder.encode();
+    encoder.getEncodedData(codeword.data());
+    info.resize(infoBytes);
+
+    std::normal_distribution<float> noise(0.0, sigma);
+    std::vector<float> llr(blockLength);
+    for (size_t i = 0; i < blockLength; ++i) {
+        const bool bit = (codeword[i / 8] >> (7 - i % 8)) & 1;
+        llr[i] = ((bit ? -1.0f : 1.0f) + noise(generator)) * 2 / (sigma * sigma);
+    }
+    return { info, llr };
+}
+
 void DecodingTest::runDoubleSPCCodeFloat(const size_t block_length)
 {
 
@@ -420,6 +558,627 @@ void DecodingTest::testRepRateOneDecoderShort8()
 }
 
 
+void DecodingTest::runBatchDecoding(
+    const std::function<PolarCode::Decoding::Decoder*()>& createDecoder)
+{
+    // Some decoders carry state from frame to frame, so reference and batch
+    // decoding each get a fresh decoder and the same sequence of frames.
+    std::unique_ptr<PolarCode::Decoding::Decoder> reference(createDecoder());
+    std::unique_ptr<PolarCode::Decoding::Decoder> decoder(createDecoder());
+    std::unique_ptr<PolarCode::Decoding::Decoder> charReference(createDecoder());
+    std::unique_ptr<PolarCode::Decoding::Decoder> charDecoder(createDecoder());
+
+    const size_t nFrames = 13;
+    const size_t blockLength = decoder->blockLength();
+    const size_t infoBytes = (decoder->infoLength() + 7) / 8;
+
+    std::vector<float> signal(nFrames * blockLength);
+    std::vector<char> charSignal(nFrames * blockLength);
+    std::mt19937_64 generator;
+    std::normal_distribution<float> dist(1.0, 2.0);
+    for (unsigned i = 0; i < signal.size(); ++i) {
+        signal[i] = dist(generator);
+        charSignal[i] =
+            static_cast<char>(std::max(-127.0f, std::min(127.0f, signal[i] * 16)));
+    }
+
+    std::vector<unsigned char> expected(nFrames * infoBytes);
+    std::vector<unsigned char> charExpected(nFrames * infoBytes);
+    std::vector<unsigned char> output(nFrames * infoBytes);
+    std::vector<unsigned char> charOutput(nFrames * infoBytes);
+    bool expectedOk[nFrames], ok[nFrames];
+    size_t expectedPassed = 0;
+
+    for (unsigned frame = 0; frame < nFrames; ++frame) {
+        expectedOk[frame] = reference->decode_vector(
+            signal.data() + frame * blockLength, expected.data() + frame * infoBytes);
+        expectedPassed += expectedOk[frame];
+        charReference->decode_vector(charSignal.data() + frame * blockLength,
+                                     charExpected.data() + frame * infoBytes);
+    }
+
+    size_t passed = decoder->decode_batch(signal.data(), nFrames, output.data(), ok);
+    charDecoder->decode_batch(charSignal.data(), nFrames, charOutput.data());
+
+    CPPUNIT_ASSERT_EQUAL(expectedPassed, passed);
+    CPPUNIT_ASSERT(expected == output);
+    CPPUNIT_ASSERT(charExpected == charOutput);
+    for (unsigned frame = 0; frame < nFrames; ++frame) {
+        CPPUNIT_ASSERT_EQUAL(expectedOk[frame], ok[frame]);
+    }
+}
+
+void DecodingTest::testBatchDecoding()
+{
+    using namespace PolarCode::Decoding;
+
+    for (size_t blockLength : { 16, 128, 1024 }) {
+        PolarCode::Construction::Bhattacharrya constructor(blockLength, blockLength / 2);
+        std::vector<unsigned> frozenBits = constructor.construct();
+
+        fmt::print("testBatchDecoding: block_length={}\n", blockLength);
+        for (bool systematic : { true, false }) {
+            runBatchDecoding([&]() {
+                Decoder* decoder = new FastSscAvxFloat(blockLength, frozenBits);
+                decoder->setSystematic(systematic);
+                return decoder;
+            });
+            runBatchDecoding([&]() {
+                Decoder* decoder = new FastSscFipChar(blockLength, frozenBits);
+                decoder->setSystematic(systematic);
+                return decoder;
+            });
+            runBatchDecoding([&]() {
+                Decoder* decoder = new SclAvxFloat(blockLength, 4, frozenBits);
+                decoder->setSystematic(systematic);
+                return decoder;
+            });
+        }
+    }
+}
+
+void DecodingTest::runInterFrameDecoding(PolarCode::Decoding::Decoder* reference,
+                                         PolarCode::Decoding::Decoder* decoder,
+                                         bool charInput)
+{
+    // Not a multiple of either lane count, so the last group is partial.
+    const size_t nFrames = 45;
+    const size_t blockLength = decoder->blockLength();
+    const size_t infoBytes = (decoder->infoLength() + 7) / 8;
+
+    std::vector<float> signal(nFrames * blockLength);
+    std::vector<char> charSignal(nFrames * blockLength);
+    std::mt19937_64 generator;
+    std::normal_distribution<float> dist(1.0, 1.0);
+    for (unsigned i = 0; i < signal.size(); ++i) {
+        signal[i] = dist(generator);
+        charSignal[i] =
+            static_cast<char>(std::max(-127.0f, std::min(127.0f, signal[i] * 8)));
+    }
+
+    std::vector<unsigned char> expected(nFrames * infoBytes);
+    std::vector<unsigned char> output(nFrames * infoBytes);
+    bool ok[nFrames];
+    size_t expectedPassed = 0;
+
+    for (unsigned frame = 0; frame < nFrames; ++frame) {
+        unsigned char* out = expected.data() + frame * infoBytes;
+        expectedPassed +=
+            charInput
+                ? reference->decode_vector(charSignal.data() + frame * blockLength, out)
+                : reference->decode_vector(signal.data() + frame * blockLength, out);
+    }
+
+    size_t passed =
+        charInput ? decoder->decode_batch(charSignal.data(), nFrames, output.data(), ok)
+                  : decoder->decode_batch(signal.data(), nFrames, output.data(), ok);
+    CPPUNIT_ASSERT(expected == output);
+    CPPUNIT_ASSERT_EQUAL(expectedPassed, passed);
+
+    // The single-frame interface decodes lane zero only
+    std::vector<unsigned char> single(infoBytes);
+    bool singleOk = charInput ? decoder->decode_vector(charSignal.data(), single.data())
+                              : decoder->decode_vector(signal.data(), single.data());
+    CPPUNIT_ASSERT(std::equal(single.begin(), single.end(), expected.begin()));
+    CPPUNIT_ASSERT_EQUAL(ok[0], singleOk);
+}
+
+void DecodingTest::testInterFrameDecoding()
+{
+    using namespace PolarCode::Decoding;
+
+    for (size_t blockLength : { 16, 128, 1024 }) {
+        PolarCode::Construction::Bhattacharrya constructor(blockLength, blockLength / 2);
+        std::vector<unsigned> frozenBits = constructor.construct();
+
+        fmt::print("testInterFrameDecoding: block_length={}\n", blockLength);
+        for (bool systematic : { true, false }) {
+            std::unique_ptr<Decoder> floatReference(
+                create(blockLength, 1, frozenBits, "float"));
+            std::unique_ptr<Decoder> floatDecoder(
+                create(blockLength, 1, frozenBits, "interframe float"));
+            std::unique_ptr<Decoder> charReference(
+                create(blockLength, 1, frozenBits, "char"));
+            std::unique_ptr<Decoder> charDecoder(
+                create(blockLength, 1, frozenBits, "interframe char"));
+            floatReference->setSystematic(systematic);
+            floatDecoder->setSystematic(systematic);
+            charReference->setSystematic(systematic);
+            charDecoder->setSystematic(systematic);
+
+            // The lane count depends on the kernel level picked at run time
+            CPPUNIT_ASSERT_EQUAL(size_t(1), floatReference->frameGroupSize());
+            CPPUNIT_ASSERT(floatDecoder->frameGroupSize() > 1);
+            CPPUNIT_ASSERT(charDecoder->frameGroupSize() >
+                           floatDecoder->frameGroupSize());
+
+            runInterFrameDecoding(floatReference.get(), floatDecoder.get(), false);
+            runInterFrameDecoding(charReference.get(), charDecoder.get(), true);
+        }
+    }
+}
+
+void DecodingTest::testDecoderPool()
+{
+    using namespace PolarCode::Decoding;
+
+    const size_t blockLength = 256;
+    const size_t nFrames = 300;
+    PolarCode::Construction::Bhattacharrya constructor(blockLength, blockLength / 2);
+    std::vector<unsigned> frozenBits = constructor.construct();
+
+    std::vector<float> signal(nFrames * blockLength);
+    fillRandom(signal.data(), signal.size(), 1.0, 1.0);
+
+    for (std::string type : { "float", "interframe char" }) {
+        std::unique_ptr<Decoder> reference(create(blockLength, 1, frozenBits, type));
+        DecoderPool pool(blockLength, 1, frozenBits, type, 4);
+        CPPUNIT_ASSERT_EQUAL(size_t(4), pool.workerCount());
+        CPPUNIT_ASSERT_EQUAL(reference->infoLength(), pool.infoLength());
+
+        const size_t infoBytes = (reference->infoLength() + 7) / 8;
+        std::vector<unsigned char> expected(nFrames * infoBytes);
+        std::vector<unsigned char> output(nFrames * infoBytes);
+        bool expectedOk[nFrames], ok[nFrames];
+
+        size_t expectedPassed =
+            reference->decode_batch(signal.data(), nFrames, expected.data(), expectedOk);
+        size_t passed = pool.decode_batch(signal.data(), nFrames, output.data(), ok);
+        CPPUNIT_ASSERT_EQUAL(expectedPassed, passed);
+        CPPUNIT_ASSERT(expected == output);
+        CPPUNIT_ASSERT(std::equal(ok, ok + nFrames, expectedOk));
+
+        std::vector<std::future<DecoderPool::Result>> futures;
+        for (size_t frame = 0; frame < 20; ++frame) {
+            futures.push_back(pool.submit(signal.data() + frame * blockLength));
+        }
+        for (size_t frame = 0; frame < futures.size(); ++frame) {
+            DecoderPool::Result result = futures[frame].get();
+            CPPUNIT_ASSERT_EQUAL(expectedOk[frame], result.ok);
+            CPPUNIT_ASSERT(std::equal(result.data.begin(),
+                                      result.data.end(),
+                                      expected.begin() + frame * infoBytes));
+        }
+
+        std::atomic<size_t> matches(0);
+        for (size_t frame = 0; frame < 20; ++frame) {
+            const unsigned char* frameExpected = expected.data() + frame * infoBytes;
+            auto callback = [&, frameExpected](const unsigned char* pData, bool) {
+                matches += std::equal(pData, pData + infoBytes, frameExpected);
+            };
+            pool.submit(signal.data() + frame * blockLength, callback);
+        }
+        pool.wait();
+        CPPUNIT_ASSERT_EQUAL(size_t(20), matches.load());
+
+        // A throwing callback must neither kill the worker nor hang wait()
+        for (size_t frame = 0; frame < 4; ++frame) {
+            pool.submit(signal.data(), [](const unsigned char*, bool) {
+                throw std::runtime_error("callback failed");
+            });
+        }
+        CPPUNIT_ASSERT_THROW(pool.wait(), std::runtime_error);
+        pool.wait();
+        CPPUNIT_ASSERT(pool.submit(signal.data()).get().ok == expectedOk[0]);
+    }
+}
+
+void DecodingTest::testListDecoderAllocations()
+{
+    using namespace PolarCode::Decoding;
+
+    const size_t nFrames = 20;
+    for (size_t blockLength : { 64, 1024 }) {
+        PolarCode::Construction::Bhattacharrya constructor(blockLength, blockLength / 2);
+        std::vector<unsigned> frozenBits = constructor.construct();
+
+        std::vector<float> signal(nFrames * blockLength);
+        fillRandom(signal.data(), signal.size(), 1.0, 1.0);
+        std::vector<unsigned char> output(blockLength / 8);
+
+        for (size_t listSize : { 1, 4, 32 }) {
+            for (std::string type : { "float", "char" }) {
+                for (bool systematic : { true, false }) {
+                    // Decoders allocate their buffers through the counted hook
+                    const size_t initial = PolarCode::alignedAllocationCount();
+                    std::unique_ptr<Decoder> decoder(
+                        create(blockLength, listSize, frozenBits, type));
+                    decoder->setSystematic(systematic);
+                    CPPUNIT_ASSERT(PolarCode::alignedAllocationCount() > initial);
+
+                    // The first frame may still set up lazily created state
+                    decoder->decode_vector(signal.data(), output.data());
+
+                    const size_t before = PolarCode::alignedAllocationCount();
+                    size_t allocations;
+                    {
+                        HeapCount heap;
+                        for (size_t frame = 1; frame < nFrames; ++frame) {
+                            decoder->decode_vector(
+                                signal.data() + frame * blockLength, output.data());
+                        }
+                        allocations = heap.allocations();
+                    }
+                    CPPUNIT_ASSERT_EQUAL(size_t(0), allocations);
+                    CPPUNIT_ASSERT_EQUAL(before, PolarCode::alignedAllocationCount());
+                }
+            }
+        }
+    }
+}
+
+void DecodingTest::testListMetricReset()
+{
+    using namespace PolarCode::Decoding;
+
+    const size_t blockLength = 256, stageCount = 9;
+
+    // A frame leaves its penalties in the metrics, the next one starts at zero
+    std::vector<float> floatLlr(blockLength, 1.0f);
+    SclAvx::PathList floatList(4, stageCount);
+    floatList.setFirstPath(floatLlr.data());
+    floatList.Metric(0) = 42.0f;
+    floatList.setFirstPath(floatLlr.data());
+    CPPUNIT_ASSERT_EQUAL(0.0f, floatList.Metric(0));
+
+    std::vector<char> charLlr(blockLength, 1);
+    SclFip::PathList charList(4, stageCount);
+    charList.setFirstPath(charLlr.data());
+    charList.Metric(0) = 42;
+    charList.setFirstPath(charLlr.data());
+    CPPUNIT_ASSERT_EQUAL(0L, charList.Metric(0));
+
+    // So a frame decodes the same, whatever the decoder saw before
+    PolarCode::Construction::Bhattacharrya constructor(blockLength, blockLength / 2);
+    std::vector<unsigned> frozenBits = constructor.construct();
+    std::vector<float> first(blockLength), second(blockLength);
+    fillRandom(first.data(), blockLength, 4.0, 4.0, 1);
+    fillRandom(second.data(), blockLength, 1.0, 1.0, 2);
+
+    for (std::string type : { "float", "char" }) {
+        std::unique_ptr<Decoder> used(create(blockLength, 4, frozenBits, type));
+        std::unique_ptr<Decoder> fresh(create(blockLength, 4, frozenBits, type));
+        std::vector<unsigned char> output(blockLength / 8), expected(blockLength / 8);
+        used->decode_vector(first.data(), output.data());
+        bool ok = used->decode_vector(second.data(), output.data());
+        CPPUNIT_ASSERT_EQUAL(fresh->decode_vector(second.data(), expected.data()), ok);
+        CPPUNIT_ASSERT(output == expected);
+    }
+}
+
+void DecodingTest::testDecoderPlanCache()
+{
+    using namespace PolarCode::Decoding;
+
+    const size_t blockLength = 1024;
+    const size_t nFrames = 10;
+    PolarCode::Construction::Bhattacharrya constructor(blockLength, blockLength / 2);
+    std::vector<unsigned> frozenBits = constructor.construct();
+
+    std::vector<float> signal(nFrames * blockLength);
+    fillRandom(signal.data(), signal.size(), 1.0, 1.0);
+    const size_t infoBytes = (blockLength / 2 + 7) / 8;
+
+    for (size_t listSize : { 1, 4 }) {
+        for (std::string type : { "float", "char" }) {
+            DecoderPlan::clearCache();
+            std::unique_ptr<Decoder> first(
+                create(blockLength, listSize, frozenBits, type));
+            CPPUNIT_ASSERT_EQUAL(size_t(1), DecoderPlan::cacheSize());
+
+            // Further decoders of the same code reuse the plan
+            std::unique_ptr<Decoder> second(
+                create(blockLength, listSize, frozenBits, type));
+            CPPUNIT_ASSERT_EQUAL(size_t(1), DecoderPlan::cacheSize());
+
+            std::vector<unsigned char> expected(nFrames * infoBytes);
+            std::vector<unsigned char> output(nFrames * infoBytes);
+            first->decode_batch(signal.data(), nFrames, expected.data());
+            second->decode_batch(signal.data(), nFrames, output.data());
+            CPPUNIT_ASSERT(expected == output);
+
+            // Decoders keep their plan alive when the cache is cleared
+            DecoderPlan::clearCache();
+            first.reset();
+            std::fill(output.begin(), output.end(), 0);
+            second->decode_batch(signal.data(), nFrames, output.data());
+            CPPUNIT_ASSERT(expected == output);
+        }
+    }
+
+    auto plan = DecoderPlan::get("FastSscAvxFloat",
+                                 blockLength,
+                                 frozenBits,
+                                 FastSscAvx::classifyNode,
+                                 FastSscAvx::nodeSize);
+    CPPUNIT_ASSERT(plan == DecoderPlan::get("FastSscAvxFloat",
+                                            blockLength,
+                                            frozenBits,
+                                            FastSscAvx::classifyNode,
+                                            FastSscAvx::nodeSize));
+    CPPUNIT_ASSERT_EQUAL(blockLength, size_t(plan->root()->blockLength));
+    CPPUNIT_ASSERT(plan->nodeCount() > 1);
+    // Node objects and child LLR buffers are laid out in the plan
+    CPPUNIT_ASSERT(plan->objectBytes() > 0);
+    CPPUNIT_ASSERT(plan->scratchBytes() > 0);
+
+    // The cache drops the least recently used plans beyond its limit
+    const size_t limit = DecoderPlan::cacheLimit();
+    DecoderPlan::clearCache();
+    DecoderPlan::setCacheLimit(2);
+    for (size_t length : { 64, 128, 256 }) {
+        PolarCode::Construction::Bhattacharrya code(length, length / 2);
+        FastSscAvxFloat decoder(length, code.construct());
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(2), DecoderPlan::cacheSize());
+    DecoderPlan::setCacheLimit(limit);
+}
+
+void DecodingTest::testCodeCatalogue()
+{
+    using namespace PolarCode::Decoding;
+
+    // One of the 5G codes in the default catalogue
+    const size_t blockLength = 512;
+    const size_t infoLength = 128;
+    const size_t nFrames = 20;
+    std::vector<unsigned> frozenBits =
+        PolarCode::Construction::create(blockLength, infoLength, 0.0, "5G")->construct();
+    CPPUNIT_ASSERT(findCodingScheme(blockLength, frozenBits) >= 0);
+
+    std::vector<unsigned> unlisted = frozenBits;
+    unlisted.pop_back();
+    CPPUNIT_ASSERT_EQUAL(-1, findCodingScheme(blockLength, unlisted));
+
+    std::vector<float> signal(nFrames * blockLength);
+    std::mt19937_64 generator;
+    std::normal_distribution<float> dist(1.0, 0.5);
+    for (auto& llr : signal) {
+        llr = dist(generator);
+    }
+    const size_t infoBytes = infoLength / 8;
+
+    std::unique_ptr<Decoder> fixedChar(create(blockLength, 1, frozenBits, "char"));
+    std::unique_ptr<Decoder> fixedFloat(create(blockLength, 1, frozenBits, "float"));
+    CPPUNIT_ASSERT(dynamic_cast<FixedChar*>(fixedChar.get()) != nullptr);
+    CPPUNIT_ASSERT(dynamic_cast<FastSscAvxFloat*>(fixedFloat.get()) == nullptr);
+
+    FastSscFipChar genericChar(blockLength, frozenBits);
+    FastSscAvxFloat genericFloat(blockLength, frozenBits);
+    std::vector<Decoder*> pairs[] = { { fixedChar.get(), &genericChar },
+                                      { fixedFloat.get(), &genericFloat } };
+    for (auto& pair : pairs) {
+        std::vector<unsigned char> expected(nFrames * infoBytes);
+        std::vector<unsigned char> output(nFrames * infoBytes);
+        pair[1]->decode_batch(signal.data(), nFrames, expected.data());
+        pair[0]->decode_batch(signal.data(), nFrames, output.data());
+        CPPUNIT_ASSERT(expected == output);
+    }
+
+    // Unlisted codes fall back to the generic decoders
+    std::unique_ptr<Decoder> fallback(create(blockLength, 1, unlisted, "char"));
+    CPPUNIT_ASSERT(dynamic_cast<FastSscFipChar*>(fallback.get()) != nullptr);
+}
+
+void DecodingTest::testFlatDecoder()
+{
+    using namespace PolarCode::Decoding;
+
+    // Repetition and SPC half codes
+    FastSscFlatFloat small(8, { 0, 1, 2, 4 });
+    const std::vector<FastSscFlat::Opcode> expected = { FastSscFlat::F,
+                                                        FastSscFlat::REP,
+                                                        FastSscFlat::G,
+                                                        FastSscFlat::SPC,
+                                                        FastSscFlat::COMBINE };
+    CPPUNIT_ASSERT_EQUAL(expected.size(), small.program().size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        CPPUNIT_ASSERT_EQUAL(expected[i], small.program()[i].op);
+    }
+
+    const size_t nFrames = 10;
+    const std::vector<std::pair<size_t, size_t>> codes = {
+        { 64, 40 }, { 128, 64 }, { 512, 56 }, { 1024, 512 }
+    };
+    std::mt19937_64 generator;
+
+    for (auto code : codes) {
+        const size_t blockLength = code.first;
+        const size_t infoLength = code.second;
+        const size_t infoBytes = infoLength / 8;
+        std::vector<unsigned> frozenBits =
+            PolarCode::Construction::create(blockLength, infoLength, 0.0, "5G")
+                ->construct();
+
+        for (bool systematic : { true, false }) {
+            FastSscFlatFloat decoder(blockLength, frozenBits);
+            decoder.setSystematic(systematic);
+
+            std::vector<unsigned char> info;
+            std::vector<float> signal;
+            for (size_t frame = 0; frame < nFrames; ++frame) {
+                auto sent =
+                    noisyFrame(generator, blockLength, frozenBits, 0.25f, systematic);
+                info.insert(info.end(), sent.first.begin(), sent.first.end());
+                signal.insert(signal.end(), sent.second.begin(), sent.second.end());
+            }
+
+            std::vector<unsigned char> output(nFrames * infoBytes + 4);
+            decoder.decode_batch(signal.data(), nFrames, output.data());
+            CPPUNIT_ASSERT(std::equal(
+                info.begin(), info.begin() + nFrames * infoBytes, output.begin()));
+        }
+    }
+
+    std::vector<unsigned> frozenBits =
+        PolarCode::Construction::create(1024, 512, 0.0, "5G")->construct();
+    std::unique_ptr<Decoder> created(create(1024, 1, frozenBits, "flat"));
+    CPPUNIT_ASSERT(dynamic_cast<FastSscFlatFloat*>(created.get()) != nullptr);
+}
+
+void DecodingTest::testDepthFirst()
+{
+    using namespace PolarCode;
+
+    const size_t blockLength = 1024, infoLength = 512, infoBytes = infoLength / 8;
+    const float sigma = 0.8f;
+    std::vector<unsigned> frozenBits =
+        Construction::Bhattacharrya(blockLength, infoLength, 2.0f).construct();
+
+    Decoding::FastSscAvxFloat reference(blockLength, frozenBits);
+    reference.setSystematic(false);
+    reference.setErrorDetection(ErrorDetection::create(32, "crc"));
+    Decoding::DepthFirst decoder(blockLength, 64, frozenBits);
+    decoder.setSystematic(false);
+    decoder.setErrorDetection(ErrorDetection::create(32, "crc"));
+    Decoding::DepthFirst parallel(blockLength, 64, frozenBits, 3);
+    parallel.setSystematic(false);
+    parallel.setErrorDetection(ErrorDetection::create(32, "crc"));
+
+    // A search decoding its trials incrementally, and a second tree decoding
+    // every one of them from scratch
+    using namespace Decoding::DepthFirstObjects;
+    datapool_t searchPool, freshPool;
+    Manager search(64), fresh(64);
+    Node searchBase(blockLength, &searchPool, &search);
+    Node freshBase(blockLength, &freshPool, &fresh);
+    std::unique_ptr<Node> searchRoot(createDecoder(frozenBits, &searchBase));
+    std::unique_ptr<Node> freshRoot(createDecoder(frozenBits, &freshBase));
+    search.setRootNode(searchRoot.get());
+    fresh.setRootNode(freshRoot.get());
+
+    std::mt19937_64 generator;
+
+    unsigned referenceSuccesses = 0, successes = 0;
+    for (unsigned frame = 0; frame < 200; ++frame) {
+        std::vector<unsigned char> info, output(infoBytes + 4);
+        std::vector<unsigned char> parallelOutput(infoBytes + 4);
+        std::vector<float> signal;
+        std::tie(info, signal) =
+            noisyFrame(generator, blockLength, frozenBits, sigma, false);
+
+        reference.setSignal(signal.data());
+        referenceSuccesses += reference.decode();
+
+        // Flipping trials re-decode only part of the tree, which must not
+        // leave traces in the next frame
+        decoder.setSignal(signal.data());
+        bool success = decoder.decode();
+        decoder.getDecodedInformationBits(output.data());
+        if (success) {
+            ++successes;
+            CPPUNIT_ASSERT(std::equal(info.begin(), info.begin() + infoBytes - 4,
+                                      output.begin()));
+        }
+
+        // Parallel trials are evaluated in the same order
+        parallel.setSignal(signal.data());
+        CPPUNIT_ASSERT_EQUAL(success, parallel.decode());
+        parallel.getDecodedInformationBits(parallelOutput.data());
+        CPPUNIT_ASSERT(output == parallelOutput);
+
+        // Reusing the unchanged part of the tree gives the full decoding result
+        if (frame % 10 == 0) {
+            memcpy(searchBase.input(), signal.data(), blockLength * sizeof(float));
+            memcpy(freshBase.input(), signal.data(), blockLength * sizeof(float));
+            search.decode();
+            for (unsigned trial = 0; trial < 64 && search.queueSize() > 0; ++trial) {
+                TrialSummary incremental, full;
+                search.summarizeFront(&incremental);
+                fresh.invalidate();
+                fresh.decodeQueued(search, 0, &full);
+                CPPUNIT_ASSERT(memcmp(searchBase.output(),
+                                      freshBase.output(),
+                                      blockLength * sizeof(float)) == 0);
+                CPPUNIT_ASSERT_EQUAL(full.metric, incremental.metric);
+                CPPUNIT_ASSERT_EQUAL(full.weakest, incremental.weakest);
+                search.decodeNext();
+            }
+        }
+    }
+    CPPUNIT_ASSERT(referenceSuccesses < 200);
+    CPPUNIT_ASSERT(successes > referenceSuccesses);
+}
+
+void DecodingTest::testScanEarlyTermination()
+{
+    using namespace PolarCode;
+
+    const size_t blockLength = 256, infoLength = 128, infoBytes = infoLength / 8;
+    const unsigned iterationLimit = 8, frameCount = 100;
+    const float sigma = 0.7f;
+    std::vector<unsigned> frozenBits =
+        Construction::Bhattacharrya(blockLength, infoLength, 2.0f).construct();
+
+    std::mt19937_64 generator;
+
+    for (bool systematic : { true, false }) {
+        Decoding::Scan decoder(blockLength, iterationLimit, frozenBits);
+        decoder.setSystematic(systematic);
+        decoder.setErrorDetection(ErrorDetection::create(32, "crc"));
+        decoder.setEarlyTermination(true);
+        Decoding::Scan full(blockLength, iterationLimit, frozenBits);
+        full.setSystematic(systematic);
+
+        unsigned successes = 0, iterations = 0;
+        for (unsigned frame = 0; frame < frameCount; ++frame) {
+            std::vector<unsigned char> info, output(infoBytes + 4);
+            std::vector<float> signal;
+            std::tie(info, signal) =
+                noisyFrame(generator, blockLength, frozenBits, sigma, systematic);
+
+            decoder.setSignal(signal.data());
+            if (decoder.decode()) {
+                ++successes;
+                decoder.getDecodedInformationBits(output.data());
+                CPPUNIT_ASSERT(std::equal(info.begin(), info.begin() + infoBytes - 4,
+                                          output.begin()));
+            }
+            CPPUNIT_ASSERT(decoder.iterationCount() <= iterationLimit);
+            iterations += decoder.iterationCount();
+
+            full.setSignal(signal.data());
+            full.decode();
+            CPPUNIT_ASSERT_EQUAL(iterationLimit, full.iterationCount());
+
+            // A-posteriori information is channel plus extrinsic information
+            std::vector<float> extrinsic(blockLength), posterior(blockLength);
+            full.getExtrinsicChannelInformation(extrinsic.data());
+            full.getPosteriorChannelInformation(posterior.data());
+            for (size_t i = 0; i < blockLength; ++i) {
+                CPPUNIT_ASSERT_EQUAL(signal[i] + extrinsic[i], posterior[i]);
+            }
+            if (systematic) {
+                std::vector<float> softCodeword(blockLength);
+                full.getSoftCodeword(softCodeword.data());
+                CPPUNIT_ASSERT(softCodeword == posterior);
+            }
+        }
+        CPPUNIT_ASSERT(successes > frameCount * 9 / 10);
+        CPPUNIT_ASSERT(iterations < frameCount * iterationLimit / 2);
+    }
+}
+
 void DecodingTest::testSpecialDecoders()
 {
 /*	__m256i llr, bits, expectedResult;
@@ -502,7 +1261,152 @@ void DecodingTest::testGeneralDecodingFunctionsAvx()
     CPPUNIT_ASSERT(testBitVectors(bits.v, expected.v));
 }
 
-#ifdef __AVX2__
+#ifdef POLARCODE_AVX512
+
+namespace {
+
+union CharVector512 {
+    fipv v;
+    char c[BYTESPERVECTOR];
+};
+
+char saturate(int value)
+{
+    return static_cast<char>(std::max(-128, std::min(127, value)));
+}
+
+char referenceF(char left, char right)
+{
+    int l = std::abs(std::max<int>(left, -127));
+    int r = std::abs(std::max<int>(right, -127));
+    int magnitude = std::max(std::min(l, r), 1);
+    return (left ^ right) < 0 ? -magnitude : magnitude;
+}
+
+} // namespace
+
+void DecodingTest::testGeneralDecodingFunctionsAvx512()
+{
+    using namespace PolarCode::Decoding;
+    std::mt19937_64 generator;
+    std::uniform_int_distribution<int> dist(-128, 127);
+    CharVector512 llr[2], bits, child, expected;
+
+    for (int round = 0; round < 100; ++round) {
+        for (unsigned i = 0; i < BYTESPERVECTOR; ++i) {
+            llr[0].c[i] = dist(generator);
+            llr[1].c[i] = dist(generator);
+            bits.c[i] = dist(generator) < 0 ? -128 : 0;
+        }
+
+        // F-function, full and half vector
+        for (unsigned i = 0; i < BYTESPERVECTOR; ++i) {
+            expected.c[i] = referenceF(llr[0].c[i], llr[1].c[i]);
+        }
+        FastSscFip::F_function(&llr[0].v, &child.v, BYTESPERVECTOR);
+        CPPUNIT_ASSERT(testVectors(child.v, expected.v));
+        FixedDecoding::F_function<BYTESPERVECTOR>(&llr[0].v, &child.v);
+        CPPUNIT_ASSERT(testVectors(child.v, expected.v));
+        for (unsigned i = 0; i < 32; ++i) {
+            expected.c[i] = referenceF(llr[0].c[i], llr[0].c[i + 32]);
+        }
+        FastSscFip::F_function(&llr[0].v, &child.v, 32);
+        CPPUNIT_ASSERT(testShortVectors(child.v, expected.v, 32));
+
+        // G-function, full and half vector
+        for (unsigned i = 0; i < BYTESPERVECTOR; ++i) {
+            int left = bits.c[i] < 0 ? -llr[0].c[i] : llr[0].c[i];
+            expected.c[i] = saturate(llr[1].c[i] + left);
+        }
+        FastSscFip::G_function(&llr[0].v, &child.v, &bits.v, BYTESPERVECTOR);
+        CPPUNIT_ASSERT(testVectors(child.v, expected.v));
+        FixedDecoding::G_function<BYTESPERVECTOR>(&llr[0].v, &child.v, &bits.v);
+        CPPUNIT_ASSERT(testVectors(child.v, expected.v));
+        for (unsigned i = 0; i < 32; ++i) {
+            int left = bits.c[i] < 0 ? -llr[0].c[i] : llr[0].c[i];
+            expected.c[i] = saturate(llr[0].c[i + 32] + left);
+        }
+        FixedDecoding::G_function<32>(&llr[0].v, &child.v, &bits.v);
+        CPPUNIT_ASSERT(testShortVectors(child.v, expected.v, 32));
+
+        // Combine-function, half vector
+        for (unsigned i = 0; i < 32; ++i) {
+            expected.c[i] = llr[0].c[i] ^ llr[1].c[i];
+            expected.c[i + 32] = llr[1].c[i];
+        }
+        CharVector512 left = llr[0], right = llr[1];
+        FixedDecoding::CombineBits<32>(&left.v, &right.v, &child.v);
+        CPPUNIT_ASSERT(testBitVectors(child.v, expected.v));
+        FastSscFip::CombineBitsShort(&left.v, &right.v, &child.v, 32);
+        CPPUNIT_ASSERT(testBitVectors(child.v, expected.v));
+
+        // Mask-based helpers
+        unsigned char minValue = 255;
+        unsigned minIndex = 0, parity = 0;
+        for (unsigned i = 0; i < BYTESPERVECTOR; ++i) {
+            unsigned char value = llr[0].c[i];
+            if (value < minValue) {
+                minValue = value;
+                minIndex = i;
+            }
+            parity ^= llr[0].c[i] < 0;
+        }
+        char value;
+        CPPUNIT_ASSERT_EQUAL(minIndex, minpos_epu8(llr[0].v, &value));
+        CPPUNIT_ASSERT_EQUAL(static_cast<char>(minValue), value);
+        CPPUNIT_ASSERT_EQUAL(parity != 0, sign_parity_epi8(llr[0].v));
+
+        for (unsigned i = 0; i < BYTESPERVECTOR; ++i) {
+            expected.c[i] = llr[1].c[i] == 0 ? 0
+                            : llr[1].c[i] < 0 ? -llr[0].c[i]
+                                               : llr[0].c[i];
+        }
+        child.v = fi_sign_epi8(llr[0].v, llr[1].v);
+        CPPUNIT_ASSERT(testVectors(child.v, expected.v));
+
+        // Sub-vector shifts, byte-wise
+        for (unsigned shift = 1; shift < BYTESPERVECTOR; shift *= 2) {
+            for (unsigned i = 0; i < BYTESPERVECTOR; ++i) {
+                expected.c[i] = i % (2 * shift) < shift ? llr[0].c[i + shift] : 0;
+            }
+            child.v = subVectorShiftBytes_epu8(llr[0].v, shift);
+            CPPUNIT_ASSERT(testVectors(child.v, expected.v));
+            child.v = subVectorShift_epu8(llr[0].v, shift * 8);
+            CPPUNIT_ASSERT(testVectors(child.v, expected.v));
+
+            for (unsigned i = 0; i < BYTESPERVECTOR; ++i) {
+                expected.c[i] = i % (2 * shift) < shift ? 0 : llr[0].c[i - shift];
+            }
+            child.v = subVectorBackShiftBytes_epu8(llr[0].v, shift);
+            CPPUNIT_ASSERT(testVectors(child.v, expected.v));
+            child.v = subVectorBackShift_epu8(llr[0].v, shift * 8);
+            CPPUNIT_ASSERT(testVectors(child.v, expected.v));
+        }
+
+        // Sub-vector shifts within bytes, most significant bit first
+        for (unsigned shift = 1; shift < 8; shift *= 2) {
+            for (unsigned i = 0; i < BYTESPERVECTOR; ++i) {
+                unsigned char in = llr[0].c[i], out = 0, back = 0;
+                for (unsigned bit = 0; bit < 8; ++bit) {
+                    if (bit % (2 * shift) < shift) {
+                        out |= (in << shift) & (0x80 >> bit);
+                    } else {
+                        back |= (in >> shift) & (0x80 >> bit);
+                    }
+                }
+                expected.c[i] = out;
+                child.c[i] = back;
+            }
+            CharVector512 result;
+            result.v = subVectorShift_epu8(llr[0].v, shift);
+            CPPUNIT_ASSERT(testVectors(result.v, expected.v));
+            result.v = subVectorBackShift_epu8(llr[0].v, shift);
+            CPPUNIT_ASSERT(testVectors(result.v, child.v));
+        }
+    }
+}
+
+#elif defined(__AVX2__)
 
 void DecodingTest::testGeneralDecodingFunctionsAvx2()
 {
@@ -1253,3 +2157,48 @@ void DecodingTest::testScan()
 
     delete decoder;
 }
+
+void DecodingTest::testNodeProfile()
+{
+    using namespace PolarCode::Decoding;
+
+    // The first half is frozen, so the root is an R1 node with a rate-0 child.
+    // Node lengths are those of the child halves.
+    const size_t blockLength = 64, frameCount = 3;
+    std::vector<unsigned> frozenBits(blockLength / 2);
+    std::iota(frozenBits.begin(), frozenBits.end(), 0);
+    std::vector<float> signal(frameCount * blockLength);
+    fillRandom(signal.data(), signal.size());
+    std::vector<unsigned char> output(frameCount * blockLength / 16);
+
+    for (std::string type : { "float", "char" }) {
+        std::unique_ptr<Decoder> decoder(create(blockLength, 1, frozenBits, type));
+        decoder->decode_batch(signal.data(), frameCount, output.data());
+        NodeProfile profile = decoder->nodeProfile();
+#ifdef POLARCODE_NODE_PROFILING
+        const std::string prefix = type == "float" ? "FastSscAvx::" : "FastSscFip::";
+        const std::vector<NodeProfile::key_t> expected = {
+            { prefix + "ROneNode F", blockLength / 2 },
+            { prefix + "ROneNode G and Combine", blockLength / 2 },
+            { prefix + "RateZeroDecoder", blockLength / 2 },
+        };
+        CPPUNIT_ASSERT_EQUAL(expected.size(), profile.entries().size());
+        for (const auto& key : expected) {
+            auto it = profile.entries().find(key);
+            CPPUNIT_ASSERT_MESSAGE(key.first, it != profile.entries().end());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(frameCount), it->second.calls);
+        }
+
+        // Profiles of batch workers merge into one
+        NodeProfile merged = profile;
+        merged.merge(profile);
+        for (const auto& entry : merged.entries()) {
+            CPPUNIT_ASSERT_EQUAL(uint64_t(2 * frameCount), entry.second.calls);
+        }
+        decoder->resetNodeProfile();
+        CPPUNIT_ASSERT(decoder->nodeProfile().empty());
+#else
+        CPPUNIT_ASSERT(profile.empty());
+#endif
+    }
+}
@@ -11,13 +11,19 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <polarcode/decoding/decoder.h>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
 
 class DecodingTest : public CppUnit::TestFixture
 {
     CPPUNIT_TEST_SUITE(DecodingTest);
     CPPUNIT_TEST(testSpecialDecoders);
     CPPUNIT_TEST(testGeneralDecodingFunctionsAvx);
-#ifdef __AVX2__
+#ifdef POLARCODE_AVX512
+    CPPUNIT_TEST(testGeneralDecodingFunctionsAvx512);
+#elif defined(__AVX2__)
     CPPUNIT_TEST(testGeneralDecodingFunctionsAvx2);
 #else
     CPPUNIT_TEST(testGeneralDecodingFunctionsSse);
@@ -35,6 +41,17 @@ class DecodingTest : public CppUnit::TestFixture
     CPPUNIT_TEST(testDoubleSPCCodeFloat);
     CPPUNIT_TEST(testTypeFiveDecoder);
     CPPUNIT_TEST(testRepRateOneDecoderShort8);
+    CPPUNIT_TEST(testBatchDecoding);
+    CPPUNIT_TEST(testInterFrameDecoding);
+    CPPUNIT_TEST(testDecoderPool);
+    CPPUNIT_TEST(testListDecoderAllocations);
+    CPPUNIT_TEST(testListMetricReset);
+    CPPUNIT_TEST(testDecoderPlanCache);
+    CPPUNIT_TEST(testCodeCatalogue);
+    CPPUNIT_TEST(testFlatDecoder);
+    CPPUNIT_TEST(testDepthFirst);
+    CPPUNIT_TEST(testScanEarlyTermination);
+    CPPUNIT_TEST(testNodeProfile);
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -46,7 +63,9 @@ public:
 
     void testSpecialDecoders();
     void testGeneralDecodingFunctionsAvx();
-#ifdef __AVX2__
+#ifdef POLARCODE_AVX512
+    void testGeneralDecodingFunctionsAvx512();
+#elif defined(__AVX2__)
     void testGeneralDecodingFunctionsAvx2();
 #else
     void testGeneralDecodingFunctionsSse();
@@ -76,9 +95,48 @@ public:
 
     void testRepRateOneDecoderShort8();
 
+    void testBatchDecoding();
+    void runBatchDecoding(
+        const std::function<PolarCode::Decoding::Decoder*()>& createDecoder);
+    void testInterFrameDecoding();
+    void runInterFrameDecoding(PolarCode::Decoding::Decoder* reference,
+                               PolarCode::Decoding::Decoder* decoder,
+                               bool charInput);
+    void testDecoderPool();
+    void testListDecoderAllocations();
+    void testListMetricReset();
+    void testDecoderPlanCache();
+    void testCodeCatalogue();
+    void testFlatDecoder();
+    void testDepthFirst();
+    void testScanEarlyTermination();
+    void testNodeProfile();
+
 private:
     void showScanTestOutput(unsigned, float*);
-    void fillRandom(float* vec, const unsigned length);
+    /*!
+     * \brief Fill _vec_ with normal distributed, finite values.
+     *
+     * The same seed always gives the same values.
+     */
+    void fillRandom(float* vec,
+                    const unsigned length,
+                    float mean = 10,
+                    float deviation = 20,
+                    unsigned seed = std::mt19937_64::default_seed);
+
+    /*!
+     * \brief Encode random information bytes with a CRC-32 and send them over
+     *        a BPSK AWGN channel with noise deviation _sigma_.
+     * \return The information bytes, the last four of them being the CRC, and
+     *         the channel LLRs of the frame.
+     */
+    std::pair<std::vector<unsigned char>, std::vector<float>>
+    noisyFrame(std::mt19937_64& generator,
+               size_t blockLength,
+               const std::vector<unsigned>& frozenBits,
+               float sigma,
+               bool systematic);
 };
 
 #endif // PC_TEST_DECODING_H
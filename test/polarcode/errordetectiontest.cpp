@@ -8,7 +8,10 @@
 
 #include "errordetectiontest.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
+#include <vector>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ErrorDetectionTest);
 
@@ -103,3 +106,71 @@ void ErrorDetectionTest::testCmac()
     //	mTestInput[0] ^= 0xFF;
     //	CPPUNIT_ASSERT_EQUAL(false, mCrc32->check(mTestInput, mDataLength));
 }
+
+void ErrorDetectionTest::testMultiCheck()
+{
+    // More candidates than a detector checks side by side
+    const int nArrays = 40;
+    std::vector<std::vector<unsigned char>> candidates(
+        nArrays, std::vector<unsigned char>(mDataLength));
+    std::vector<void*> pointers(nArrays);
+
+    void** data = pointers.data();
+    PolarCode::ErrorDetection::CRC24NRC crc24nrc;
+    PolarCode::ErrorDetection::Detector* crc24 = &crc24nrc;
+
+    for (auto detector : { mCrc8, mCrc32, crc24 }) {
+        for (int array = 0; array < nArrays; ++array) {
+            std::vector<unsigned char>& candidate = candidates[array];
+            std::copy(mData, mData + mDataLength, candidate.begin());
+            candidate[array % mDataLength] ^= array;
+            detector->generate(candidate.data(), mDataLength);
+            candidate[0] ^= 0x01; // Invalidate
+            pointers[array] = candidate.data();
+        }
+        CPPUNIT_ASSERT_EQUAL(-1, detector->multiCheck(data, nArrays, mDataLength));
+
+        candidates[37][0] ^= 0x01;
+        CPPUNIT_ASSERT_EQUAL(37, detector->multiCheck(data, nArrays, mDataLength));
+
+        candidates[5][0] ^= 0x01;
+        CPPUNIT_ASSERT_EQUAL(5, detector->multiCheck(data, nArrays, mDataLength));
+    }
+}
+
+void ErrorDetectionTest::testCrcEngine()
+{
+    using PolarCode::ErrorDetection::CrcEngine;
+
+    const unsigned char check[] = "123456789";
+    CPPUNIT_ASSERT_EQUAL(0x31C3u, CrcEngine(16, 0x1021).calculate(check, 9));
+    CPPUNIT_ASSERT_EQUAL(0x29B1u, CrcEngine(16, 0x1021, 0xFFFF).calculate(check, 9));
+    CPPUNIT_ASSERT_EQUAL(0xF4u, CrcEngine(8, 0x07).calculate(check, 9));
+
+    // Compare against a bit-serial register for all NR widths and for lengths
+    // which exercise the folding loop, its tail and partial bytes.
+    const unsigned widths[] = { 6, 11, 16, 24 };
+    const uint32_t polynomials[] = { 0x21, 0x621, 0x1021, 0xb2b117 };
+    std::vector<unsigned char> data(40);
+    srand(7);
+
+    for (int i = 0; i < 4; ++i) {
+        CrcEngine engine(widths[i], polynomials[i]);
+        const uint32_t topBit = 1u << (widths[i] - 1);
+        const uint32_t mask = (topBit << 1) - 1;
+
+        for (size_t bits = 0; bits <= 8 * data.size(); ++bits) {
+            std::generate(data.begin(), data.end(), rand);
+            if (bits % 8) {
+                data[bits / 8] &= 0xFF00 >> (bits % 8);
+            }
+            uint32_t reg = 0;
+            for (size_t bit = 0; bit < bits; ++bit) {
+                bool in = (data[bit / 8] >> (7 - bit % 8)) & 1;
+                bool out = reg & topBit;
+                reg = ((reg << 1) & mask) ^ ((in != out) ? polynomials[i] : 0);
+            }
+            CPPUNIT_ASSERT_EQUAL(reg, engine.calculateBits(data.data(), bits));
+        }
+    }
+}
@@ -12,8 +12,10 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <polarcode/errordetection/cmac.h>
+#include <polarcode/errordetection/crc24nrc.h>
 #include <polarcode/errordetection/crc32.h>
 #include <polarcode/errordetection/crc8.h>
+#include <polarcode/errordetection/crcengine.h>
 #include <polarcode/errordetection/dummy.h>
 
 class ErrorDetectionTest : public CppUnit::TestFixture
@@ -23,6 +25,8 @@ class ErrorDetectionTest : public CppUnit::TestFixture
     CPPUNIT_TEST(testCrc8);
     CPPUNIT_TEST(testCrc32);
     CPPUNIT_TEST(testCmac);
+    CPPUNIT_TEST(testMultiCheck);
+    CPPUNIT_TEST(testCrcEngine);
     CPPUNIT_TEST_SUITE_END();
 
     PolarCode::ErrorDetection::Detector *mDummy, *mCrc8, *mCrc32, *mCmac;
@@ -41,6 +45,8 @@ public:
     void testCrc8();
     void testCrc32();
     void testCmac();
+    void testMultiCheck();
+    void testCrcEngine();
 };
 
 #endif // PC_TEST_ERRORDETECTION_H
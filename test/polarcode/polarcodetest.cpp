@@ -8,14 +8,24 @@
 
 #include "polarcodetest.h"
 
+#include <polarcode/alignedmemory.h>
 #include <polarcode/construction/bhattacharrya.h>
+#include <polarcode/datapool.txx>
+#include <polarcode/decoding/decoderplan.h>
+#include <polarcode/decoding/fastssc_avx_float.h>
 #include <polarcode/decoding/fastssc_fip_char.h>
+#include <polarcode/decoding/scl_avx_float.h>
 #include <polarcode/decoding/scl_fip_char.h>
 #include <polarcode/encoding/butterfly_fip_packed.h>
 #include <polarcode/errordetection/crc32.h>
+#include <polarcode/errordetection/crc8.h>
+#include <polarcode/isadispatch.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <random>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PolarCodeTest);
@@ -198,3 +208,146 @@ void PolarCodeTest::testAvxConvenience()
         CPPUNIT_ASSERT_EQUAL(minVal, 4.0f);
     }
 }
+
+void PolarCodeTest::testDataPool()
+{
+    PolarCode::DataPool<float, 32> pool;
+
+    auto* a = pool.allocate(100);
+    auto* b = pool.allocate(128);
+
+    // Sizes share the class of the next power of two, carved from one slab
+    const size_t freeCount = pool.freeBlockCount(100);
+    CPPUNIT_ASSERT(freeCount > 0);
+    CPPUNIT_ASSERT_EQUAL(freeCount, pool.freeBlockCount(128));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), pool.freeBlockCount(129));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), reinterpret_cast<size_t>(a->data) % 32);
+    CPPUNIT_ASSERT(a->data != b->data);
+
+    // Fresh blocks are zeroed
+    for (unsigned i = 0; i < 100; ++i) {
+        CPPUNIT_ASSERT_EQUAL(0.0f, a->data[i]);
+        a->data[i] = i;
+    }
+
+    // Copy on write
+    auto* c = pool.lazyDuplicate(a);
+    CPPUNIT_ASSERT(c == a);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), a->useCount);
+    pool.prepareForWrite(c);
+    CPPUNIT_ASSERT(c != a);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), a->useCount);
+    CPPUNIT_ASSERT_EQUAL(size_t(100), c->size);
+    CPPUNIT_ASSERT_EQUAL(99.0f, c->data[99]);
+    CPPUNIT_ASSERT_EQUAL(freeCount - 1, pool.freeBlockCount(100));
+
+    // Released blocks are recycled last in, first out
+    float* aData = a->data;
+    pool.release(a);
+    CPPUNIT_ASSERT(a == nullptr);
+    CPPUNIT_ASSERT_EQUAL(freeCount, pool.freeBlockCount(100));
+    auto* d = pool.allocate(65);
+    CPPUNIT_ASSERT(d->data == aData);
+
+    pool.release(b);
+    pool.release(c);
+    pool.release(d);
+    CPPUNIT_ASSERT_EQUAL(freeCount + 2, pool.freeBlockCount(128));
+
+    // Small sizes are padded to the alignment
+    auto* e = pool.allocate(1);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), reinterpret_cast<size_t>(e->data) % 32);
+    pool.release(e);
+}
+
+void PolarCodeTest::testIsaDispatch()
+{
+    using namespace PolarCode::Dispatch;
+
+    for (int i = IsaAvx; i <= IsaAvx512; ++i) {
+        IsaLevel level;
+        CPPUNIT_ASSERT(parseIsa(isaName(static_cast<IsaLevel>(i)), &level));
+        CPPUNIT_ASSERT_EQUAL(i, int(level));
+    }
+    IsaLevel level = IsaAvx2;
+    CPPUNIT_ASSERT(!parseIsa("sse2", &level));
+    CPPUNIT_ASSERT_EQUAL(int(IsaAvx2), int(level));
+
+    // The environment can only lower the level, never below the compiled one
+    const char* previous = getenv("POLARCODE_ISA");
+    std::string saved = previous ? previous : "";
+    setenv("POLARCODE_ISA", "avx", 1);
+    CPPUNIT_ASSERT_EQUAL(int(compiledIsa()), int(selectedIsa()));
+    setenv("POLARCODE_ISA", "avx512", 1);
+    CPPUNIT_ASSERT_EQUAL(int(std::max(cpuIsa(), compiledIsa())), int(selectedIsa()));
+    if (previous) {
+        setenv("POLARCODE_ISA", saved.c_str(), 1);
+    } else {
+        unsetenv("POLARCODE_ISA");
+    }
+
+    CPPUNIT_ASSERT(activeIsa() >= compiledIsa());
+
+    // Every module the CPU can run decodes like this build and shares its state
+    using namespace PolarCode::Decoding;
+    const size_t blockLength = 1024;
+    const size_t nFrames = 4;
+    PolarCode::Construction::Bhattacharrya constructor(blockLength, blockLength / 2);
+    std::vector<unsigned> frozenBits = constructor.construct();
+
+    std::vector<float> signal(nFrames * blockLength);
+    std::mt19937_64 generator;
+    std::normal_distribution<float> dist(1.0, 1.0);
+    for (auto& llr : signal) {
+        llr = dist(generator);
+    }
+    const size_t infoBytes = (blockLength / 2 + 7) / 8;
+    PolarCode::ErrorDetection::CRC8 detector; // As attached by create()
+
+    for (int i = compiledIsa() + 1; i <= cpuIsa(); ++i) {
+        const IsaLevel moduleIsa = static_cast<IsaLevel>(i);
+        const KernelTable* kernels = loadModule(moduleIsa);
+#ifdef POLARCODE_ISA_DISPATCH
+        CPPUNIT_ASSERT_MESSAGE(std::string("No kernel module for ") + isaName(moduleIsa),
+                               kernels != nullptr);
+#endif
+        if (kernels == nullptr) {
+            continue;
+        }
+        CPPUNIT_ASSERT_EQUAL(i, int(kernels->isa));
+
+        for (size_t listSize : { 1, 4 }) {
+            for (std::string type : { "float", "char" }) {
+                std::unique_ptr<Decoder> reference;
+                if (listSize == 1 && type == "float") {
+                    reference.reset(new FastSscAvxFloat(blockLength, frozenBits));
+                } else if (listSize == 1) {
+                    reference.reset(new FastSscFipChar(blockLength, frozenBits));
+                } else if (type == "float") {
+                    reference.reset(new SclAvxFloat(blockLength, listSize, frozenBits));
+                } else {
+                    reference.reset(new SclFipChar(blockLength, listSize, frozenBits));
+                }
+                reference->setErrorDetection(&detector);
+
+                // The plan and the buffers of the module's decoder are those of
+                // this library
+                DecoderPlan::clearCache();
+                const size_t allocations = PolarCode::alignedAllocationCount();
+                std::unique_ptr<Decoder> decoder(
+                    kernels->createDecoder(blockLength, listSize, frozenBits, type));
+                CPPUNIT_ASSERT_EQUAL(size_t(1), DecoderPlan::cacheSize());
+                CPPUNIT_ASSERT(PolarCode::alignedAllocationCount() > allocations);
+
+                std::vector<unsigned char> expected(nFrames * infoBytes);
+                std::vector<unsigned char> output(nFrames * infoBytes);
+                reference->decode_batch(signal.data(), nFrames, expected.data());
+                decoder->decode_batch(signal.data(), nFrames, output.data());
+                CPPUNIT_ASSERT_MESSAGE(std::string(isaName(moduleIsa)) + " " + type +
+                                           " decoder, list size " +
+                                           std::to_string(listSize),
+                                       expected == output);
+            }
+        }
+    }
+}
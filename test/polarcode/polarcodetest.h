@@ -19,6 +19,8 @@ class PolarCodeTest : public CppUnit::TestFixture
     CPPUNIT_TEST(testAvx2);
     CPPUNIT_TEST(testAvx2List);
     CPPUNIT_TEST(testAvxConvenience);
+    CPPUNIT_TEST(testDataPool);
+    CPPUNIT_TEST(testIsaDispatch);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -28,6 +30,8 @@ public:
     void testAvx2();
     void testAvx2List();
     void testAvxConvenience();
+    void testDataPool();
+    void testIsaDispatch();
 };
 
 #endif // PC_TEST_POLARCODE_H
@@ -8,8 +8,234 @@
 
 #include "transmissiontest.h"
 
+#include <signalprocessing/modulation/ask.h>
+#include <signalprocessing/modulation/bpsk.h>
+#include <signalprocessing/philox.h>
+#include <signalprocessing/transmission/awgn.h>
+#include <signalprocessing/transmission/fusedchannel.h>
+#include <signalprocessing/transmission/scale.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 CPPUNIT_TEST_SUITE_REGISTRATION(TransmissionTest);
 
 void TransmissionTest::setUp() {}
 
 void TransmissionTest::tearDown() {}
+
+void TransmissionTest::testPhiloxKnownAnswer()
+{
+    using SignalProcessing::Random::Philox;
+
+    // Known answers of the Random123 reference implementation
+    uint32_t counter[3][4] = { { 0, 0, 0, 0 },
+                               { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+                               { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 } };
+    const uint32_t key[3][2] = { { 0, 0 },
+                                 { 0xffffffff, 0xffffffff },
+                                 { 0xa4093822, 0x299f31d0 } };
+    const uint32_t expected[3][4] = {
+        { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+        { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+        { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }
+    };
+
+    for (int i = 0; i < 3; ++i) {
+        Philox::hash(counter[i], key[i]);
+        CPPUNIT_ASSERT(memcmp(counter[i], expected[i], sizeof(expected[i])) == 0);
+    }
+}
+
+void TransmissionTest::testPhiloxBlocks()
+{
+    using SignalProcessing::Random::Philox;
+
+    const uint64_t seed = 0x0123456789abcdefULL;
+    const uint32_t key[2] = { uint32_t(seed), uint32_t(seed >> 32) };
+    Philox generator(seed, 5);
+    uint32_t words[3][32];
+
+    generator.setBlock(7);
+    generator.generate(reinterpret_cast<__m256i*>(words[0]));
+    generator.generate(reinterpret_cast<__m256i*>(words[1]));
+
+    // Vector lanes match the scalar reference at their counters
+    for (unsigned draw = 0; draw < 16; ++draw) {
+        uint32_t counter[4] = { draw, 7, 0, 5 };
+        Philox::hash(counter, key);
+        for (unsigned word = 0; word < 4; ++word) {
+            CPPUNIT_ASSERT_EQUAL(counter[word], words[draw / 8][word * 8 + draw % 8]);
+        }
+    }
+
+    // Jumping back reproduces a block, other blocks and streams differ
+    generator.setBlock(7);
+    generator.generate(reinterpret_cast<__m256i*>(words[2]));
+    CPPUNIT_ASSERT(memcmp(words[0], words[2], sizeof(words[0])) == 0);
+
+    generator.setBlock(8);
+    generator.generate(reinterpret_cast<__m256i*>(words[2]));
+    CPPUNIT_ASSERT(memcmp(words[0], words[2], sizeof(words[0])) != 0);
+
+    generator.seed(seed, 6);
+    generator.setBlock(7);
+    generator.generate(reinterpret_cast<__m256i*>(words[2]));
+    CPPUNIT_ASSERT(memcmp(words[0], words[2], sizeof(words[0])) != 0);
+}
+
+void TransmissionTest::testAwgnReproducible()
+{
+    SignalProcessing::Transmission::Awgn channel;
+    std::vector<float> clean(1024, 1.0f);
+    std::vector<float> first(clean), second(clean), third(clean);
+
+    channel.setEsN0(2.0f);
+    channel.seed(42, 3);
+
+    channel.setBlock(10);
+    channel.setSignal(&first);
+    channel.transmit();
+
+    channel.setBlock(11);
+    channel.setSignal(&third);
+    channel.transmit();
+
+    channel.setBlock(10);
+    channel.setSignal(&second);
+    channel.transmit();
+
+    CPPUNIT_ASSERT(first == second);
+    CPPUNIT_ASSERT(first != third);
+    CPPUNIT_ASSERT(first != clean);
+}
+
+void TransmissionTest::testAwgnArbitraryLength()
+{
+    SignalProcessing::Transmission::Awgn channel;
+    const size_t length = 869; // Rate-matched, not a multiple of the vector size
+    std::vector<float> buffer(length + 16, 1.0f);
+    std::vector<float> first(buffer), second(buffer);
+
+    channel.setEsN0(2.0f);
+    channel.seed(7, 0);
+
+    // Noise on every symbol, nothing beyond the frame
+    first.resize(length);
+    channel.setBlock(0);
+    channel.setSignal(&first);
+    channel.transmit();
+    first.resize(length + 16, 1.0f);
+    for (size_t i = length - 16; i < length; ++i) {
+        CPPUNIT_ASSERT(first[i] != 1.0f);
+    }
+    CPPUNIT_ASSERT(std::equal(first.begin() + length, first.end(), buffer.begin()));
+
+    // Another block gives another tail
+    second.resize(length);
+    channel.setBlock(1);
+    channel.setSignal(&second);
+    channel.transmit();
+    for (size_t i = length - 5; i < length; ++i) {
+        CPPUNIT_ASSERT(first[i] != second[i]);
+    }
+
+    // Noise power within 10% of the expected variance
+    double power = 0.0;
+    std::vector<float> noise(length * 64);
+    channel.getNoise(noise.data(), length, 64, 100);
+    for (float n : noise) {
+        power += n * n;
+    }
+    power /= noise.size();
+    const double variance = 1.0 / (2.0 * pow(10.0, 0.2));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(variance, power, variance * 0.1);
+}
+
+void TransmissionTest::testAwgnBatch()
+{
+    SignalProcessing::Transmission::Awgn channel;
+    const size_t length = 100, nFrames = 5;
+    std::vector<float> batch(length * nFrames, -1.0f);
+
+    channel.setEsN0(0.0f);
+    channel.seed(11, 2);
+    channel.transmit_batch(batch.data(), length, nFrames, 20);
+
+    for (size_t frame = 0; frame < nFrames; ++frame) {
+        std::vector<float> single(length, -1.0f);
+        channel.setBlock(20 + frame);
+        channel.setSignal(&single);
+        channel.transmit();
+        CPPUNIT_ASSERT(
+            std::equal(single.begin(), single.end(), batch.begin() + frame * length));
+    }
+}
+
+void TransmissionTest::testFusedChannel()
+{
+    using namespace SignalProcessing;
+
+    const size_t lengths[] = { 8, 869, 1024 };
+    const unsigned modulations[] = { 1, 2, 3 };
+
+    for (size_t length : lengths) {
+        for (unsigned bps : modulations) {
+            // Random code bits
+            std::vector<unsigned char> bits((length + 7) / 8);
+            std::vector<float> floatBits(length);
+            Random::Philox(3).fill(bits.data(), bits.size());
+            for (size_t i = 0; i < length; ++i) {
+                floatBits[i] = (bits[i / 8] << (i % 8)) & 0x80 ? -0.0f : 0.0f;
+            }
+
+            // Reference: separate passes, as in the simulation
+            Modulation::Modem* modem;
+            if (bps == 1) {
+                modem = new Modulation::Bpsk();
+            } else {
+                modem = new Modulation::Ask(bps);
+            }
+            Transmission::Awgn awgn(1.0f);
+            Transmission::Scale scale(4.0f);
+            modem->setInputSignal(&floatBits);
+            modem->modulate();
+            std::vector<float> signal(*modem->outputSignal());
+            awgn.seed(5, 1);
+            awgn.setSignal(&signal);
+            awgn.transmit();
+            modem->setInputSignal(&signal);
+            modem->demodulate();
+            std::vector<float> expected(*modem->outputSignal());
+            scale.setSignal(&expected);
+            scale.transmit();
+            expected.resize(length);
+
+            // Saturated and rounded to nearest, as CharContainer::insertLlr()
+            std::vector<char> expectedChar(length);
+            for (size_t i = 0; i < length; ++i) {
+                float clamped = std::min(std::max(expected[i], -128.0f), 127.0f);
+                expectedChar[i] = static_cast<char>(std::nearbyint(clamped));
+            }
+
+            // Single pass
+            Transmission::FusedChannel channel(bps);
+            channel.setEsN0(1.0f);
+            channel.setAmplification(4.0f);
+            channel.seed(5, 1);
+            std::vector<float> llr(length + 1, 99.0f);
+            channel.transmit(bits.data(), length, llr.data());
+            CPPUNIT_ASSERT_EQUAL(99.0f, llr[length]);
+            llr.resize(length);
+            CPPUNIT_ASSERT(llr == expected);
+
+            channel.setBlock(0);
+            std::vector<char> llrChar(length);
+            channel.transmit(bits.data(), length, llrChar.data());
+            CPPUNIT_ASSERT(llrChar == expectedChar);
+
+            delete modem;
+        }
+    }
+}
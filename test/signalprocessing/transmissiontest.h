@@ -13,12 +13,24 @@
 class TransmissionTest : public CppUnit::TestFixture
 {
     CPPUNIT_TEST_SUITE(TransmissionTest);
-    //	CPPUNIT_TEST(test);
+    CPPUNIT_TEST(testPhiloxKnownAnswer);
+    CPPUNIT_TEST(testPhiloxBlocks);
+    CPPUNIT_TEST(testAwgnReproducible);
+    CPPUNIT_TEST(testAwgnArbitraryLength);
+    CPPUNIT_TEST(testAwgnBatch);
+    CPPUNIT_TEST(testFusedChannel);
     CPPUNIT_TEST_SUITE_END();
 
 public:
     void setUp();
     void tearDown();
+
+    void testPhiloxKnownAnswer();
+    void testPhiloxBlocks();
+    void testAwgnReproducible();
+    void testAwgnArbitraryLength();
+    void testAwgnBatch();
+    void testFusedChannel();
 };
 
 #endif // PC_TEST_TRANSMISSION_H
@@ -0,0 +1,171 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#include "statisticstest.h"
+#include "statistics.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using Simulation::Statistics;
+
+CPPUNIT_TEST_SUITE_REGISTRATION(StatisticsTest);
+
+void StatisticsTest::setUp() {}
+
+void StatisticsTest::tearDown() {}
+
+void StatisticsTest::testPercentiles()
+{
+    Statistics stat;
+    CPPUNIT_ASSERT_EQUAL(0.0f, stat.percentile(0.5));
+
+    // Shuffled decoding times of 1 to 10000 microseconds, so the p-th
+    // percentile is p * 10 milliseconds
+    std::vector<float> values;
+    for (int i = 1; i <= 10000; ++i) {
+        values.push_back(i * 1e-6f);
+    }
+    std::shuffle(values.begin(), values.end(), std::mt19937());
+    for (float value : values) {
+        stat.insert(value);
+    }
+
+    for (double fraction : { 0.01, 0.5, 0.9, 0.99, 0.999, 0.9999 }) {
+        const float expected = fraction * 1e-2;
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(
+            expected, stat.percentile(fraction), expected / 256);
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1e-6, stat.percentile(0.0), 1e-6 / 256);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1e-2, stat.percentile(1.0), 1e-2 / 256);
+
+    // Values out of range are counted in the first and last bucket
+    Statistics outliers;
+    outliers.insert(0.0f);
+    outliers.insert(1e6f);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), outliers.count());
+    CPPUNIT_ASSERT(outliers.percentile(0.5) < 1e-9f);
+    CPPUNIT_ASSERT(outliers.percentile(1.0) > 1000.0f);
+    CPPUNIT_ASSERT_EQUAL(1e6f, outliers.evaluate().max);
+}
+
+void StatisticsTest::testDeviation()
+{
+    // Jitter of ten microseconds on top of a second, where the sum of squares
+    // would cancel out
+    std::mt19937 generator;
+    std::normal_distribution<float> dist(1.0f, 1e-5f);
+    std::vector<float> values(100000);
+    double sum = 0.0;
+    for (float& value : values) {
+        value = dist(generator);
+        sum += value;
+    }
+    const double mean = sum / values.size();
+    double squares = 0.0;
+    for (float value : values) {
+        squares += (value - mean) * (value - mean);
+    }
+    const double dev = sqrt(squares / (values.size() - 1));
+
+    Statistics stat;
+    for (float value : values) {
+        stat.insert(value);
+    }
+    auto out = stat.evaluate();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(mean, out.mean, mean * 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(dev, out.dev, dev * 1e-6);
+}
+
+void StatisticsTest::testMerge()
+{
+    std::mt19937 generator;
+    std::lognormal_distribution<float> dist(-10.0f, 1.0f);
+
+    Statistics single, parts[3];
+    for (int i = 0; i < 30000; ++i) {
+        const float value = dist(generator);
+        single.insert(value);
+        parts[i % 3].insert(value);
+    }
+
+    Statistics merged;
+    merged.merge(Statistics()); // Empty histograms are ignored
+    for (const Statistics& part : parts) {
+        merged.merge(part);
+    }
+
+    // Buckets, count and limits are equal, sums up to rounding
+    std::vector<uint64_t> singleWords = single.serialize();
+    std::vector<uint64_t> mergedWords = merged.serialize();
+    CPPUNIT_ASSERT_EQUAL(singleWords.size(), mergedWords.size());
+    CPPUNIT_ASSERT_EQUAL(singleWords[0], mergedWords[0]);
+    CPPUNIT_ASSERT_EQUAL(singleWords[3], mergedWords[3]);
+    for (size_t i = 4; i < singleWords.size(); ++i) {
+        CPPUNIT_ASSERT_EQUAL(singleWords[i], mergedWords[i]);
+    }
+
+    auto expected = single.evaluate();
+    auto out = merged.evaluate();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.mean, out.mean, expected.mean * 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.dev, out.dev, expected.dev * 1e-6);
+    CPPUNIT_ASSERT_EQUAL(expected.p50, out.p50);
+    CPPUNIT_ASSERT_EQUAL(expected.p9999, out.p9999);
+}
+
+void StatisticsTest::testSerialization()
+{
+    std::mt19937 generator;
+    std::exponential_distribution<float> dist(1e5f);
+
+    Statistics stat;
+    for (int i = 0; i < 1000; ++i) {
+        stat.insert(dist(generator));
+    }
+    std::vector<uint64_t> words = stat.serialize();
+
+    Statistics restored;
+    restored.insert(1.0f); // Overwritten
+    CPPUNIT_ASSERT(restored.deserialize(words));
+    CPPUNIT_ASSERT(words == restored.serialize());
+    CPPUNIT_ASSERT_EQUAL(stat.count(), restored.count());
+    CPPUNIT_ASSERT_EQUAL(stat.evaluate().dev, restored.evaluate().dev);
+    CPPUNIT_ASSERT_EQUAL(stat.percentile(0.99), restored.percentile(0.99));
+
+    CPPUNIT_ASSERT(restored.deserialize(Statistics().serialize()));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), restored.count());
+}
+
+void StatisticsTest::testMalformedWords()
+{
+    Statistics stat;
+    for (float value : { 1e-6f, 2e-6f, 2e-6f, 5e-6f }) {
+        stat.insert(value);
+    }
+    const std::vector<uint64_t> words = stat.serialize();
+
+    std::vector<std::vector<uint64_t>> malformed;
+    malformed.emplace_back(words.begin(), words.begin() + 3); // Truncated header
+    malformed.emplace_back(words.begin(), words.end() - 1);   // Half a bucket
+    malformed.push_back(words);
+    malformed.back()[0]++; // Count does not match the buckets
+    malformed.push_back(words);
+    malformed.back()[4] = 1u << 30; // Bucket index out of range
+    malformed.push_back(words);
+    malformed.back()[2] = 0xFFF8000000000000ull; // NaN deviation
+    malformed.push_back(words);
+    malformed.back()[3] = malformed.back()[3] << 32 | malformed.back()[3] >> 32;
+
+    Statistics restored;
+    for (const auto& bad : malformed) {
+        restored.insert(1.0f);
+        CPPUNIT_ASSERT(!restored.deserialize(bad));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), restored.count());
+    }
+}
@@ -0,0 +1,34 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2018 Florian Lotze
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+
+#ifndef PC_TEST_STATISTICS_H
+#define PC_TEST_STATISTICS_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class StatisticsTest : public CppUnit::TestFixture
+{
+    CPPUNIT_TEST_SUITE(StatisticsTest);
+    CPPUNIT_TEST(testPercentiles);
+    CPPUNIT_TEST(testDeviation);
+    CPPUNIT_TEST(testMerge);
+    CPPUNIT_TEST(testSerialization);
+    CPPUNIT_TEST(testMalformedWords);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+    void testPercentiles();
+    void testDeviation();
+    void testMerge();
+    void testSerialization();
+    void testMalformedWords();
+};
+
+#endif // PC_TEST_STATISTICS_H